@@ -11,6 +11,7 @@ import (
 	"io"
 	"os"
 	"runtime/debug"
+	"strings"
 	"sync"
 	"time"
 
@@ -20,8 +21,11 @@ import (
 	"github.com/rokath/trice/internal/do"
 	"github.com/rokath/trice/internal/emitter"
 	"github.com/rokath/trice/internal/id"
+	"github.com/rokath/trice/internal/metrics"
+	"github.com/rokath/trice/internal/profile"
 	"github.com/rokath/trice/internal/receiver"
 	"github.com/rokath/trice/internal/translator"
+	"github.com/rokath/trice/internal/trexDecoder"
 	"github.com/rokath/trice/pkg/cipher"
 	"github.com/rokath/trice/pkg/msg"
 	"github.com/spf13/afero"
@@ -183,6 +187,14 @@ func logLoop(w io.Writer, fSys *afero.Afero) {
 	m.Lock()
 	ilu.AddFmtCount(w)
 	m.Unlock()
+	if id.TilCache != "" && id.TilCache != "off" { // firmware identity trices select the ID table per stream
+		c, err := id.NewLutCache(w, fSys, id.TilCache)
+		msg.FatalOnErr(err)
+		if b, err := fSys.ReadFile(id.FnJSON); err == nil {
+			c.Add(id.TilHash(b), ilu)
+		}
+		trexDecoder.TilCache = c
+	}
 	// Just in case the id list file FnJSON gets updated, the file watcher updates lut.
 	// This way trice needs NOT to be restarted during development process.
 	////////////////////////////////////////// go ilu.FileWatcher(w, fSys, m)
@@ -207,10 +219,21 @@ func logLoop(w io.Writer, fSys *afero.Afero) {
 		}
 	}
 
+	metrics.Start(w)
+	if strings.ToUpper(receiver.Port) == "TCP4SERVER" { // many device connections, each with its own line composer
+		address := receiver.PortArguments
+		if address == "default" {
+			address = receiver.DefaultTCP4ServerArgs
+		}
+		msg.OnErr(translator.Serve(w, ilu, m, li, address))
+		return
+	}
 	sw := emitter.New(w)
+	profile.Setup(fSys, ilu, li)
 	var interrupted bool
 	var counter int
 
+	receiver.TargetBigEndian = translator.TriceEndianness == "bigEndian"
 	for {
 		rwc, e := receiver.NewReadWriteCloser(w, fSys, Verbose, receiver.Port, receiver.PortArguments)
 		if e != nil {
@@ -233,6 +256,7 @@ func logLoop(w io.Writer, fSys *afero.Afero) {
 		}
 		e = translator.Translate(w, sw, ilu, m, li, rwc)
 		if io.EOF == e {
+			profile.Finish(w)
 			return // end of predefined buffer
 		}
 	}
@@ -7,11 +7,14 @@ import (
 	"flag"
 	"fmt"
 
+	"github.com/rokath/trice/internal/clock"
 	"github.com/rokath/trice/internal/com"
 	"github.com/rokath/trice/internal/decoder"
 	"github.com/rokath/trice/internal/do"
 	"github.com/rokath/trice/internal/emitter"
 	"github.com/rokath/trice/internal/id"
+	"github.com/rokath/trice/internal/metrics"
+	"github.com/rokath/trice/internal/profile"
 	"github.com/rokath/trice/internal/receiver"
 	"github.com/rokath/trice/internal/translator"
 	"github.com/rokath/trice/internal/trexDecoder"
@@ -98,6 +101,7 @@ func logInit() {
 	fsScLog.StringVar(&cipher.Password, "password", "", `The decrypt passphrase. If you change this value you need to compile the target with the appropriate key (see -showKeys).
 Encryption is recommended if you deliver firmware to customers and want protect the trice log output. This does work right now only with flex and flexL format.`) // flag
 	fsScLog.StringVar(&cipher.Password, "pw", "", "Short for -password.") // short flag
+	fsScLog.StringVar(&cipher.Mode, "cipher", "XTEA", `The target encryption with -password. Options: XTEA (TRICE_DEFERRED_XTEA_ENCRYPT) and SPECK (TRICE_DEFERRED_STREAM_ENCRYPT, Speck64/128 in counter mode without padding).`)
 	fsScLog.BoolVar(&cipher.ShowKey, "showKey", false, `Show encryption key. Use this switch for creating your own password keys. If applied together with "-password MySecret" it shows the encryption key.
 Simply copy this key than into the line "#define ENCRYPT XTEA_KEY( ea, bb, ec, 6f, 31, 80, 4e, b9, 68, e2, fa, ea, ae, f1, 50, 54 ); //!< -password MySecret" inside triceConfig.h.
 `+boolInfo)
@@ -109,6 +113,11 @@ Logs without channel specifier are not suppressed. Using an invalid value like "
 		`PC timestamp for logs and logfile name, options: 'off|none|UTCmicro|zero'
 This timestamp switch generates the timestamps on the PC only (reception time), what is good enough for many cases. 
 "LOCmicro" means local time with microseconds. "UTCmicro" shows timestamps in universal time. When set to "off" no PC timestamps displayed.`) // flag
+	fsScLog.StringVar(&receiver.ArrivalStamp, "arrival", "off", `Host arrival time column in front of the target stamp, options: 'off|none|us|LOCmicro|UTCmicro'
+The time is taken, when the port read returns the bytes, and holds for all trices inside. So it is not delayed by decoding and display.
+"us" shows the seconds with microseconds since the first trice arrival. "LOCmicro" and "UTCmicro" show the local or universal time of day.`)
+	fsScLog.StringVar(&clock.Format, "correlate", "off", `Reconstructed host time column of the target stamps in front of the target stamp, options: 'off|none|LOCmicro|UTCmicro'
+The target stamps are correlated with the host arrival times. Offset and drift are fitted continuously and are not disturbed by queueing delays. Logs of several targets get a common time line this way. 16-bit stamps need at least one trice per wrap period. Target clock sync trices (see -syncID) improve the fit.`)
 	fsScLog.StringVar(&decoder.ShowID, "showID", "", `Format string for displaying first trice ID at start of each line. Example: "debug:%7d ". Default is "". If several trices form a log line only the first trice ID ist displayed.`)
 	fsScLog.StringVar(&decoder.LocationInformationFormatString, "liFmt", "info:%21s %5d ", `Target location format string at start of each line, if target location existent (configured). Use "off" or "none" to suppress existing target location. If several trices form a log line only the location of first trice ist displayed.`)
 	fsScLog.StringVar(&decoder.TargetStamp, "ts", "µs", `Target timestamp general format string at start of each line, if target timestamps existent (configured). Choose between "µs" (or "us") and "ms", use "" or 'off' or 'none' to suppress existing target timestamps. Sets ts0, ts16, ts32 if these not passed. If several trices form a log line only the timestamp of first trice ist displayed.`)
@@ -121,7 +130,7 @@ This timestamp switch generates the timestamps on the PC only (reception time),
 	fsScLog.StringVar(&emitter.Prefix, "prefix", defaultPrefix, "Line prefix, options: any string or 'off|none' or 'source:' followed by 0-12 spaces, 'source:' will be replaced by source value e.g., 'COM17:'.") // flag
 	fsScLog.StringVar(&emitter.Suffix, "suffix", "", "Append suffix to all lines, options: any string.")                                                                                                           // flag
 
-	info := `Case insensitive receiver device name: 'serial name|JLINK|STLINK|FILE|FILEBUFFER|TCP4|TCP4BUFFER|DEC|BUFFER|HEX|DUMP. 
+	info := `Case insensitive receiver device name: 'serial name|JLINK|STLINK|FILE|FILEBUFFER|FLASHIMAGE|SHM|TCP4|TCP4BUFFER|TCP4SERVER|DEC|BUFFER|HEX|DUMP. 
 The serial name is like 'COM12' for Windows or a Linux name like '/dev/tty/usb12'. 
 Using a virtual serial COM port on the PC over a FTDI USB adapter is a most likely variant.
 `
@@ -143,8 +152,11 @@ port "J-LINK": default="`, receiver.DefaultLinkArgs, `", `, linkArgsInfo, `
 port "ST-LINK": default="`, receiver.DefaultLinkArgs, `", `, linkArgsInfo, `
 port "FILE": default="`, receiver.DefaultFileArgs, `", Option for args is any file name for binary log data like written []byte{115, 111, 109, 101, 10}. Trice retries on EOF.
 port "FILEBUFFER": default="`, receiver.DefaultFileArgs, `", Option for args is any file name for binary log data like written []byte{115, 111, 109, 101, 10}. Trice stops on EOF.
+port "FLASHIMAGE": default="`, receiver.DefaultFlashImageArgs, `", Option for args is a flash memory dump file name with a trice log written by the target code with TRICE_DEFERRED_FLASH == 1. Trice stops at the log end.
+port "SHM": default="`, receiver.DefaultSHMArgs, `", Option for args is the POSIX shared memory name of a trice ring written by target code running on the same Linux host with TRICE_SHM == 1. Trice waits for data.
 port "TCP4": default="`, receiver.DefaultTCP4Args, `", use any IP:port endpoint like "127.0.0.1:19021". This port is usable for reading, when the Trice logs go into a TCP server.
 port "TCP4BUFFER": default="`, receiver.DefaultTCP4Args, `". This port is used for "-port TCP4" testing, to shutdown the Trice tool automatically.
+port "TCP4SERVER": default="`, receiver.DefaultTCP4ServerArgs, `", use any listen address like "0.0.0.0:17005". Trice accepts any number of device connections and decodes each on its own, only TREX encoding. The "source:" prefix shows the peer address. Closed connections report their throughput, -metricsInterval reports all open connections periodically.
 port "DEC" or "BUFFER": default="`, receiver.DefaultBUFFERArgs, `", Option for args is any space separated decimal number byte sequence. Example -p BUFFER -args "7 123 44".
 port "HEX" or "DUMP": default="`, receiver.DefaultDumpArgs, `", Option for args is any space or comma separated byte sequence in hex. Example: -p DUMP -args "7B 1A ee,88, 5a".
 `)
@@ -152,6 +164,9 @@ port "HEX" or "DUMP": default="`, receiver.DefaultDumpArgs, `", Option for args
 	execInfo := `Use to pass an additional command line for port TCP4 (like gdbserver start).`
 
 	fsScLog.StringVar(&receiver.PortArguments, "args", "default", argsInfo)
+	fsScLog.StringVar(&receiver.RTTChannels, "rttChannels", "", `Comma separated RTT up-channel list for port J-LINK or ST-LINK, like "0,1".
+With more than one channel, an RTT logger runs for each channel and the trice packages are merged by their 32-bit target stamps.
+The channels need the same package framing. Example: "trice log -p J-LINK -rttChannels 0,1 -pf TCOBS".`)
 	fsScLog.StringVar(&do.TCPOutAddr, "tcp", "", `TCP address for an external log receiver like Putty. Example: 1st: "trice log -p COM1 -tcp localhost:64000", 2nd "putty". In "Terminal" enable "Implicit CR in every LF", In "Session" Connection type:"Other:Telnet", specify "hostname:port" here like "localhost:64000".`)
 	fsScLog.BoolVar(&emitter.DisplayRemote, "displayserver", false, `Send trice lines to displayserver @ ipa:ipp.
 Example: "trice l -port COM38 -ds -ipa 192.168.178.44" sends trice output to a previously started display server in the same network.`)
@@ -186,6 +201,20 @@ Example: "-pick err:wrn -pick default" results in suppressing all messages despi
 	fsScLog.StringVar(&decoder.PackageFraming, "packageFraming", "TCOBSv1", `Use "none" or "COBS" as alternative. "COBS" needs "#define TRICE_FRAMING TRICE_FRAMING_COBS" inside "triceConfig.h".`)
 	fsScLog.StringVar(&decoder.PackageFraming, "pf", "TCOBSv1", "Short for '-packageFraming'.")
 	fsScLog.BoolVar(&trexDecoder.AddNewlineToEachTriceMessage, "addNL", false, `Add a newline char at trice messages end to use for example "hi" instead of "hi\n" in source code.`)
+	fsScLog.BoolVar(&trexDecoder.Compressed, "compressed", false, `Expand trices compressed by the target with TRICE_DEFERRED_COMPRESS == 1. Needs COBS or TCOBS package framing.`)
+	fsScLog.IntVar(&trexDecoder.DiagnosticsID, "diagID", 16369, `Reserved ID of the target TriceLogDiagnostics record, must match TRICE_DIAGNOSTICS_ID. It is decoded without til.json entry. 0 disables the special handling.`)
+	fsScLog.IntVar(&trexDecoder.SyncID, "syncID", 16367, `Reserved ID of the target clock sync trice, must match TRICE_CLOCK_SYNC_ID. It is used only for -correlate and not displayed. 0 disables the special handling.`)
+	fsScLog.IntVar(&trexDecoder.PostMortemID, "postMortemID", 16368, `Reserved ID of the target post mortem markers, must match TRICE_POST_MORTEM_ID. The trices from before a target reset are shown between "previous boot" lines. 0 disables the special handling.`)
+	fsScLog.IntVar(&trexDecoder.IdentityID, "identityID", 16366, `Reserved ID of the target firmware identity trice, must match TRICE_IDENTITY_ID. It carries the til.json hash and selects the matching -tilCache version for the stream. 0 disables the special handling.`)
+	fsScLog.StringVar(&id.TilCache, "tilCache", "off", `Directory with til.json versions, written by "trice insert -tilCache". Each stream is decoded with the version matching its firmware identity trice, until then with the -i til.json. The versions are read on first use.`)
+	fsScLog.BoolVar(&profile.Enabled, "profile", false, `Accumulate per-ID and per-file (via li.json) trice counts, bytes, rates and burst maxima and print a top table at the end of the log session (CTRL-C or end of a buffer or FILEBUFFER port). 
+For an offline profile replay a binary logfile with "-port FILEBUFFER -args file.bin -profileClock target". See also -profileTop and -profileReport.`)
+	fsScLog.IntVar(&profile.Top, "profileTop", 20, `Row count of the -profile tables.`)
+	fsScLog.StringVar(&profile.ReportFile, "profileReport", "off", `Write the -profile result into this file. A ".json" extension selects JSON, other names get CSV with the per-ID rows followed by the per-file rows with an empty ID.`)
+	fsScLog.StringVar(&profile.Clock, "profileClock", "host", `Time base for -profile rates and bursts: "host" uses the reception time, "target" the 32-bit target timestamps (unit according -ts32 "ms" or "µs").`)
+	fsScLog.StringVar(&metrics.Address, "metrics", "off", `Local HTTP endpoint like "localhost:9464" serving live log statistics at "/metrics" in Prometheus text format. 
+Counted are decoded trices, received bytes and packages, lost trices (inferred from cycle counter gaps), unknown IDs, framing errors, decode latencies, trices per ID and the per ID rates over the last 10 seconds. Use "off" or "none" to disable.`)
+	fsScLog.IntVar(&metrics.Interval, "metricsInterval", 0, `Print every n seconds a summary line with trices/s, bytes/s, packages/s, loss counters and the 3 IDs with the highest rates. 0 disables the summary line.`)
 }
 
 func addInit() {
@@ -216,6 +245,19 @@ func insertIDsInit() {
 	fsScInsert.IntVar(&id.DefaultStampSize, "defaultStampSize", 32, "Default stamp size for written TRICE macros without id(0), Id(0 or ID(0). Valid values are 0, 16 or 32.")
 	fsScInsert.StringVar(&id.SearchMethod, "IDMethod", "random", "Search method for new ID's in range- Options are 'upward', 'downward' & 'random'.")
 	fsScInsert.BoolVar(&id.ExtendMacrosWithParamCount, "addParamCount", false, "Extend TRICE macro names with the parameter count _n to enable compile time checks.")
+	flagCache(fsScInsert)
+	fsScInsert.BoolVar(&id.Watch, "watch", false, `Keep running after the insert pass and patch each saved source file within milliseconds.
+The ID state stays in memory and til.json and li.json are written after each batch of saved files.
+Build steps can ask the daemon with "trice insert -watchCheck" instead of running a full pass.
+`+boolInfo)
+	fsScInsert.BoolVar(&id.WatchCheck, "watchCheck", false, `Ask a "trice insert -watch" daemon for the same til.json first.
+If it has processed all saved files, nothing else is done, otherwise a normal insert pass follows.
+`+boolInfo)
+	fsScInsert.StringVar(&id.GeneratedHeader, "generatedHeader", "off", `Write a C header with TRICE_SINGLE_MAX_SIZE and ENABLE_* switches for only the trice variants in use, for example "triceGenerated.h".
+Include it at the begin of triceConfig.h, so flash and RAM shrink automatically. "off" or "none" disable it. The file is written only on changes.
+`)
+	fsScInsert.StringVar(&id.TilCache, "tilCache", "off", `Directory, where a copy of til.json is stored as "<hash>.json". The hash is TRICE_GENERATED_TIL_HASH inside the -generatedHeader file. "trice log -tilCache" selects the til.json version per target with it.`)
+	fsScInsert.StringVar(&id.WatchAddress, "watchAddress", id.WatchAddress, "Local address of the watch daemon query socket.")
 }
 
 func zeroInit() {
@@ -226,6 +268,7 @@ func zeroInit() {
 func cleanIDsInit() {
 	fsScClean = flag.NewFlagSet("cleanSourceTreeIds", flag.ContinueOnError)
 	flagsRefreshAndUpdate(fsScClean)
+	flagCache(fsScClean)
 }
 
 func versionInit() {
@@ -314,6 +357,14 @@ Add this flag for skript speed-up, when not editing the souces.
 	p.BoolVar(&id.SkipAdditionalChecks, "skip", false, "short for skipAdditionalChecks") // flag
 }
 
+func flagCache(p *flag.FlagSet) {
+	p.BoolVar(&id.CacheEnabled, "cache", false, `Use the Trice cache in $HOME/.trice/cache (see docs/TriceCacheSpec.md).
+Unedited files are restored from the cache with their former modification time instead of being parsed and written again.
+So "trice insert" and "trice clean" around each build do not trigger a re-compilation of unedited files anymore.
+The cache needs the li.json file and is not used together with "-dry-run".
+`+boolInfo) // flag
+}
+
 func flagIDList(p *flag.FlagSet) {
 	p.StringVar(&id.FnJSON, "idlist", id.FnJSON, `The trice ID list file.
 The specified JSON file is needed to display the ID coded trices during runtime and should be under version control.
@@ -119,11 +119,18 @@ sub-command 'l|log': For displaying trice logs coming from port. With "trice log
     		For args options see JLinkRTTLogger in SEGGER UM08001_JLink.pdf.
     	port "FILE": default="trices.raw", Option for args is any file name for binary log data like written []byte{115, 111, 109, 101, 10}. Trice retries on EOF.
     	port "FILEBUFFER": default="trices.raw", Option for args is any file name for binary log data like written []byte{115, 111, 109, 101, 10}. Trice stops on EOF.
+    	port "FLASHIMAGE": default="triceFlash.bin", Option for args is a flash memory dump file name with a trice log written by the target code with TRICE_DEFERRED_FLASH == 1. Trice stops at the log end.
+    	port "SHM": default="/trice", Option for args is the POSIX shared memory name of a trice ring written by target code running on the same Linux host with TRICE_SHM == 1. Trice waits for data.
     	port "TCP4": default="localhost:17001", use any IP:port endpoint like "127.0.0.1:19021". This port is usable for reading, when the Trice logs go into a TCP server.
     	port "TCP4BUFFER": default="localhost:17001". This port is used for "-port TCP4" testing, to shutdown the Trice tool automatically.
+    	port "TCP4SERVER": default=":17005", use any listen address like "0.0.0.0:17005". Trice accepts any number of device connections and decodes each on its own, only TREX encoding. The "source:" prefix shows the peer address. Closed connections report their throughput, -metricsInterval reports all open connections periodically.
     	port "DEC" or "BUFFER": default="0 0 0 0", Option for args is any space separated decimal number byte sequence. Example -p BUFFER -args "7 123 44".
     	port "HEX" or "DUMP": default="", Option for args is any space or comma separated byte sequence in hex. Example: -p DUMP -args "7B 1A ee,88, 5a".
     	 (default "default")
+  -arrival string
+    	Host arrival time column in front of the target stamp, options: 'off|none|us|LOCmicro|UTCmicro'
+    	The time is taken, when the port read returns the bytes, and holds for all trices inside. So it is not delayed by decoding and display.
+    	"us" shows the seconds with microseconds since the first trice arrival. "LOCmicro" and "UTCmicro" show the local or universal time of day. (default "off")
   -ban value
     	Channel(s) to ignore. This is a multi-flag switch. It can be used several times with a colon separated list of channel descriptors not to display.
     	Example: "-ban dbg:wrn -ban diag" results in suppressing all as debug, diag and warning tagged messages. Not usable in conjunction with "-pick". See also "-logLevel".
@@ -142,6 +149,8 @@ sub-command 'l|log': For displaying trice logs coming from port. With "trice log
     	 (default "off")
   -blf string
     	Short for binaryLogfile (default "off")
+  -cipher string
+    	The target encryption with -password. Options: XTEA (TRICE_DEFERRED_XTEA_ENCRYPT) and SPECK (TRICE_DEFERRED_STREAM_ENCRYPT, Speck64/128 in counter mode without padding). (default "XTEA")
   -color string
     	The format strings can start with a lower or upper case channel information.
     	See https://github.com/rokath/trice/blob/master/pkg/src/triceCheck.c for examples. Color options: 
@@ -149,6 +158,11 @@ sub-command 'l|log': For displaying trice logs coming from port. With "trice log
     	"none": Disable ANSI color. The lower case channel information is removed: "w:x"-> "x"
     	"default|color": Use ANSI color codes for known upper and lower case channel info are inserted and lower case channel information is removed.
     	 (default "default")
+  -compressed
+    	Expand trices compressed by the target with TRICE_DEFERRED_COMPRESS == 1. Needs COBS or TCOBS package framing.
+  -correlate string
+    	Reconstructed host time column of the target stamps in front of the target stamp, options: 'off|none|LOCmicro|UTCmicro'
+    	The target stamps are correlated with the host arrival times. Offset and drift are fitted continuously and are not disturbed by queueing delays. Logs of several targets get a common time line this way. 16-bit stamps need at least one trice per wrap period. Target clock sync trices (see -syncID) improve the fit. (default "off")
   -d16
     	Short for '-Doubled16BitID'.
   -databits int
@@ -159,6 +173,8 @@ sub-command 'l|log': For displaying trice logs coming from port. With "trice log
     	Show additional debug information
   -defaultTRICEBitwidth string
     	The expected value bit width for TRICE macros. Options: 8, 16, 32, 64. Must be in sync with the 'TRICE_DEFAULT_PARAMETER_BIT_WIDTH' setting inside triceConfig.h (default "32")
+  -diagID int
+    	Reserved ID of the target TriceLogDiagnostics record, must match TRICE_DIAGNOSTICS_ID. It is decoded without til.json entry. 0 disables the special handling. (default 16369)
   -displayserver
     	Send trice lines to displayserver @ ipa:ipp.
     	Example: "trice l -port COM38 -ds -ipa 192.168.178.44" sends trice output to a previously started display server in the same network.
@@ -186,6 +202,8 @@ sub-command 'l|log': For displaying trice logs coming from port. With "trice log
   -idList string
     	Alternate for '-idlist'.
     	 (default "til.json")
+  -identityID int
+    	Reserved ID of the target firmware identity trice, must match TRICE_IDENTITY_ID. It carries the til.json hash and selects the matching -tilCache version for the stream. 0 disables the special handling. (default 16366)
   -idlist string
     	The trice ID list file.
     	The specified JSON file is needed to display the ID coded trices during runtime and should be under version control.
@@ -229,6 +247,11 @@ sub-command 'l|log': For displaying trice logs coming from port. With "trice log
     	All trice output of the appropriate subcommands is appended per default into the logfile additionally to the normal output.
     	Change the filename with "-logfile myName.txt" or switch logging off with "-logfile none".
     	 (default "off")
+  -metrics string
+    	Local HTTP endpoint like "localhost:9464" serving live log statistics at "/metrics" in Prometheus text format. 
+    	Counted are decoded trices, received bytes and packages, lost trices (inferred from cycle counter gaps), unknown IDs, framing errors, decode latencies, trices per ID and the per ID rates over the last 10 seconds. Use "off" or "none" to disable. (default "off")
+  -metricsInterval int
+    	Print every n seconds a summary line with trices/s, bytes/s, packages/s, loss counters and the 3 IDs with the highest rates. 0 disables the summary line.
   -newlineIndent int
     	Force newline offset for trice format strings with line breaks before end. -1=auto sense (default -1)
   -p string
@@ -246,14 +269,29 @@ sub-command 'l|log': For displaying trice logs coming from port. With "trice log
     	Channel(s) to display. This is a multi-flag switch. It can be used several times with a colon separated list of channel descriptors only to display.
     	Example: "-pick err:wrn -pick default" results in suppressing all messages despite of as error, warning and default tagged messages. Not usable in conjunction with "-ban". See also "-logLevel".
   -port string
-    	Case insensitive receiver device name: 'serial name|JLINK|STLINK|FILE|FILEBUFFER|TCP4|TCP4BUFFER|DEC|BUFFER|HEX|DUMP. 
+    	Case insensitive receiver device name: 'serial name|JLINK|STLINK|FILE|FILEBUFFER|FLASHIMAGE|SHM|TCP4|TCP4BUFFER|TCP4SERVER|DEC|BUFFER|HEX|DUMP. 
     	The serial name is like 'COM12' for Windows or a Linux name like '/dev/tty/usb12'. 
     	Using a virtual serial COM port on the PC over a FTDI USB adapter is a most likely variant.
     	 (default "J-LINK")
+  -postMortemID int
+    	Reserved ID of the target post mortem markers, must match TRICE_POST_MORTEM_ID. The trices from before a target reset are shown between "previous boot" lines. 0 disables the special handling. (default 16368)
   -prefix string
     	Line prefix, options: any string or 'off|none' or 'source:' followed by 0-12 spaces, 'source:' will be replaced by source value e.g., 'COM17:'. (default "source: ")
+  -profile
+    	Accumulate per-ID and per-file (via li.json) trice counts, bytes, rates and burst maxima and print a top table at the end of the log session (CTRL-C or end of a buffer or FILEBUFFER port). 
+    	For an offline profile replay a binary logfile with "-port FILEBUFFER -args file.bin -profileClock target". See also -profileTop and -profileReport.
+  -profileClock string
+    	Time base for -profile rates and bursts: "host" uses the reception time, "target" the 32-bit target timestamps (unit according -ts32 "ms" or "µs"). (default "host")
+  -profileReport string
+    	Write the -profile result into this file. A ".json" extension selects JSON, other names get CSV with the per-ID rows followed by the per-file rows with an empty ID. (default "off")
+  -profileTop int
+    	Row count of the -profile tables. (default 20)
   -pw string
     	Short for -password.
+  -rttChannels string
+    	Comma separated RTT up-channel list for port J-LINK or ST-LINK, like "0,1".
+    	With more than one channel, an RTT logger runs for each channel and the trice packages are merged by their 32-bit target stamps.
+    	The channels need the same package framing. Example: "trice log -p J-LINK -rttChannels 0,1 -pf TCOBS".
   -s	Short for '-showInputBytes'.
   -showID string
     	Format string for displaying first trice ID at start of each line. Example: "debug:%7d ". Default is "". If several trices form a log line only the first trice ID ist displayed.
@@ -268,6 +306,8 @@ sub-command 'l|log': For displaying trice logs coming from port. With "trice log
     	Serial port stopbit, options: 1.5, 2 (default "1")
   -suffix string
     	Append suffix to all lines, options: any string.
+  -syncID int
+    	Reserved ID of the target clock sync trice, must match TRICE_CLOCK_SYNC_ID. It is used only for -correlate and not displayed. 0 disables the special handling. (default 16367)
   -tcp string
     	TCP address for an external log receiver like Putty. Example: 1st: "trice log -p COM1 -tcp localhost:64000", 2nd "putty". In "Terminal" enable "Implicit CR in every LF", In "Session" Connection type:"Other:Telnet", specify "hostname:port" here like "localhost:64000".
   -testTable
@@ -275,6 +315,8 @@ sub-command 'l|log': For displaying trice logs coming from port. With "trice log
   -til string
     	Short for '-idlist'.
     	 (default "til.json")
+  -tilCache string
+    	Directory with til.json versions, written by "trice insert -tilCache". Each stream is decoded with the version matching its firmware identity trice, until then with the -i til.json. The versions are read on first use. (default "off")
   -triceEndianness string
     	Target endianness trice data stream. Option: "bigEndian". (default "littleEndian")
   -ts string
@@ -475,12 +517,22 @@ sub-command 'i|insert': For updating til.json and inserting IDs into source file
     	Lower end of ID range for normal trices. (default 1000)
   -addParamCount
     	Extend TRICE macro names with the parameter count _n to enable compile time checks.
+  -cache
+    	Use the Trice cache in $HOME/.trice/cache (see docs/TriceCacheSpec.md).
+    	Unedited files are restored from the cache with their former modification time instead of being parsed and written again.
+    	So "trice insert" and "trice clean" around each build do not trigger a re-compilation of unedited files anymore.
+    	The cache needs the li.json file and is not used together with "-dry-run".
+    	This is a bool switch. It has no parameters. Its default value is false. If the switch is applied its value is true. You can also set it explicit: =false or =true.
   -defaultStampSize int
     	Default stamp size for written TRICE macros without id(0), Id(0 or ID(0). Valid values are 0, 16 or 32. (default 32)
   -dry-run
     	No changes applied but output shows what would happen.
-    	"trice update -dry-run" will change nothing but show changes it would perform without the "-dry-run" switch.
+    	"trice insertSourceTreeIds -dry-run" will change nothing but show changes it would perform without the "-dry-run" switch.
     	This is a bool switch. It has no parameters. Its default value is false. If the switch is applied its value is true. You can also set it explicit: =false or =true.
+  -generatedHeader string
+    	Write a C header with TRICE_SINGLE_MAX_SIZE and ENABLE_* switches for only the trice variants in use, for example "triceGenerated.h".
+    	Include it at the begin of triceConfig.h, so flash and RAM shrink automatically. "off" or "none" disable it. The file is written only on changes.
+    	 (default "off")
   -i string
     	Short for '-idlist'.
     	 (default "til.json")
@@ -514,23 +566,34 @@ sub-command 'i|insert': For updating til.json and inserting IDs into source file
     	This reduses the processing time by a few percent but does not detect wrong parameter counts, anyway the compiler would complain.
     	Add this flag for skript speed-up, when not editing the souces.
     	This is a bool switch. It has no parameters. Its default value is false. If the switch is applied its value is true. You can also set it explicit: =false or =true.
-  -spacing
-    	Add space between Trice opening brace and ID name. Use this if your default code auto-formatting is with space after opening brace.
   -src value
     	Source dir or file, It has one parameter. Not usable in the form "-src *.c".
     	This is a multi-flag switch. It can be used several times for directories and also for files. 
-    	Example: "trice update -dry-run -v -src ./test/ -src pkg/src/trice.h" will scan all C|C++ header and 
+    	Example: "trice insertSourceTreeIds -dry-run -v -src ./test/ -src pkg/src/trice.h" will scan all C|C++ header and 
     	source code files inside directory ./test and scan also file trice.h inside pkg/src directory. 
     	Without the "-dry-run" switch it would create|extend a list file til.json in the current directory.
     	 (default "./")
   -til string
     	Short for '-idlist'.
     	 (default "til.json")
+  -tilCache string
+    	Directory, where a copy of til.json is stored as "<hash>.json". The hash is TRICE_GENERATED_TIL_HASH inside the -generatedHeader file. "trice log -tilCache" selects the til.json version per target with it. (default "off")
   -v	short for verbose
   -verbose
     	Gives more informal output if used. Can be helpful during setup.
     	For example "trice u -dry-run -v" is the same as "trice u -dry-run" but with more descriptive output.
     	This is a bool switch. It has no parameters. Its default value is false. If the switch is applied its value is true. You can also set it explicit: =false or =true.
+  -watch
+    	Keep running after the insert pass and patch each saved source file within milliseconds.
+    	The ID state stays in memory and til.json and li.json are written after each batch of saved files.
+    	Build steps can ask the daemon with "trice insert -watchCheck" instead of running a full pass.
+    	This is a bool switch. It has no parameters. Its default value is false. If the switch is applied its value is true. You can also set it explicit: =false or =true.
+  -watchAddress string
+    	Local address of the watch daemon query socket. (default "localhost:61496")
+  -watchCheck
+    	Ask a "trice insert -watch" daemon for the same til.json first.
+    	If it has processed all saved files, nothing else is done, otherwise a normal insert pass follows.
+    	This is a bool switch. It has no parameters. Its default value is false. If the switch is applied its value is true. You can also set it explicit: =false or =true.
 sub-command 'z|zero': Set all [id|Id|ID|iD](n) inside source tree dir to [id|Id|ID|iD](0).
 #	All in source code found IDs are added to til.json if not already there. Inside til.json differently used IDs are 
 #	reported and just zeroed inside the source files. The existing li.json is updated/extended. 
@@ -598,6 +661,12 @@ sub-command 'c|clean': Set all [id|Id|ID](n) inside source tree dir to [id|Id|ID
 #	EXPERIMENTAL! With "#define TRICE_CLEAN 1" inside "triceConfig.h" these displayed "errors" are suppressable.
 #	EXPERIMENTAL! All files including trice.h are re-compiled then on the next compiler run, what could be time-consuming.
 #	In difference to "trice zero", Trice function calls get iD(n) removed. Example: "TRice( iD(88), "hi);" -> "TRice("hi);"
+  -cache
+    	Use the Trice cache in $HOME/.trice/cache (see docs/TriceCacheSpec.md).
+    	Unedited files are restored from the cache with their former modification time instead of being parsed and written again.
+    	So "trice insert" and "trice clean" around each build do not trigger a re-compilation of unedited files anymore.
+    	The cache needs the li.json file and is not used together with "-dry-run".
+    	This is a bool switch. It has no parameters. Its default value is false. If the switch is applied its value is true. You can also set it explicit: =false or =true.
   -dry-run
     	No changes applied but output shows what would happen.
     	"trice cleanSourceTreeIds -dry-run" will change nothing but show changes it would perform without the "-dry-run" switch.
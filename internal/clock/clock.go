@@ -0,0 +1,243 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+// Package clock correlates the target stamps with the host arrival times for "trice log -correlate".
+//
+// The decoder hands each target stamp together with the host arrival time of its package to Trice.
+// The arrival time is the emission time plus a non-negative queueing delay. So the points with the
+// smallest delay form the lower convex hull of all (target stamp, host time) pairs. The fitted line is
+// the hull edge below the stamp mean. It has the smallest summed distance to all points of all lines
+// below them and is therefore not moved by delayed packages. Its slope is the target clock drift.
+//
+// 16-bit and 32-bit stamps are correlated separately, because they can be different target clocks.
+// Stamp wraps are counted. A 16-bit stamp needs at least one trice per wrap period. A longer
+// pause is bridged only when the host time shows several wrap periods. A 32-bit stamp jumping
+// back starts a new correlation after a target reset.
+// Target clock sync trices (TriceClockSync with TRICE_CLOCK_SYNC_ID) have a small and constant delay.
+// When at least 2 of them arrived, only they are used for the fit.
+package clock
+
+import (
+	"math"
+	"sync"
+	"time"
+
+	"github.com/rokath/trice/internal/decoder"
+)
+
+// Format is the reconstructed time column format: "off", "none", "LOCmicro" or "UTCmicro".
+var Format = "off"
+
+// Active returns true, when the reconstructed time column is shown.
+func Active() bool {
+	return Format != "off" && Format != "none"
+}
+
+// maxDeviation is the largest accepted relative target clock deviation. A steeper fit is replaced by the nominal slope.
+// This happens at the start, when all packages arrived in one read.
+const maxDeviation = 0.05
+
+// point is a target stamp extended by the wraps and the host time in ns since the correlation start.
+type point struct {
+	x, y float64
+}
+
+// hull is the lower convex hull of all added points and their count and x sum.
+type hull struct {
+	pts  []point
+	n    int
+	sumX float64
+}
+
+// add inserts q. The x values are added in not decreasing order.
+func (h *hull) add(q point) {
+	h.n++
+	h.sumX += q.x
+	if k := len(h.pts); k > 0 && h.pts[k-1].x == q.x {
+		if h.pts[k-1].y <= q.y {
+			return // not below the hull
+		}
+		h.pts = h.pts[:k-1]
+	}
+	for k := len(h.pts); k >= 2; k = len(h.pts) {
+		o, a := h.pts[k-2], h.pts[k-1]
+		if (a.x-o.x)*(q.y-o.y)-(a.y-o.y)*(q.x-o.x) > 0 { // left turn
+			break
+		}
+		h.pts = h.pts[:k-1]
+	}
+	h.pts = append(h.pts, q)
+}
+
+// line returns intercept and slope of the hull edge below the x mean. With a single point, slope is the nominal value.
+func (h *hull) line(nominal float64) (intercept, slope float64) {
+	k := len(h.pts)
+	if k == 0 {
+		return 0, nominal
+	}
+	if k == 1 {
+		return h.pts[0].y - nominal*h.pts[0].x, nominal
+	}
+	mean := h.sumX / float64(h.n)
+	i := 0
+	for i < k-2 && h.pts[i+1].x < mean {
+		i++
+	}
+	a, b := h.pts[i], h.pts[i+1]
+	slope = (b.y - a.y) / (b.x - a.x)
+	if math.Abs(slope/nominal-1) > maxDeviation { // too short or batched start
+		return b.y - nominal*b.x, nominal
+	}
+	return a.y - slope*a.x, slope
+}
+
+// correlator is the state for one target stamp size.
+type correlator struct {
+	bits    uint      // bits is the stamp width.
+	started bool      // started is true after the first stamp.
+	base    time.Time // base is the host arrival of the first stamp and the host time reference.
+	raw     uint64    // raw is the last target stamp.
+	ext     uint64    // ext is the last target stamp extended by the counted wraps.
+	host    float64   // host is the host arrival of the last stamp in ns since base.
+	x       float64   // x is the extended stamp of the last trice, which can be an out of order stamp.
+	all     hull      // all is the hull of all points.
+	sync    hull      // sync is the hull of the clock sync trice points.
+}
+
+// tick returns the nominal target stamp period in ns.
+func (c *correlator) tick() float64 {
+	unit := decoder.TargetStamp32
+	if c.bits == 16 {
+		unit = decoder.TargetStamp16
+	}
+	switch unit {
+	case "us", "µs", "ms_µs", "ssss,ms_µs":
+		return float64(time.Microsecond)
+	case "ms", "s,ms", "hh:mm:ss,ms":
+		return float64(time.Millisecond)
+	}
+	if decoder.TargetStamp == "ms" {
+		return float64(time.Millisecond)
+	}
+	return float64(time.Microsecond)
+}
+
+// add correlates stamp with the host arrival time.
+//
+// A stamp slightly smaller than the last one is an out of order stamp, for example from an interrupt.
+// It gets a reconstructed time, but does not change the fit. A 32-bit stamp more than a second smaller is a target reset.
+func (c *correlator) add(stamp uint64, arrival time.Time, sync bool) {
+	modulus := uint64(1) << c.bits
+	stamp &= modulus - 1
+	back := (c.raw - stamp) & (modulus - 1)
+	switch {
+	case c.started && back != 0 && back < c.tolerance():
+		c.x = float64(c.ext - back)
+		return
+	case !c.started || c.bits == 32 && stamp < c.raw && c.raw-stamp < modulus/2:
+		*c = correlator{bits: c.bits, started: true, base: arrival, raw: stamp, ext: stamp}
+	default:
+		delta := (stamp - c.raw) & (modulus - 1)
+		host := float64(arrival.Sub(c.base))
+		if period := float64(modulus) * c.tick(); host-c.host > 4*period { // long pause: count the wraps from the host time
+			intercept, slope := c.line()
+			gap := host - (intercept + slope*float64(c.ext)) - float64(delta)*c.tick()
+			if wraps := math.Floor(gap/period + 0.5); wraps > 0 {
+				delta += uint64(wraps) * modulus
+			}
+		}
+		c.raw = stamp
+		c.ext += delta
+	}
+	c.host = float64(arrival.Sub(c.base))
+	c.x = float64(c.ext)
+	q := point{c.x, c.host}
+	c.all.add(q)
+	if sync {
+		c.sync.add(q)
+	}
+}
+
+// tolerance returns the stamp count, a stamp can be smaller than the last one without being a wrap or reset.
+func (c *correlator) tolerance() uint64 {
+	if c.bits == 16 {
+		return 1 << 12
+	}
+	return uint64(float64(time.Second) / c.tick())
+}
+
+// line returns the actual fit. The sync points are used, when at least 2 exist.
+func (c *correlator) line() (intercept, slope float64) {
+	if len(c.sync.pts) >= 2 {
+		return c.sync.line(c.tick())
+	}
+	return c.all.line(c.tick())
+}
+
+// time returns the reconstructed host time of the last stamp.
+func (c *correlator) time() time.Time {
+	intercept, slope := c.line()
+	return c.base.Add(time.Duration(math.Round(intercept + slope*c.x)))
+}
+
+// drift returns the target clock deviation in ppm. A positive value means a too fast target clock.
+func (c *correlator) drift() float64 {
+	_, slope := c.line()
+	return (c.tick()/slope - 1) * 1e6
+}
+
+var (
+	mu      sync.Mutex
+	stamp16 = correlator{bits: 16}
+	stamp32 = correlator{bits: 32}
+	last    *correlator // last is the correlator of the last trice or nil for a trice without stamp.
+)
+
+// Reset clears all collected values. It is used for tests.
+func Reset() {
+	mu.Lock()
+	defer mu.Unlock()
+	stamp16 = correlator{bits: 16}
+	stamp32 = correlator{bits: 32}
+	last = nil
+}
+
+// Trice adds a decoded trice with a size byte target stamp and its host arrival time.
+// sync is true for a target clock sync trice. A trice without stamp or arrival time is not correlated.
+func Trice(size int, stamp uint64, arrival time.Time, sync bool) {
+	mu.Lock()
+	defer mu.Unlock()
+	switch {
+	case arrival.IsZero():
+		last = nil
+	case size == 2:
+		last = &stamp16
+	case size == 4:
+		last = &stamp32
+	default:
+		last = nil
+	}
+	if last != nil {
+		last.add(stamp, arrival, sync)
+	}
+}
+
+// Time returns the reconstructed host time of the last trice. ok is false for a trice without stamp.
+func Time() (t time.Time, ok bool) {
+	mu.Lock()
+	defer mu.Unlock()
+	if last == nil {
+		return
+	}
+	return last.time(), true
+}
+
+// Drift returns the estimated target clock deviation in ppm for the size byte target stamps.
+func Drift(size int) float64 {
+	mu.Lock()
+	defer mu.Unlock()
+	if size == 2 {
+		return stamp16.drift()
+	}
+	return stamp32.drift()
+}
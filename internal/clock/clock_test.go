@@ -0,0 +1,74 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package clock
+
+import (
+	"math"
+	"math/rand"
+	"testing"
+	"time"
+
+	"github.com/rokath/trice/internal/decoder"
+	"github.com/tj/assert"
+)
+
+// emit feeds n trices every step of target time. The target clock runs ppm fast and starts at stamp.
+// Each package arrives after a random queueing delay of up to 20 ms. Every 10th package has no delay.
+// It returns the maximum deviation of the reconstructed time from the true emission time.
+func emit(size, n int, stamp uint64, step time.Duration, ppm float64) (maxErr time.Duration) {
+	r := rand.New(rand.NewSource(1))
+	base := time.Date(2024, 1, 2, 3, 4, 5, 0, time.UTC)
+	for i := 0; i < n; i++ {
+		emission := time.Duration(i) * step
+		s := stamp + uint64(float64(emission/time.Microsecond)*(1+ppm*1e-6))
+		delay := time.Duration(r.Int63n(int64(20 * time.Millisecond)))
+		if i%10 == 0 {
+			delay = 0
+		}
+		Trice(size, s, base.Add(emission+delay), false)
+		t, ok := Time()
+		if !ok {
+			return math.MaxInt64
+		}
+		d := t.Sub(base.Add(emission))
+		if d < 0 {
+			d = -d
+		}
+		if i > n/2 && d > maxErr { // after settling
+			maxErr = d
+		}
+	}
+	return
+}
+
+func TestCorrelate32(t *testing.T) {
+	Reset()
+	decoder.TargetStamp32 = "us"
+	maxErr := emit(4, 2000, 1000000, 7*time.Millisecond, 100)
+	assert.True(t, maxErr < 50*time.Microsecond, maxErr)
+	assert.True(t, math.Abs(Drift(4)-100) < 2, Drift(4))
+}
+
+func TestCorrelate16Wrap(t *testing.T) {
+	Reset()
+	decoder.TargetStamp16 = "us"
+	maxErr := emit(2, 2000, 60000, 7*time.Millisecond, -50) // 16-bit µs stamps wrap every 65.536 ms
+	assert.True(t, maxErr < 50*time.Microsecond, maxErr)
+	assert.True(t, math.Abs(Drift(2)+50) < 2, Drift(2))
+}
+
+func TestCorrelateReset(t *testing.T) {
+	Reset()
+	decoder.TargetStamp32 = "ms"
+	base := time.Now()
+	Trice(4, 5000, base, false)
+	Trice(4, 6000, base.Add(time.Second), false)
+	Trice(4, 10, base.Add(2*time.Second), false) // target reset
+	tm, ok := Time()
+	assert.True(t, ok)
+	assert.Equal(t, base.Add(2*time.Second), tm)
+	Trice(0, 0, base, false)
+	_, ok = Time()
+	assert.False(t, ok)
+}
@@ -11,6 +11,7 @@ import (
 	"regexp"
 	"strings"
 	"sync"
+	"time"
 
 	"github.com/rokath/trice/internal/id"
 )
@@ -93,6 +94,9 @@ var (
 	// decoder.LastTriceID is last decoded ID. It is used for switch -showID.
 	LastTriceID id.TriceID
 
+	// HostArrival is the host reception time of the last decoded trice, if the input reader provides it.
+	HostArrival time.Time
+
 	// TestTableMode is a special option for easy decoder test table generation.
 	TestTableMode bool
 
@@ -139,6 +143,24 @@ type Decoder interface {
 	SetInput(io.Reader)
 }
 
+// TriceInfo holds the values of a decoded trice, which the line composition needs besides the trice string.
+type TriceInfo struct {
+	ID        id.TriceID // ID is the trice ID, used for -showID and the location information.
+	Arrival   time.Time  // Arrival is the host reception time, if the input reader provides it.
+	StampSize int        // StampSize is the target stamp byte count 0, 2 or 4.
+	Stamp     uint64     // Stamp is the target stamp value.
+}
+
+// Informer is implemented by decoders, which keep the TriceInfo of the last decoded trice per instance.
+type Informer interface {
+	Info() TriceInfo
+}
+
+// ArrivalReader is implemented by input readers, which know the host reception time of the bytes returned with the last Read.
+type ArrivalReader interface {
+	Arrival() time.Time
+}
+
 // DecoderData is the common data struct for all decoders.
 type DecoderData struct {
 	W           io.Writer          // io.Stdout or the like
@@ -16,6 +16,7 @@ import (
 	"github.com/rokath/trice/internal/emitter"
 	"github.com/rokath/trice/internal/id"
 	"github.com/rokath/trice/internal/link"
+	"github.com/rokath/trice/internal/metrics"
 	"github.com/rokath/trice/internal/receiver"
 	"github.com/rokath/trice/internal/translator"
 	"github.com/rokath/trice/pkg/msg"
@@ -35,6 +36,7 @@ func DistributeArgs(w io.Writer, fSys *afero.Afero, logfileName string, verbose
 	link.Verbose = verbose
 	decoder.Verbose = verbose
 	emitter.Verbose = verbose
+	metrics.Verbose = verbose
 	receiver.Verbose = verbose
 	translator.Verbose = verbose
 	emitter.TestTableMode = decoder.TestTableMode
@@ -5,10 +5,12 @@
 package emitter
 
 import (
+	"bytes"
 	"fmt"
 	"io"
 	"os"
 	"strings"
+	"sync"
 
 	"github.com/rokath/trice/internal/receiver"
 	"github.com/rokath/trice/pkg/msg"
@@ -144,12 +146,56 @@ func New(w io.Writer) *TriceLineComposer {
 
 // setPrefix changes "source:" to e.g., "JLINK:".
 func setPrefix() {
+	Prefix = sourcePrefix(Prefix, receiver.Port)
+}
+
+// sourcePrefix returns prefix with a leading "source:" changed to source followed by ":".
+func sourcePrefix(prefix, source string) string {
 	defaultPrefix := "source:"
-	if strings.HasPrefix(Prefix, defaultPrefix) {
-		Prefix = receiver.Port + ":" + Prefix[len(defaultPrefix):]
-	} else if Prefix == "off" || Prefix == "none" {
-		Prefix = ""
+	if strings.HasPrefix(prefix, defaultPrefix) {
+		return source + ":" + prefix[len(defaultPrefix):]
+	} else if prefix == "off" || prefix == "none" {
+		return ""
 	}
+	return prefix
+}
+
+// SharedLineWriter serializes the lines of several concurrently used line composers into one line writer.
+// It is also an io.Writer for w, so other messages do not tear the lines apart.
+type SharedLineWriter struct {
+	mu sync.Mutex
+	w  io.Writer
+	lw LineWriter
+}
+
+// NewSharedLineWriter provides a line writer for w, which is usable from several goroutines.
+func NewSharedLineWriter(w io.Writer) *SharedLineWriter {
+	return &SharedLineWriter{w: w, lw: newLineWriter(w)}
+}
+
+// WriteLine writes line as a whole.
+func (p *SharedLineWriter) WriteLine(line []string) {
+	p.mu.Lock()
+	p.lw.WriteLine(line)
+	p.mu.Unlock()
+}
+
+// Write writes b unchanged to w.
+func (p *SharedLineWriter) Write(b []byte) (int, error) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	return p.w.Write(b)
+}
+
+// NewSource returns a line composer for the trice strings from source, writing into lw.
+// A "source:" Prefix is changed to source followed by ":".
+// The composer collects only a few line parts, because many of them can exist at the same time.
+func NewSource(lw LineWriter, source string) *TriceLineComposer {
+	p := newLineComposer(lw)
+	p.prefix = sourcePrefix(Prefix, source)
+	p.Line = make([]string, 0, 64)
+	p.concurrent = true
+	return p
 }
 
 // BanOrPickFilter returns len of b if b ist not filtered out, otherwise 0.
@@ -165,28 +211,62 @@ func banOrPickFilter(ban, pick channelArrayFlag, b []byte) int {
 	if ban == nil && pick == nil {
 		return len(b) // nothing to filter
 	}
-	msg.FatalInfoOnTrue(nil != Ban && nil != Pick, "switches -ban and -pick cannot be used together")
-	s := string(b)
-	sc := strings.SplitN(s, ":", 2) // example: "deb" -> []string{ "deb"} "deb:" -> []string{ "deb", "" }
-	if nil != Ban {
-		if len(sc) < 2 { // no color separator
-			return len(b) // nothing to filter
+	i := bytes.IndexByte(b, ':') // example: "deb" -> -1, "deb:" -> 3
+	if i < 0 {
+		i = len(b)
+	}
+	if channelShown(ban, pick, string(b[:i]), i < len(b)) {
+		return len(b)
+	}
+	return 0
+}
+
+// ChannelFilter returns the -ban and -pick decision for trices with format string strg.
+// The decoder uses it once per trice ID to drop filtered trices before formatting them.
+// If the channel specifier in strg contains a format specifier, known is false and only
+// BanOrPickFilter on the formatted string can decide.
+func ChannelFilter(strg string) (show, known bool) {
+	i := strings.IndexByte(strg, ':')
+	if i < 0 {
+		i = len(strg)
+	}
+	if strings.IndexByte(strg[:i], '%') >= 0 {
+		return true, false
+	}
+	return channelShown(Ban, Pick, strg[:i], i < len(strg)), true
+}
+
+// Filtering is true, when -ban or -pick is used.
+func Filtering() bool {
+	return Ban != nil || Pick != nil
+}
+
+// channelShown returns false, if channel ch is in ban or not in pick.
+// Without color separator (sep false) there is no channel, what is only filtered out with pick.
+func channelShown(ban, pick channelArrayFlag, ch string, sep bool) bool {
+	if ban == nil && pick == nil {
+		return true // nothing to filter
+	}
+	msg.FatalInfoOnTrue(nil != ban && nil != pick, "switches -ban and -pick cannot be used together")
+	if nil != ban {
+		if !sep { // no color separator
+			return true // nothing to filter
 		}
-		for _, c := range Ban {
-			if sc[0] == c {
-				return 0 // filter match
+		for _, c := range ban {
+			if ch == c {
+				return false // filter match
 			}
 		}
-		return len(b) // no filter match
-	} else { // Pick is set
-		if len(sc) < 2 { // no color separator
-			return 0 // filter out
-		}
-		for _, c := range Pick {
-			if sc[0] == c {
-				return len(b) // filter match
-			}
+		return true // no filter match
+	}
+	// pick is set
+	if !sep { // no color separator
+		return false // filter out
+	}
+	for _, c := range pick {
+		if ch == c {
+			return true // filter match
 		}
-		return 0 // no filter match
 	}
+	return false // no filter match
 }
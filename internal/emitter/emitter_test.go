@@ -49,3 +49,33 @@ func TestNewLineWriter(t *testing.T) {
 	var out bytes.Buffer
 	_ = newLineWriter(&out)
 }
+
+func TestChannelFilter(t *testing.T) {
+	defer func() { Ban, Pick = nil, nil }()
+	assert.Nil(t, Ban.Set("dbg:wrn"))
+	for _, x := range []struct {
+		strg        string
+		show, known bool
+	}{
+		{"deb:value=%d\n", false, true},
+		{"WARNING:stop", false, true},
+		{"msg:value=%d\n", true, true},
+		{"value=%d\n", true, false},
+		{"%s:value=%d\n", true, false},
+		{"no channel", true, true},
+	} {
+		show, known := ChannelFilter(x.strg)
+		assert.Equal(t, x.show, show, x.strg)
+		assert.Equal(t, x.known, known, x.strg)
+		if known {
+			assert.Equal(t, x.show, BanOrPickFilter([]byte(x.strg)) > 0, x.strg)
+		}
+	}
+	Ban = nil
+	assert.Nil(t, Pick.Set("msg"))
+	show, known := ChannelFilter("no channel")
+	assert.False(t, show)
+	assert.True(t, known)
+	show, _ = ChannelFilter("MESSAGE:%d")
+	assert.True(t, show)
+}
@@ -19,13 +19,25 @@ type TriceLineComposer struct {
 	suffix          string
 	Line            []string // line collector
 	err             error
+	esc             []byte // esc is the reused buffer for escape sequence resolution.
+	nl              []byte // nl is the reused buffer for newline normalization.
+	stampSecond     int64  // stampSecond is the host time second the cached stampHead belongs to.
+	stampHead       string // stampHead is the cached formatted host timestamp up to the microseconds.
+	stamp           []byte // stamp is the reused buffer for the host timestamp.
+	concurrent      bool   // concurrent is true, when several composers are in use at the same time. They leave NextLine untouched.
 }
 
 // newLineComposer constructs log lines according to these rules:...
 // It provides an io.StringWriter interface which is used for the reception of (trice) strings.
 // It uses lw for writing the generated lines.
 func newLineComposer(lw LineWriter) *TriceLineComposer {
-	p := &TriceLineComposer{lw, HostStamp, Prefix, Suffix, make([]string, 0, 4096), nil} // not more than 4096 strings per line expected
+	p := &TriceLineComposer{
+		lw:              lw,
+		timestampFormat: HostStamp,
+		prefix:          Prefix,
+		suffix:          Suffix,
+		Line:            make([]string, 0, 4096), // not more than 4096 strings per line expected
+	}
 	return p
 }
 
@@ -34,9 +46,9 @@ func (p *TriceLineComposer) timestamp() string {
 	var s string
 	switch p.timestampFormat {
 	case "LOCmicro":
-		s = time.Now().Format(time.StampMicro) + "  "
+		s = p.microStamp("", time.Now())
 	case "UTCmicro":
-		s = "UTC " + time.Now().UTC().Format(time.StampMicro) + "  "
+		s = p.microStamp("UTC ", time.Now().UTC())
 	case "off", "none":
 		s = ""
 	case "zero":
@@ -47,12 +59,79 @@ func (p *TriceLineComposer) timestamp() string {
 	return s
 }
 
+// microStamp returns head and t in time.StampMicro format followed by 2 spaces.
+// Only the microseconds are formatted on each call. The rest is formatted once per second.
+func (p *TriceLineComposer) microStamp(head string, t time.Time) string {
+	if sec := t.Unix(); sec != p.stampSecond || p.stampHead == "" {
+		p.stampSecond = sec
+		p.stampHead = head + t.Format("Jan _2 15:04:05.")
+	}
+	us := t.Nanosecond() / 1000
+	b := append(p.stamp[:0], p.stampHead...)
+	b = append(b, '0', '0', '0', '0', '0', '0', ' ', ' ')
+	for i := len(b) - 3; us > 0; i-- {
+		b[i] = byte('0' + us%10)
+		us /= 10
+	}
+	p.stamp = b
+	return string(b)
+}
+
 // Write treats received buffer as a string.
 func (p *TriceLineComposer) Write(b []byte) (n int, err error) {
 	s := string(b)
 	return p.WriteString(s)
 }
 
+// unescape resolves in s the escape sequences `\\`, `\a` and `\t` and converts `\r\n`, `\n` and "\r\n" into "\n".
+//
+// A `\\` resolved to `\` is able to form a `\n` with the following character.
+// s is returned unchanged, if it contains no backslash and no carriage return.
+// Otherwise, the result is built in 2 passes inside reused buffers.
+func (p *TriceLineComposer) unescape(s string) string {
+	if strings.IndexByte(s, '\\') < 0 && strings.IndexByte(s, '\r') < 0 {
+		return s
+	}
+	b := p.esc[:0]
+	for i := 0; i < len(s); i++ {
+		if s[i] == '\\' && i+1 < len(s) {
+			switch s[i+1] {
+			case '\\':
+				b = append(b, '\\')
+				i++
+				continue
+			case 'a':
+				b = append(b, '\a') // Alert or Bell
+				i++
+				continue
+			case 't':
+				b = append(b, '\t') // horizontal tab
+				i++
+				continue
+			}
+		}
+		b = append(b, s[i])
+	}
+	p.esc = b
+	n := p.nl[:0]
+	for i := 0; i < len(b); i++ {
+		c := b[i]
+		if c == '\\' && i+3 < len(b) && b[i+1] == 'r' && b[i+2] == '\\' && b[i+3] == 'n' {
+			c = '\n'
+			i += 3
+		} else if c == '\\' && i+1 < len(b) && b[i+1] == 'n' {
+			c = '\n'
+			i++
+		}
+		if c == '\n' && len(n) > 0 && n[len(n)-1] == '\r' {
+			n = n[:len(n)-1] // "\r\n" -> "\n"
+		}
+		n = append(n, c)
+	}
+	p.nl = n
+	return string(n)
+}
+
 // WriteString implements the io.StringWriter interface. The triceLineComposer can use it.
 // WriteString uses the internal line writer p.lw for writing out full lines.
 // If s is empty, WriteString returns 0, nil.
@@ -61,67 +140,50 @@ func (p *TriceLineComposer) Write(b []byte) (n int, err error) {
 // If s ends with newline it is added to p.line and also the suffix is added to p.line and pline is written to p.lw.
 // If s contains several newlines it is split there and the substrings are handled accordingly.
 // That means it writes internally a separate line for each substring (in s) ending with a newline.
+// The substrings are slices of the unescaped s, so no further allocations are needed.
 func (p *TriceLineComposer) WriteString(s string) (n int, err error) {
 	n = len(s)
 	if n == 0 {
 		return
 	}
-	var emptyLine bool
-	// https://www.geeksforgeeks.org/rune-in-golang/
-	bs := "~bs___________________bs~" // escaped backslash
-	sa := strings.ReplaceAll(s, `\\`, bs)
-	sb := strings.ReplaceAll(sa, `\a`, "\u0007") // Alert or Bell
-	sc := strings.ReplaceAll(sb, `\t`, "\u0009") // horizontal tab
-	sd := strings.ReplaceAll(sc, bs, "\\")
-	s0 := strings.ReplaceAll(sd, "\\r\\n", "\n")
-	s1 := strings.ReplaceAll(s0, "\\n", "\n")
-	sn := strings.ReplaceAll(s1, "\r\n", "\n")
-	ss := strings.Split(sn, "\n")
-
-	// play ground results:
-	// fmt.Printf("%q\n", strings.Split("a", "\n"))           // ["s"]                // 0 new line
-	// fmt.Printf("%q\n", strings.Split("a\n", "\n"))         // ["a" ""]             // 1 new line
-	// fmt.Printf("%q\n", strings.Split("", "\n"))            // [""]                 // 0 new line
-	// fmt.Printf("%q\n", strings.Split("\n", "\n"))          // ["" ""]              // 1 new lne
-	// fmt.Printf("%q\n", strings.Split("\n\n", "\n"))        // ["" "" ""]           // 2 new lines
-	// fmt.Printf("%q\n", strings.Split("a b c", "\n"))       // ["a b c"]            // 0 new line
-	// fmt.Printf("%q\n", strings.Split("a\nb\nc\n", "\n"))   // ["a" "b" "c" ""]     // 3 new lines
-	// fmt.Printf("%q\n", strings.Split("a\n\nb\nc\n", "\n")) // ["a" "" "b" "c" ""]  // 4 new lines
-	// fmt.Printf("%q\n", strings.Split("a\nb\nc", "\n"))     // ["a" "b" "c"]        // 2 new lines
-	// derived rule: len(ss)-1 is count of new lines
-	lineEndCount := len(ss) - 1
+	sn := p.unescape(s)
 
 	// One string with several newlines gets the identical timestamp.
 	// If a string was already started and gets completed with a following WriteString call,
 	// it keeps its original timestamp, but if following lines inside s they get a new timestamp.
-	ts := p.timestamp()
-	for _, sx := range ss {
-		if len(p.Line) == 0 && 0 < lineEndCount { // start new line && and complete line
-			p.Line = append(p.Line, ts, p.prefix, sx, p.suffix)
-			p.completeLine()
-			lineEndCount--
-		} else if len(p.Line) == 0 && lineEndCount == 0 { // start new line
-			p.Line = append(p.Line, ts, p.prefix, sx)
-			if len(sx) == 0 { // A new line with an empty string was started.
+	var ts string
+	var tsValid bool
+	for {
+		i := strings.IndexByte(sn, '\n')
+		lineEnd := i >= 0
+		sx := sn
+		if lineEnd {
+			sx = sn[:i]
+		}
+		if len(p.Line) == 0 {
+			if !lineEnd && len(sx) == 0 { // A new line with an empty string would be started.
 				// This could cause unwanted timestamp offsets if the next line is significantly delayed.
-				emptyLine = true
+				return
+			}
+			if !tsValid {
+				ts, tsValid = p.timestamp(), true
 			}
-		} else if 0 < len(p.Line) && 0 < lineEndCount { // complete line
-			p.Line = append(p.Line, sx, p.suffix)
-			p.completeLine()
-			lineEndCount--
-		} else if 0 < len(p.Line) && lineEndCount == 0 { // extend line
-			p.Line = append(p.Line, sx)
+			p.Line = append(p.Line, ts, p.prefix) // start new line
 		}
+		p.Line = append(p.Line, sx)
+		if !lineEnd { // extend line
+			return
+		}
+		p.Line = append(p.Line, p.suffix) // complete line
+		p.completeLine()
+		sn = sn[i+1:]
 	}
-	if emptyLine { // clean up
-		p.Line = p.Line[:0]
-	}
-	return
 }
 
 func (p *TriceLineComposer) completeLine() {
 	p.lw.WriteLine(p.Line)
 	p.Line = p.Line[:0]
-	NextLine = true
+	if !p.concurrent {
+		NextLine = true
+	}
 }
@@ -7,6 +7,7 @@ package emitter
 import (
 	"strings"
 	"testing"
+	"time"
 
 	"github.com/rokath/trice/pkg/msg"
 
@@ -71,3 +72,54 @@ func (p *checkDisplay) WriteLine(line []string) {
 	s := strings.Join(line, "")
 	p.lines = append(p.lines, s)
 }
+
+// replaceAllUnescape is the former WriteString escape handling, kept as reference for unescape.
+func replaceAllUnescape(s string) string {
+	bs := "~bs___________________bs~" // escaped backslash
+	sa := strings.ReplaceAll(s, `\\`, bs)
+	sb := strings.ReplaceAll(sa, `\a`, "\u0007") // Alert or Bell
+	sc := strings.ReplaceAll(sb, `\t`, "\u0009") // horizontal tab
+	sd := strings.ReplaceAll(sc, bs, "\\")
+	s0 := strings.ReplaceAll(sd, "\\r\\n", "\n")
+	s1 := strings.ReplaceAll(s0, "\\n", "\n")
+	return strings.ReplaceAll(s1, "\r\n", "\n")
+}
+
+func TestUnescape(t *testing.T) {
+	p := newLineComposer(newCheckDisplay())
+	for _, s := range []string{
+		"", "Hi", `Hi\n`, "Hi\r\n", `Hi\r\n`, `a\tb\ac`, `a\\b`, `a\\n`, `a\\\n`, `a\\\\n`,
+		"a\r\r\n", "a\r" + `\n`, "a\r" + `\r\n`, `\`, `a\`, `\\`, `\r`, "\r", `\t\a\\\r\n\n` + "\r\n",
+	} {
+		assert.Equal(t, replaceAllUnescape(s), p.unescape(s), s)
+	}
+}
+
+func TestMicroStamp(t *testing.T) {
+	p := newLineComposer(newCheckDisplay())
+	for _, ns := range []int{0, 7000, 999999000, 123456789} {
+		tm := time.Date(2024, 3, 5, 13, 4, 5, ns, time.Local)
+		assert.Equal(t, tm.Format(time.StampMicro)+"  ", p.microStamp("", tm))
+		u := tm.UTC().Add(time.Hour) // other second
+		assert.Equal(t, "UTC "+u.Format(time.StampMicro)+"  ", p.microStamp("UTC ", u), ns)
+	}
+}
+
+// discardDisplay is a Linewriter dropping all lines, used for benchmarks.
+type discardDisplay struct{}
+
+func (discardDisplay) WriteLine([]string) {}
+
+func BenchmarkLineComposer(b *testing.B) {
+	HostStamp = "LOCmicro"
+	Prefix = "COM1:"
+	Suffix = ""
+	defer func() { HostStamp, Prefix = "", "" }()
+	p := newLineComposer(discardDisplay{})
+	s := `msg:triceFifoDepthMax = 92 of max 128, triceStreamBufferDepthMax = 1360 of max 2048\n`
+	b.SetBytes(int64(len(s)))
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		_, _ = p.WriteString(s)
+	}
+}
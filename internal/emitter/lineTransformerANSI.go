@@ -21,6 +21,7 @@ import (
 type lineTransformerANSI struct {
 	lw           LineWriter
 	colorPalette string
+	l            []string // l is the reused transformed line. The LineWriter must not keep it.
 }
 
 func ShowAllColors() {
@@ -48,7 +49,7 @@ func ShowAllColors() {
 // newLineTransformerANSI translates lines to ANSI colors according to colorPalette.
 // It provides a Linewriter interface and uses internally a Linewriter.
 func newLineTransformerANSI(lw LineWriter, colorPalette string) *lineTransformerANSI {
-	p := &lineTransformerANSI{lw, colorPalette}
+	p := &lineTransformerANSI{lw, colorPalette, make([]string, 0, 10)}
 	return p
 }
 
@@ -136,15 +137,23 @@ var colorChannels = []colorChannel{
 	{0, []string{"Verbose", "verbose", "VERBOSE"}, colorizeVERBOSE},
 }
 
+// channelIndex maps each channel specifier to its colorChannels positions.
+// Some specifiers like "w" or "rx" are part of several channels.
+var channelIndex = func() map[string][]int {
+	m := make(map[string][]int)
+	for i, cc := range colorChannels {
+		for _, c := range cc.channel {
+			m[c] = append(m[c], i)
+		}
+	}
+	return m
+}()
+
 // ColorChannelEvents returns count of occurred channel events.
 // If ch is unknown, the returned value is -1.
 func ColorChannelEvents(ch string) int {
-	for _, s := range colorChannels {
-		for _, c := range s.channel {
-			if c == ch {
-				return s.events
-			}
-		}
+	if idx, ok := channelIndex[ch]; ok {
+		return colorChannels[idx[0]].events
 	}
 	return -1
 }
@@ -168,20 +177,25 @@ func PrintColorChannelEvents(w io.Writer) {
 // channelVariants returns all variants of ch as string slice.
 // If ch is not inside ansiSel nil is returned.
 func channelVariants(ch string) []string {
-	for _, s := range colorChannels {
-		for _, c := range s.channel {
-			if c == ch {
-				return s.channel
-			}
-		}
+	if idx, ok := channelIndex[ch]; ok {
+		return colorChannels[idx[0]].channel
 	}
 	return nil
 }
 
 // isChannel returns true if ch is any ansiSel string.
 func isChannel(ch string) bool {
-	cv := channelVariants(ch)
-	return cv != nil
+	_, ok := channelIndex[ch]
+	return ok
+}
+
+// logThreshold returns the colorChannels position of LogLevel or 0, if LogLevel is no channel.
+func logThreshold() int {
+	idx := channelIndex[LogLevel]
+	if len(idx) == 0 {
+		return 0
+	}
+	return idx[len(idx)-1]
 }
 
 // colorize prefixes s with an ansi color code according to these conditions:
@@ -192,30 +206,25 @@ func isChannel(ch string) bool {
 // Additionally, if global variable LogLevel is not the default "all", but found inside
 // ColorChannels, logs with higher index positions are suppressed.
 // As special case LogLevel == "off" does not output anything.
+// The channel is resolved with one channelIndex look-up.
 func (p *lineTransformerANSI) colorize(s string) (r string, show bool) {
 	if LogLevel == "off" {
 		return // do not log at all, return empty string
 	}
-	var logLev int       // numeric log level
-	var logThreshold int // numeric log threshold
 	r = s
-	sc := strings.SplitN(s, ":", 2)
-	if len(sc) < 2 { // no color separator (no log level)
+	i := strings.IndexByte(s, ':')
+	if i < 0 { // no color separator (no log level)
 		return r, true // do nothing, return unchanged string
 	}
-	for i, cc := range colorChannels {
-		for _, c := range cc.channel {
-			if c == sc[0] {
-				colorChannels[i].events++ // count event
-				logLev = i
-			}
-			if c == LogLevel {
-				logThreshold = i
-			}
-		}
+	ch := s[:i]
+	idx := channelIndex[ch]
+	var logLev int // numeric log level
+	for _, k := range idx {
+		colorChannels[k].events++ // count event
+		logLev = k
 	}
 
-	if LogLevel != "all" && logLev > logThreshold {
+	if LogLevel != "all" && logLev > logThreshold() {
 		r = "" // suppress unwanted logs
 		return r, false
 	}
@@ -223,20 +232,13 @@ func (p *lineTransformerANSI) colorize(s string) (r string, show bool) {
 	if p.colorPalette == "off" {
 		return r, true // do nothing (despite event counting)
 	}
-	if isChannel(sc[0]) && isLower(sc[0]) {
-		r = sc[1] // remove channel info
+	if idx != nil && isLower(ch) {
+		r = s[i+1:] // remove channel info
 	}
-	if p.colorPalette == "none" {
+	if p.colorPalette == "none" || idx == nil {
 		return r, true
 	}
-	for _, cs := range colorChannels {
-		for _, c := range cs.channel {
-			if c == sc[0] {
-				return cs.colorize(r), true
-			}
-		}
-	}
-	return r, true
+	return colorChannels[idx[0]].colorize(r), true
 }
 
 // WriteLine consumes a full line, translates it and writes it to the internal Linewriter.
@@ -245,7 +247,7 @@ func (p *lineTransformerANSI) colorize(s string) (r string, show bool) {
 func (p *lineTransformerANSI) WriteLine(line []string) {
 	var colored bool
 	showLine := true
-	l := make([]string, 0, 10)
+	l := p.l[:0]
 	for i, s := range line {
 		cs, show := p.colorize(s)
 		// The relevant channel information is probably in the last string in the line slice before the suffix.
@@ -267,4 +269,5 @@ func (p *lineTransformerANSI) WriteLine(line []string) {
 	if showLine { // suppress empty lines when logLevel == "off"
 		p.lw.WriteLine(l)
 	}
+	p.l = l
 }
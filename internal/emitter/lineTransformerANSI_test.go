@@ -79,3 +79,12 @@ func Test1WriteLine(t *testing.T) {
 	eq := strings.Join([]string{"M:msg", "I:Info", "wrn:End"}, "")
 	assert.Equal(t, []string{ep, eq}, lw.lines)
 }
+
+func BenchmarkLineTransformerANSI(b *testing.B) {
+	p := newLineTransformerANSI(discardDisplay{}, "default")
+	l := []string{"Jan  2 15:04:05.123456  ", "COM1:", "time: 842,150_450", "msg:triceFifoDepthMax = 92 of max 128", ""}
+	b.ReportAllocs()
+	for i := 0; i < b.N; i++ {
+		p.WriteLine(l)
+	}
+}
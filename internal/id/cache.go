@@ -0,0 +1,173 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package id
+
+// Trice cache, see docs/TriceCacheSpec.md
+
+import (
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"strings"
+
+	"github.com/spf13/afero"
+)
+
+var (
+	// CacheEnabled is true, when the -cache switch is set.
+	CacheEnabled bool
+
+	// CacheDir is the Trice cache root folder. "" means $HOME/.trice/cache.
+	CacheDir string
+)
+
+const (
+	cacheInserted = "inserted"
+	cacheCleaned  = "cleaned"
+)
+
+// cacheRoot returns the Trice cache root folder.
+func cacheRoot() (string, error) {
+	if CacheDir != "" {
+		return filepath.Abs(CacheDir)
+	}
+	home, err := os.UserHomeDir()
+	if err != nil {
+		return "", err
+	}
+	return filepath.Join(home, ".trice", "cache"), nil
+}
+
+// cachePath returns the cache file name of fn in the cache folder state ("inserted" or "cleaned").
+func cachePath(state, fn string) (string, error) {
+	dir, err := cacheRoot()
+	if err != nil {
+		return "", err
+	}
+	abs, err := filepath.Abs(fn)
+	if err != nil {
+		return "", err
+	}
+	return filepath.Join(dir, state, filepath.VolumeName(abs), abs[len(filepath.VolumeName(abs)):]), nil
+}
+
+// cacheUsable returns true, when the Trice cache can be used for this run.
+// Without location information the IDs of not parsed files would be unknown.
+func cacheUsable() bool {
+	return CacheEnabled && !DryRun && LIFnJSON != "off" && LIFnJSON != "none"
+}
+
+// cacheValid returns true, when cache file cFn exists and matches fileInfo in modification time and size.
+func cacheValid(fSys *afero.Afero, cFn string, fileInfo os.FileInfo) bool {
+	cInfo, err := fSys.Stat(cFn)
+	if err != nil {
+		return false
+	}
+	return cInfo.ModTime().Equal(fileInfo.ModTime()) && cInfo.Size() == fileInfo.Size()
+}
+
+// cacheRestore copies cache file cFn into fn and gives fn the modification time of cFn.
+// This way the build system sees fn unchanged since the cFn creation and does not recompile it.
+func cacheRestore(fSys *afero.Afero, cFn, fn string, fileInfo os.FileInfo) error {
+	cInfo, err := fSys.Stat(cFn)
+	if err != nil {
+		return err
+	}
+	b, err := fSys.ReadFile(cFn)
+	if err != nil {
+		return err
+	}
+	if err = fSys.WriteFile(fn, b, fileInfo.Mode()); err != nil {
+		return err
+	}
+	return fSys.Chtimes(fn, cInfo.ModTime(), cInfo.ModTime())
+}
+
+// cacheStore copies fn content b into the cache file cFn and gives it the modification time of fn.
+func cacheStore(fSys *afero.Afero, cFn, fn string, b []byte) error {
+	fileInfo, err := fSys.Stat(fn)
+	if err != nil {
+		return err
+	}
+	if err = fSys.MkdirAll(filepath.Dir(cFn), 0o755); err != nil {
+		return err
+	}
+	if err = fSys.WriteFile(cFn, b, fileInfo.Mode()); err != nil {
+		return err
+	}
+	return fSys.Chtimes(cFn, fileInfo.ModTime(), fileInfo.ModTime())
+}
+
+// cacheLookup checks the Trice cache for fn in the wanted state ("inserted" or "cleaned").
+// hit is true, when fn is now in the wanted state without parsing. This is the case, when fn
+// - is the unchanged cached wanted state already or
+// - is the unchanged cached other state and the cached wanted state exists, which gets restored then.
+// wantFn is the cache file name for storing the result after parsing, when hit is false. It is "" without usable cache.
+func cacheLookup(w io.Writer, fSys *afero.Afero, fn string, fileInfo os.FileInfo, want, other string) (hit bool, wantFn string) {
+	if !cacheUsable() {
+		return false, ""
+	}
+	wantFn, err := cachePath(want, fn)
+	if err != nil {
+		fmt.Fprintln(w, "Trice cache not usable:", err)
+		return false, ""
+	}
+	root, _ := cacheRoot()
+	abs, _ := filepath.Abs(fn)
+	if strings.HasPrefix(abs, root+string(filepath.Separator)) { // The cache folder is inside the source tree.
+		return true, "" // Cache files are never processed.
+	}
+	otherFn, _ := cachePath(other, fn)
+	if cacheValid(fSys, wantFn, fileInfo) {
+		return true, wantFn
+	}
+	if !cacheValid(fSys, otherFn, fileInfo) { // fn was edited or is not cached yet.
+		_ = fSys.Remove(otherFn) // A cached other state does not fit to the new content anymore.
+		return false, wantFn
+	}
+	if _, err := fSys.Stat(wantFn); err != nil {
+		return false, wantFn
+	}
+	if err := cacheRestore(fSys, wantFn, fn, fileInfo); err != nil {
+		fmt.Fprintln(w, "Trice cache restore failed:", err)
+		return false, wantFn
+	}
+	if Verbose {
+		fmt.Fprintln(w, "Restored from Trice cache:", fn)
+	}
+	return true, wantFn
+}
+
+// cacheUpdate stores the processed fn content b as cache file wantFn.
+func cacheUpdate(w io.Writer, fSys *afero.Afero, wantFn, fn string, b []byte) {
+	if wantFn == "" {
+		return
+	}
+	if err := cacheStore(fSys, wantFn, fn, b); err != nil {
+		fmt.Fprintln(w, "Trice cache update failed:", err)
+	}
+}
+
+// locRefByFile returns the IDs per location file name from the li.json reference data.
+func (p *idData) locRefByFile() map[string][]TriceID {
+	m := make(map[string][]TriceID)
+	for id, li := range p.idToLocRef {
+		m[li.File] = append(m[li.File], id)
+	}
+	return m
+}
+
+// registerCachedIDs takes over the IDs of the not parsed file liPath from li.json.
+// With used true, the IDs are also marked as used, like insertTriceIDs does for found IDs.
+// The caller holds the admin mutex.
+func (p *idData) registerCachedIDs(liPath string, used bool) {
+	for _, id := range p.idsByFile[liPath] {
+		p.idToLocNew[id] = p.idToLocRef[id]
+		if used {
+			t := p.idToTrice[id]
+			p.triceToId[t] = removeIDFromSlice(p.triceToId[t], id)
+		}
+	}
+}
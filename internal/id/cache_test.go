@@ -0,0 +1,59 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package id_test
+
+import (
+	"bytes"
+	"io"
+	"testing"
+	"time"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/rokath/trice/internal/id"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+func TestCacheInsertCleanCycle(t *testing.T) {
+
+	fSys := &afero.Afero{Fs: afero.NewMemMapFs()}
+	defer id.SetupTest(t, fSys)()
+	id.CacheDir = "/cache"
+
+	sFn := "src/file.c"
+	assert.Nil(t, fSys.WriteFile(sFn, []byte(`trice("msg:value=%d\n", -1);`), 0777))
+
+	run := func(cmd ...string) (string, time.Time) {
+		var b bytes.Buffer
+		assert.Nil(t, args.Handler(io.Writer(&b), fSys, append([]string{"trice"}, append(cmd, "-cache", "-src", "src", "-til", id.FnJSON, "-li", id.LIFnJSON)...)))
+		src, e := fSys.ReadFile(sFn)
+		assert.Nil(t, e)
+		fi, e := fSys.Stat(sFn)
+		assert.Nil(t, e)
+		return string(src), fi.ModTime()
+	}
+	inserted, insertedTime := run("insert", "-IDMin", "100", "-IDMax", "199", "-IDMethod", "upward")
+	assert.Equal(t, `trice(iD(100), "msg:value=%d\n", -1);`, inserted)
+
+	cleaned, cleanedTime := run("clean")
+	assert.Equal(t, `trice( "msg:value=%d\n", -1);`, cleaned)
+
+	// An unedited file gets restored from the cache with its former modification time.
+	act, actTime := run("insert", "-IDMin", "100", "-IDMax", "199", "-IDMethod", "upward")
+	assert.Equal(t, inserted, act)
+	assert.True(t, insertedTime.Equal(actTime))
+	li, e := fSys.ReadFile(id.LIFnJSON)
+	assert.Nil(t, e)
+	assert.Contains(t, string(li), `"100"`)
+
+	act, actTime = run("clean")
+	assert.Equal(t, cleaned, act)
+	assert.True(t, cleanedTime.Equal(actTime))
+
+	// An edited file gets parsed again.
+	assert.Nil(t, fSys.WriteFile(sFn, []byte(`trice("msg:value=%d\n", -2);`), 0777))
+	act, actTime = run("insert", "-IDMin", "100", "-IDMax", "199", "-IDMethod", "upward")
+	assert.Equal(t, `trice(iD(100), "msg:value=%d\n", -2);`, act)
+	assert.False(t, insertedTime.Equal(actTime))
+}
@@ -25,14 +25,6 @@ func SubCmdIdClean(w io.Writer, fSys *afero.Afero) error {
 // triceIDCleaning reads file, processes it and writes it back, if needed.
 func triceIDCleaning(w io.Writer, fSys *afero.Afero, path string, fileInfo os.FileInfo, a *ant.Admin) (err error) {
 
-	in, err := fSys.ReadFile(path)
-	if err != nil {
-		return err
-	}
-	if Verbose {
-		fmt.Fprintln(w, path)
-	}
-
 	var liPath string
 
 	if LiPathIsRelative {
@@ -41,6 +33,22 @@ func triceIDCleaning(w io.Writer, fSys *afero.Afero, path string, fileInfo os.Fi
 		liPath = filepath.Base(path)
 	}
 
+	hit, cacheFn := cacheLookup(w, fSys, path, fileInfo, cacheCleaned, cacheInserted)
+	if hit { // The file is in the wanted state without parsing.
+		a.Mutex.Lock()
+		IDData.registerCachedIDs(liPath, false)
+		a.Mutex.Unlock()
+		return nil
+	}
+
+	in, err := fSys.ReadFile(path)
+	if err != nil {
+		return err
+	}
+	if Verbose {
+		fmt.Fprintln(w, path)
+	}
+
 	out, modified, err := cleanTriceIDs(w, liPath, in, a)
 	if err != nil {
 		return err
@@ -63,7 +71,9 @@ func triceIDCleaning(w io.Writer, fSys *afero.Afero, path string, fileInfo os.Fi
 			err = fSys.WriteFile(path, out, fileInfo.Mode())
 		}
 	}
-
+	if err == nil {
+		cacheUpdate(w, fSys, cacheFn, path, out)
+	}
 	return err
 }
 
@@ -0,0 +1,177 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package id
+
+// triceGenerated.h creation
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"regexp"
+	"strconv"
+
+	"github.com/spf13/afero"
+)
+
+// GeneratedHeader is the target header file name written by "trice insert". "off" or "none" disables it.
+var GeneratedHeader = "off"
+
+// triceFnMaxParams is the max parameter count of the trice functions in trice8.c ... trice64.c.
+const triceFnMaxParams = 12
+
+// matchFixedSizeTrice matches trice type names with a compile time known size.
+// Submatch 1 is the stamp part of the name, 2 the bit width and 3 the parameter count, if given.
+var matchFixedSizeTrice = regexp.MustCompile(`^(trice|Trice|TRice|TRICE)(8|16|32|64)?(?:_?(\d+))?$`)
+
+// triceUsage collects the trice variants used inside the source tree.
+type triceUsage struct {
+	maxSize int    // maxSize is the biggest used trice in bytes, rounded up to a multiple of 4.
+	maxType string // maxType is the trice type with maxSize.
+	dynamic bool   // dynamic is true, when runtime sized trices like triceS or triceB are used.
+
+	// fn holds the used trice function variants [stamp][bit width][parameter count]. stamp is 0 for trice, 1 for Trice and 2 for TRice.
+	fn [3][4][triceFnMaxParams + 1]bool
+}
+
+// stampSize returns the stamp byte count for the trice name prefix and the stamp index for triceUsage.fn.
+// TRICE macros get the stamp from the ID writing (id, Id or ID), which is not stored, so the 32-bit stamp is assumed.
+func stampSize(prefix string) (size, index int) {
+	switch prefix {
+	case "trice":
+		return 0, 0
+	case "Trice":
+		return 2, 1
+	default:
+		return 4, 2
+	}
+}
+
+// fixedSize parses the type name of t. ok is false for runtime sized trices like triceS, triceN, triceB, triceF or triceAssertTrue.
+// prefix is the stamp part of the name, width the value bit width and count the value count.
+func (t TriceFmt) fixedSize() (prefix string, width, count int, ok bool) {
+	m := matchFixedSizeTrice.FindStringSubmatch(t.Type)
+	if m == nil {
+		return
+	}
+	bitWidth := DefaultTriceBitWidth
+	if m[2] != "" {
+		bitWidth = m[2]
+	}
+	width, _ = strconv.Atoi(bitWidth)
+	count = formatSpecifierCount(t.Strg)
+	if m[3] != "" {
+		count, _ = strconv.Atoi(m[3])
+	}
+	return m[1], width, count, true
+}
+
+// ParamSpace returns the value byte count n of trice t without padding, as the target transmits it.
+// ok is false for runtime sized trices like triceS or triceB.
+func (t TriceFmt) ParamSpace() (n int, ok bool) {
+	_, width, count, ok := t.fixedSize()
+	return count * width / 8, ok
+}
+
+// add registers trice t in u.
+func (u *triceUsage) add(t TriceFmt) {
+	prefix, width, count, ok := t.fixedSize()
+	if !ok {
+		u.dynamic = true
+		return
+	}
+	stamp, index := stampSize(prefix)
+	size := (2 + stamp + 2 + count*width/8 + 3) &^ 3                 // id + stamp + count + values
+	if size > u.maxSize || size == u.maxSize && t.Type < u.maxType { // deterministic maxType for an unchanged file
+		u.maxSize = size
+		u.maxType = t.Type
+	}
+	if prefix == "TRICE" || count > triceFnMaxParams { // TRICE macros are inlined and need no functions.
+		return
+	}
+	u.fn[index][widthIndex(width)][count] = true
+}
+
+// widthIndex returns the triceUsage.fn index of bit width.
+func widthIndex(width int) int {
+	switch width {
+	case 8:
+		return 0
+	case 16:
+		return 1
+	case 32:
+		return 2
+	default:
+		return 3
+	}
+}
+
+// writeGeneratedHeader writes GeneratedHeader for the trices in use, which are the ones with location information inside li.
+// The file is written only on changes, to avoid needless re-compilations.
+func (p *idData) writeGeneratedHeader(w io.Writer, fSys *afero.Afero, li TriceIDLookUpLI) error {
+	if GeneratedHeader == "off" || GeneratedHeader == "none" || DryRun {
+		return nil
+	}
+	var u triceUsage
+	for id := range li {
+		if t, ok := p.idToTrice[id]; ok {
+			u.add(t)
+		}
+	}
+	_, hash, err := p.tilJSON()
+	if err != nil {
+		return err
+	}
+	b := u.header(len(li), hash)
+	old, err := fSys.ReadFile(GeneratedHeader)
+	if err == nil && bytes.Equal(old, b) {
+		return nil
+	}
+	if Verbose {
+		fmt.Fprintln(w, "Writing", GeneratedHeader)
+	}
+	return fSys.WriteFile(GeneratedHeader, b, 0o644)
+}
+
+// header returns the triceGenerated.h content for u. count is the number of trices in use and hash the til.json hash.
+func (u *triceUsage) header(count int, hash uint32) []byte {
+	var b bytes.Buffer
+	fmt.Fprintln(&b, `//! \file triceGenerated.h`)
+	fmt.Fprintf(&b, "//! Generated by \"trice insert -generatedHeader\" from %d trices in use. Do not edit.\n", count)
+	fmt.Fprintln(&b, `//! Include it at the begin of triceConfig.h. Definitions in front of the include have priority.`)
+	fmt.Fprintln(&b, `//! ///////////////////////////////////////////////////////////////////////////`)
+	fmt.Fprintln(&b)
+	fmt.Fprintln(&b, "#ifndef TRICE_GENERATED_H_")
+	fmt.Fprintln(&b, "#define TRICE_GENERATED_H_")
+	fmt.Fprintln(&b)
+	fmt.Fprintf(&b, "#define TRICE_GENERATED_DEFAULT_PARAMETER_BIT_WIDTH %s //!< Bit width assumed for trices without bit width in their names.\n", DefaultTriceBitWidth)
+	fmt.Fprintf(&b, "#define TRICE_GENERATED_TIL_HASH 0x%08xu //!< TRICE_GENERATED_TIL_HASH identifies the til.json, which TriceIdentity transmits.\n", hash)
+	fmt.Fprintln(&b)
+	if u.dynamic {
+		fmt.Fprintln(&b, "// Runtime sized trices (like triceS or triceB) are in use, so TRICE_SINGLE_MAX_SIZE is not derivable.")
+	} else if u.maxSize > 0 {
+		offset := (u.maxSize/31 + 2 + 3) &^ 3 // (T)COBS overhead and the 0-delimiter for one trice
+		fmt.Fprintln(&b, "#ifndef TRICE_SINGLE_MAX_SIZE")
+		fmt.Fprintf(&b, "#define TRICE_SINGLE_MAX_SIZE %d //!< %s is the biggest trice in use.\n", u.maxSize, u.maxType)
+		fmt.Fprintln(&b, "#endif")
+		fmt.Fprintln(&b)
+		fmt.Fprintf(&b, "#define TRICE_GENERATED_DATA_OFFSET_MIN %d //!< TRICE_GENERATED_DATA_OFFSET_MIN is the recommended TRICE_DATA_OFFSET minimum for in-buffer encoding.\n", offset)
+		fmt.Fprintf(&b, "#define TRICE_GENERATED_DEFERRED_BUFFER_SIZE_MIN %d //!< TRICE_GENERATED_DEFERRED_BUFFER_SIZE_MIN is the recommended TRICE_DEFERRED_BUFFER_SIZE minimum (double buffer).\n", 2*(offset+u.maxSize+4))
+	}
+	for i, width := range []int{8, 16, 32, 64} {
+		for stamp, prefix := range []string{"trice", "Trice", "TRice"} {
+			fmt.Fprintln(&b)
+			for n := 0; n <= triceFnMaxParams; n++ {
+				on := 0
+				if u.fn[stamp][i][n] {
+					on = 1
+				}
+				fmt.Fprintf(&b, "#ifndef ENABLE_%s%dfn_%d\n#define ENABLE_%s%dfn_%d %d\n#endif\n", prefix, width, n, prefix, width, n, on)
+			}
+		}
+	}
+	fmt.Fprintln(&b)
+	fmt.Fprintln(&b, "#endif // TRICE_GENERATED_H_")
+	return b.Bytes()
+}
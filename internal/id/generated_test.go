@@ -0,0 +1,75 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package id_test
+
+import (
+	"bytes"
+	"io"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/rokath/trice/internal/id"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+func TestGeneratedHeader(t *testing.T) {
+
+	fSys := &afero.Afero{Fs: afero.NewMemMapFs()}
+	defer id.SetupTest(t, fSys)()
+
+	src := `TRice8("%d %d\n", a, b); trice16_1("%x\n", x); TRice("hi\n");`
+	assert.Nil(t, fSys.WriteFile("file.c", []byte(src), 0777))
+
+	var b bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&b), fSys, []string{"trice", "insert", "-generatedHeader", "triceGenerated.h", "-til", id.FnJSON, "-li", id.LIFnJSON}))
+
+	h, e := fSys.ReadFile("triceGenerated.h")
+	assert.Nil(t, e)
+	act := string(h)
+	assert.Contains(t, act, "#define TRICE_SINGLE_MAX_SIZE 12 //!< TRice8 is the biggest trice in use.\n")
+	assert.Contains(t, act, "#define ENABLE_TRice8fn_2 1\n")
+	assert.Contains(t, act, "#define ENABLE_trice16fn_1 1\n")
+	assert.Contains(t, act, "#define ENABLE_TRice32fn_0 1\n")
+	assert.Contains(t, act, "#define ENABLE_TRice32fn_1 0\n")
+	assert.Contains(t, act, "#define ENABLE_trice8fn_2 0\n")
+
+	// An unchanged result is not written again, so the build system does not recompile.
+	old := time.Date(2020, 1, 1, 0, 0, 0, 0, time.UTC)
+	assert.Nil(t, fSys.Chtimes("triceGenerated.h", old, old))
+	assert.Nil(t, args.Handler(io.Writer(&b), fSys, []string{"trice", "insert", "-generatedHeader", "triceGenerated.h", "-til", id.FnJSON, "-li", id.LIFnJSON}))
+	fi, e := fSys.Stat("triceGenerated.h")
+	assert.Nil(t, e)
+	assert.True(t, fi.ModTime().Equal(old))
+
+	// Runtime sized trices make TRICE_SINGLE_MAX_SIZE underivable.
+	assert.Nil(t, fSys.WriteFile("file.c", []byte(src+` triceS("%s\n", s);`), 0777))
+	assert.Nil(t, args.Handler(io.Writer(&b), fSys, []string{"trice", "insert", "-generatedHeader", "triceGenerated.h", "-til", id.FnJSON, "-li", id.LIFnJSON}))
+	h, e = fSys.ReadFile("triceGenerated.h")
+	assert.Nil(t, e)
+	assert.False(t, strings.Contains(string(h), "#define TRICE_SINGLE_MAX_SIZE"))
+}
+
+// TestParamSpace checks the value byte count derived from the til.json entries.
+func TestParamSpace(t *testing.T) {
+	for _, x := range []struct {
+		t  id.TriceFmt
+		n  int
+		ok bool
+	}{
+		{id.TriceFmt{Type: "TRICE16_1", Strg: "select = %d"}, 2, true},
+		{id.TriceFmt{Type: "trice8", Strg: "%u %u %u"}, 3, true},
+		{id.TriceFmt{Type: "TRice64_2", Strg: "%d %d"}, 16, true},
+		{id.TriceFmt{Type: "Trice", Strg: "%d"}, 4, true}, // default bit width 32
+		{id.TriceFmt{Type: "trice", Strg: "hi"}, 0, true},
+		{id.TriceFmt{Type: "triceS", Strg: "%s"}, 0, false},
+		{id.TriceFmt{Type: "TRICE8_B", Strg: "%02x"}, 0, false},
+	} {
+		n, ok := x.t.ParamSpace()
+		assert.Equal(t, x.ok, ok, x.t.Type)
+		assert.Equal(t, x.n, n, x.t.Type)
+	}
+}
@@ -53,4 +53,8 @@ func ResetGlobalVars(t *testing.T) {
 	DefaultTriceBitWidth = "32"
 	DefaultStampSize = 32
 	StampSizeId = " ID(0),"
+	CacheEnabled = false
+	CacheDir = ""
+	Watch = false
+	WatchCheck = false
 }
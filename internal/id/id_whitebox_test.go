@@ -72,6 +72,33 @@ func TestInsertIDsAndJSONDownward(t *testing.T) {
 	assert.Equal(t, expLI, string(actLI))
 }
 
+// TestInsertSkipsReservedIDs checks, that an ID range containing the reserved IDs does not assign them.
+func TestInsertSkipsReservedIDs(t *testing.T) {
+
+	fSys := &afero.Afero{Fs: afero.NewMemMapFs()}
+	defer id.SetupTest(t, fSys)()
+
+	src0 := `
+	TRice( "a" );
+	TRice( "b" );
+	TRice( "c" );
+	`
+	fn0 := t.Name() + "file0.c"
+	assert.Nil(t, fSys.WriteFile(fn0, []byte(src0), 0777))
+
+	var b bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&b), fSys, []string{"TRICE", "insert", "-src", ".", "-til", id.FnJSON, "-li", id.LIFnJSON, "-IDMin", "16364", "-IDMax", "16370", "-IDMethod", "downward"}))
+
+	expSrc0 := `
+	TRice(iD(16370), "a" );
+	TRice(iD(16365), "b" );
+	TRice(iD(16364), "c" );
+	`
+	actSrc0, e := fSys.ReadFile(fn0)
+	assert.Nil(t, e)
+	assert.Equal(t, expSrc0, string(actSrc0))
+}
+
 func TestInsertIDsAndJSONUpward(t *testing.T) {
 
 	fSys := &afero.Afero{Fs: afero.NewMemMapFs()}
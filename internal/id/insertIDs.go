@@ -39,23 +39,27 @@ var SkipAdditionalChecks bool
 
 // SubCmdIdInsert performs sub-command insert, adding trice IDs to source tree.
 func SubCmdIdInsert(w io.Writer, fSys *afero.Afero) (e error) {
+	if WatchCheck && WatchIDsCurrent(w) {
+		if Verbose {
+			fmt.Fprintln(w, "IDs are current, the watch daemon at", WatchAddress, "processed all saved files.")
+		}
+		return nil
+	}
+	if Watch {
+		return IDData.watchInsert(w, fSys, nil)
+	}
 	e = IDData.cmdSwitchTriceIDs(w, fSys, IDData.triceIDInsertion)
 	if e != nil {
 		return e
 	}
-	return
+	if e = IDData.storeTil(w, fSys); e != nil {
+		return e
+	}
+	return IDData.writeGeneratedHeader(w, fSys, IDData.idToLocNew) // The full pass found all trices in use.
 }
 
 // triceIDInsertion reads file, processes it and writes it back, if needed.
 func (p *idData) triceIDInsertion(w io.Writer, fSys *afero.Afero, path string, fileInfo os.FileInfo, a *ant.Admin) error {
-	in, err := fSys.ReadFile(path)
-	if err != nil {
-		return err
-	}
-	if Verbose {
-		fmt.Fprintln(w, path)
-	}
-
 	var liPath string
 
 	if LiPathIsRelative {
@@ -64,6 +68,22 @@ func (p *idData) triceIDInsertion(w io.Writer, fSys *afero.Afero, path string, f
 		liPath = filepath.Base(path)
 	}
 
+	hit, cacheFn := cacheLookup(w, fSys, path, fileInfo, cacheInserted, cacheCleaned)
+	if hit { // The file is in the wanted state without parsing.
+		a.Mutex.Lock()
+		p.registerCachedIDs(liPath, true)
+		a.Mutex.Unlock()
+		return nil
+	}
+
+	in, err := fSys.ReadFile(path)
+	if err != nil {
+		return err
+	}
+	if Verbose {
+		fmt.Fprintln(w, path)
+	}
+
 	out, modified, err := p.insertTriceIDs(w, liPath, in, a)
 	if err != nil {
 		return err
@@ -86,7 +106,9 @@ func (p *idData) triceIDInsertion(w io.Writer, fSys *afero.Afero, path string, f
 			err = fSys.WriteFile(path, out, fileInfo.Mode())
 		}
 	}
-
+	if err == nil {
+		cacheUpdate(w, fSys, cacheFn, path, out)
+	}
 	return err
 }
 
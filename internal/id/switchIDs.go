@@ -18,12 +18,14 @@ import (
 
 // idData holds the Id specific data.
 type idData struct {
-	idToTrice      TriceIDLookUp   // idToTrice is a trice ID lookup map and is generated from existing til.json file at the begin of SubCmdIdInsert. This map is only extended during SubCmdIdInsert and goes back into til.json afterwards.
-	triceToId      triceFmtLookUp  // triceToId is a trice fmt lookup map (reversed idToFmt for faster operation). Each fmt can have several trice IDs (slice). This map is only reduced during SubCmdIdInsert and goes _not_ back into til.json afterwards.
-	idToLocRef     TriceIDLookUpLI // idToLocRef is the trice ID location information as reference generated from li.json (if exists) at the begin of SubCmdIdInsert and is not modified at all. At the end of SubCmdIdInsert a new li.json is generated from itemToId.
-	idToLocNew     TriceIDLookUpLI // idToLocNew is the trice ID location information generated during insertTriceIDs. At the end of SubCmdIdInsert a new li.json is generated from idToLocRef + idToLocNew.
-	idInitialCount int             // idInitialCount is the initial used ID count.
-	IDSpace        []TriceID       // IDSpace contains unused IDs.
+	idToTrice      TriceIDLookUp        // idToTrice is a trice ID lookup map and is generated from existing til.json file at the begin of SubCmdIdInsert. This map is only extended during SubCmdIdInsert and goes back into til.json afterwards.
+	triceToId      triceFmtLookUp       // triceToId is a trice fmt lookup map (reversed idToFmt for faster operation). Each fmt can have several trice IDs (slice). This map is only reduced during SubCmdIdInsert and goes _not_ back into til.json afterwards.
+	idToLocRef     TriceIDLookUpLI      // idToLocRef is the trice ID location information as reference generated from li.json (if exists) at the begin of SubCmdIdInsert and is not modified at all. At the end of SubCmdIdInsert a new li.json is generated from itemToId.
+	idToLocNew     TriceIDLookUpLI      // idToLocNew is the trice ID location information generated during insertTriceIDs. At the end of SubCmdIdInsert a new li.json is generated from idToLocRef + idToLocNew.
+	idInitialCount int                  // idInitialCount is the initial used ID count.
+	IDSpace        []TriceID            // IDSpace contains unused IDs.
+	idsByFile      map[string][]TriceID // idsByFile holds the idToLocRef IDs per file for the Trice cache.
+	idToLocUsed    TriceIDLookUpLI      // idToLocUsed is the location information of the trices in use during a watch session. idToLocNew holds only the last batch there.
 }
 
 // IDIsPartOfIDSpace returns true if ID is existend inside IDSpace.
@@ -87,10 +89,19 @@ func (p *idData) GetIDStateFromJSONFiles(w io.Writer, fSys *afero.Afero) {
 func (p *idData) PreProcessing(w io.Writer, fSys *afero.Afero) {
 
 	p.GetIDStateFromJSONFiles(w, fSys)
+	if cacheUsable() {
+		p.idsByFile = p.locRefByFile()
+	}
 
 	// create IDSpace
 	p.IDSpace = make([]TriceID, 0, Max-Min+1)
 	for id := Min; id <= Max; id++ {
+		if isReservedID(id) {
+			if Verbose {
+				fmt.Fprintln(w, "ID", id, "is reserved and not usable for normal trices")
+			}
+			continue
+		}
 		_, usedFmt := p.idToTrice[id]
 		_, usedLoc := p.idToLocRef[id]
 		if !usedFmt && !usedLoc {
@@ -112,6 +123,16 @@ func (p *idData) PreProcessing(w io.Writer, fSys *afero.Afero) {
 	}
 }
 
+// isReservedID returns true, when id is one of the ReservedIDs.
+func isReservedID(id TriceID) bool {
+	for _, r := range ReservedIDs {
+		if r == id {
+			return true
+		}
+	}
+	return false
+}
+
 // postProcessing
 func (p *idData) postProcessing(w io.Writer, fSys *afero.Afero) {
 	// til.json
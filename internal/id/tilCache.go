@@ -0,0 +1,152 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package id
+
+// til.json version cache for the firmware identity handshake
+
+import (
+	"fmt"
+	"hash/fnv"
+	"io"
+	"path/filepath"
+	"regexp"
+	"strconv"
+	"sync"
+
+	"github.com/spf13/afero"
+)
+
+// TilCache is the directory with the til.json versions. "trice insert" stores a copy of til.json there
+// and "trice log" selects the version matching the firmware identity trice of each stream. "" or "off" disables it.
+var TilCache = "off"
+
+// matchHashName matches the til.json copy names written by "trice insert -tilCache". Submatch 1 is the hash.
+var matchHashName = regexp.MustCompile(`^([0-9a-f]{8})\.json$`)
+
+// TilHash returns the hash of the til.json content b. The target gets it as TRICE_GENERATED_TIL_HASH.
+func TilHash(b []byte) uint32 {
+	h := fnv.New32a()
+	_, _ = h.Write(b)
+	return h.Sum32()
+}
+
+// tilJSON returns the til.json content, as "trice insert" writes it, together with its hash.
+func (p *idData) tilJSON() (b []byte, hash uint32, err error) {
+	b, err = p.idToTrice.toJSON()
+	return b, TilHash(b), err
+}
+
+// storeTil writes the til.json content as "<hash>.json" into TilCache, if not there already.
+func (p *idData) storeTil(w io.Writer, fSys *afero.Afero) error {
+	if TilCache == "" || TilCache == "off" || DryRun {
+		return nil
+	}
+	b, hash, err := p.tilJSON()
+	if err != nil {
+		return err
+	}
+	fn := filepath.Join(TilCache, fmt.Sprintf("%08x.json", hash))
+	if ok, _ := fSys.Exists(fn); ok {
+		return nil
+	}
+	if err := fSys.MkdirAll(TilCache, 0o755); err != nil {
+		return err
+	}
+	if Verbose {
+		fmt.Fprintln(w, "Writing", fn)
+	}
+	return fSys.WriteFile(fn, b, 0o644)
+}
+
+// LutCache holds the til.json versions of a directory, indexed by their TilHash.
+//
+// A version is read on its first use. Entries equal in several versions share their strings.
+// LutCache is usable from several goroutines.
+type LutCache struct {
+	w    io.Writer
+	fSys *afero.Afero
+	dir  string
+	mu   sync.Mutex
+	fn   map[uint32]string        // fn is the file name of each known version.
+	lut  map[uint32]TriceIDLookUp // lut holds the read versions.
+	fmts map[TriceFmt]TriceFmt    // fmts holds each distinct entry of the read versions once.
+}
+
+// NewLutCache indexes the *.json files inside dir.
+// Files named "<hash>.json" are indexed by their name without reading. Other files are read once to compute their hash.
+func NewLutCache(w io.Writer, fSys *afero.Afero, dir string) (*LutCache, error) {
+	entries, err := fSys.ReadDir(dir)
+	if err != nil {
+		return nil, err
+	}
+	c := &LutCache{
+		w:    w,
+		fSys: fSys,
+		dir:  dir,
+		fn:   make(map[uint32]string),
+		lut:  make(map[uint32]TriceIDLookUp),
+		fmts: make(map[TriceFmt]TriceFmt),
+	}
+	for _, e := range entries {
+		if e.IsDir() || filepath.Ext(e.Name()) != ".json" {
+			continue
+		}
+		fn := filepath.Join(dir, e.Name())
+		if m := matchHashName.FindStringSubmatch(e.Name()); m != nil {
+			h, _ := strconv.ParseUint(m[1], 16, 32)
+			c.fn[uint32(h)] = fn
+			continue
+		}
+		b, err := fSys.ReadFile(fn)
+		if err != nil {
+			return nil, err
+		}
+		c.fn[TilHash(b)] = fn
+	}
+	if Verbose {
+		fmt.Fprintln(w, len(c.fn), "til.json versions in", dir)
+	}
+	return c, nil
+}
+
+// Add registers the already read version lut with hash, for example the til.json given with -i.
+func (c *LutCache) Add(hash uint32, lut TriceIDLookUp) {
+	c.mu.Lock()
+	c.lut[hash] = lut
+	c.mu.Unlock()
+}
+
+// Lut returns the version with hash. It is read on the first request.
+func (c *LutCache) Lut(hash uint32) (TriceIDLookUp, error) {
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	if lut, ok := c.lut[hash]; ok {
+		return lut, nil
+	}
+	fn, ok := c.fn[hash]
+	if !ok {
+		return nil, fmt.Errorf("no til.json with hash %08x inside %s", hash, c.dir)
+	}
+	b, err := c.fSys.ReadFile(fn)
+	if err != nil {
+		return nil, err
+	}
+	lut := make(TriceIDLookUp)
+	if err := lut.FromJSON(b); err != nil {
+		return nil, fmt.Errorf("%s: %w", fn, err)
+	}
+	lut.AddFmtCount(c.w)
+	for id, t := range lut {
+		if s, ok := c.fmts[t]; ok {
+			lut[id] = s
+		} else {
+			c.fmts[t] = t
+		}
+	}
+	if Verbose {
+		fmt.Fprintln(c.w, "Read ID List file", fn, "with", len(lut), "items.")
+	}
+	c.lut[hash] = lut
+	return lut, nil
+}
@@ -0,0 +1,64 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package id_test
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"testing"
+	"unsafe"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/rokath/trice/internal/id"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+// TestTilCache checks, that "trice insert" stores the til.json version with the hash written into the generated header
+// and that the cache finds the versions by hash and shares their common entries.
+func TestTilCache(t *testing.T) {
+	fSys := &afero.Afero{Fs: afero.NewMemMapFs()}
+	defer id.SetupTest(t, fSys)()
+	defer func() { id.TilCache = "off" }()
+
+	assert.Nil(t, fSys.WriteFile("file.c", []byte(`trice("hi\n"); trice("one %d\n", 1);`), 0777))
+	var b bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&b), fSys, []string{"trice", "insert", "-generatedHeader", "triceGenerated.h", "-tilCache", "tils", "-til", id.FnJSON, "-li", id.LIFnJSON}))
+	til, e := fSys.ReadFile(id.FnJSON)
+	assert.Nil(t, e)
+	v1 := id.TilHash(til)
+	h, e := fSys.ReadFile("triceGenerated.h")
+	assert.Nil(t, e)
+	assert.Contains(t, string(h), fmt.Sprintf("#define TRICE_GENERATED_TIL_HASH 0x%08xu ", v1))
+	stored, e := fSys.ReadFile(fmt.Sprintf("tils/%08x.json", v1))
+	assert.Nil(t, e)
+	assert.Equal(t, til, stored)
+
+	assert.Nil(t, fSys.WriteFile("file.c", []byte(`trice("hi\n"); trice("two %d\n", 2);`), 0777))
+	assert.Nil(t, args.Handler(io.Writer(&b), fSys, []string{"trice", "insert", "-tilCache", "tils", "-til", id.FnJSON, "-li", id.LIFnJSON}))
+	til, e = fSys.ReadFile(id.FnJSON)
+	assert.Nil(t, e)
+	v2 := id.TilHash(til)
+	assert.NotEqual(t, v1, v2)
+
+	c, e := id.NewLutCache(io.Discard, fSys, "tils")
+	assert.Nil(t, e)
+	lut1, e := c.Lut(v1)
+	assert.Nil(t, e)
+	lut2, e := c.Lut(v2)
+	assert.Nil(t, e)
+	assert.Equal(t, 2, len(lut1))
+	assert.Equal(t, 3, len(lut2))
+	var shared int
+	for k, t1 := range lut1 {
+		if t2, ok := lut2[k]; ok && t1.Strg == "hi\\n" {
+			assert.True(t, unsafe.StringData(t1.Strg) == unsafe.StringData(t2.Strg))
+			shared++
+		}
+	}
+	assert.Equal(t, 1, shared)
+	_, e = c.Lut(v1 ^ 1)
+	assert.NotNil(t, e)
+}
@@ -38,3 +38,7 @@ var (
 
 	SpaceBetweenTriceOpeningBraceAndIDName = false
 )
+
+// ReservedIDs are the target default IDs of TRICE_IDENTITY_ID, TRICE_CLOCK_SYNC_ID, TRICE_POST_MORTEM_ID and TRICE_DIAGNOSTICS_ID.
+// "trice insert" does not assign them to normal trices, also not with an -IDMax above them.
+var ReservedIDs = []TriceID{16366, 16367, 16368, 16369}
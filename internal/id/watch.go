@@ -0,0 +1,273 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package id
+
+// trice insert -watch daemon
+
+import (
+	"bufio"
+	"fmt"
+	"io"
+	"net"
+	"os"
+	"path/filepath"
+	"strings"
+	"time"
+
+	"github.com/fsnotify/fsnotify"
+	"github.com/rokath/trice/pkg/ant"
+	"github.com/rokath/trice/pkg/msg"
+	"github.com/spf13/afero"
+)
+
+var (
+	// Watch is true, when "trice insert" stays running and patches saved source files.
+	Watch bool
+
+	// WatchCheck is true, when "trice insert" asks a running watch daemon first and skips the full pass, if the IDs are current.
+	WatchCheck bool
+
+	// WatchAddress is the local address of the watch daemon socket.
+	WatchAddress = "localhost:61496"
+
+	// watchDelay is the time to collect file events before processing them.
+	watchDelay = 50 * time.Millisecond
+)
+
+const (
+	watchQuery   = "current?" // watchQuery is followed by the absolute til.json path.
+	watchCurrent = "yes"
+	watchOutdate = "no"
+)
+
+// watchQueryTimeout limits the watch daemon answer time, when a build step asks.
+var watchQueryTimeout = 2 * time.Second
+
+// WatchIDsCurrent returns true, when a watch daemon for the same til.json is running and all saved files are processed.
+func WatchIDsCurrent(w io.Writer) bool {
+	til, err := filepath.Abs(FnJSON)
+	if err != nil {
+		return false
+	}
+	conn, err := net.DialTimeout("tcp", WatchAddress, watchQueryTimeout)
+	if err != nil {
+		if Verbose {
+			fmt.Fprintln(w, "No watch daemon at", WatchAddress)
+		}
+		return false
+	}
+	defer conn.Close()
+	msg.OnErr(conn.SetDeadline(time.Now().Add(watchQueryTimeout)))
+	if _, err = fmt.Fprintln(conn, watchQuery, til); err != nil {
+		return false
+	}
+	answer, err := bufio.NewReader(conn).ReadString('\n')
+	if err != nil {
+		return false
+	}
+	return strings.TrimSpace(answer) == watchCurrent
+}
+
+// watchRequest is a query from a build step.
+type watchRequest struct {
+	til   string      // til is the absolute til.json path of the asking process.
+	reply chan string // reply gets watchCurrent or watchOutdate.
+}
+
+// watchInsert does a normal insert pass and keeps then the ID state in memory.
+// Saved source files are patched one by one and til.json, li.json, the TilCache version and GeneratedHeader are written after each batch.
+// It returns, when stop gets closed.
+func (p *idData) watchInsert(w io.Writer, fSys *afero.Afero, stop <-chan struct{}) error {
+	a := new(ant.Admin)
+	a.Action = p.triceIDInsertion
+	a.Trees = Srcs
+	a.MatchingFileName = isSourceFile
+
+	p.PreProcessing(w, fSys)
+	p.idToLocUsed = make(TriceIDLookUpLI)
+	if err := a.Walk(w, fSys); err != nil {
+		return err
+	}
+	if err := p.watchFlush(w, fSys); err != nil {
+		return err
+	}
+
+	watcher, err := fsnotify.NewWatcher()
+	if err != nil {
+		return err
+	}
+	defer func() { msg.OnErr(watcher.Close()) }()
+	for _, tree := range Srcs {
+		watchAddTree(w, fSys, watcher, tree)
+	}
+
+	ln, err := net.Listen("tcp", WatchAddress)
+	if err != nil {
+		return err
+	}
+	defer ln.Close()
+	requests := make(chan watchRequest)
+	go watchServe(ln, requests, stop)
+
+	til, _ := filepath.Abs(FnJSON)
+	written := make(map[string]time.Time) // written holds the modification times of files patched here to ignore their events.
+	pending := make(map[string]bool)      // pending are the saved files not processed yet.
+	var waiting []watchRequest            // waiting are the queries to answer after processing the pending files.
+	timer := time.NewTimer(watchDelay)
+	timer.Stop()
+	fmt.Fprintln(w, "Watching", Srcs, "for changes. Query address is", WatchAddress)
+	for {
+		select {
+		case <-stop:
+			return nil
+		case event := <-watcher.Events:
+			if event.Op&(fsnotify.Write|fsnotify.Create) == 0 {
+				continue
+			}
+			fi, err := fSys.Stat(event.Name)
+			if err != nil {
+				continue
+			}
+			if fi.IsDir() {
+				watchAddTree(w, fSys, watcher, event.Name)
+				continue
+			}
+			if !isSourceFile(fi) || fi.ModTime().Equal(written[event.Name]) {
+				continue
+			}
+			pending[event.Name] = true
+			timer.Reset(watchDelay)
+		case err := <-watcher.Errors:
+			fmt.Fprintln(w, "watch error:", err)
+		case r := <-requests:
+			switch {
+			case r.til != til:
+				r.reply <- watchOutdate
+			case len(pending) > 0:
+				waiting = append(waiting, r)
+			default:
+				r.reply <- watchCurrent
+			}
+		case <-timer.C:
+			start := time.Now()
+			for path := range pending {
+				delete(pending, path)
+				p.watchPatch(w, fSys, a, path, written)
+			}
+			if err := p.watchFlush(w, fSys); err != nil {
+				fmt.Fprintln(w, err)
+			}
+			if Verbose {
+				fmt.Fprintln(w, "processed in", time.Since(start))
+			}
+			for _, r := range waiting {
+				r.reply <- watchCurrent
+			}
+			waiting = waiting[:0]
+		}
+	}
+}
+
+// watchPatch runs the ID insertion on the saved file path.
+// The IDs path got in the previous pass are released first, otherwise they would count as already used somewhere else.
+func (p *idData) watchPatch(w io.Writer, fSys *afero.Afero, a *ant.Admin, path string, written map[string]time.Time) {
+	fi, err := fSys.Stat(path)
+	if err != nil {
+		return // file was removed meanwhile
+	}
+	liPath := filepath.Base(path)
+	if LiPathIsRelative {
+		liPath = filepath.ToSlash(path)
+	}
+	p.releaseIDs(liPath)
+	if err := p.triceIDInsertion(w, fSys, path, fi, a); err != nil {
+		fmt.Fprintln(w, path, err)
+		return
+	}
+	if fi, err = fSys.Stat(path); err == nil {
+		written[path] = fi.ModTime()
+	}
+}
+
+// liFile returns the li.json file name of li in the form liPath has.
+func liFile(li TriceLI) string {
+	if LiPathIsRelative {
+		return filepath.ToSlash(li.File)
+	}
+	return filepath.Base(li.File)
+}
+
+// releaseIDs makes the IDs located inside liPath usable again for their trices.
+// They are not in use anymore, until the insertion finds them again in liPath.
+func (p *idData) releaseIDs(liPath string) {
+	for id, li := range p.idToLocUsed {
+		if liFile(li) == liPath {
+			delete(p.idToLocUsed, id)
+		}
+	}
+	for id, li := range p.idToLocRef {
+		if liFile(li) != liPath {
+			continue
+		}
+		t, ok := p.idToTrice[id]
+		if !ok {
+			continue
+		}
+		ids := removeIDFromSlice(p.triceToId[t], id)
+		p.triceToId[t] = append(ids, id)
+	}
+}
+
+// watchFlush writes til.json and li.json, if needed, stores the til.json version in TilCache,
+// renews GeneratedHeader for all trices in use and starts a new batch.
+func (p *idData) watchFlush(w io.Writer, fSys *afero.Afero) error {
+	p.postProcessing(w, fSys)
+	p.idInitialCount = len(p.idToTrice)
+	for k, v := range p.idToLocNew {
+		p.idToLocUsed[k] = v
+	}
+	err := p.storeTil(w, fSys)
+	if err == nil {
+		err = p.writeGeneratedHeader(w, fSys, p.idToLocUsed)
+	}
+	p.idToLocNew = make(TriceIDLookUpLI)
+	return err
+}
+
+// watchAddTree adds root and all its sub directories to watcher, because fsnotify watches single directories only.
+func watchAddTree(w io.Writer, fSys *afero.Afero, watcher *fsnotify.Watcher, root string) {
+	msg.OnErr(fSys.Walk(root, func(path string, fi os.FileInfo, err error) error {
+		if err != nil || !fi.IsDir() {
+			return nil
+		}
+		if e := watcher.Add(path); e != nil {
+			fmt.Fprintln(w, "cannot watch", path, e)
+		}
+		return nil
+	}))
+}
+
+// watchServe answers queries from build steps on ln.
+func watchServe(ln net.Listener, requests chan<- watchRequest, stop <-chan struct{}) {
+	for {
+		conn, err := ln.Accept()
+		if err != nil {
+			return // listener closed
+		}
+		go func(conn net.Conn) {
+			defer conn.Close()
+			msg.OnErr(conn.SetDeadline(time.Now().Add(watchQueryTimeout)))
+			line, err := bufio.NewReader(conn).ReadString('\n')
+			if err != nil || !strings.HasPrefix(line, watchQuery+" ") {
+				return
+			}
+			r := watchRequest{strings.TrimSpace(strings.TrimPrefix(line, watchQuery+" ")), make(chan string, 1)}
+			select {
+			case requests <- r:
+				fmt.Fprintln(conn, <-r.reply)
+			case <-stop:
+			}
+		}(conn)
+	}
+}
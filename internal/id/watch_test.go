@@ -0,0 +1,97 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package id
+
+import (
+	"fmt"
+	"io"
+	"path/filepath"
+	"regexp"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+// TestWatchInsert needs the OS file system, because fsnotify works on it.
+func TestWatchInsert(t *testing.T) {
+	ResetGlobalVars(t)
+	fSys := &afero.Afero{Fs: afero.NewOsFs()}
+	dir := t.TempDir()
+	FnJSON = filepath.Join(dir, "til.json")
+	LIFnJSON = filepath.Join(dir, "li.json")
+	Srcs = []string{filepath.Join(dir, "src")}
+	WatchAddress = "localhost:61495"
+	TilCache = filepath.Join(dir, "tilCache")
+	GeneratedHeader = filepath.Join(dir, "triceGenerated.h")
+	defer func() { TilCache, GeneratedHeader = "off", "off" }()
+	sFn := filepath.Join(dir, "src", "file.c")
+	assert.Nil(t, fSys.WriteFile(FnJSON, nil, 0o644))
+	assert.Nil(t, fSys.WriteFile(LIFnJSON, nil, 0o644))
+	assert.Nil(t, fSys.MkdirAll(Srcs[0], 0o755))
+	assert.Nil(t, fSys.WriteFile(sFn, []byte(`trice("msg:a\n");`), 0o644))
+
+	stop := make(chan struct{})
+	defer close(stop)
+	go func() { assert.Nil(t, IDData.watchInsert(io.Discard, fSys, stop)) }()
+
+	ids := regexp.MustCompile(`iD\((\d+)\)`)
+	wait := func(count int) []string {
+		deadline := time.Now().Add(5 * time.Second)
+		for time.Now().Before(deadline) {
+			if WatchIDsCurrent(io.Discard) {
+				b, err := fSys.ReadFile(sFn)
+				assert.Nil(t, err)
+				if m := ids.FindAllString(string(b), -1); len(m) == count {
+					return m
+				}
+			}
+			time.Sleep(10 * time.Millisecond)
+		}
+		b, _ := fSys.ReadFile(sFn)
+		t.Fatal("watch daemon did not patch", sFn, string(b))
+		return nil
+	}
+	first := wait(1)
+
+	// Only the new trice gets a new ID, when the file is saved again.
+	assert.Nil(t, fSys.WriteFile(sFn, []byte(`trice(`+first[0]+`, "msg:a\n"); trice("msg:b\n");`), 0o644))
+	second := wait(2)
+	assert.Equal(t, first[0], second[0])
+	assert.NotEqual(t, second[0], second[1])
+
+	til, err := fSys.ReadFile(FnJSON)
+	assert.Nil(t, err)
+	assert.Contains(t, string(til), "msg:b")
+
+	// The til.json version of the second save is stored and its hash is inside the generated header.
+	hash := TilHash(til)
+	ok, err := fSys.Exists(filepath.Join(TilCache, fmt.Sprintf("%08x.json", hash)))
+	assert.Nil(t, err)
+	assert.True(t, ok)
+	h, err := fSys.ReadFile(GeneratedHeader)
+	assert.Nil(t, err)
+	assert.Contains(t, string(h), fmt.Sprintf("#define TRICE_GENERATED_TIL_HASH 0x%08xu", hash))
+
+	// The generated header covers all trices in use, not only the ones of the last batch.
+	inUse := func(count int) {
+		exp := fmt.Sprintf("from %d trices in use", count)
+		deadline := time.Now().Add(5 * time.Second)
+		for time.Now().Before(deadline) {
+			if h, _ := fSys.ReadFile(GeneratedHeader); strings.Contains(string(h), exp) {
+				return
+			}
+			time.Sleep(10 * time.Millisecond)
+		}
+		h, _ := fSys.ReadFile(GeneratedHeader)
+		t.Fatal("generated header is not", exp, string(h))
+	}
+	oFn := filepath.Join(dir, "src", "other.c")
+	assert.Nil(t, fSys.WriteFile(oFn, []byte(`trice("msg:c\n");`), 0o644))
+	inUse(3)
+	assert.Nil(t, fSys.WriteFile(oFn, nil, 0o644))
+	inUse(2)
+}
@@ -0,0 +1,363 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+// Package metrics collects live statistics of a running trice log session.
+//
+// The decoder feeds decoded trices, received bytes and packages, cycle gaps, unknown IDs, framing errors
+// and decode latencies into the package global counters. They are exposed over a local HTTP endpoint
+// in Prometheus text format (-metrics) and/or as a periodic summary line (-metricsInterval).
+package metrics
+
+import (
+	"fmt"
+	"io"
+	"net/http"
+	"sort"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/rokath/trice/internal/id"
+)
+
+var (
+	// Address is the local HTTP endpoint like "localhost:9464" serving the metrics in Prometheus text format. "" or "off" disables it.
+	Address = ""
+
+	// Interval is the summary line interval in seconds. 0 disables the summary line.
+	Interval int
+
+	// Active is true, when metrics are collected. The decoder checks it to avoid measuring cost otherwise.
+	Active bool
+
+	// Verbose gives more information on output if set. The value is injected from main packages.
+	Verbose bool
+)
+
+// TopIDs is the count of IDs with the highest rates shown in the summary line.
+var TopIDs = 3
+
+// RateWindow is the time window of the per ID rates exposed over the HTTP endpoint.
+var RateWindow = 10 * time.Second
+
+// LatencyBuckets are the upper bounds in seconds of the decode latency histogram.
+var LatencyBuckets = []float64{1e-6, 5e-6, 10e-6, 50e-6, 100e-6, 500e-6, 1e-3, 5e-3, 10e-3, 50e-3}
+
+// counters holds the metric values. All counters are monotonic.
+type counters struct {
+	trices        atomic.Uint64 // decoded trices
+	bytes         atomic.Uint64 // received raw bytes
+	packages      atomic.Uint64 // received (framed) packages
+	lost          atomic.Uint64 // trices lost, inferred from cycle counter gaps
+	unknownIDs    atomic.Uint64 // trices with an ID not found in til.json
+	framingErrors atomic.Uint64 // packages not decodable (COBS or TCOBS errors)
+
+	mu        sync.Mutex            // mu protects the fields below
+	perID     map[id.TriceID]uint64 // decoded trices per ID
+	buckets   []uint64              // latency histogram counts, one per LatencyBuckets value plus +Inf
+	latSum    float64               // latency sum in seconds
+	latCount  uint64                // latency observations count
+	startTime time.Time             // metrics start
+	target    TargetDiagnostics     // last received target diagnostics record
+	targetOK  bool                  // true, when a target diagnostics record was received
+}
+
+// TargetDiagnostics are the values of a target TriceLogDiagnostics record in transmit order.
+type TargetDiagnostics [12]uint32
+
+// targetNames are the gauge names for TargetDiagnostics values.
+var targetNames = [12]string{
+	"trice_target_error_count",
+	"trice_target_direct_overflow_count",
+	"trice_target_deferred_overflow_count",
+	"trice_target_dyn_buf_truncate_count",
+	"trice_target_single_depth_max_bytes",
+	"trice_target_single_buffer_size_bytes",
+	"trice_target_data_offset_depth_max_bytes",
+	"trice_target_data_offset_bytes",
+	"trice_target_deferred_depth_max_bytes",
+	"trice_target_deferred_buffer_size_bytes",
+	"trice_target_rtt0_write_depth_max_bytes",
+	"trice_target_rtt0_buffer_size_bytes",
+}
+
+// c is the session wide metrics instance.
+var c = newCounters()
+
+// idRates holds the per ID rates of the last completed RateWindow for the HTTP endpoint.
+var idRates struct {
+	sync.Mutex
+	perID map[id.TriceID]float64
+}
+
+func newCounters() *counters {
+	return &counters{
+		perID:     make(map[id.TriceID]uint64),
+		buckets:   make([]uint64, len(LatencyBuckets)+1),
+		startTime: time.Now(),
+	}
+}
+
+// Reset clears all collected values. It is used for tests.
+func Reset() {
+	c = newCounters()
+	setRates(nil)
+}
+
+// Start activates the metrics collection, when -metrics or -metricsInterval is set.
+//
+// It starts the HTTP server and the summary line writer in the background. The summary lines go to w.
+func Start(w io.Writer) {
+	if Address == "off" || Address == "none" {
+		Address = ""
+	}
+	if Address == "" && Interval <= 0 {
+		return
+	}
+	Active = true
+	if Address != "" {
+		go rateLoop(RateWindow)
+		go serve(w, Address)
+	}
+	if Interval > 0 {
+		go summaryLoop(w, time.Duration(Interval)*time.Second)
+	}
+}
+
+// serve runs the HTTP endpoint. An error is reported but does not stop the log session.
+func serve(w io.Writer, addr string) {
+	mux := http.NewServeMux()
+	mux.HandleFunc("/metrics", func(rw http.ResponseWriter, _ *http.Request) {
+		rw.Header().Set("Content-Type", "text/plain; version=0.0.4")
+		WritePrometheus(rw)
+	})
+	if Verbose {
+		fmt.Fprintln(w, "metrics endpoint is http://"+addr+"/metrics")
+	}
+	if err := http.ListenAndServe(addr, mux); err != nil {
+		fmt.Fprintln(w, "wrn:metrics endpoint", addr, "failed:", err)
+	}
+}
+
+// summaryLoop writes every d a summary line into w.
+func summaryLoop(w io.Writer, d time.Duration) {
+	var last Snapshot
+	for range time.Tick(d) {
+		s := Take()
+		WriteSummary(w, s, last, d)
+		last = s
+	}
+}
+
+// rateLoop computes every d the per ID rates for the HTTP endpoint.
+func rateLoop(d time.Duration) {
+	last := Take()
+	for range time.Tick(d) {
+		s := Take()
+		setRates(PerIDRates(s, last))
+		last = s
+	}
+}
+
+// setRates stores r as the actual per ID rates.
+func setRates(r map[id.TriceID]float64) {
+	idRates.Lock()
+	idRates.perID = r
+	idRates.Unlock()
+}
+
+// PerIDRates returns the decoded trices per second of each ID, which occurred between the snapshots last and s.
+func PerIDRates(s, last Snapshot) map[id.TriceID]float64 {
+	sec := s.Time.Sub(last.Time).Seconds()
+	r := make(map[id.TriceID]float64)
+	if sec <= 0 {
+		return r
+	}
+	for k, v := range s.PerID {
+		if d := v - last.PerID[k]; d > 0 {
+			r[k] = float64(d) / sec
+		}
+	}
+	return r
+}
+
+// Bytes counts n received raw bytes.
+func Bytes(n int) {
+	c.bytes.Add(uint64(n))
+}
+
+// Package counts a received package with n raw bytes including the delimiter.
+func Package(n int) {
+	c.packages.Add(1)
+	c.bytes.Add(uint64(n))
+}
+
+// FramingError counts a not decodable package.
+func FramingError() {
+	c.framingErrors.Add(1)
+}
+
+// UnknownID counts a trice with an ID not found in the ID list.
+func UnknownID() {
+	c.unknownIDs.Add(1)
+}
+
+// Lost counts n trices lost on the way, detected by a cycle counter gap.
+func Lost(n int) {
+	c.lost.Add(uint64(n))
+}
+
+// CycleGap returns the count of trices lost between the expected cycle and the received cycle.
+// The cycle counter wraps from 0xff to 0 but the target skips nothing, so the gap is computed modulo 256.
+func CycleGap(received, expected uint8) int {
+	return int(received - expected)
+}
+
+// Trice counts a successfully decoded trice with ID tid and latency d, measured from package arrival.
+func Trice(tid id.TriceID, d time.Duration) {
+	c.trices.Add(1)
+	sec := d.Seconds()
+	c.mu.Lock()
+	c.perID[tid]++
+	i := sort.SearchFloat64s(LatencyBuckets, sec) // first bucket with upper bound >= sec
+	c.buckets[i]++
+	c.latSum += sec
+	c.latCount++
+	c.mu.Unlock()
+}
+
+// Target stores the values of a received target diagnostics record.
+func Target(v TargetDiagnostics) {
+	c.mu.Lock()
+	c.target = v
+	c.targetOK = true
+	c.mu.Unlock()
+}
+
+// Snapshot is a consistent copy of all metric values.
+type Snapshot struct {
+	Time          time.Time
+	Trices        uint64
+	Bytes         uint64
+	Packages      uint64
+	Lost          uint64
+	UnknownIDs    uint64
+	FramingErrors uint64
+	PerID         map[id.TriceID]uint64
+	Buckets       []uint64 // not cumulative
+	LatencySum    float64
+	LatencyCount  uint64
+	Target        TargetDiagnostics
+	TargetOK      bool
+}
+
+// Take returns a snapshot of the actual metric values.
+func Take() (s Snapshot) {
+	s.Time = time.Now()
+	s.Trices = c.trices.Load()
+	s.Bytes = c.bytes.Load()
+	s.Packages = c.packages.Load()
+	s.Lost = c.lost.Load()
+	s.UnknownIDs = c.unknownIDs.Load()
+	s.FramingErrors = c.framingErrors.Load()
+	c.mu.Lock()
+	s.PerID = make(map[id.TriceID]uint64, len(c.perID))
+	for k, v := range c.perID {
+		s.PerID[k] = v
+	}
+	s.Buckets = append([]uint64(nil), c.buckets...)
+	s.LatencySum = c.latSum
+	s.LatencyCount = c.latCount
+	s.Target = c.target
+	s.TargetOK = c.targetOK
+	c.mu.Unlock()
+	return
+}
+
+// WriteSummary writes a one line summary of s into w. The rates are computed against the previous snapshot last over d.
+// The line ends with the TopIDs IDs with the highest rates.
+func WriteSummary(w io.Writer, s, last Snapshot, d time.Duration) {
+	sec := d.Seconds()
+	fmt.Fprintf(w, "metrics: %.1f trices/s, %.1f bytes/s, %.1f packages/s, lost=%d, unknownIDs=%d, framingErrors=%d",
+		float64(s.Trices-last.Trices)/sec,
+		float64(s.Bytes-last.Bytes)/sec,
+		float64(s.Packages-last.Packages)/sec,
+		s.Lost, s.UnknownIDs, s.FramingErrors)
+	ids := make([]id.TriceID, 0, len(s.PerID))
+	for k, v := range s.PerID {
+		if v > last.PerID[k] {
+			ids = append(ids, k)
+		}
+	}
+	sort.Slice(ids, func(i, j int) bool {
+		di, dj := s.PerID[ids[i]]-last.PerID[ids[i]], s.PerID[ids[j]]-last.PerID[ids[j]]
+		return di > dj || di == dj && ids[i] < ids[j]
+	})
+	for i, k := range ids {
+		if i == TopIDs {
+			break
+		}
+		sep := ", "
+		if i == 0 {
+			sep = ", top IDs: "
+		}
+		fmt.Fprintf(w, "%s%d=%.1f/s", sep, k, float64(s.PerID[k]-last.PerID[k])/sec)
+	}
+	fmt.Fprintln(w)
+}
+
+// WritePrometheus writes the actual metric values in Prometheus text exposition format into w.
+func WritePrometheus(w io.Writer) {
+	s := Take()
+	counter := func(name, help string, v uint64) {
+		fmt.Fprintf(w, "# HELP %s %s\n# TYPE %s counter\n%s %d\n", name, help, name, name, v)
+	}
+	counter("trice_decoded_total", "Decoded trices.", s.Trices)
+	counter("trice_received_bytes_total", "Received raw bytes.", s.Bytes)
+	counter("trice_received_packages_total", "Received packages.", s.Packages)
+	counter("trice_lost_total", "Lost trices inferred from cycle counter gaps.", s.Lost)
+	counter("trice_unknown_id_total", "Trices with an ID not inside the ID list.", s.UnknownIDs)
+	counter("trice_framing_errors_total", "Not decodable packages.", s.FramingErrors)
+
+	fmt.Fprintf(w, "# HELP trice_decode_latency_seconds Time from package arrival until the trice is decoded.\n# TYPE trice_decode_latency_seconds histogram\n")
+	var cumulative uint64
+	for i, le := range LatencyBuckets {
+		cumulative += s.Buckets[i]
+		fmt.Fprintf(w, "trice_decode_latency_seconds_bucket{le=\"%g\"} %d\n", le, cumulative)
+	}
+	cumulative += s.Buckets[len(LatencyBuckets)]
+	fmt.Fprintf(w, "trice_decode_latency_seconds_bucket{le=\"+Inf\"} %d\n", cumulative)
+	fmt.Fprintf(w, "trice_decode_latency_seconds_sum %g\n", s.LatencySum)
+	fmt.Fprintf(w, "trice_decode_latency_seconds_count %d\n", s.LatencyCount)
+
+	fmt.Fprintf(w, "# HELP trice_id_decoded_total Decoded trices per ID.\n# TYPE trice_id_decoded_total counter\n")
+	ids := make([]int, 0, len(s.PerID))
+	for k := range s.PerID {
+		ids = append(ids, int(k))
+	}
+	sort.Ints(ids)
+	for _, k := range ids {
+		fmt.Fprintf(w, "trice_id_decoded_total{id=\"%d\"} %d\n", k, s.PerID[id.TriceID(k)])
+	}
+
+	idRates.Lock()
+	r := idRates.perID
+	idRates.Unlock()
+	fmt.Fprintf(w, "# HELP trice_id_rate Decoded trices per second and ID over the last rate window.\n# TYPE trice_id_rate gauge\n")
+	for _, k := range ids {
+		if v, ok := r[id.TriceID(k)]; ok {
+			fmt.Fprintf(w, "trice_id_rate{id=\"%d\"} %g\n", k, v)
+		}
+	}
+
+	if !s.TargetOK {
+		return
+	}
+	for i, name := range targetNames {
+		v := int64(s.Target[i])
+		if i == 6 { // TriceDataOffsetDepthMax is signed
+			v = int64(int32(s.Target[i]))
+		}
+		fmt.Fprintf(w, "# HELP %s Value from the last target diagnostics record.\n# TYPE %s gauge\n%s %d\n", name, name, name, v)
+	}
+}
@@ -0,0 +1,105 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package metrics
+
+import (
+	"bytes"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/tj/assert"
+)
+
+func TestCycleGap(t *testing.T) {
+	assert.Equal(t, 0, CycleGap(0xc5, 0xc5))
+	assert.Equal(t, 3, CycleGap(0xc8, 0xc5))
+	assert.Equal(t, 2, CycleGap(0x01, 0xff)) // wrap
+}
+
+func TestWritePrometheus(t *testing.T) {
+	Reset()
+	Package(10)
+	Bytes(5)
+	Trice(7, 2*time.Microsecond)
+	Trice(7, time.Second)
+	Trice(3, 0)
+	Lost(2)
+	UnknownID()
+	FramingError()
+	var out bytes.Buffer
+	WritePrometheus(&out)
+	act := out.String()
+	for _, exp := range []string{
+		"trice_decoded_total 3\n",
+		"trice_received_bytes_total 15\n",
+		"trice_received_packages_total 1\n",
+		"trice_lost_total 2\n",
+		"trice_unknown_id_total 1\n",
+		"trice_framing_errors_total 1\n",
+		"trice_decode_latency_seconds_bucket{le=\"1e-06\"} 1\n",
+		"trice_decode_latency_seconds_bucket{le=\"5e-06\"} 2\n",
+		"trice_decode_latency_seconds_bucket{le=\"0.05\"} 2\n",
+		"trice_decode_latency_seconds_bucket{le=\"+Inf\"} 3\n",
+		"trice_decode_latency_seconds_count 3\n",
+		"trice_id_decoded_total{id=\"3\"} 1\ntrice_id_decoded_total{id=\"7\"} 2\n",
+	} {
+		assert.True(t, strings.Contains(act, exp), exp)
+	}
+}
+
+func TestWriteSummary(t *testing.T) {
+	Reset()
+	last := Take()
+	for i := 0; i < 20; i++ {
+		Package(8)
+		Trice(1, 0)
+	}
+	Lost(1)
+	var out bytes.Buffer
+	WriteSummary(&out, Take(), last, 2*time.Second)
+	assert.Equal(t, "metrics: 10.0 trices/s, 80.0 bytes/s, 10.0 packages/s, lost=1, unknownIDs=0, framingErrors=0, top IDs: 1=10.0/s\n", out.String())
+}
+
+func TestPerIDRates(t *testing.T) {
+	Reset()
+	last := Take()
+	for i := 0; i < 8; i++ {
+		Trice(5, 0)
+	}
+	for i := 0; i < 4; i++ {
+		Trice(2, 0)
+	}
+	Trice(9, 0)
+	Trice(1, 0)
+	s := Take()
+	s.Time = last.Time.Add(2 * time.Second)
+	r := PerIDRates(s, last)
+	assert.Equal(t, 4.0, r[5])
+	assert.Equal(t, 2.0, r[2])
+	assert.Equal(t, 0.5, r[9])
+
+	var out bytes.Buffer
+	WriteSummary(&out, s, last, 2*time.Second)
+	assert.True(t, strings.HasSuffix(out.String(), ", top IDs: 5=4.0/s, 2=2.0/s, 1=0.5/s\n"), out.String())
+
+	setRates(r)
+	out.Reset()
+	WritePrometheus(&out)
+	assert.True(t, strings.Contains(out.String(), "trice_id_rate{id=\"2\"} 2\ntrice_id_rate{id=\"5\"} 4\ntrice_id_rate{id=\"9\"} 0.5\n"), out.String())
+}
+
+func TestTargetGauges(t *testing.T) {
+	Reset()
+	var out bytes.Buffer
+	WritePrometheus(&out)
+	assert.False(t, strings.Contains(out.String(), "trice_target_"))
+	Target(TargetDiagnostics{0, 0, 3, 0, 56, 124, 0xfffffffc, 16, 200, 1024, 0, 0})
+	out.Reset()
+	WritePrometheus(&out)
+	act := out.String()
+	assert.True(t, strings.Contains(act, "trice_target_deferred_overflow_count 3\n"))
+	assert.True(t, strings.Contains(act, "trice_target_data_offset_depth_max_bytes -4\n"))
+	assert.True(t, strings.Contains(act, "trice_target_deferred_buffer_size_bytes 1024\n"))
+}
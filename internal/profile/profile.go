@@ -0,0 +1,288 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+// Package profile accumulates per-ID and per-file trice traffic statistics for "trice log -profile".
+//
+// The decoder hands each decoded trice ID and size to Trice. At the end of a log session Finish prints
+// a sorted top-N table and optionally writes a CSV or JSON report. Replaying a binary logfile with
+// "-port FILEBUFFER" together with "-profileClock target" gives the offline variant.
+package profile
+
+import (
+	"encoding/csv"
+	"encoding/json"
+	"fmt"
+	"io"
+	"path/filepath"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+	"time"
+
+	"github.com/rokath/trice/internal/decoder"
+	"github.com/rokath/trice/internal/id"
+	"github.com/rokath/trice/pkg/msg"
+	"github.com/spf13/afero"
+)
+
+var (
+	// Enabled is true, when -profile is set.
+	Enabled bool
+
+	// Top is the row count of the printed tables.
+	Top = 20
+
+	// ReportFile is the CSV or JSON report file name. The extension ".json" selects JSON, all others CSV. "off" or "none" disables the report.
+	ReportFile = "off"
+
+	// Clock selects the time base: "host" is the reception time and "target" the 32-bit target timestamps.
+	Clock = "host"
+)
+
+// BurstWindow is the time window for the burst maxima.
+const BurstWindow = time.Second
+
+// Entry holds the traffic statistics of one trice ID or one source file.
+type Entry struct {
+	ID       id.TriceID `json:"ID,omitempty"`
+	File     string     `json:"File"`
+	Line     int        `json:"Line,omitempty"`
+	Fmt      string     `json:"Fmt,omitempty"`
+	Count    uint64     `json:"Count"`
+	Bytes    uint64     `json:"Bytes"`
+	Share    float64    `json:"Share"`    // Share is the percentage of all trice bytes.
+	Rate     float64    `json:"Rate"`     // Rate is the average count per second over the whole session.
+	ByteRate float64    `json:"ByteRate"` // ByteRate is the average bytes per second over the whole session.
+	BurstMax int        `json:"BurstMax"` // BurstMax is the maximum count inside one BurstWindow.
+
+	windowStart time.Duration // start of the actual burst window
+	windowCount int           // count inside the actual burst window
+}
+
+// profiler is the session state.
+type profiler struct {
+	mu        sync.Mutex
+	ids       map[id.TriceID]*Entry
+	start     time.Time     // host clock start
+	first     time.Duration // first trice time
+	last      time.Duration // last trice time
+	seen      bool          // at least one trice
+	stampLast uint64        // last target stamp for wrap detection
+	stampHigh uint64        // accumulated 32-bit target stamp wraps
+	fSys      *afero.Afero
+	lut       id.TriceIDLookUp
+	li        id.TriceIDLookUpLI
+	done      bool
+}
+
+var p = newProfiler()
+
+func newProfiler() *profiler {
+	return &profiler{ids: make(map[id.TriceID]*Entry), start: time.Now()}
+}
+
+// Setup starts a new profile and provides the file system for the report and the ID and location information for the tables.
+func Setup(fSys *afero.Afero, lut id.TriceIDLookUp, li id.TriceIDLookUpLI) {
+	Reset()
+	p.fSys = fSys
+	p.lut = lut
+	p.li = li
+}
+
+// Reset clears all collected values. It is used for tests.
+func Reset() {
+	p = newProfiler()
+}
+
+// now returns the actual time according to Clock. Without 32-bit target stamp the last target time is used.
+func (p *profiler) now() time.Duration {
+	if Clock != "target" {
+		return time.Since(p.start)
+	}
+	if decoder.TargetTimestampSize != 4 {
+		return p.last
+	}
+	stamp := decoder.TargetTimestamp
+	if p.seen && stamp < p.stampLast { // 32-bit wrap
+		p.stampHigh += 1 << 32
+	}
+	p.stampLast = stamp
+	unit := time.Millisecond
+	if decoder.TargetStamp32 == "us" || decoder.TargetStamp32 == "µs" || decoder.TargetStamp32 == "ssss,ms_µs" {
+		unit = time.Microsecond
+	}
+	return time.Duration(p.stampHigh+stamp) * unit
+}
+
+// Trice counts a decoded trice with ID tid and size bytes.
+func Trice(tid id.TriceID, size int) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	t := p.now()
+	if !p.seen {
+		p.first = t
+		p.seen = true
+	}
+	p.last = t
+	e, ok := p.ids[tid]
+	if !ok {
+		e = &Entry{ID: tid, windowStart: t}
+		p.ids[tid] = e
+	}
+	e.Count++
+	e.Bytes += uint64(size)
+	if t-e.windowStart >= BurstWindow {
+		e.windowStart = t
+		e.windowCount = 0
+	}
+	e.windowCount++
+	if e.windowCount > e.BurstMax {
+		e.BurstMax = e.windowCount
+	}
+}
+
+// Result returns the per-ID and per-file entries sorted by descending bytes.
+func Result() (ids, files []Entry) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	var total uint64
+	for _, e := range p.ids {
+		total += e.Bytes
+	}
+	seconds := (p.last - p.first).Seconds()
+	byFile := make(map[string]*Entry)
+	for tid, e := range p.ids {
+		x := *e
+		if li, ok := p.li[tid]; ok {
+			x.File, x.Line = li.File, li.Line
+		}
+		if t, ok := p.lut[tid]; ok {
+			x.Fmt = t.Strg
+		}
+		ids = append(ids, x)
+		f, ok := byFile[x.File]
+		if !ok {
+			f = &Entry{File: x.File}
+			byFile[x.File] = f
+		}
+		f.Count += x.Count
+		f.Bytes += x.Bytes
+		f.BurstMax += x.BurstMax // upper bound, the ID bursts may not coincide
+	}
+	for _, f := range byFile {
+		files = append(files, *f)
+	}
+	for _, list := range [][]Entry{ids, files} {
+		for i := range list {
+			e := &list[i]
+			if total > 0 {
+				e.Share = 100 * float64(e.Bytes) / float64(total)
+			}
+			if seconds > 0 {
+				e.Rate = float64(e.Count) / seconds
+				e.ByteRate = float64(e.Bytes) / seconds
+			}
+		}
+		sort.SliceStable(list, func(i, j int) bool {
+			if list[i].Bytes != list[j].Bytes {
+				return list[i].Bytes > list[j].Bytes
+			}
+			if list[i].ID != list[j].ID {
+				return list[i].ID < list[j].ID
+			}
+			return list[i].File < list[j].File
+		})
+	}
+	return
+}
+
+// Finish prints the top tables into w and writes the report file, if configured. Only the first call has an effect.
+func Finish(w io.Writer) {
+	if !Enabled {
+		return
+	}
+	p.mu.Lock()
+	if p.done {
+		p.mu.Unlock()
+		return
+	}
+	p.done = true
+	p.mu.Unlock()
+	ids, files := Result()
+	PrintTables(w, ids, files)
+	if ReportFile != "off" && ReportFile != "none" && ReportFile != "" {
+		msg.OnErr(WriteReport(p.fSys, ReportFile, ids, files))
+	}
+}
+
+// PrintTables writes the top per-ID and per-file tables into w.
+func PrintTables(w io.Writer, ids, files []Entry) {
+	fmt.Fprintf(w, "profile: top %d trice IDs by bytes\n", Top)
+	fmt.Fprintf(w, "%6s %8s %10s %6s %10s %10s %8s  %s\n", "ID", "count", "bytes", "share", "trices/s", "bytes/s", "burst/s", "location")
+	for i, e := range ids {
+		if i == Top {
+			break
+		}
+		fmt.Fprintf(w, "%6d %8d %10d %5.1f%% %10.1f %10.1f %8d  %s:%d %s\n", e.ID, e.Count, e.Bytes, e.Share, e.Rate, e.ByteRate, e.BurstMax, e.File, e.Line, shorten(e.Fmt, 40))
+	}
+	fmt.Fprintf(w, "profile: top %d files by bytes\n", Top)
+	fmt.Fprintf(w, "%8s %10s %6s %10s %10s  %s\n", "count", "bytes", "share", "trices/s", "bytes/s", "file")
+	for i, e := range files {
+		if i == Top {
+			break
+		}
+		fmt.Fprintf(w, "%8d %10d %5.1f%% %10.1f %10.1f  %s\n", e.Count, e.Bytes, e.Share, e.Rate, e.ByteRate, e.File)
+	}
+}
+
+// shorten returns s with max n runes and escaped newlines.
+func shorten(s string, n int) string {
+	s = strings.ReplaceAll(s, "\n", `\n`)
+	r := []rune(s)
+	if len(r) > n {
+		return string(r[:n-3]) + "..."
+	}
+	return s
+}
+
+// WriteReport writes ids and files into fn. The extension ".json" selects JSON, otherwise CSV is written.
+// The CSV per-file rows follow the per-ID rows with the same columns, but an empty ID, Line and Fmt.
+func WriteReport(fSys *afero.Afero, fn string, ids, files []Entry) error {
+	fh, err := fSys.Create(fn)
+	if err != nil {
+		return err
+	}
+	defer fh.Close()
+	if strings.ToLower(filepath.Ext(fn)) == ".json" {
+		b, err := json.MarshalIndent(struct {
+			IDs   []Entry `json:"IDs"`
+			Files []Entry `json:"Files"`
+		}{ids, files}, "", "\t")
+		if err != nil {
+			return err
+		}
+		_, err = fh.Write(b)
+		return err
+	}
+	cw := csv.NewWriter(fh)
+	msg.OnErr(cw.Write([]string{"ID", "File", "Line", "Count", "Bytes", "Share", "Rate", "ByteRate", "BurstMax", "Fmt"}))
+	for _, e := range ids {
+		msg.OnErr(cw.Write([]string{
+			strconv.Itoa(int(e.ID)), e.File, strconv.Itoa(e.Line),
+			strconv.FormatUint(e.Count, 10), strconv.FormatUint(e.Bytes, 10),
+			strconv.FormatFloat(e.Share, 'f', 2, 64), strconv.FormatFloat(e.Rate, 'f', 2, 64),
+			strconv.FormatFloat(e.ByteRate, 'f', 2, 64), strconv.Itoa(e.BurstMax), e.Fmt,
+		}))
+	}
+	for _, e := range files {
+		msg.OnErr(cw.Write([]string{
+			"", e.File, "",
+			strconv.FormatUint(e.Count, 10), strconv.FormatUint(e.Bytes, 10),
+			strconv.FormatFloat(e.Share, 'f', 2, 64), strconv.FormatFloat(e.Rate, 'f', 2, 64),
+			strconv.FormatFloat(e.ByteRate, 'f', 2, 64), strconv.Itoa(e.BurstMax), "",
+		}))
+	}
+	cw.Flush()
+	return cw.Error()
+}
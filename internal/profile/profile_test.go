@@ -0,0 +1,63 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package profile
+
+import (
+	"bytes"
+	"strings"
+	"testing"
+
+	"github.com/rokath/trice/internal/decoder"
+	"github.com/rokath/trice/internal/id"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+// trices feeds n trices with ID tid, size bytes and 32-bit target stamps starting at ms every step ms.
+func trices(tid id.TriceID, size, n int, ms, step uint64) {
+	decoder.TargetTimestampSize = 4
+	for i := 0; i < n; i++ {
+		decoder.TargetTimestamp = ms + uint64(i)*step
+		Trice(tid, size)
+	}
+}
+
+func TestProfileTargetClock(t *testing.T) {
+	fSys := &afero.Afero{Fs: afero.NewMemMapFs()}
+	lut := id.TriceIDLookUp{10: {Type: "TRICE8_1", Strg: "msg:%d\\n"}, 20: {Type: "TRICE", Strg: "dbg:hi\\n"}}
+	li := id.TriceIDLookUpLI{10: {File: "a.c", Line: 5}, 20: {File: "b.c", Line: 7}}
+	Setup(fSys, lut, li)
+	Clock = "target"
+	decoder.TargetStamp32 = "ms"
+	defer func() { Clock = "host" }()
+
+	trices(10, 8, 10, 0, 10)   // burst: 10 trices within 100 ms
+	trices(20, 12, 2, 1000, 0) // 2 trices at 1 s
+	trices(10, 8, 1, 2000, 0)  // 1 trice at 2 s
+
+	ids, files := Result()
+	assert.Equal(t, 2, len(ids))
+	assert.Equal(t, id.TriceID(10), ids[0].ID) // 88 bytes
+	assert.Equal(t, uint64(11), ids[0].Count)
+	assert.Equal(t, uint64(88), ids[0].Bytes)
+	assert.Equal(t, 10, ids[0].BurstMax)
+	assert.Equal(t, 5.5, ids[0].Rate) // 11 trices in 2 s
+	assert.Equal(t, "a.c", ids[0].File)
+	assert.Equal(t, "b.c", files[1].File)
+	assert.Equal(t, uint64(24), files[1].Bytes)
+
+	var out bytes.Buffer
+	PrintTables(&out, ids, files)
+	assert.True(t, strings.Contains(out.String(), "    10       11         88  78.6%        5.5       44.0       10  a.c:5 msg:%d\\n\n"), out.String())
+
+	assert.Nil(t, WriteReport(fSys, "p.csv", ids, files))
+	csv, err := fSys.ReadFile("p.csv")
+	assert.Nil(t, err)
+	assert.Equal(t, `ID,File,Line,Count,Bytes,Share,Rate,ByteRate,BurstMax,Fmt
+10,a.c,5,11,88,78.57,5.50,44.00,10,msg:%d\n
+20,b.c,7,2,24,21.43,1.00,12.00,2,dbg:hi\n
+,a.c,,11,88,78.57,5.50,44.00,10,
+,b.c,,2,24,21.43,1.00,12.00,2,
+`, string(csv))
+}
@@ -0,0 +1,51 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package receiver
+
+// Host arrival timestamps taken directly at the port reads.
+
+import (
+	"io"
+	"time"
+
+	"github.com/rokath/trice/internal/decoder"
+)
+
+// ArrivalStamp is the format of the host arrival time column. With "off" or "none" the port reads are not stamped.
+var ArrivalStamp = "off"
+
+// arrivalStamper records the host time of each read returning data.
+//
+// time.Now carries the monotonic clock, so differences between arrival times are not affected by wall clock changes.
+type arrivalStamper struct {
+	io.ReadWriteCloser
+	arrival time.Time // arrival is the time, when the last read with data returned.
+}
+
+// newArrivalStamper returns r with arrival time stamping.
+func newArrivalStamper(r io.ReadWriteCloser) *arrivalStamper {
+	return &arrivalStamper{ReadWriteCloser: r}
+}
+
+// Read reads from the port and stamps the arrival time, when data were read.
+func (p *arrivalStamper) Read(b []byte) (n int, err error) {
+	n, err = p.ReadWriteCloser.Read(b)
+	if n > 0 {
+		p.arrival = time.Now()
+	}
+	return
+}
+
+// Arrival returns the host time, when the last read with data returned.
+func (p *arrivalStamper) Arrival() time.Time {
+	return p.arrival
+}
+
+// arrival returns the arrival time of r or the zero time, if r does not provide it.
+func arrival(r io.Reader) time.Time {
+	if a, ok := r.(decoder.ArrivalReader); ok {
+		return a.Arrival()
+	}
+	return time.Time{}
+}
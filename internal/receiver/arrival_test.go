@@ -0,0 +1,35 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package receiver
+
+import (
+	"io"
+	"testing"
+	"time"
+
+	"github.com/tj/assert"
+)
+
+// TestArrivalStamper checks, that only reads with data are stamped and that the wrappers forward the arrival time.
+func TestArrivalStamper(t *testing.T) {
+	ArrivalStamp = "us"
+	defer func() { ArrivalStamp = "off" }()
+	rc, err := NewReadWriteCloser(nil, nil, false, "BUFFER", "7 123 44")
+	assert.Nil(t, err)
+	rc = NewBytesViewer(io.Discard, rc)
+	assert.True(t, arrival(rc).IsZero())
+	before := time.Now()
+	b := make([]byte, 4)
+	n, err := rc.Read(b)
+	assert.Nil(t, err)
+	assert.Equal(t, 3, n)
+	stamp := arrival(rc)
+	assert.False(t, stamp.Before(before))
+	assert.False(t, time.Now().Before(stamp))
+	n, err = rc.Read(b)
+	assert.Equal(t, 0, n)
+	assert.Equal(t, io.EOF, err)
+	assert.Equal(t, stamp, arrival(rc)) // no data, no new stamp
+	assert.Nil(t, rc.Close())
+}
@@ -0,0 +1,115 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package receiver
+
+// Reading of trice flash log images, written by the target code with TRICE_DEFERRED_FLASH == 1 (see src/triceFlash.c).
+
+import (
+	"encoding/binary"
+	"fmt"
+	"io"
+	"sort"
+
+	"github.com/spf13/afero"
+)
+
+// DefaultFlashImageArgs replaces "default" args value for FLASHIMAGE port.
+var DefaultFlashImageArgs = "triceFlash.bin"
+
+const (
+	flashMagic      = 0x54524346 // flashMagic is TRICE_FLASH_MAGIC.
+	flashHeaderSize = 16         // flashHeaderSize is the byte count of triceFlashPageHeader_t.
+)
+
+// flashPage is a valid page inside a flash log image.
+type flashPage struct {
+	offset   int    // offset is the page position inside the image.
+	sequence uint32 // sequence is the page sequence number.
+}
+
+// flashGeometry returns page size and program size from the first valid page header in image.
+func flashGeometry(image []byte) (pageSize, programSize int, err error) {
+	for i := 0; i+flashHeaderSize <= len(image); i += flashHeaderSize {
+		if _, ps, pgs, ok := flashPageHeader(image[i:]); ok && i%ps == 0 {
+			return ps, pgs, nil
+		}
+	}
+	return 0, 0, fmt.Errorf("no trice flash log page found")
+}
+
+// flashPageHeader decodes the page header at the begin of b.
+func flashPageHeader(b []byte) (sequence uint32, pageSize, programSize int, ok bool) {
+	u32, u16 := binary.LittleEndian.Uint32, binary.LittleEndian.Uint16
+	if TargetBigEndian {
+		u32, u16 = binary.BigEndian.Uint32, binary.BigEndian.Uint16
+	}
+	sequence = u32(b[4:])
+	ps := u32(b[8:])
+	pgs := u16(b[12:])
+	check := ^uint16(sequence ^ sequence>>16 ^ ps ^ uint32(pgs))
+	if u32(b) != flashMagic || u16(b[14:]) != check || (pgs != 4 && pgs != 8 && pgs != 16) || ps < flashHeaderSize+uint32(pgs) || ps%uint32(pgs) != 0 {
+		return 0, 0, 0, false
+	}
+	return sequence, int(ps), int(pgs), true
+}
+
+// flashImage returns the trice packages stored in the flash log image in write order.
+// Pages are ordered by their sequence numbers. A page is read until its first not valid record.
+func flashImage(image []byte) ([]byte, error) {
+	pageSize, programSize, err := flashGeometry(image)
+	if err != nil {
+		return nil, err
+	}
+	u16 := binary.LittleEndian.Uint16
+	if TargetBigEndian {
+		u16 = binary.BigEndian.Uint16
+	}
+	var pages []flashPage
+	for i := 0; i+pageSize <= len(image); i += pageSize {
+		if seq, ps, pgs, ok := flashPageHeader(image[i:]); ok && ps == pageSize && pgs == programSize {
+			pages = append(pages, flashPage{i, seq})
+		}
+	}
+	if len(pages) == 0 {
+		return nil, fmt.Errorf("no complete trice flash log page found")
+	}
+	newest := pages[0].sequence
+	for _, p := range pages {
+		if int32(p.sequence-newest) > 0 {
+			newest = p.sequence
+		}
+	}
+	sort.Slice(pages, func(i, j int) bool { // wrap aware
+		return int32(pages[i].sequence-newest) < int32(pages[j].sequence-newest)
+	})
+	var b []byte
+	for _, p := range pages {
+		page := image[p.offset : p.offset+pageSize]
+		for k := flashHeaderSize; k+programSize <= pageSize; {
+			n := int(u16(page[k:]))
+			size := (n + programSize - 1) &^ (programSize - 1)
+			if u16(page[k+2:]) != ^uint16(n) || n == 0 || k+programSize+size > pageSize {
+				break // unused space or a record not completed before a power fail
+			}
+			b = append(b, page[k+programSize:k+programSize+n]...)
+			k += programSize + size
+		}
+	}
+	return b, nil
+}
+
+// newFlashImageReader returns a buffer with the trice packages from flash log image file fn.
+func newFlashImageReader(fSys *afero.Afero, fn string) (io.ReadWriteCloser, error) {
+	image, err := fSys.ReadFile(fn)
+	if err != nil {
+		return nil, err
+	}
+	b, err := flashImage(image)
+	if err != nil {
+		return nil, fmt.Errorf("%s: %w", fn, err)
+	}
+	r := &buffer{}
+	r.Write(b)
+	return r, nil
+}
@@ -0,0 +1,73 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package receiver
+
+import (
+	"encoding/binary"
+	"testing"
+
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+// flashTestPage returns a 64 bytes flash page with program size 8, sequence number seq and records r like written by src/triceFlash.c.
+func flashTestPage(seq uint32, r ...[]byte) []byte {
+	const pageSize, programSize = 64, 8
+	b := make([]byte, pageSize)
+	for i := range b {
+		b[i] = 0xff
+	}
+	binary.LittleEndian.PutUint32(b, flashMagic)
+	binary.LittleEndian.PutUint32(b[4:], seq)
+	binary.LittleEndian.PutUint32(b[8:], pageSize)
+	binary.LittleEndian.PutUint16(b[12:], programSize)
+	binary.LittleEndian.PutUint16(b[14:], ^uint16(seq^seq>>16^pageSize^programSize))
+	k := flashHeaderSize
+	for _, x := range r {
+		binary.LittleEndian.PutUint16(b[k:], uint16(len(x)))
+		binary.LittleEndian.PutUint16(b[k+2:], ^uint16(len(x)))
+		copy(b[k+programSize:], x)
+		for i := len(x); i%programSize != 0; i++ {
+			b[k+programSize+i] = 0
+		}
+		k += programSize + (len(x)+programSize-1)&^(programSize-1)
+	}
+	return b
+}
+
+func TestFlashImage(t *testing.T) {
+	page0 := flashTestPage(5, []byte{5, 0}, []byte{6, 6, 6, 6, 6, 6, 6, 6, 6, 0})
+	page1 := flashTestPage(2) // an old page, erased by page 0
+	page2 := flashTestPage(3, []byte{3, 0}, []byte{4, 0})
+	page3 := flashTestPage(4, []byte{7, 7, 0}, []byte{8, 0})
+	page3[34] = 0x55 // a not completed record header programming during a power fail
+	for i := range page1 {
+		page1[i] = 0xff
+	}
+	image := append(append(append(page0, page1...), page2...), page3...)
+	act, err := flashImage(image)
+	assert.Nil(t, err)
+	assert.Equal(t, []byte{3, 0, 4, 0, 7, 7, 0, 5, 0, 6, 6, 6, 6, 6, 6, 6, 6, 6, 0}, act)
+}
+
+func TestFlashImageSequenceWrap(t *testing.T) {
+	image := append(flashTestPage(0xffffffff, []byte{1, 0}), flashTestPage(0, []byte{2, 0})...)
+	act, err := flashImage(image)
+	assert.Nil(t, err)
+	assert.Equal(t, []byte{1, 0, 2, 0}, act)
+}
+
+func TestFlashImageReader(t *testing.T) {
+	fSys := &afero.Afero{Fs: afero.NewMemMapFs()}
+	assert.Nil(t, fSys.WriteFile("flash.bin", flashTestPage(1, []byte{9, 0}), 0o644))
+	r, err := NewReadWriteCloser(nil, fSys, false, "FLASHIMAGE", "flash.bin")
+	assert.Nil(t, err)
+	b := make([]byte, 10)
+	n, _ := r.Read(b)
+	assert.Equal(t, []byte{9, 0}, b[:n])
+
+	assert.Nil(t, fSys.WriteFile("empty.bin", make([]byte, 64), 0o644))
+	_, err = NewReadWriteCloser(nil, fSys, false, "FLASHIMAGE", "empty.bin")
+	assert.Error(t, err)
+}
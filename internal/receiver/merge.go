@@ -0,0 +1,309 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package receiver
+
+// Merging of several RTT up-channels into one trice stream.
+
+import (
+	"encoding/binary"
+	"io"
+	"path/filepath"
+	"strings"
+	"time"
+
+	cobs "github.com/rokath/cobs/go"
+	"github.com/rokath/tcobs/v1"
+	"github.com/rokath/trice/internal/decoder"
+	"github.com/rokath/trice/pkg/cipher"
+)
+
+var (
+	// RTTChannels is a comma separated RTT up-channel list for port J-LINK or ST-LINK.
+	// With more than one channel, an RTT logger is started for each channel and the trice packages are merged by their target stamps.
+	RTTChannels string
+
+	// MergeWindow is the time a package waits for packages with smaller target stamps from the other channels.
+	MergeWindow = 20 * time.Millisecond
+
+	// TargetBigEndian is true for big endian target stamps. It is needed only for merging several channels.
+	TargetBigEndian bool
+
+	// mergePoll is the read retry interval for a live channel without new data.
+	mergePoll = 5 * time.Millisecond
+)
+
+// mergePackage is a complete trice package from one of the merged channels.
+type mergePackage struct {
+	channel int       // channel is the source index.
+	raw     []byte    // raw is the package as received, with its 0-delimiter when framed. nil signals the channel end.
+	stamp   uint32    // stamp is the 32-bit target stamp or, if the package has none, the stamp of the previous channel package.
+	arrival time.Time // arrival is the receive time.
+}
+
+// merger delivers the trice packages of several sources as one stream ordered by target stamp.
+//
+// Only 32-bit target stamps are used for sorting. Packages without such a stamp keep their position behind the previous package of the same channel.
+// Encrypted packages are merged in arrival order.
+type merger struct {
+	sources []io.ReadWriteCloser
+	in      chan mergePackage
+	queue   [][]mergePackage // queue holds the received and not delivered packages per channel.
+	done    []bool           // done is true for ended channels.
+	out     []byte           // out holds delivered and not read bytes.
+	framing string           // framing is the lower case package framing.
+	live    bool             // live is true, when io.EOF means only no data yet.
+	arrival time.Time        // arrival is the receive time of the last delivered package.
+}
+
+// newMerger starts reading all sources in parallel. framing is the trice package framing ("cobs", "tcobs" or "none").
+func newMerger(sources []io.ReadWriteCloser, framing string, live bool) *merger {
+	m := &merger{
+		sources: sources,
+		in:      make(chan mergePackage, 64),
+		queue:   make([][]mergePackage, len(sources)),
+		done:    make([]bool, len(sources)),
+		framing: strings.ToLower(framing),
+		live:    live,
+	}
+	for i, src := range sources {
+		go m.receive(i, src)
+	}
+	return m
+}
+
+// receive splits the data from src into packages and sends them to m.in.
+func (m *merger) receive(channel int, src io.Reader) {
+	buf := make([]byte, 0, decoder.DefaultSize)
+	scratch := make([]byte, decoder.DefaultSize) // scratch is the decoding buffer for the stamp extraction.
+	var stamp uint32
+	for {
+		if len(buf) == cap(buf) { // A package bigger than the buffer cannot be merged.
+			buf = buf[:0]
+		}
+		n, err := src.Read(buf[len(buf):cap(buf)])
+		buf = buf[:len(buf)+n]
+		k := 0
+		for {
+			size := m.packageSize(buf[k:])
+			if size == 0 {
+				break
+			}
+			raw := append([]byte(nil), buf[k:k+size]...)
+			if s, ok := m.stamp32(scratch, raw); ok {
+				stamp = s
+			}
+			m.in <- mergePackage{channel, raw, stamp, time.Now()}
+			k += size
+		}
+		buf = buf[:copy(buf, buf[k:])]
+		if err == nil || err == io.EOF && m.live {
+			if n == 0 {
+				time.Sleep(mergePoll)
+			}
+			continue
+		}
+		m.in <- mergePackage{channel: channel}
+		return
+	}
+}
+
+// packageSize returns the byte count of the first complete package in b or 0.
+func (m *merger) packageSize(b []byte) int {
+	if m.framing != "none" {
+		for i, x := range b {
+			if x == 0 {
+				return i + 1
+			}
+		}
+		return 0
+	}
+	if len(b) < 4 {
+		return 0
+	}
+	var head int
+	switch m.u16(b) >> 14 {
+	case 1: // no stamp
+		head = 4
+	case 2, 3: // 16-bit stamp with doubled ID or 32-bit stamp
+		head = 8
+	default: // Padding or garbage bytes are passed one by one, so the decoder can resync.
+		return 1
+	}
+	if len(b) < head {
+		return 0
+	}
+	nc := m.u16(b[head-2:])
+	count := int(nc >> 8)
+	if nc>>15 == 1 {
+		count = int(nc & 0x7fff)
+	}
+	size := head + (count+3)&^3
+	if len(b) < size {
+		return 0
+	}
+	return size
+}
+
+// stamp32 returns the 32-bit target stamp of raw. ok is false, when raw has no 32-bit stamp. scratch is used for decoding.
+func (m *merger) stamp32(scratch, raw []byte) (stamp uint32, ok bool) {
+	if cipher.Password != "" {
+		return 0, false
+	}
+	b := raw
+	switch m.framing {
+	case "none":
+	case "cobs":
+		n, err := cobs.Decode(scratch, raw[:len(raw)-1])
+		if err != nil {
+			return 0, false
+		}
+		b = scratch[:n]
+	default:
+		n, err := tcobs.Decode(scratch, raw[:len(raw)-1]) // TCOBS decodes from the end and fills scratch from its end.
+		if err != nil {
+			return 0, false
+		}
+		b = scratch[len(scratch)-n:]
+	}
+	if len(b) < 6 || m.u16(b)>>14 != 3 {
+		return 0, false
+	}
+	if TargetBigEndian {
+		return binary.BigEndian.Uint32(b[2:]), true
+	}
+	return binary.LittleEndian.Uint32(b[2:]), true
+}
+
+// u16 reads a 16-bit target value.
+func (m *merger) u16(b []byte) uint16 {
+	if TargetBigEndian {
+		return binary.BigEndian.Uint16(b)
+	}
+	return binary.LittleEndian.Uint16(b)
+}
+
+// Read fills b with merged packages. It returns io.EOF, when all sources ended and all packages are read.
+func (m *merger) Read(b []byte) (int, error) {
+	if len(m.out) == 0 {
+		m.collect()
+	}
+	n := copy(b, m.out)
+	m.out = m.out[n:]
+	if n == 0 && m.ended() {
+		return 0, io.EOF
+	}
+	return n, nil
+}
+
+// collect waits up to MergeWindow for packages, takes over all received ones and delivers what is possible.
+func (m *merger) collect() {
+	timer := time.NewTimer(MergeWindow)
+	defer timer.Stop()
+	select {
+	case p := <-m.in:
+		m.add(p)
+	case <-timer.C:
+	}
+	for {
+		select {
+		case p := <-m.in:
+			m.add(p)
+			continue
+		default:
+		}
+		break
+	}
+	m.deliver(time.Now())
+}
+
+// add queues p.
+func (m *merger) add(p mergePackage) {
+	if p.raw == nil {
+		m.done[p.channel] = true
+		return
+	}
+	m.queue[p.channel] = append(m.queue[p.channel], p)
+}
+
+// deliver moves packages in target stamp order into m.out.
+// The package with the smallest stamp is delivered, when all running channels have a package queued or when it waited MergeWindow.
+func (m *merger) deliver(now time.Time) {
+	for {
+		next := -1
+		complete := true // complete is true, when all running channels have a package queued.
+		for i, q := range m.queue {
+			if len(q) == 0 {
+				complete = complete && m.done[i]
+				continue
+			}
+			if next < 0 || int32(q[0].stamp-m.queue[next][0].stamp) < 0 {
+				next = i
+			}
+		}
+		if next < 0 {
+			return
+		}
+		p := m.queue[next][0]
+		if !complete && now.Sub(p.arrival) < MergeWindow {
+			return
+		}
+		m.out = append(m.out, p.raw...)
+		m.arrival = p.arrival
+		m.queue[next] = m.queue[next][1:]
+	}
+}
+
+// ended returns true, when all channels ended and all their packages are delivered.
+func (m *merger) ended() bool {
+	for i := range m.queue {
+		if !m.done[i] || len(m.queue[i]) > 0 {
+			return false
+		}
+	}
+	return len(m.in) == 0
+}
+
+// Arrival returns the receive time of the last delivered package.
+// Packages delivered together in one Read share this time.
+func (m *merger) Arrival() time.Time {
+	return m.arrival
+}
+
+// Write sends b to the first channel.
+func (m *merger) Write(b []byte) (int, error) {
+	return m.sources[0].Write(b)
+}
+
+// Close closes all sources.
+func (m *merger) Close() (err error) {
+	for _, src := range m.sources {
+		if e := src.Close(); e != nil {
+			err = e
+		}
+	}
+	return
+}
+
+// rttChannelArgs returns the link args with ch as -RTTChannel value.
+// A log file name given as last argument gets ch appended, to keep the RTT logger outputs separated.
+func rttChannelArgs(args, ch string) string {
+	a := strings.Split(args, " ")
+	found := false
+	for i := 0; i+1 < len(a); i++ {
+		if strings.ToLower(a[i]) == "-rttchannel" {
+			a[i+1] = ch
+			found = true
+		}
+	}
+	last := a[len(a)-1]
+	if filepath.Ext(last) == ".bin" {
+		a[len(a)-1] = strings.TrimSuffix(last, ".bin") + "_" + ch + ".bin"
+		if !found {
+			a = append(a[:len(a)-1], "-RTTChannel", ch, a[len(a)-1])
+		}
+	} else if !found {
+		a = append(a, "-RTTChannel", ch)
+	}
+	return strings.Join(a, " ")
+}
@@ -0,0 +1,108 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package receiver
+
+import (
+	"encoding/binary"
+	"io"
+	"testing"
+
+	"github.com/tj/assert"
+)
+
+// stamped returns an unframed trice package with ID id, 32-bit stamp and 4 parameter bytes.
+func stamped(id uint16, stamp uint32) []byte {
+	b := make([]byte, 12)
+	binary.LittleEndian.PutUint16(b, 0xC000|id)
+	binary.LittleEndian.PutUint32(b[2:], stamp)
+	binary.LittleEndian.PutUint16(b[6:], 4<<8|0xc0)
+	return b
+}
+
+// unstamped returns an unframed trice package with ID id and without stamp.
+func unstamped(id uint16) []byte {
+	b := make([]byte, 4)
+	binary.LittleEndian.PutUint16(b, 0x4000|id)
+	binary.LittleEndian.PutUint16(b[2:], 0<<8|0xc0)
+	return b
+}
+
+// cobsFrame returns b COBS encoded with 0-delimiter.
+func cobsFrame(b []byte) []byte {
+	out := []byte{0}
+	code := 0
+	for _, x := range b {
+		if x == 0 {
+			out[code] = byte(len(out) - code)
+			code = len(out)
+			out = append(out, 0)
+			continue
+		}
+		out = append(out, x)
+	}
+	out[code] = byte(len(out) - code)
+	return append(out, 0)
+}
+
+// source returns an io.ReadWriteCloser delivering the packages p.
+func source(p ...[]byte) io.ReadWriteCloser {
+	s := &buffer{}
+	for _, b := range p {
+		s.Write(b)
+	}
+	return s
+}
+
+// readAll reads r until io.EOF.
+func readAll(t *testing.T, r io.Reader) []byte {
+	var all []byte
+	b := make([]byte, 7) // smaller than a package
+	for {
+		n, err := r.Read(b)
+		all = append(all, b[:n]...)
+		if err == io.EOF {
+			return all
+		}
+		assert.Nil(t, err)
+	}
+}
+
+func join(p ...[]byte) (b []byte) {
+	for _, x := range p {
+		b = append(b, x...)
+	}
+	return
+}
+
+func TestMergeByStamp(t *testing.T) {
+	a0, a1, a2 := stamped(100, 10), unstamped(101), stamped(102, 50)
+	b0, b1 := stamped(200, 20), stamped(201, 40)
+	m := newMerger([]io.ReadWriteCloser{source(a0, a1, a2), source(b0, b1)}, "none", false)
+	act := readAll(t, m)
+	assert.Equal(t, join(a0, a1, b0, b1, a2), act) // a1 keeps its place behind a0.
+	assert.Nil(t, m.Close())
+}
+
+func TestMergeByStampCOBS(t *testing.T) {
+	a0, a1 := cobsFrame(stamped(100, 0x10000)), cobsFrame(stamped(101, 0x30000))
+	b0 := cobsFrame(stamped(200, 0x20000))
+	m := newMerger([]io.ReadWriteCloser{source(a0, a1), source(b0)}, "COBS", false)
+	act := readAll(t, m)
+	assert.Equal(t, join(a0, b0, a1), act)
+}
+
+func TestMergeStampWrap(t *testing.T) {
+	a0, a1 := stamped(100, 0xfffffff0), stamped(101, 0x10)
+	b0 := stamped(200, 0xfffffff8)
+	m := newMerger([]io.ReadWriteCloser{source(a0, a1), source(b0)}, "none", false)
+	act := readAll(t, m)
+	assert.Equal(t, join(a0, b0, a1), act)
+}
+
+func TestRTTChannelArgs(t *testing.T) {
+	assert.Equal(t, "-Device STM32F030R8 -RTTChannel 1 -Speed 4000", rttChannelArgs("-Device STM32F030R8 -RTTChannel 0 -Speed 4000", "1"))
+	assert.Equal(t, "-Device STM32F030R8 -RTTChannel 2", rttChannelArgs("-Device STM32F030R8", "2"))
+	assert.Equal(t, "-Device STM32F030R8 -RTTChannel 1 trice_1.bin", rttChannelArgs("-Device STM32F030R8 trice.bin", "1"))
+	assert.Equal(t, "-rttchannel 3 log_3.bin", rttChannelArgs("-rttchannel 0 log.bin", "3"))
+}
@@ -45,7 +45,9 @@ import (
 	"time"
 	"unicode"
 
+	"github.com/rokath/trice/internal/clock"
 	"github.com/rokath/trice/internal/com"
+	"github.com/rokath/trice/internal/decoder"
 	"github.com/rokath/trice/internal/link"
 	"github.com/rokath/trice/pkg/msg"
 	"github.com/spf13/afero"
@@ -73,6 +75,9 @@ var (
 	// DefaultTCP4Args replaces "default" args value for TCP4 port.
 	DefaultTCP4Args = "localhost:17001" // OpenOCD starts a server on localhost:17001 where it dumps all RTT messages.
 
+	// DefaultTCP4ServerArgs replaces "default" args value for TCP4SERVER port. It is the listen address for the device connections.
+	DefaultTCP4ServerArgs = ":17005"
+
 	// DefaultFileArgs replaces "default" args value for FILE port.
 	DefaultFileArgs = "trices.raw"
 
@@ -217,8 +222,11 @@ func (p *file) Close() error {
 // When port is "COMn" args can be used to be "TARM" to use a different driver for dynamic testing.
 // When port is "DUMP", args is expected to be a space or comma separated hex print like "09 a1 fe"
 // When port is "BUFFER", args is expected to be a decimal byte sequence in the same format as for example coming from one of the other ports.
+// When port is "FLASHIMAGE", args is expected to be a flash image file name with a trice log written by the target code with TRICE_DEFERRED_FLASH == 1.
+// When port is "SHM", args is expected to be the shared memory name used by the target code with TRICE_SHM == 1 on the same Linux host.
 // When port is "JLINK" args contains JLinkRTTLogger.exe specific parameters described inside UM08001_JLink.pdf.
 // When port is "STLINK" args has the same format as for "JLINK"
+// When port is "JLINK" or "STLINK" and RTTChannels lists several channels, these are read in parallel and merged.
 func NewReadWriteCloser(w io.Writer, fSys *afero.Afero, verbose bool, port, args string) (r io.ReadWriteCloser, err error) {
 	if Verbose {
 		if args == "default" {
@@ -235,11 +243,28 @@ func NewReadWriteCloser(w io.Writer, fSys *afero.Afero, verbose bool, port, args
 		if Verbose {
 			fmt.Fprintln(w, "PortArguments=", args)
 		}
-		l := link.NewDevice(w, fSys, port, args)
-		if nil != l.Open() {
-			err = fmt.Errorf("can not open link device %s with args %s", port, args)
+		channels := strings.Split(RTTChannels, ",")
+		if len(channels) < 2 {
+			l := link.NewDevice(w, fSys, port, args)
+			if nil != l.Open() {
+				err = fmt.Errorf("can not open link device %s with args %s", port, args)
+			}
+			r = l
+			break
 		}
-		r = l
+		sources := make([]io.ReadWriteCloser, 0, len(channels))
+		for _, ch := range channels {
+			chArgs := rttChannelArgs(args, strings.TrimSpace(ch))
+			l := link.NewDevice(w, fSys, port, chArgs)
+			if nil != l.Open() {
+				for _, src := range sources { // The caller retries, so the already started loggers must not stay behind.
+					msg.OnErr(src.Close())
+				}
+				return nil, fmt.Errorf("can not open link device %s with args %s", port, chArgs)
+			}
+			sources = append(sources, l)
+		}
+		r = newMerger(sources, decoder.PackageFraming, true)
 	case "TCP4", "TCP4BUFFER": // TCP4BUFFER is undocumented, because it is used just for tests.
 		if args == "default" { // nothing assigned in args
 			args = DefaultTCP4Args
@@ -260,6 +285,22 @@ func NewReadWriteCloser(w io.Writer, fSys *afero.Afero, verbose bool, port, args
 			fmt.Fprintln(w, "PortArguments=", args)
 		}
 		r = newFileReader(fSys, args)
+	case "FLASHIMAGE":
+		if args == "default" { // nothing assigned in args
+			args = DefaultFlashImageArgs
+		}
+		if Verbose {
+			fmt.Fprintln(w, "PortArguments=", args)
+		}
+		r, err = newFlashImageReader(fSys, args)
+	case "SHM":
+		if args == "default" { // nothing assigned in args
+			args = DefaultSHMArgs
+		}
+		if Verbose {
+			fmt.Fprintln(w, "PortArguments=", args)
+		}
+		r = newSHMReader(w, args)
 	case "DUMP", "HEX":
 		if args == "default" { // nothing assigned in args
 			args = DefaultDumpArgs
@@ -303,6 +344,11 @@ func NewReadWriteCloser(w io.Writer, fSys *afero.Afero, verbose bool, port, args
 		}
 		r = c
 	}
+	if err == nil && (ArrivalStamp != "off" && ArrivalStamp != "none" || clock.Active()) {
+		if _, ok := r.(decoder.ArrivalReader); !ok {
+			r = newArrivalStamper(r)
+		}
+	}
 	return
 }
 
@@ -363,6 +409,9 @@ func (p *binaryLogger) Read(buf []byte) (count int, err error) {
 // Close is needed to satisfy the ReadCloser interface.
 func (p *binaryLogger) Close() error { return nil }
 
+// Arrival forwards the arrival time of the inner reader.
+func (p *binaryLogger) Arrival() time.Time { return arrival(p.r) }
+
 func (p *binaryLogger) Write(buf []byte) (count int, err error) { return 0, nil }
 
 //                                                                                               //
@@ -404,6 +453,9 @@ func (p *bytesViewer) Read(buf []byte) (count int, err error) {
 // Close is needed to satisfy the ReadCloser interface.
 func (p *bytesViewer) Close() error { return nil }
 
+// Arrival forwards the arrival time of the inner reader.
+func (p *bytesViewer) Arrival() time.Time { return arrival(p.r) }
+
 // Close is needed to satisfy the ReadCloser interface.
 func (p *bytesViewer) Write(_ []byte) (int, error) { return 0, nil }
 
@@ -0,0 +1,137 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package receiver
+
+// Reading of the POSIX shared memory ring, written by target code running on Linux with TRICE_SHM == 1 (see src/triceShm.c).
+
+import (
+	"fmt"
+	"io"
+	"sync/atomic"
+	"time"
+	"unsafe"
+
+	"github.com/rokath/trice/internal/metrics"
+)
+
+// DefaultSHMArgs replaces "default" args value for SHM port. It is the shared memory name used with TriceShmOpen.
+var DefaultSHMArgs = "/trice"
+
+const (
+	shmMagic       = 0x54525348 // shmMagic is TRICE_SHM_MAGIC.
+	shmSizeOffset  = 4          // shmSizeOffset is the offset of triceShmHeader_t size.
+	shmDropOffset  = 8          // shmDropOffset is the offset of triceShmHeader_t drop.
+	shmWriteOffset = 64         // shmWriteOffset is the offset of triceShmHeader_t writeIndex.
+	shmReadOffset  = 128        // shmReadOffset is the offset of triceShmHeader_t readIndex.
+	shmHeaderSize  = 192        // shmHeaderSize is the byte count of triceShmHeader_t.
+
+	shmPollMin = 50 * time.Microsecond // shmPollMin is the first wait time on an empty ring.
+	shmPollMax = 10 * time.Millisecond // shmPollMax is the longest wait time, before Read returns without data.
+)
+
+// shm is a shared memory ring reader.
+type shm struct {
+	w    io.Writer // os.Stdout
+	name string    // name is the shared memory name.
+	mem  []byte    // mem is the mapped shared memory or nil, when not attached.
+	data []byte    // data is the ring data part of mem.
+	drop uint32    // drop is the last seen drop count of the writer.
+}
+
+// newSHMReader returns a reader for the shared memory ring name.
+// The ring is attached on the first Read, when the writer has initialized it, so the order of starting writer and reader does not matter.
+func newSHMReader(w io.Writer, name string) *shm {
+	return &shm{w: w, name: name}
+}
+
+// word returns the header word at offset.
+func (p *shm) word(offset int) *uint32 {
+	return (*uint32)(unsafe.Pointer(&p.mem[offset]))
+}
+
+// attach maps the shared memory and reports, if it contains an initialized ring.
+func (p *shm) attach() bool {
+	mem, err := shmMap(p.name)
+	if err != nil {
+		return false
+	}
+	p.mem = mem
+	size := int(atomic.LoadUint32(p.word(shmSizeOffset)))
+	if atomic.LoadUint32(p.word(0)) != shmMagic || size < 1024 || size&(size-1) != 0 || len(mem) < shmHeaderSize+size {
+		p.detach()
+		return false
+	}
+	p.data = mem[shmHeaderSize : shmHeaderSize+size]
+	p.drop = atomic.LoadUint32(p.word(shmDropOffset))
+	if Verbose {
+		fmt.Fprintln(p.w, "Attached to shared memory ring", p.name, "with", size, "bytes.")
+	}
+	return true
+}
+
+// detach unmaps the shared memory.
+func (p *shm) detach() {
+	shmUnmap(p.mem)
+	p.mem, p.data = nil, nil
+}
+
+// read copies the available ring data into b. It does not block.
+func (p *shm) read(b []byte) int {
+	if p.mem == nil && !p.attach() {
+		return 0
+	}
+	if atomic.LoadUint32(p.word(0)) != shmMagic || atomic.LoadUint32(p.word(shmSizeOffset)) != uint32(len(p.data)) {
+		p.detach() // the writer re-initialized the ring
+		return 0
+	}
+	if d := atomic.LoadUint32(p.word(shmDropOffset)); d != p.drop {
+		metrics.Lost(int(d - p.drop))
+		p.drop = d
+	}
+	wr := atomic.LoadUint32(p.word(shmWriteOffset))
+	rd := atomic.LoadUint32(p.word(shmReadOffset))
+	count := wr - rd
+	if count > uint32(len(p.data)) { // not plausible, continue with the next package
+		atomic.StoreUint32(p.word(shmReadOffset), wr)
+		return 0
+	}
+	n := int(count)
+	if n > len(b) {
+		n = len(b)
+	}
+	at := int(rd) & (len(p.data) - 1)
+	k := copy(b[:n], p.data[at:])
+	copy(b[k:n], p.data)
+	atomic.StoreUint32(p.word(shmReadOffset), rd+uint32(n))
+	return n
+}
+
+// Read is part of the exported interface io.ReadCloser. It reads a slice of bytes.
+// On an empty ring it waits with increasing sleep times up to about 2*shmPollMax and returns then 0 without error.
+func (p *shm) Read(b []byte) (int, error) {
+	for wait := shmPollMin; ; wait *= 2 {
+		if n := p.read(b); n > 0 {
+			return n, nil
+		}
+		if wait > shmPollMax {
+			return 0, nil
+		}
+		time.Sleep(wait)
+	}
+}
+
+func (p *shm) Write(b []byte) (int, error) {
+	return len(b), nil // discard, the ring has no back channel
+}
+
+// Close is part of the exported interface io.ReadCloser. It unmaps the shared memory.
+func (p *shm) Close() error {
+	if Verbose {
+		fmt.Fprintln(p.w, "Closing shared memory ring", p.name)
+	}
+	if p.mem != nil {
+		p.detach()
+	}
+	return nil
+}
@@ -0,0 +1,33 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package receiver
+
+import (
+	"fmt"
+	"os"
+	"strings"
+	"syscall"
+)
+
+// shmMap maps the POSIX shared memory name, which lives on Linux as file in /dev/shm.
+func shmMap(name string) ([]byte, error) {
+	f, err := os.OpenFile("/dev/shm/"+strings.TrimPrefix(name, "/"), os.O_RDWR, 0)
+	if err != nil {
+		return nil, err
+	}
+	defer f.Close()
+	fi, err := f.Stat()
+	if err != nil {
+		return nil, err
+	}
+	if fi.Size() < shmHeaderSize {
+		return nil, fmt.Errorf("%s: shared memory too small", name)
+	}
+	return syscall.Mmap(int(f.Fd()), 0, int(fi.Size()), syscall.PROT_READ|syscall.PROT_WRITE, syscall.MAP_SHARED)
+}
+
+// shmUnmap unmaps mem.
+func shmUnmap(mem []byte) {
+	_ = syscall.Munmap(mem)
+}
@@ -0,0 +1,16 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+//go:build !linux
+
+package receiver
+
+import "fmt"
+
+// shmMap is implemented only for Linux.
+func shmMap(name string) ([]byte, error) {
+	return nil, fmt.Errorf("%s: shared memory port is supported only on Linux", name)
+}
+
+// shmUnmap is implemented only for Linux.
+func shmUnmap(mem []byte) {}
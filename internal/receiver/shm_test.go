@@ -0,0 +1,101 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package receiver
+
+import (
+	"fmt"
+	"os"
+	"sync/atomic"
+	"testing"
+
+	"github.com/tj/assert"
+)
+
+// shmTestInit initializes the ring in mem with size data bytes like TriceShmOpen.
+func shmTestInit(p *shm, size int) {
+	atomic.StoreUint32(p.word(shmSizeOffset), uint32(size))
+	atomic.StoreUint32(p.word(0), shmMagic)
+}
+
+// shmTestWrite appends pkg like TriceNonBlockingDeferredWriteShm and reports, if it fitted.
+// The C writer itself is tested against this reader in test/dblB_de_tcobs_shm.
+func shmTestWrite(p *shm, size int, pkg []byte) bool {
+	wr := atomic.LoadUint32(p.word(shmWriteOffset))
+	rd := atomic.LoadUint32(p.word(shmReadOffset))
+	if len(pkg) > size-int(wr-rd) {
+		atomic.AddUint32(p.word(shmDropOffset), 1)
+		return false
+	}
+	for i, x := range pkg {
+		p.mem[shmHeaderSize+(int(wr)+i)&(size-1)] = x
+	}
+	atomic.StoreUint32(p.word(shmWriteOffset), wr+uint32(len(pkg)))
+	return true
+}
+
+func TestSHMRing(t *testing.T) {
+	const size = 1024
+	p := &shm{mem: make([]byte, shmHeaderSize+size)}
+	shmTestInit(p, size)
+	p.data = p.mem[shmHeaderSize:]
+	atomic.StoreUint32(p.word(shmWriteOffset), 0xffffffff-100) // index wrap
+	atomic.StoreUint32(p.word(shmReadOffset), 0xffffffff-100)
+
+	var exp, act []byte
+	b := make([]byte, 300)
+	for i := 0; i < 40; i++ { // several ring wraps
+		pkg := make([]byte, 1+i*7%97)
+		for k := range pkg {
+			pkg[k] = byte(i + k)
+		}
+		assert.True(t, shmTestWrite(p, size, pkg))
+		exp = append(exp, pkg...)
+		if i%3 == 2 {
+			for n := p.read(b); n > 0; n = p.read(b) {
+				act = append(act, b[:n]...)
+			}
+		}
+	}
+	for n := p.read(b); n > 0; n = p.read(b) {
+		act = append(act, b[:n]...)
+	}
+	assert.Equal(t, exp, act)
+
+	assert.True(t, shmTestWrite(p, size, make([]byte, size)))
+	assert.False(t, shmTestWrite(p, size, []byte{1}))
+	assert.Equal(t, size, p.read(make([]byte, 2*size)))
+	assert.Equal(t, uint32(1), p.drop)
+
+	atomic.StoreUint32(p.word(0), 0) // writer re-initializes
+	assert.Equal(t, 0, p.read(b))
+	assert.Nil(t, p.mem)
+}
+
+func TestSHMReader(t *testing.T) {
+	if _, err := os.Stat("/dev/shm"); err != nil {
+		t.Skip("no /dev/shm")
+	}
+	const size = 4096
+	name := fmt.Sprint("/triceTest", os.Getpid())
+	fn := "/dev/shm" + name
+	defer os.Remove(fn)
+	assert.Nil(t, os.WriteFile(fn, make([]byte, shmHeaderSize+size), 0600))
+
+	r := newSHMReader(os.Stdout, name)
+	b := make([]byte, 100)
+	n, err := r.Read(b) // not initialized yet
+	assert.Nil(t, err)
+	assert.Equal(t, 0, n)
+
+	mem, err := shmMap(name)
+	assert.Nil(t, err)
+	w := &shm{mem: mem}
+	defer w.detach()
+	shmTestInit(w, size)
+	assert.True(t, shmTestWrite(w, size, []byte{1, 2, 3, 0}))
+	n, err = r.Read(b)
+	assert.Nil(t, err)
+	assert.Equal(t, []byte{1, 2, 3, 0}, b[:n])
+	assert.Nil(t, r.Close())
+}
@@ -0,0 +1,214 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package translator
+
+// Fleet ingestion: The TCP4SERVER port accepts any number of device connections and decodes each on its own goroutine.
+
+import (
+	"errors"
+	"fmt"
+	"io"
+	"net"
+	"sort"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/rokath/trice/internal/clock"
+	"github.com/rokath/trice/internal/emitter"
+	"github.com/rokath/trice/internal/id"
+	"github.com/rokath/trice/internal/metrics"
+	"github.com/rokath/trice/internal/receiver"
+	"github.com/rokath/trice/internal/trexDecoder"
+	"github.com/rokath/trice/pkg/msg"
+)
+
+// ServerBufferSize is the package buffer size of each device connection. A connection needs about 6 times this memory.
+var ServerBufferSize = 8192
+
+// connection is an accepted device connection. It is the input reader of its decoder.
+type connection struct {
+	conn       net.Conn
+	peer       string        // peer is the remote address, used as line prefix source.
+	start      time.Time     // start is the accept time.
+	stamp      bool          // stamp is true, when the arrival times are needed.
+	arrival    time.Time     // arrival is the host reception time of the last read data.
+	closed     bool          // closed is set, when the connection read failed or ended.
+	bytes      atomic.Uint64 // bytes is the received byte count.
+	trices     atomic.Uint64 // trices is the decoded trice count.
+	lastBytes  uint64        // lastBytes is the byte count at the last periodic report.
+	lastTrices uint64        // lastTrices is the trice count at the last periodic report.
+}
+
+// Read reads from the connection and maps any error to io.EOF, because the decoder treats other read errors as fatal.
+func (c *connection) Read(b []byte) (int, error) {
+	n, err := c.conn.Read(b)
+	c.bytes.Add(uint64(n))
+	if c.stamp && n > 0 {
+		c.arrival = time.Now()
+	}
+	if err != nil {
+		c.closed = true
+		return n, io.EOF
+	}
+	return n, nil
+}
+
+// Arrival returns the host reception time of the last read data.
+func (c *connection) Arrival() time.Time {
+	return c.arrival
+}
+
+// rates returns the byte count bc and trice count tc as kB/s and trices/s over duration d.
+func rates(bc, tc uint64, d time.Duration) string {
+	s := d.Seconds()
+	if s <= 0 {
+		s = 1e-9
+	}
+	return fmt.Sprintf("%.1f kB/s, %.0f trices/s", float64(bc)/1000/s, float64(tc)/s)
+}
+
+// throughput returns the counts and the average rates of c since its start.
+func (c *connection) throughput(now time.Time) string {
+	d := now.Sub(c.start)
+	bc, tc := c.bytes.Load(), c.trices.Load()
+	return fmt.Sprintf("%d bytes, %d trices in %.1fs (%s)", bc, tc, d.Seconds(), rates(bc, tc, d))
+}
+
+// fleet holds the common values of all device connections.
+type fleet struct {
+	lw     *emitter.SharedLineWriter
+	lut    id.TriceIDLookUp
+	m      *sync.RWMutex
+	li     id.TriceIDLookUpLI
+	endian bool
+	mu     sync.Mutex               // mu protects conns.
+	conns  map[*connection]struct{} // conns are the open connections.
+}
+
+// Serve performs the trice log task for a fleet of devices.
+//
+// It listens on address and accepts any number of device connections. Each connection is decoded on its own goroutine
+// with an isolated TREX decoder, so the devices do not influence each other. The lines of all connections go into one
+// line writer for w and carry the peer address as "source:" prefix.
+// A closing connection reports its throughput. With metrics.Interval > 0 the open connections are reported periodically.
+// The target clock correlation and the profile are not done, because they assume a single target.
+// Serve returns on a listen or accept error or after the listener was closed.
+func Serve(w io.Writer, lut id.TriceIDLookUp, m *sync.RWMutex, li id.TriceIDLookUpLI, address string) error {
+	if strings.ToUpper(Encoding) != "TREX" {
+		return fmt.Errorf("encoding %s is not supported with TCP4SERVER, only TREX", Encoding)
+	}
+	ln, err := net.Listen("tcp", address)
+	if err != nil {
+		return err
+	}
+	if Verbose {
+		fmt.Fprintln(w, "accepting device connections on", ln.Addr())
+	}
+	go handleSIGTERM(w, ln)
+	return serve(w, ln, lut, m, li, targetEndian())
+}
+
+// serve accepts device connections from ln until an accept error.
+func serve(w io.Writer, ln net.Listener, lut id.TriceIDLookUp, m *sync.RWMutex, li id.TriceIDLookUpLI, endian bool) error {
+	if clock.Active() {
+		fmt.Fprintln(w, "wrn:-correlate is ignored, because one clock fit cannot serve several targets")
+		clock.Format = "off"
+	}
+	firstArrival = time.Now()
+	setTargetStamps()
+	f := &fleet{lw: emitter.NewSharedLineWriter(w), lut: lut, m: m, li: li, endian: endian, conns: make(map[*connection]struct{})}
+	if metrics.Interval > 0 {
+		go f.reportLoop(time.Duration(metrics.Interval) * time.Second)
+	}
+	for {
+		conn, err := ln.Accept()
+		if errors.Is(err, net.ErrClosed) { // CTRL-C shutdown
+			return nil
+		}
+		if err != nil {
+			return err
+		}
+		go f.handle(conn)
+	}
+}
+
+// handle decodes the trices of conn until it ends and reports its throughput then.
+func (f *fleet) handle(conn net.Conn) {
+	c := &connection{
+		conn:  conn,
+		peer:  conn.RemoteAddr().String(),
+		start: time.Now(),
+		stamp: receiver.ArrivalStamp != "off" && receiver.ArrivalStamp != "none",
+	}
+	f.mu.Lock()
+	f.conns[c] = struct{}{}
+	f.mu.Unlock()
+	defer func() {
+		f.mu.Lock()
+		delete(f.conns, c)
+		f.mu.Unlock()
+		msg.OnErr(conn.Close())
+	}()
+
+	dec := trexDecoder.NewIsolated(f.lw, f.lut, f.m, f.li, c, f.endian, ServerBufferSize)
+	sw := emitter.NewSource(f.lw, c.peer)
+	b := make([]byte, ServerBufferSize) // intermediate trice string buffer
+	for {
+		n, err := dec.Read(b) // blocks inside the connection read, when no complete package is there
+		if err != nil && err != io.EOF {
+			fmt.Fprintln(f.lw, c.peer, err)
+			break
+		}
+		if n == 0 {
+			if c.closed {
+				break
+			}
+			continue
+		}
+		c.trices.Add(1)
+		n = emitter.BanOrPickFilter(b[:n])
+		if n > 0 {
+			if len(sw.Line) == 0 { // log line start
+				writeLineHead(sw, f.li, triceInfo(dec))
+			}
+			_, err = sw.Write(b[:n])
+			msg.OnErr(err)
+		}
+	}
+	if len(sw.Line) > 0 {
+		_, _ = sw.Write([]byte(`\n`)) // display any started line
+	}
+	_, err := sw.Write([]byte("sig:connection closed after " + c.throughput(time.Now()) + `\n`))
+	msg.OnErr(err)
+}
+
+// reportLoop writes every d the connection count and with Verbose the rates of each open connection since the last report.
+func (f *fleet) reportLoop(d time.Duration) {
+	for range time.Tick(d) {
+		f.mu.Lock()
+		conns := make([]*connection, 0, len(f.conns))
+		for c := range f.conns {
+			conns = append(conns, c)
+		}
+		f.mu.Unlock()
+		sort.Slice(conns, func(i, j int) bool { return conns[i].peer < conns[j].peer })
+		var bc, tc uint64
+		var s strings.Builder
+		for _, c := range conns {
+			b, t := c.bytes.Load(), c.trices.Load()
+			db, dt := b-c.lastBytes, t-c.lastTrices
+			c.lastBytes, c.lastTrices = b, t
+			bc += db
+			tc += dt
+			if Verbose {
+				fmt.Fprintf(&s, "%s: %s\n", c.peer, rates(db, dt, d))
+			}
+		}
+		fmt.Fprintf(&s, "%d device connections: %s\n", len(conns), rates(bc, tc, d))
+		_, err := f.lw.Write([]byte(s.String()))
+		msg.OnErr(err)
+	}
+}
@@ -0,0 +1,82 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package translator
+
+import (
+	"bytes"
+	"net"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+
+	"github.com/rokath/trice/internal/decoder"
+	"github.com/rokath/trice/internal/emitter"
+	"github.com/rokath/trice/internal/id"
+	"github.com/tj/assert"
+)
+
+// syncBuffer is a bytes.Buffer usable from several goroutines.
+type syncBuffer struct {
+	mu sync.Mutex
+	b  bytes.Buffer
+}
+
+func (p *syncBuffer) Write(b []byte) (int, error) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	return p.b.Write(b)
+}
+
+func (p *syncBuffer) String() string {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	return p.b.String()
+}
+
+// TestServe checks, that the trices of several concurrent device connections are decoded separately and tagged with their peer.
+func TestServe(t *testing.T) {
+	decoder.PackageFraming = "TCOBSv1"
+	TriceEndianness = "littleEndian"
+	emitter.HostStamp = "off"
+	emitter.ColorPalette = "off"
+	emitter.Prefix = "source: "
+	ilu := make(id.TriceIDLookUp)
+	assert.Nil(t, ilu.FromJSON([]byte(`{"3713":{"Type":"TRICE16","Strg":"MSG: 💚 START select = %d\\n"}}`)))
+	trice := []byte{0x81, 0x8e, 0x09, 0x23, 0xc0, 0x02, 0xb8, 0x01, 0xa4, 0x00} // cycle 0xc0
+
+	ln, err := net.Listen("tcp", "127.0.0.1:0")
+	assert.Nil(t, err)
+	defer ln.Close()
+	var out syncBuffer
+	go func() { _ = serve(&out, ln, ilu, new(sync.RWMutex), nil, decoder.LittleEndian) }()
+
+	const devices, count = 8, 50
+	var peers []string
+	var wg sync.WaitGroup
+	for i := 0; i < devices; i++ {
+		conn, err := net.Dial("tcp", ln.Addr().String())
+		assert.Nil(t, err)
+		peers = append(peers, conn.LocalAddr().String())
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			for k := 0; k < count; k++ { // the same cycle each time is a target reset for a shared decoder state
+				_, err := conn.Write(trice)
+				assert.Nil(t, err)
+			}
+			assert.Nil(t, conn.Close())
+		}()
+	}
+	wg.Wait()
+	for start := time.Now(); strings.Count(out.String(), "connection closed") < devices && time.Since(start) < 5*time.Second; {
+		time.Sleep(10 * time.Millisecond)
+	}
+	s := out.String()
+	for _, peer := range peers {
+		assert.Equal(t, count, strings.Count(s, peer+": default: MSG: 💚 START select = 440\n"), peer)
+		assert.True(t, strings.Contains(s, peer+": sig:connection closed after 500 bytes, 50 trices"), peer)
+	}
+	assert.False(t, strings.Contains(s, "CYCLE"))
+}
@@ -12,11 +12,13 @@ import (
 	"time"
 
 	"github.com/rokath/trice/internal/charDecoder"
+	"github.com/rokath/trice/internal/clock"
 	"github.com/rokath/trice/internal/decoder"
 	"github.com/rokath/trice/internal/dumpDecoder"
 	"github.com/rokath/trice/internal/emitter"
 	"github.com/rokath/trice/internal/id"
 	"github.com/rokath/trice/internal/keybcmd"
+	"github.com/rokath/trice/internal/profile"
 	"github.com/rokath/trice/internal/receiver"
 	"github.com/rokath/trice/internal/trexDecoder"
 	"github.com/rokath/trice/pkg/msg"
@@ -44,16 +46,8 @@ func Translate(w io.Writer, sw *emitter.TriceLineComposer, lut id.TriceIDLookUp,
 	if Verbose {
 		fmt.Fprintln(w, "Encoding is", Encoding)
 	}
-	var endian bool
+	endian := targetEndian()
 	var dec decoder.Decoder
-	switch TriceEndianness {
-	case "littleEndian":
-		endian = decoder.LittleEndian
-	case "bigEndian":
-		endian = decoder.BigEndian
-	default:
-		log.Fatalf(fmt.Sprintln("unknown endianness ", TriceEndianness, "-accepting litteEndian or bigEndian."))
-	}
 	switch strings.ToUpper(Encoding) {
 	//case "TLE", "COBS":
 	//	dec = tleDecoder.New(w, lut, m, li, rwc, endian)
@@ -79,8 +73,21 @@ func Translate(w io.Writer, sw *emitter.TriceLineComposer, lut id.TriceIDLookUp,
 	return decodeAndComposeLoop(w, sw, dec, lut, li)
 }
 
+// targetEndian returns the decoder endianness according TriceEndianness.
+func targetEndian() (endian bool) {
+	switch TriceEndianness {
+	case "littleEndian":
+		endian = decoder.LittleEndian
+	case "bigEndian":
+		endian = decoder.BigEndian
+	default:
+		log.Fatalf(fmt.Sprintln("unknown endianness ", TriceEndianness, "-accepting litteEndian or bigEndian."))
+	}
+	return
+}
+
 // handleSIGTERM is called on CTRL-C shutdown.
-func handleSIGTERM(w io.Writer, rc io.ReadCloser) {
+func handleSIGTERM(w io.Writer, rc io.Closer) {
 	// prepare CTRL-C shutdown reaction
 	sigs := make(chan os.Signal, 1)
 	signal.Notify(sigs, syscall.SIGINT, syscall.SIGTERM)
@@ -92,6 +99,7 @@ func handleSIGTERM(w io.Writer, rc io.ReadCloser) {
 				fmt.Fprintln(w, "####################################", sig, "####################################")
 			}
 			emitter.PrintColorChannelEvents(w)
+			profile.Finish(w)
 			msg.FatalOnErr(rc.Close())
 			os.Exit(0) // end
 		case <-ticker.C:
@@ -106,39 +114,7 @@ func decodeAndComposeLoop(w io.Writer, sw *emitter.TriceLineComposer, dec decode
 	b := make([]byte, decoder.DefaultSize) // intermediate trice string buffer
 	bufferReadStartTime := time.Now()
 	sleepCounter := 0
-	if decoder.TargetStamp == "" || decoder.TargetStamp == "off" || decoder.TargetStamp == "none" {
-		if !decoder.ShowTargetStamp0Passed {
-			decoder.TargetStamp0 = ""
-		}
-		if !decoder.ShowTargetStamp16Passed {
-			decoder.TargetStamp16 = ""
-		}
-		if !decoder.ShowTargetStamp32Passed {
-			decoder.TargetStamp32 = ""
-		}
-	}
-	if decoder.TargetStamp == "ms" {
-		if !decoder.ShowTargetStamp0Passed {
-			decoder.TargetStamp0 = DefaultTargetStamp0
-		}
-		if !decoder.ShowTargetStamp16Passed {
-			decoder.TargetStamp16 = "ms"
-		}
-		if !decoder.ShowTargetStamp32Passed {
-			decoder.TargetStamp32 = "ms"
-		}
-	}
-	if decoder.TargetStamp == "us" || decoder.TargetStamp == "µs" {
-		if !decoder.ShowTargetStamp0Passed {
-			decoder.TargetStamp0 = DefaultTargetStamp0
-		}
-		if !decoder.ShowTargetStamp16Passed {
-			decoder.TargetStamp16 = "us"
-		}
-		if !decoder.ShowTargetStamp32Passed {
-			decoder.TargetStamp32 = "us"
-		}
-	}
+	setTargetStamps()
 	for {
 		n, err := dec.Read(b) // Code to measure, dec.Read can return n=0 in some cases and then wait.
 
@@ -152,7 +128,8 @@ func decodeAndComposeLoop(w io.Writer, sw *emitter.TriceLineComposer, dec decode
 				receiver.Port == "HEX" ||
 				receiver.Port == "DUMP" ||
 				receiver.Port == "DEC" ||
-				receiver.Port == "BUFFER") /*&& err == io.EOF*/ && time.Since(bufferReadStartTime) > 100*time.Millisecond { // do not wait if a predefined buffer
+				receiver.Port == "BUFFER" ||
+				receiver.Port == "FLASHIMAGE") /*&& err == io.EOF*/ && time.Since(bufferReadStartTime) > 100*time.Millisecond { // do not wait if a predefined buffer
 				if len(sw.Line) > 0 {
 					_, _ = sw.Write([]byte(`\n`)) // add newline as line end to display any started line
 				}
@@ -175,86 +152,12 @@ func decodeAndComposeLoop(w io.Writer, sw *emitter.TriceLineComposer, dec decode
 		start := time.Now()
 
 		// Filtering is done here to suppress the loc, timestamp and id display as well for the filtered items.
-		n = emitter.BanOrPickFilter(b[:n]) // todo: b can contain several trices - handle that!
+		// The decoder drops filtered trices already by ID. Here decoder messages and trices with a value dependent channel are filtered.
+		n = emitter.BanOrPickFilter(b[:n])
 
 		if n > 0 { // s.th. to write out
-			var logLineStart bool // logLineStart is a helper flag for log line start detection
-			if len(sw.Line) == 0 {
-				logLineStart = true
-			}
-
-			if logLineStart && id.LIFnJSON != "off" && id.LIFnJSON != "none" {
-				s := locationInformation(decoder.LastTriceID, li)
-				_, err := sw.Write([]byte(s))
-				msg.OnErr(err)
-			}
-
-			/////////////
-			// obsolete
-			//
-			// // If target location & enabled and line start, write target location.
-			// if logLineStart && decoder.TargetLocationExists && decoder.LocationInformationFormatString != "off" && decoder.LocationInformationFormatString != "none" {
-			// 	targetFileID := id.TriceID(decoder.TargetLocation >> 16)
-			// 	t := lut[targetFileID]
-			// 	targetFile := t.Strg
-			// 	s := fmt.Sprintf(decoder.LocationInformationFormatString, targetFile, 0xffff&decoder.TargetLocation)
-			// 	_, err := sw.Write([]byte(s))
-			// 	msg.OnErr(err)
-			// }
-
-			var s string
-			if logLineStart {
-				switch decoder.TargetTimestampSize {
-				case 4:
-					switch decoder.TargetStamp32 {
-					case "ms", "hh:mm:ss,ms":
-						ms := decoder.TargetTimestamp % 1000
-						sec := (decoder.TargetTimestamp - ms) / 1000 % 60
-						min := (decoder.TargetTimestamp - ms - 1000*sec) / 60000 % 60
-						hour := (decoder.TargetTimestamp - ms - 1000*sec - 60000*min) / 3600000
-						s = fmt.Sprintf("time:%2d:%02d:%02d,%03d", hour, min, sec, ms)
-					case "us", "µs", "ssss,ms_µs":
-						us := decoder.TargetTimestamp % 1000
-						ms := (decoder.TargetTimestamp - us) / 1000 % 1000
-						sd := (decoder.TargetTimestamp - 1000*ms) / 1000000
-						s = fmt.Sprintf("time:%4d,%03d_%03d", sd, ms, us)
-					case "":
-					default:
-						s = fmt.Sprintf(decoder.TargetStamp32, decoder.TargetTimestamp)
-					}
-
-				case 2:
-					switch decoder.TargetStamp16 {
-					case "ms", "s,ms":
-						ms := decoder.TargetTimestamp % 1000
-						sec := (decoder.TargetTimestamp - ms) / 1000
-						s = fmt.Sprintf("time:      %2d,%03d", sec, ms)
-					case "us", "µs", "ms_µs":
-						us := decoder.TargetTimestamp % 1000
-						ms := (decoder.TargetTimestamp - us) / 1000 % 1000
-						s = fmt.Sprintf("time:      %2d_%03d", ms, us)
-					case "":
-					default:
-						s = fmt.Sprintf(decoder.TargetStamp16, decoder.TargetTimestamp)
-					}
-
-				case 0:
-					if decoder.TargetStamp0 != "" {
-						s = fmt.Sprintf(decoder.TargetStamp0)
-					}
-				}
-				_, err := sw.Write([]byte(s))
-				msg.OnErr(err)
-				_, err = sw.Write([]byte("default: "))
-				msg.OnErr(err)
-			}
-			// write ID only if enabled and line start.
-			if logLineStart && decoder.ShowID != "" {
-				s := fmt.Sprintf(decoder.ShowID, decoder.LastTriceID)
-				_, err := sw.Write([]byte(s))
-				msg.OnErr(err)
-				_, err = sw.Write([]byte("default: ")) // add space as separator
-				msg.OnErr(err)
+			if len(sw.Line) == 0 { // log line start
+				writeLineHead(sw, li, triceInfo(dec))
 			}
 			_, err := sw.Write(b[:n])
 			msg.OnErr(err)
@@ -268,6 +171,165 @@ func decodeAndComposeLoop(w io.Writer, sw *emitter.TriceLineComposer, dec decode
 	}
 }
 
+// triceInfo returns the values of the last trice decoded by dec.
+func triceInfo(dec decoder.Decoder) decoder.TriceInfo {
+	if i, ok := dec.(decoder.Informer); ok {
+		return i.Info()
+	}
+	return decoder.TriceInfo{ID: decoder.LastTriceID, Arrival: decoder.HostArrival, StampSize: decoder.TargetTimestampSize, Stamp: decoder.TargetTimestamp}
+}
+
+// writeLineHead writes the enabled location, arrival, correlated, target stamp and ID columns of trice t at a log line start.
+func writeLineHead(sw *emitter.TriceLineComposer, li id.TriceIDLookUpLI, t decoder.TriceInfo) {
+	if id.LIFnJSON != "off" && id.LIFnJSON != "none" {
+		s := locationInformation(t.ID, li)
+		_, err := sw.Write([]byte(s))
+		msg.OnErr(err)
+	}
+
+	if receiver.ArrivalStamp != "off" && receiver.ArrivalStamp != "none" {
+		_, err := sw.Write([]byte(arrivalStamp(t.Arrival)))
+		msg.OnErr(err)
+		_, err = sw.Write([]byte("default: "))
+		msg.OnErr(err)
+	}
+
+	if clock.Active() {
+		_, err := sw.Write([]byte(correlatedStamp()))
+		msg.OnErr(err)
+		_, err = sw.Write([]byte("default: "))
+		msg.OnErr(err)
+	}
+
+	var s string
+	switch t.StampSize {
+	case 4:
+		switch decoder.TargetStamp32 {
+		case "ms", "hh:mm:ss,ms":
+			ms := t.Stamp % 1000
+			sec := (t.Stamp - ms) / 1000 % 60
+			min := (t.Stamp - ms - 1000*sec) / 60000 % 60
+			hour := (t.Stamp - ms - 1000*sec - 60000*min) / 3600000
+			s = fmt.Sprintf("time:%2d:%02d:%02d,%03d", hour, min, sec, ms)
+		case "us", "µs", "ssss,ms_µs":
+			us := t.Stamp % 1000
+			ms := (t.Stamp - us) / 1000 % 1000
+			sd := (t.Stamp - 1000*ms) / 1000000
+			s = fmt.Sprintf("time:%4d,%03d_%03d", sd, ms, us)
+		case "":
+		default:
+			s = fmt.Sprintf(decoder.TargetStamp32, t.Stamp)
+		}
+
+	case 2:
+		switch decoder.TargetStamp16 {
+		case "ms", "s,ms":
+			ms := t.Stamp % 1000
+			sec := (t.Stamp - ms) / 1000
+			s = fmt.Sprintf("time:      %2d,%03d", sec, ms)
+		case "us", "µs", "ms_µs":
+			us := t.Stamp % 1000
+			ms := (t.Stamp - us) / 1000 % 1000
+			s = fmt.Sprintf("time:      %2d_%03d", ms, us)
+		case "":
+		default:
+			s = fmt.Sprintf(decoder.TargetStamp16, t.Stamp)
+		}
+
+	case 0:
+		if decoder.TargetStamp0 != "" {
+			s = fmt.Sprintf(decoder.TargetStamp0)
+		}
+	}
+	_, err := sw.Write([]byte(s))
+	msg.OnErr(err)
+	_, err = sw.Write([]byte("default: "))
+	msg.OnErr(err)
+	// write ID only if enabled.
+	if decoder.ShowID != "" {
+		s := fmt.Sprintf(decoder.ShowID, t.ID)
+		_, err := sw.Write([]byte(s))
+		msg.OnErr(err)
+		_, err = sw.Write([]byte("default: ")) // add space as separator
+		msg.OnErr(err)
+	}
+}
+
+// setTargetStamps applies the -ts value to the not explicitly passed target stamp formats.
+func setTargetStamps() {
+	if decoder.TargetStamp == "" || decoder.TargetStamp == "off" || decoder.TargetStamp == "none" {
+		if !decoder.ShowTargetStamp0Passed {
+			decoder.TargetStamp0 = ""
+		}
+		if !decoder.ShowTargetStamp16Passed {
+			decoder.TargetStamp16 = ""
+		}
+		if !decoder.ShowTargetStamp32Passed {
+			decoder.TargetStamp32 = ""
+		}
+	}
+	if decoder.TargetStamp == "ms" {
+		if !decoder.ShowTargetStamp0Passed {
+			decoder.TargetStamp0 = DefaultTargetStamp0
+		}
+		if !decoder.ShowTargetStamp16Passed {
+			decoder.TargetStamp16 = "ms"
+		}
+		if !decoder.ShowTargetStamp32Passed {
+			decoder.TargetStamp32 = "ms"
+		}
+	}
+	if decoder.TargetStamp == "us" || decoder.TargetStamp == "µs" {
+		if !decoder.ShowTargetStamp0Passed {
+			decoder.TargetStamp0 = DefaultTargetStamp0
+		}
+		if !decoder.ShowTargetStamp16Passed {
+			decoder.TargetStamp16 = "us"
+		}
+		if !decoder.ShowTargetStamp32Passed {
+			decoder.TargetStamp32 = "us"
+		}
+	}
+}
+
+// firstArrival is the host arrival time of the first trice. It is the reference for the "us" arrival stamp.
+var firstArrival time.Time
+
+// arrivalStamp returns the host arrival time t formatted according receiver.ArrivalStamp.
+// "us" is the elapsed time since the first trice arrival in seconds with microseconds.
+// "LOCmicro" and "UTCmicro" are the wall clock times.
+// An unknown arrival time gives an empty column.
+func arrivalStamp(t time.Time) string {
+	if t.IsZero() {
+		return "time:               "
+	}
+	switch receiver.ArrivalStamp {
+	case "LOCmicro":
+		return t.Format("time:15:04:05.000000")
+	case "UTCmicro":
+		return t.UTC().Format("time:15:04:05.000000")
+	default:
+		if firstArrival.IsZero() {
+			firstArrival = t
+		}
+		us := t.Sub(firstArrival).Microseconds()
+		return fmt.Sprintf("time:%8d.%06d", us/1000000, us%1000000)
+	}
+}
+
+// correlatedStamp returns the reconstructed host time of the target stamp formatted according clock.Format.
+// A trice without target stamp gives an empty column.
+func correlatedStamp() string {
+	t, ok := clock.Time()
+	if !ok {
+		return "time:               "
+	}
+	if clock.Format == "UTCmicro" {
+		t = t.UTC()
+	}
+	return t.Format("time:15:04:05.000000")
+}
+
 // locationInformation returns optional location information for id.
 func locationInformation(tid id.TriceID, li id.TriceIDLookUpLI) string {
 	if li != nil && decoder.LocationInformationFormatString != "off" && decoder.LocationInformationFormatString != "none" {
@@ -0,0 +1,160 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package trexDecoder
+
+import (
+	"encoding/binary"
+	"errors"
+
+	"github.com/rokath/trice/internal/decoder"
+)
+
+// Compressed is true, when the target uses TRICE_DEFERRED_COMPRESS == 1.
+var Compressed bool
+
+const (
+	compressDictHit   = 0x80 // tyId is dict[hdr bits 6-4]
+	compressCycleNext = 0x08 // cycle is previous cycle + 1
+	compressVarint    = 0x04 // params are zigzag varints of the 32-bit words, rest bytes raw
+	compressCycleSame = 0x02 // cycle is previous cycle
+	compressReset     = 0x01 // state reset before this trice
+)
+
+var errCompressed = errors.New("inconsistent compressed trice data")
+
+// Decompressor reverses the target TriceCompress function in src/trice.c.
+//
+// It holds the same history as the target and must see all compressed trices in order.
+// After a lost package the caller invokes Desync and the trices are dropped until the next trice with reset flag.
+type Decompressor struct {
+	order   byteOrder  // transfer order
+	dict    [8][2]byte // recent tyId bytes
+	next    int        // next dictionary replace index
+	stamp16 uint16     // previous 16-bit stamp
+	stamp32 uint32     // previous 32-bit stamp
+	cycle   uint8      // previous cycle
+	synced  bool       // a reset flag was seen
+}
+
+// byteOrder is implemented by binary.LittleEndian and binary.BigEndian.
+type byteOrder interface {
+	binary.ByteOrder
+	binary.AppendByteOrder
+}
+
+// NewDecompressor returns a Decompressor for the transfer byte order given by endian.
+func NewDecompressor(endian bool) *Decompressor {
+	p := &Decompressor{order: binary.LittleEndian}
+	if endian == decoder.BigEndian {
+		p.order = binary.BigEndian
+	}
+	return p
+}
+
+// Desync marks the history as lost after a dropped package, so dictionary hits are discarded until the next reset flag.
+func (p *Decompressor) Desync() {
+	p.synced = false
+}
+
+// Expand appends the original trices of the compressed trices in src to dst and returns the extended buffer.
+// Trices before the first reset flag are dropped, because their history is unknown.
+func (p *Decompressor) Expand(dst, src []byte) ([]byte, error) {
+	for len(src) > 0 {
+		hdr := src[0]
+		src = src[1:]
+		if hdr&compressReset != 0 {
+			*p = Decompressor{order: p.order, synced: true}
+		}
+		start := len(dst)
+		if hdr&(compressCycleNext|compressCycleSame) == compressCycleNext|compressCycleSame {
+			return dst, errCompressed
+		}
+
+		var tyId [2]byte
+		if hdr&compressDictHit != 0 {
+			if !p.synced { // The dictionary is unknown and so the remaining package is not parsable.
+				return dst, nil
+			}
+			tyId = p.dict[(hdr>>4)&7]
+		} else {
+			if len(src) < 2 {
+				return dst[:start], errCompressed
+			}
+			copy(tyId[:], src)
+			src = src[2:]
+			p.dict[p.next] = tyId
+			p.next = (p.next + 1) & 7
+		}
+		dst = append(dst, tyId[:]...)
+
+		var u uint64
+		var n int
+		switch p.order.Uint16(tyId[:]) >> 14 {
+		case typeS2:
+			if u, n = binary.Uvarint(src); n <= 0 {
+				return dst[:start], errCompressed
+			}
+			src = src[n:]
+			p.stamp16 += uint16(unzigzag(u))
+			dst = p.order.AppendUint16(dst, p.stamp16)
+		case typeS4:
+			if u, n = binary.Uvarint(src); n <= 0 {
+				return dst[:start], errCompressed
+			}
+			src = src[n:]
+			p.stamp32 += uint32(unzigzag(u))
+			dst = p.order.AppendUint32(dst, p.stamp32)
+		case typeX0:
+			return dst[:start], errCompressed
+		}
+
+		if u, n = binary.Uvarint(src); n <= 0 {
+			return dst[:start], errCompressed
+		}
+		src = src[n:]
+		count := int(u >> 1)
+		if u&1 != 0 { // long count
+			dst = p.order.AppendUint16(dst, uint16(0x8000|count))
+		} else {
+			switch {
+			case hdr&compressCycleNext != 0:
+				p.cycle++
+			case hdr&compressCycleSame != 0:
+			default:
+				if len(src) < 1 {
+					return dst[:start], errCompressed
+				}
+				p.cycle = src[0]
+				src = src[1:]
+			}
+			dst = p.order.AppendUint16(dst, uint16(count<<8)|uint16(p.cycle))
+		}
+
+		if hdr&compressVarint != 0 {
+			for i := 0; i < count>>2; i++ {
+				if u, n = binary.Uvarint(src); n <= 0 {
+					return dst[:start], errCompressed
+				}
+				src = src[n:]
+				dst = p.order.AppendUint32(dst, uint32(unzigzag(u)))
+			}
+			count &= 3
+		}
+		if len(src) < count {
+			return dst[:start], errCompressed
+		}
+		dst = append(dst, src[:count]...)
+		src = src[count:]
+
+		if !p.synced {
+			dst = dst[:start]
+		}
+	}
+	return dst, nil
+}
+
+// unzigzag reverses the target triceZigzag function.
+func unzigzag(u uint64) int64 {
+	return int64(u>>1) ^ -int64(u&1)
+}
@@ -0,0 +1,36 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package trexDecoder
+
+import (
+	"testing"
+
+	"github.com/rokath/trice/internal/decoder"
+	"github.com/tj/assert"
+)
+
+func TestExpand(t *testing.T) {
+	dc := NewDecompressor(decoder.LittleEndian)
+	compressed := []byte{
+		0x05, 0x64, 0xc0, 0xd0, 0x0f, 0x08, 0xc0, 0x0a, // reset, varint params, tyId, stamp +1000, count 4, cycle c0, param 5
+		0x88, 0x14, 0x08, 0x01, 0x02, 0x03, 0x04, // dict[0], next cycle, stamp +10, count 4, raw params
+		0x02, 0x05, 0x40, 0x00, // same cycle, S0 tyId, count 0
+	}
+	exp := []byte{
+		0x64, 0xc0, 0xe8, 0x03, 0x00, 0x00, 0xc0, 0x04, 0x05, 0x00, 0x00, 0x00,
+		0x64, 0xc0, 0xf2, 0x03, 0x00, 0x00, 0xc1, 0x04, 0x01, 0x02, 0x03, 0x04,
+		0x05, 0x40, 0xc1, 0x00,
+	}
+	act, err := dc.Expand(nil, compressed)
+	assert.Nil(t, err)
+	assert.Equal(t, exp, act)
+
+	// Without reset flag the history is unknown and the trice is dropped.
+	act, err = NewDecompressor(decoder.LittleEndian).Expand(nil, compressed[8:15])
+	assert.Nil(t, err)
+	assert.Equal(t, 0, len(act))
+
+	_, err = dc.Expand(nil, compressed[:5])
+	assert.Error(t, err)
+}
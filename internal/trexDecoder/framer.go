@@ -0,0 +1,92 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package trexDecoder
+
+import (
+	"bytes"
+	"io"
+
+	"github.com/rokath/trice/internal/decoder"
+)
+
+// framerSize is the receive buffer size. It limits the framed package size.
+const framerSize = 4 * decoder.DefaultSize
+
+// framer splits a raw byte stream into 0-delimited packages inside a fixed buffer.
+//
+// The packages are returned as slices into the buffer without copying. They stay valid until the next fill call.
+// Only when the buffer end is reached, the unprocessed bytes are moved to the buffer start.
+type framer struct {
+	buf     []byte // fixed receive buffer
+	r       int    // first unprocessed byte
+	w       int    // first free byte
+	scan    int    // first byte not searched for a delimiter yet, r <= scan <= w
+	dropped int    // count of packages dropped, because they did not fit into buf
+}
+
+// newFramer returns a framer with a fixed buffer of size bytes.
+func newFramer(size int) *framer {
+	return &framer{buf: make([]byte, size)}
+}
+
+// next returns the next complete package without its 0-delimiter.
+// raw is the same package with the delimiter. ok is false, when no complete package is inside the buffer.
+func (f *framer) next() (frame, raw []byte, ok bool) {
+	i := bytes.IndexByte(f.buf[f.scan:f.w], 0)
+	if i < 0 {
+		f.scan = f.w // do not search these bytes again
+		return nil, nil, false
+	}
+	end := f.scan + i
+	frame = f.buf[f.r:end:end]
+	raw = f.buf[f.r : end+1 : end+1]
+	f.r = end + 1
+	f.scan = f.r
+	return frame, raw, true
+}
+
+// fill reads from in into the free buffer space and returns the read byte count.
+func (f *framer) fill(in io.Reader) (int, error) {
+	if f.r == f.w { // all processed
+		f.r, f.w, f.scan = 0, 0, 0
+	}
+	if f.w == len(f.buf) { // buffer end reached
+		if f.r == 0 { // an incomplete package fills the whole buffer: drop it
+			f.dropped++
+			f.w, f.scan = 0, 0
+		} else {
+			n := copy(f.buf, f.buf[f.r:f.w])
+			f.scan -= f.r
+			f.r, f.w = 0, n
+		}
+	}
+	m, err := in.Read(f.buf[f.w:])
+	f.w += m
+	return m, err
+}
+
+var (
+	newline        = []byte{'\n'}
+	carriageReturn = []byte{'\r'}
+)
+
+// skipTextLines writes the first 3 lines of a not decodable frame into w and returns the frame rest behind them.
+// This helps, when the target mixes some text lines into the trice stream. ok is false, when frame has less than 2 newlines.
+// Nothing is allocated here, so a garbage flood does not slow down the decoding.
+func skipTextLines(w io.Writer, frame []byte) (rest []byte, ok bool) {
+	if bytes.Count(frame, newline) < 2 {
+		return frame, false
+	}
+	for i := 0; i < 3 && len(frame) > 0; i++ {
+		line := frame
+		if k := bytes.IndexByte(frame, '\n'); k >= 0 {
+			line, frame = frame[:k], frame[k+1:]
+		} else {
+			frame = frame[len(frame):]
+		}
+		w.Write(bytes.TrimSuffix(line, carriageReturn))
+		w.Write(newline)
+	}
+	return frame, true
+}
@@ -0,0 +1,112 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package trexDecoder
+
+import (
+	"bytes"
+	"io"
+	"testing"
+	"testing/iotest"
+
+	"github.com/rokath/tcobs/v1"
+	"github.com/tj/assert"
+)
+
+// recorded are TCOBSv1 packages taken from TestTREX.
+var recorded = [][]byte{
+	{0x81, 0x8e, 0x09, 0x23, 0xc0, 0x02, 0xb8, 0x01, 0xa4, 0x00},
+	{0xa7, 0x83, 0x1b, 0x23, 0xc1, 0x10, 0x5c, 0x63, 0x80, 0x61, 0x50, 0x05, 0x62, 0x08, 0x41, 0x00},
+}
+
+func TestFramer(t *testing.T) {
+	f := newFramer(20)
+	in := iotest.OneByteReader(bytes.NewReader(bytes.Join([][]byte{recorded[0], recorded[1], recorded[0]}, nil)))
+	var frames [][]byte
+	for {
+		frame, raw, ok := f.next()
+		if ok {
+			assert.Equal(t, len(frame)+1, len(raw))
+			frames = append(frames, append([]byte(nil), frame...))
+			continue
+		}
+		if _, err := f.fill(in); err == io.EOF {
+			break
+		}
+	}
+	assert.Equal(t, [][]byte{recorded[0][:9], recorded[1][:15], recorded[0][:9]}, frames)
+
+	// A package bigger than the buffer gets dropped.
+	f = newFramer(8)
+	in = bytes.NewReader(bytes.Join([][]byte{recorded[1], recorded[0][4:]}, nil))
+	frames = frames[:0]
+	for {
+		frame, _, ok := f.next()
+		if ok {
+			frames = append(frames, append([]byte(nil), frame...))
+			continue
+		}
+		if _, err := f.fill(in); err == io.EOF {
+			break
+		}
+	}
+	assert.Equal(t, 1, f.dropped)
+	assert.Equal(t, recorded[1][8:15], frames[0]) // The rest of the dropped package is not decodable later.
+	assert.Equal(t, recorded[0][4:9], frames[1])
+}
+
+func TestSkipTextLines(t *testing.T) {
+	var out bytes.Buffer
+	rest, ok := skipTextLines(&out, []byte("line1\r\nline2\nline3\n\x81\x8e"))
+	assert.True(t, ok)
+	assert.Equal(t, "line1\nline2\nline3\n", out.String())
+	assert.Equal(t, []byte{0x81, 0x8e}, rest)
+
+	_, ok = skipTextLines(&out, []byte("line1\n\x81"))
+	assert.False(t, ok)
+
+	garbage := []byte("a\nb\nc\nd")
+	allocs := testing.AllocsPerRun(100, func() {
+		skipTextLines(io.Discard, garbage)
+	})
+	assert.Equal(t, 0.0, allocs)
+}
+
+// BenchmarkFramer measures the framing throughput on recorded packages.
+func BenchmarkFramer(b *testing.B) {
+	benchmarkFramer(b, nil)
+}
+
+// BenchmarkFramerTCOBS measures the framing and TCOBS decoding throughput on recorded packages.
+func BenchmarkFramerTCOBS(b *testing.B) {
+	dst := make([]byte, 1024)
+	benchmarkFramer(b, func(frame []byte) { tcobs.Decode(dst, frame) })
+}
+
+func benchmarkFramer(b *testing.B, decode func(frame []byte)) {
+	var data []byte
+	for len(data) < 1<<20 {
+		data = append(data, recorded[0]...)
+		data = append(data, recorded[1]...)
+	}
+	in := bytes.NewReader(data)
+	f := newFramer(framerSize)
+	b.SetBytes(int64(len(data)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		in.Reset(data)
+		for {
+			frame, _, ok := f.next()
+			if ok {
+				if decode != nil {
+					decode(frame)
+				}
+				continue
+			}
+			if _, err := f.fill(in); err == io.EOF {
+				break
+			}
+		}
+	}
+}
@@ -0,0 +1,192 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package trexDecoder
+
+// Resynchronisation after line noise, a mid-stream attach or not decodable packages.
+
+import (
+	"fmt"
+	"time"
+
+	"github.com/rokath/trice/internal/decoder"
+	"github.com/rokath/trice/internal/id"
+)
+
+// ResyncInterval is the minimum time between 2 resync summary lines of a decoder.
+// The first skipped data are reported at once, all later ones are collected until the interval is over.
+var ResyncInterval = time.Second
+
+// ResyncMaxParamSpace is the max value byte count accepted for a runtime sized trice like triceS, as long as the decoder is not in sync.
+// A noise candidate with a big count would otherwise swallow the following valid trices.
+var ResyncMaxParamSpace = 1024
+
+const (
+	candidateInvalid    = iota // candidateInvalid means the data at this position are no trice.
+	candidateIncomplete        // candidateIncomplete means a possible trice, which needs more data for the decision.
+	candidateValid             // candidateValid means a trice with known ID and the expected length.
+)
+
+// resyncStats collects the skipped data for the rate limited summary line.
+type resyncStats struct {
+	bytes    int        // bytes is the count of skipped bytes without framing.
+	packages int        // packages is the count of dropped packages with framing.
+	unknown  int        // unknown is the count of dropped trices with an ID not inside the til.json.
+	lastID   id.TriceID // lastID is the last unknown ID.
+	reported time.Time  // reported is the time of the last summary line.
+	hinted   bool       // hinted is true after the decoder.Hints were shown once.
+}
+
+// pending returns true, if some skipped data are not reported yet.
+func (r *resyncStats) pending() bool {
+	return r.bytes|r.packages|r.unknown != 0
+}
+
+// summary writes the collected counts as one line into b and resets them, when ResyncInterval passed since the last line.
+func (r *resyncStats) summary(b []byte, now time.Time) (n int) {
+	if now.Sub(r.reported) < ResyncInterval {
+		return 0
+	}
+	s := fmt.Sprintf("wrn:resync: skipped %d bytes, %d packages", r.bytes, r.packages)
+	if r.unknown > 0 {
+		s += fmt.Sprintf(", %d with unknown ID (last %d)", r.unknown, r.lastID)
+	}
+	if !r.reported.IsZero() {
+		s += fmt.Sprintf(" in the last %.1fs", now.Sub(r.reported).Seconds())
+	}
+	n = copy(b, s+"\n")
+	if !r.hinted {
+		n += copy(b[n:], decoder.Hints+"\n")
+		r.hinted = true
+	}
+	*r = resyncStats{reported: now, hinted: r.hinted}
+	return
+}
+
+// paramSpaceCache is the once per trice ID resolved value byte count.
+type paramSpaceCache struct {
+	t     id.TriceFmt // t is the til.json entry the count was resolved for. A til.json refresh or version switch can change it.
+	n     int         // n is the value byte count.
+	fixed bool        // fixed is false for runtime sized trices.
+	valid bool        // valid is true after the first resolution.
+}
+
+// expectedParamSpace returns the value byte count of trice triceID. fixed is false for runtime sized trices.
+// known is false, when triceID is neither a reserved ID nor inside the til.json.
+func (p *trexDec) expectedParamSpace(triceID id.TriceID) (n int, fixed, known bool) {
+	switch {
+	case SyncID != 0 && triceID == id.TriceID(SyncID):
+		return 0, true, true
+	case PostMortemID != 0 && triceID == id.TriceID(PostMortemID), IdentityID != 0 && triceID == id.TriceID(IdentityID):
+		return 4, true, true
+	case DiagnosticsID != 0 && triceID == id.TriceID(DiagnosticsID):
+		return diagnosticsSize, true, true
+	}
+	p.LutMutex.RLock()
+	t, ok := p.Lut[triceID]
+	p.LutMutex.RUnlock()
+	if !ok {
+		return 0, false, false
+	}
+	if p.space == nil {
+		p.space = make([]paramSpaceCache, 0x4000) // 14-bit IDs
+	}
+	c := &p.space[triceID]
+	if !c.valid || c.t != t {
+		c.n, c.fixed = t.ParamSpace()
+		c.t, c.valid = t, true
+	}
+	return c.n, c.fixed, true
+}
+
+// check classifies the data at the start of b without package framing.
+//
+// A valid trice has a regular type, an ID known from the til.json or reserved, with Doubled16BitID the same ID twice
+// and the value byte count the til.json entry needs. size is the trice byte count then.
+// The padding is not part of size, because the deferred output without framing transmits the trices without it.
+// fixed is false for a runtime sized trice, where the count gives only a weak check.
+func (p *trexDec) check(b []byte) (size int, fixed bool, state int) {
+	if len(b) < tyIdSize {
+		return 0, false, candidateIncomplete
+	}
+	tyId := p.ReadU16(b)
+	head := tyIdSize
+	switch int(tyId >> decoder.IDBits) {
+	case typeS0:
+	case typeS2:
+		head += 2
+		if Doubled16BitID {
+			if len(b) < 2*tyIdSize {
+				return 0, false, candidateIncomplete
+			}
+			if p.ReadU16(b[tyIdSize:]) != tyId {
+				return 0, false, candidateInvalid
+			}
+			head += tyIdSize
+		}
+	case typeS4:
+		head += 4
+	default:
+		return 0, false, candidateInvalid
+	}
+	expected, fixed, known := p.expectedParamSpace(id.TriceID(0x3FFF & tyId))
+	if !known {
+		return 0, false, candidateInvalid
+	}
+	if len(b) < head+ncSize {
+		return 0, false, candidateIncomplete
+	}
+	nc := p.ReadU16(b[head:])
+	paramSpace := int(nc >> 8)
+	if nc>>15 == 1 {
+		paramSpace = int(0x7FFF & nc)
+	}
+	if fixed && paramSpace != expected || !fixed && p.lost && paramSpace > ResyncMaxParamSpace {
+		return 0, false, candidateInvalid
+	}
+	size = head + ncSize + paramSpace
+	if len(b) < size {
+		return 0, false, candidateIncomplete
+	}
+	return size, fixed, candidateValid
+}
+
+// syncNone moves p.B to the next valid trice without package framing and returns true then.
+//
+// Bytes not starting a valid trice are skipped and counted, zero bytes silently as padding or idle line.
+// After skipped data a runtime sized trice is taken only, when the following trice is valid too or not there yet.
+// syncNone returns false, when more data are needed for the decision.
+func (p *trexDec) syncNone() bool {
+	for len(p.B) >= tyIdSize {
+		size, fixed, state := p.check(p.B)
+		if state == candidateValid && !fixed && p.lost && !p.followed(size) {
+			state = candidateInvalid
+		}
+		switch state {
+		case candidateValid:
+			p.lost = false
+			return true
+		case candidateIncomplete:
+			return false
+		}
+		if p.B[0] != 0 {
+			p.lost = true
+			p.rs.bytes++
+		}
+		p.B = p.B[1:]
+	}
+	return false
+}
+
+// followed returns false, when the data behind the p.B trice with size bytes are there and start no valid trice, with and without padding.
+func (p *trexDec) followed(size int) bool {
+	for _, at := range [2]int{size, (size + 3) &^ 3} {
+		if len(p.B) < at+tyIdSize || p.B[at] == 0 && p.B[at+1] == 0 { // not there yet, padding or idle line
+			return true
+		}
+		if _, _, state := p.check(p.B[at:]); state != candidateInvalid {
+			return true
+		}
+	}
+	return false
+}
@@ -4,21 +4,25 @@
 package trexDecoder
 
 import (
-	"bytes"
 	"encoding/binary"
 	"encoding/hex"
 	"fmt"
 	"io"
 	"log"
 	"math"
+	"os"
 	"strings"
 	"sync"
+	"time"
 
 	cobs "github.com/rokath/cobs/go"
 	"github.com/rokath/tcobs/v1"
+	"github.com/rokath/trice/internal/clock"
 	"github.com/rokath/trice/internal/decoder"
 	"github.com/rokath/trice/internal/emitter"
 	"github.com/rokath/trice/internal/id"
+	"github.com/rokath/trice/internal/metrics"
+	"github.com/rokath/trice/internal/profile"
 	"github.com/rokath/trice/pkg/cipher"
 )
 
@@ -42,6 +46,24 @@ const (
 var Doubled16BitID bool
 var AddNewlineToEachTriceMessage bool
 
+// DiagnosticsID is the reserved ID of the target TriceLogDiagnostics record. It must match TRICE_DIAGNOSTICS_ID. 0 disables the special handling.
+var DiagnosticsID = 16369
+
+// diagnosticsSize is the TriceLogDiagnostics record payload size: 12 32-bit values.
+const diagnosticsSize = 12 * 4
+
+// SyncID is the reserved ID of the target clock sync trice. It must match TRICE_CLOCK_SYNC_ID. 0 disables the special handling.
+var SyncID = 16367
+
+// PostMortemID is the reserved ID of the target post mortem markers. It must match TRICE_POST_MORTEM_ID. 0 disables the special handling.
+var PostMortemID = 16368
+
+// IdentityID is the reserved ID of the target firmware identity trice. It must match TRICE_IDENTITY_ID. 0 disables the special handling.
+var IdentityID = 16366
+
+// TilCache provides the til.json versions selected by the firmware identity trices. With nil all streams use the -i til.json.
+var TilCache *id.LutCache
+
 /*
 var (
 	IDMask int
@@ -85,6 +107,28 @@ type trexDec struct {
 	pFmt           string // modified trice format string: %u -> %d
 	u              []int  // 1: modified format string positions:  %u -> %d, 2: float (%f)
 	packageFraming int
+	arrival        time.Time // arrival time of the actual package, used for metrics and decoder.HostArrival
+	dc             *Decompressor
+	expanded       []byte // expanded package, when Compressed
+	fr             *framer
+	cycleResync    bool          // cycleResync is true after a post mortem marker, because the following trices have the cycle counter of a different target boot.
+	filter         []triceFilter // filter holds the -ban and -pick decisions indexed by trice ID.
+	drop           bool          // drop is true, when read dropped a filtered trice.
+	info           decoder.TriceInfo
+	isolated       bool              // isolated is true, when the decoder does not publish its values into the decoder package variables.
+	initialCycle   *bool             // initialCycle is &decoder.InitialCycle or an own value for an isolated decoder.
+	raw            []byte            // raw is the input buffer without package framing. p.B is a slice of it.
+	lost           bool              // lost is true without package framing, when the last data did not start with a valid trice.
+	space          []paramSpaceCache // space holds the value byte counts indexed by trice ID for the resync checks.
+	rs             resyncStats       // rs collects the skipped data for the rate limited summary line.
+	newlineIndent  int               // newlineIndent is the resolved decoder.NewlineIndent. Concurrent decoders must not auto sense into the package variable.
+}
+
+// triceFilter is the once per trice ID resolved -ban and -pick decision.
+type triceFilter struct {
+	strg  string // strg is the format string the decision was made for. A til.json refresh can change it.
+	valid bool   // valid is true after the first decision.
+	show  bool   // show is false for a banned or not picked trice.
 }
 
 // New provides a TREX decoder instance.
@@ -92,21 +136,64 @@ type trexDec struct {
 // l is the trice id list in slice of struct format.
 // in is the usable reader for the input bytes.
 func New(w io.Writer, lut id.TriceIDLookUp, m *sync.RWMutex, li id.TriceIDLookUpLI, in io.Reader, endian bool) decoder.Decoder {
-	// Todo: rewrite using the TCOBS Reader. The provided in io.Reader provides a raw data stream.
-	// https://github.com/rokath/tcobs/blob/master/TCOBSv1/read.go -> use NewDecoder ...
+	return newDecoder(w, lut, m, li, in, endian, decoder.DefaultSize)
+}
+
+// NewIsolated provides a TREX decoder instance for one of several concurrently decoded streams.
+//
+// It keeps the cycle counter automatic and the last trice values only inside the instance (see Info)
+// and does not feed the target clock correlation and the profile, which assume a single target.
+// size is the package buffer size. The framer buffer is twice as big.
+func NewIsolated(w io.Writer, lut id.TriceIDLookUp, m *sync.RWMutex, li id.TriceIDLookUpLI, in io.Reader, endian bool, size int) decoder.Decoder {
+	p := newDecoder(w, lut, m, li, in, endian, size)
+	p.isolated = true
+	p.initialCycle = new(bool)
+	*p.initialCycle = true
+	return p
+}
+
+// newlineIndent returns decoder.NewlineIndent or, when it is -1, the auto sensed value.
+func newlineIndent() int {
+	if decoder.NewlineIndent != -1 {
+		return decoder.NewlineIndent
+	}
+	indent := 12 + 1 // todo: strings.SplitN & len(decoder.TargetStamp0) // 12
+	if !(id.LIFnJSON == "off" || id.LIFnJSON == "none") {
+		indent += 28 /* todo: length(decoder.LocationInformationFormatString), see https://stackoverflow.com/questions/32987215/find-numbers-in-string-using-golang-regexp*/
+		// todo: split channel info with format specifiers too, example: ["msg:%d\nsignal:%x %u\n", p0, p1, p2] -> ["msg:%d\n", p0] && ["signal:%x %u\n", p1, p2]
+	}
+	if decoder.ShowID != "" {
+		indent += 5 // todo: automatic
+	}
+	return indent
+}
+
+// newDecoder provides a TREX decoder instance with package buffers of size bytes.
+func newDecoder(w io.Writer, lut id.TriceIDLookUp, m *sync.RWMutex, li id.TriceIDLookUpLI, in io.Reader, endian bool, size int) *trexDec {
+	// The provided in io.Reader provides a raw data stream. The framer splits it into packages without copying.
 
 	p := &trexDec{}
 	p.cycle = 0xc0 // start value
+	p.initialCycle = &decoder.InitialCycle
 	p.W = w
 	p.In = in
-	p.IBuf = make([]byte, 0, decoder.DefaultSize)     // len 0
-	p.B = make([]byte, 0, decoder.DefaultSize)        // len 0
-	p.B0 = make([]byte, decoder.DefaultSize)          // len max
-	p.InnerBuffer = make([]byte, decoder.DefaultSize) // len max
+	framing := framerSize
+	if size != decoder.DefaultSize {
+		framing = 2 * size
+	}
+	p.fr = newFramer(framing)
+	p.B = make([]byte, 0, size)        // len 0
+	p.B0 = make([]byte, size)          // len max
+	p.InnerBuffer = make([]byte, size) // len max
 	p.Lut = lut
 	p.LutMutex = m
 	p.Endian = endian
 	p.Li = li
+	p.newlineIndent = newlineIndent()
+	if Compressed {
+		p.dc = NewDecompressor(endian)
+		p.expanded = make([]byte, 0, 4*size)
+	}
 
 	switch strings.ToLower(decoder.PackageFraming) {
 	case "cobs":
@@ -117,6 +204,8 @@ func New(w io.Writer, lut id.TriceIDLookUp, m *sync.RWMutex, li id.TriceIDLookUp
 		p.packageFraming = packageFramingTCOBSv2
 	case "none":
 		p.packageFraming = packageFramingNone
+		p.raw = make([]byte, 2*size)
+		p.B = p.raw[:0]
 	default:
 		log.Fatal("Invalid framing switch:\a", decoder.PackageFraming)
 	}
@@ -129,114 +218,116 @@ func New(w io.Writer, lut id.TriceIDLookUp, m *sync.RWMutex, li id.TriceIDLookUp
 // That means the incoming data stream is exhausted and a next try should be started a bit later.
 // Some arrived bytes are kept internally and concatenated with the following bytes in a next Read.
 // Afterwards 0 or at least 4 bytes are inside p.B
+// The leftovers are moved to the p.raw start, when the p.B capacity is exhausted, so the buffer does not grow.
 func (p *trexDec) nextData() {
+	if cap(p.B)-len(p.B) < len(p.InnerBuffer) && len(p.B) <= len(p.raw)-len(p.InnerBuffer) {
+		p.B = p.raw[:copy(p.raw, p.B)]
+	}
 	m, err := p.In.Read(p.InnerBuffer)      // use p.InnerBuffer as destination read buffer
 	p.B = append(p.B, p.InnerBuffer[:m]...) // merge with leftovers
 	if err != nil && err != io.EOF {        // some serious error
 		log.Fatal("ERROR:internal reader error\a", err) // exit
 	}
+	if m > 0 {
+		if metrics.Active {
+			metrics.Bytes(m)
+		}
+		p.setArrival()
+	}
 }
 
-// nextPackage reads with an inner reader a TCOBSv1 encoded byte stream.
+// Info returns the values of the last decoded trice.
+func (p *trexDec) Info() decoder.TriceInfo {
+	return p.info
+}
+
+// publish copies the values of the last decoded trice into the decoder package variables, when not isolated.
+func (p *trexDec) publish() {
+	if p.isolated {
+		return
+	}
+	decoder.LastTriceID = p.info.ID
+	decoder.HostArrival = p.info.Arrival
+	decoder.TargetTimestampSize = p.info.StampSize
+	decoder.TargetTimestamp = p.info.Stamp
+}
+
+// setArrival takes the package arrival time from the input reader, if it provides it.
+// Otherwise, the actual time is used, when metrics need it.
+func (p *trexDec) setArrival() {
+	if a, ok := p.In.(decoder.ArrivalReader); ok {
+		p.arrival = a.Arrival()
+	} else if metrics.Active {
+		p.arrival = time.Now()
+	}
+}
+
+// nextPackage reads with an inner reader a COBS or TCOBSv1 encoded byte stream.
 //
 // When no terminating 0 is found in the incoming bytes nextPackage returns without action.
 // That means the incoming data stream is exhausted and a next try should be started a bit later.
-// Some arrived bytes are kept internally and concatenated with the following bytes in a next Read.
-// When a terminating 0 is found in the incoming bytes ReadFromCOBS decodes the COBS package
-// and returns it in b and its len in n. If more data arrived after the first terminating 0,
-// these are kept internally and concatenated with the following bytes in a next Read.
+// Some arrived bytes are kept inside the framer buffer and completed with the following bytes in a next Read.
+// When a terminating 0 is found, the package gets decoded into p.B0 and p.B is the decoded package then.
+// If more data arrived after the first terminating 0, these stay in the framer buffer for the next call.
+// The framer returns the packages as slices into its fixed buffer, so nothing is copied or allocated here.
 func (p *trexDec) nextPackage() {
-	// Here p.IBuf contains none or available bytes, what can be several trice messages.
-	// So first try to process p.IBuf.
-	index := bytes.IndexByte(p.IBuf, 0) // find terminating 0
-	if index == -1 {                    // p.IBuf has no complete COBS data, so try to read more input
-		m, err := p.In.Read(p.InnerBuffer)            // use p.InnerBuffer as bytes read buffer
-		p.IBuf = append(p.IBuf, p.InnerBuffer[:m]...) // merge with leftovers
-		if err != nil && err != io.EOF {              // some serious error
+	frame, raw, ok := p.fr.next()
+	if !ok { // no complete package, so try to read more input
+		_, err := p.fr.fill(p.In)
+		if err != nil && err != io.EOF { // some serious error
 			log.Fatal("ERROR:internal reader error\a", err) // exit
 		}
-		index = bytes.IndexByte(p.IBuf, 0) // find terminating 0
-		if index == -1 {                   // p.IBuf has no complete COBS data, so leave
-			// Even err could be io.EOF, some valid data possibly in p.iBUf.
+		if frame, raw, ok = p.fr.next(); !ok {
+			// Even err could be io.EOF, some valid data possibly in the framer buffer.
 			// In case of file input (J-LINK usage) a plug off is not detectable here.
 			return // no terminating 0, nothing to do
 		}
 	}
 	if decoder.TestTableMode {
-		p.printTestTableLine(index + 1)
+		p.printTestTableLine(raw)
+	}
+	if metrics.Active {
+		metrics.Package(len(raw))
 	}
+	p.setArrival()
 	// here a complete COBS or TCOBS package exists
 	if decoder.DebugOut { // Debug output
 		fmt.Fprintf(p.W, "%s: ", decoder.PackageFraming)
-		decoder.Dump(p.W, p.IBuf[:index+1])
+		decoder.Dump(p.W, raw)
 	}
 
-	frame := p.IBuf[:index]
-
 	switch p.packageFraming {
 
 	case packageFramingCOBS:
-		p.B = p.B0                      // make([]byte, decoder.DefaultSize) // todo: avoid allocation
-		n, e := cobs.Decode(p.B, frame) // if index is 0, an empty buffer is decoded
-		p.IBuf = p.IBuf[index+1:]       // step forward (next package data in p.IBuf now, if any)
+		n, e := cobs.Decode(p.B0, frame) // if frame is empty, an empty buffer is decoded
 		if e != nil {
-			if decoder.Verbose {
-				fmt.Println("\ainconsistent COBS buffer!") // show also terminating 0
-			}
+			metrics.FramingError()
+			p.rs.packages++ // drop the package, it is counted for the resync summary
+			p.drop = true
+			p.desync()
+			n = 0
 		}
-		p.B = p.B[:n]
+		p.B = p.B0[:n]
 
 	case packageFramingTCOBS:
-	repeat:
-		p.B = p.B0                       // make([]byte, decoder.DefaultSize) // todo: avoid allocation
-		n, e := tcobs.Decode(p.B, frame) // if index is 0, an empty buffer is decoded
-		// from merging: p.IBuf = p.IBuf[index+1:]        // step forward (next package data in p.IBuf now, if any)
-		if e != nil {
-			fmt.Println("\ainconsistent TCOBSv1 buffer!")
-
-			// remove 3 lines if they exist
-			s := strings.SplitN(strings.ReplaceAll(string(frame), "\r\n", "\n"), "\n", 4)
-			var bytesCount int
-			if len(s) >= 3 {
-				var newLines int
-				fmt.Println(s[0])
-				fmt.Println(s[1])
-				fmt.Println(s[2])
-				for _, b := range frame {
-					frame = frame[1:]
-					bytesCount++
-					if b == 10 {
-						newLines++
-						if newLines == 3 {
-							break
-						}
-					}
-					continue
-				}
-				index -= bytesCount
-				goto repeat
+		for {
+			n, e := tcobs.Decode(p.B0, frame) // The decoding starts at the frame end and fills p.B0 from its end.
+			if e == nil {
+				p.B = p.B0[len(p.B0)-n:]
+				break
 			}
-			if decoder.Verbose {
-				fmt.Println(e, "\ainconsistent TCOBSv1 buffer:\n", hex.Dump(frame)) // show also terminating 0
+			metrics.FramingError()
+			if rest, ok := skipTextLines(os.Stdout, frame); ok { // The target mixed some text lines into the trice stream.
+				frame = rest
+				continue
 			}
-			e = nil
-			p.B = p.B[:0]
-			p.IBuf = p.IBuf[index+1:] // step forward (next package data in p.IBuf now, if any) // from merging:
-		} else {
-			p.B = p.B[len(p.B)-n:]    // buffer is filled from the end
-			p.IBuf = p.IBuf[index+1:] // step forward (next package data in p.IBuf now, if any) // from merging:
+			p.rs.packages++ // drop the package, it is counted for the resync summary
+			p.drop = true
+			p.desync()
+			p.B = p.B0[:0]
+			break
 		}
 
-	//  case packageFramingTCOBSv2:
-	//  	n := tcobs.CDecode(p.B, p.IBuf[:index]) // if index is 0, an empty buffer is decoded
-	//      p.IBuf = p.IBuf[index+1:] // step forward (next package data in p.IBuf now, if any)
-	//  	if n < 0 {
-	//  		fmt.Println("\ainconsistent TCOBSv2 buffer:\n", p.IBuf[:index+1]) // show also terminating 0
-	//  		p.B = p.B[:0]
-	//  	} else {
-	//  		p.B = p.B[len(p.B)-n:]
-	//  	}
-
 	default:
 		log.Fatalln("unexpected execution path", p.packageFraming)
 	}
@@ -247,12 +338,40 @@ func (p *trexDec) nextPackage() {
 	}
 
 	if cipher.Password != "" { // encrypted
-		cipher.Decrypt(p.B, p.B)
+		var err error
+		p.B, err = cipher.DecryptPackage(p.B)
+		if err != nil {
+			metrics.FramingError()
+			fmt.Fprintln(p.W, "wrn:", err)
+			p.desync()
+		}
 		if decoder.DebugOut { // Debug output
 			fmt.Fprint(p.W, "-> DEC:  ")
 			decoder.Dump(p.W, p.B)
 		}
 	}
+
+	if p.dc != nil && len(p.B) > 0 {
+		var err error
+		p.expanded, err = p.dc.Expand(p.expanded[:0], p.B)
+		if err != nil {
+			metrics.FramingError()
+			fmt.Fprintln(p.W, "wrn:", err)
+			p.dc.Desync()
+		}
+		p.B = p.expanded
+		if decoder.DebugOut { // Debug output
+			fmt.Fprint(p.W, "-> EXP:  ")
+			decoder.Dump(p.W, p.B)
+		}
+	}
+}
+
+// desync invalidates the decompressor history after a lost package, because its dictionary and deltas miss the package updates.
+func (p *trexDec) desync() {
+	if p.dc != nil {
+		p.dc.Desync()
+	}
 }
 
 func isZero(bytes []byte) bool {
@@ -302,17 +421,33 @@ func (p *trexDec) removeZeroHiByte(s []byte) (r []byte) {
 // but the start of a following trice package can be already inside the internal buffer.
 // In case of a not matching cycle, a warning message in trice format is prefixed.
 // In case of invalid package data, error messages in trice format are returned and the package is dropped.
+// Trices filtered out by -ban or -pick and dropped data are skipped before formatting and the next trice is read.
 func (p *trexDec) Read(b []byte) (n int, err error) {
+	for {
+		n, err = p.read(b)
+		if n > 0 || !p.drop {
+			return
+		}
+	}
+}
+
+// read decodes the next trice into b. It sets p.drop, when the trice was filtered out or data were skipped.
+// A buffer input ends on the first n == 0, so the dropped data must not stop the reading.
+func (p *trexDec) read(b []byte) (n int, err error) {
+	p.drop = false
 	if p.packageFraming == packageFramingNone {
-		p.nextData() // returns all unprocessed data inside p.B
-		p.B0 = p.B   // keep data for re-sync
+		p.nextData()       // returns all unprocessed data inside p.B
+		if !p.syncNone() { // moves p.B to the next valid trice
+			n = p.resyncSummary(b)
+			return // wait for more data
+		}
 	} else {
 		if cipher.Password != "" && len(p.B) < 8 && isZero(p.B) {
 			p.B = p.B[:0] // Discard trailing zeroes. ATTENTION: incomplete trice messages containing many zeroes could be problematic here!
 		}
 		if len(p.B) == 1 { // last decoded package exhausted
-			if decoder.Verbose {
-				fmt.Println("inconsistent data, discarding last single byte", p.B[0], "from", hex.Dump(p.B))
+			if p.B[0] != 0 { // inconsistent data, discarding last single byte
+				p.rs.bytes++
 			}
 			p.B = p.B[:0]
 		}
@@ -320,6 +455,7 @@ func (p *trexDec) Read(b []byte) (n int, err error) {
 			p.nextPackage() // returns one decoded package inside p.B
 		}
 	}
+	n = p.resyncSummary(b)
 	packageSize := len(p.B)
 	if packageSize < tyIdSize { // not enough data for a next package
 		return
@@ -330,13 +466,14 @@ func (p *trexDec) Read(b []byte) (n int, err error) {
 
 	triceType := int(tyId >> decoder.IDBits) // most significant bit are the triceType
 	triceID := id.TriceID(0x3FFF & tyId)     // 14 least significant bits are the ID
-	decoder.LastTriceID = triceID            // used for showID
+	p.info.ID = triceID                      // used for showID
+	p.info.Arrival = p.arrival               // used for the arrival column
 
 	switch triceType {
 	case typeS0: // no timestamp
-		decoder.TargetTimestampSize = 0
+		p.info.StampSize = 0
 	case typeS2: // 16-bit stamp
-		decoder.TargetTimestampSize = 2
+		p.info.StampSize = 2
 		if Doubled16BitID { // p.packageFraming == packageFramingNone || cipher.Password != "" {
 			if len(p.B) < 2 {
 				return // wait for more data
@@ -346,38 +483,44 @@ func (p *trexDec) Read(b []byte) (n int, err error) {
 			p.B = p.B[tyIdSize:] // When target encoding is done, it removes the double 16-bit ID at the 16-bit timestamp trices.
 		}
 	case typeS4: // 32-bit stamp
-		decoder.TargetTimestampSize = 4
+		p.info.StampSize = 4
 	case typeX0: // extended trice type X0
-		if p.packageFraming == packageFramingNone {
-			// typeX0 is not supported (yet)
-			if decoder.Verbose {
-				n += copy(b[n:], fmt.Sprintln("wrn:\aRemoving zero HI byte from", hex.Dump(p.B0), "to try to resync."))
-			}
-			p.B = p.removeZeroHiByte(p.B0)
+		// Without package framing syncNone does not accept typeX0, so p.packageFraming != packageFramingNone here.
+		// We can reach here in target TRICE_MULTI_PACK_MODE, when a trice message is followed by several zeroes (up to 7 possible with encryption).
+		hi := packed[0] // hi is the ID high byte, which removeZeroHiByte removes.
+		if p.Endian == decoder.LittleEndian {
+			hi = packed[1]
+		}
+		if hi != 0 { // No padding zero and no trice uses typeX0 yet, so this is a damaged package.
+			p.rs.packages++
+			p.drop = true
+			p.B = p.B[:0]
 			return
 		}
-		// p.packageFraming != packageFramingNone
-		// We can reach here in target TRICE_MULTI_PACK_MODE, when a trice message is followed by several zeroes (up to 7 possible with encryption).
 		p.B = p.removeZeroHiByte(packed)
+		return
 	}
 
-	if packageSize < tyIdSize+decoder.TargetTimestampSize+ncSize { // for non typeEX trices
+	p.publish()
+
+	if packageSize < tyIdSize+p.info.StampSize+ncSize { // for non typeEX trices
 		return // not enough data
 	}
 
 	// try to interpret
 	if triceType == typeS0 {
-		decoder.TargetTimestamp = 0
+		p.info.Stamp = 0
 	} else if triceType == typeS2 { // 16-bit stamp
-		decoder.TargetTimestamp = uint64(p.ReadU16(p.B))
+		p.info.Stamp = uint64(p.ReadU16(p.B))
 	} else if triceType == typeS4 { // 32-bit stamp
-		decoder.TargetTimestamp = uint64(p.ReadU32(p.B))
+		p.info.Stamp = uint64(p.ReadU32(p.B))
 		//} else if triceType == typeS8 { // 64-bit stamp
-		//	decoder.TargetTimestamp = uint64(p.ReadU64(p.B))
+		//	p.info.Stamp = uint64(p.ReadU64(p.B))
 	} else {
 		log.Fatal("triceType ", triceType, " not implemented (hint: IDBits value?)")
 	}
-	p.B = p.B[decoder.TargetTimestampSize:]
+	p.publish()
+	p.B = p.B[p.info.StampSize:]
 
 	if len(p.B) < 2 {
 		return // wait for more data
@@ -396,52 +539,75 @@ func (p *trexDec) Read(b []byte) (n int, err error) {
 		p.ParamSpace = int(nc >> 8) // high byte is 7 bit number of bytes for data count excluding timestamp
 	}
 
-	p.TriceSize = tyIdSize + decoder.TargetTimestampSize + ncSize + p.ParamSpace
-	if p.TriceSize > packageSize { //  '>' for multiple trices in one package (case TriceOutMultiPackMode), todo: discuss all possible variants
-		if p.packageFraming == packageFramingNone {
-			if decoder.Verbose {
-				n += copy(b[n:], fmt.Sprintln("wrn:\adiscarding first byte", p.B0[0], "from", hex.Dump(p.B0)))
-			}
-			p.B0 = p.B0[1:] // discard first byte and try again
-			p.B = p.B0
-			return
-		}
-		if decoder.Verbose {
-			n += copy(b[n:], fmt.Sprintln("ERROR:\apackage size", packageSize, "is <", p.TriceSize, " - ignoring package:"))
-			n += copy(b[n:], fmt.Sprintln(hex.Dump(p.B)))
-			n += copy(b[n:], fmt.Sprintln("tyIdSize=", tyIdSize, "tsSize=", decoder.TargetTimestampSize, "ncSize=", ncSize, "ParamSpae=", p.ParamSpace))
-			n += copy(b[n:], fmt.Sprintln(decoder.Hints))
-		}
+	p.TriceSize = tyIdSize + p.info.StampSize + ncSize + p.ParamSpace
+	if p.TriceSize > packageSize || len(p.B) < p.ParamSpace { //  '>' for multiple trices in one package (case TriceOutMultiPackMode), todo: discuss all possible variants
+		// Without package framing syncNone checked the size already, so this is a damaged package.
+		p.rs.packages++
+		p.drop = true
 		p.B = p.B[len(p.B):] // discard buffer
+		return
+	}
+
+	if PostMortemID != 0 && triceID == id.TriceID(PostMortemID) && p.ParamSpace == 4 && len(p.B) >= 4 {
+		n += p.sprintPostMortem(b[n:])
+		p.B = p.B[4:]
+		p.cycleResync = true
+		return
 	}
 
 	// cycle counter automatic & check
-	if cycle == 0xc0 && p.cycle != 0xc0 && decoder.InitialCycle { // with cycle counter and seems to be a target reset
+	if p.cycleResync {
+		p.cycle = cycle
+		p.cycleResync = false
+	}
+	if cycle == 0xc0 && p.cycle != 0xc0 && *p.initialCycle { // with cycle counter and seems to be a target reset
 		n += copy(b[n:], fmt.Sprintln("warning:\a   Target Reset?   "))
 		p.cycle = cycle + 1 // adjust cycle
-		decoder.InitialCycle = false
+		*p.initialCycle = false
 	}
-	if cycle == 0xc0 && p.cycle != 0xc0 && !decoder.InitialCycle { // with cycle counter and seems to be a target reset
+	if cycle == 0xc0 && p.cycle != 0xc0 && !*p.initialCycle { // with cycle counter and seems to be a target reset
 		//n += copy(b[n:], fmt.Sprintln("info:   Target Reset?   ")) // todo: This line is ok with cycle counter but not without cycle counter
 		p.cycle = cycle + 1 // adjust cycle
 	}
-	if cycle == 0xc0 && p.cycle == 0xc0 && decoder.InitialCycle { // with or without cycle counter and seems to be a target reset
+	if cycle == 0xc0 && p.cycle == 0xc0 && *p.initialCycle { // with or without cycle counter and seems to be a target reset
 		//n += copy(b[n:], fmt.Sprintln("warning:   Restart?   "))
 		p.cycle = cycle + 1 // adjust cycle
-		decoder.InitialCycle = false
+		*p.initialCycle = false
 	}
-	if cycle == 0xc0 && p.cycle == 0xc0 && !decoder.InitialCycle { // with or without cycle counter and seems to be a normal case
+	if cycle == 0xc0 && p.cycle == 0xc0 && !*p.initialCycle { // with or without cycle counter and seems to be a normal case
 		p.cycle = cycle + 1 // adjust cycle
 	}
 	if cycle != 0xc0 { // with cycle counter and s.th. lost
 		if cycle != p.cycle { // no cycle check for 0xc0 to avoid messages on every target reset and when no cycle counter is active
 			n += copy(b[n:], fmt.Sprint("CYCLE:\a", cycle, "!=", p.cycle, " # ", emitter.ColorChannelEvents("CYCLE")+1, " # "))
+			metrics.Lost(metrics.CycleGap(cycle, p.cycle))
 			p.cycle = cycle // adjust cycle
 		}
-		decoder.InitialCycle = false
+		*p.initialCycle = false
 		p.cycle++
 	}
 
+	sync := SyncID != 0 && triceID == id.TriceID(SyncID) && p.ParamSpace == 0
+	if clock.Active() && !p.isolated {
+		clock.Trice(p.info.StampSize, p.info.Stamp, p.arrival, sync)
+	}
+	if sync {
+		p.drop = true // A clock sync trice has no til.json entry and no output.
+		return
+	}
+
+	if IdentityID != 0 && triceID == id.TriceID(IdentityID) && p.ParamSpace == 4 && len(p.B) >= 4 {
+		n += p.sprintIdentity(b[n:])
+		p.B = p.B[4:]
+		return
+	}
+
+	if DiagnosticsID != 0 && triceID == id.TriceID(DiagnosticsID) && p.ParamSpace == diagnosticsSize && len(p.B) >= diagnosticsSize {
+		n += p.sprintDiagnostics(b[n:])
+		p.B = p.B[diagnosticsSize:] // the record size is a multiple of 4, so no padding in case of package framing none
+		return
+	}
+
 	var ok bool
 	p.LutMutex.RLock()
 	p.Trice, ok = p.Lut[triceID]
@@ -449,49 +615,121 @@ func (p *trexDec) Read(b []byte) (n int, err error) {
 		p.Trice.Strg += `\n` // this adds a newline to each single Trice message
 	}
 	p.LutMutex.RUnlock()
-	if !ok {
-		if p.packageFraming == packageFramingNone {
-			if decoder.Verbose {
-				n += copy(b[n:], fmt.Sprintln("wrn:\adiscarding first byte", p.B0[0], "from", hex.Dump(p.B0)))
-			}
-			p.B0 = p.B0[1:] // discard first byte and try again
-			p.B = p.B0
+	if !ok { // the ID is counted for the resync summary
+		metrics.UnknownID()
+		p.rs.unknown++
+		p.rs.lastID = triceID
+		p.drop = true
+		if p.packageFraming == packageFramingNone { // The til.json changed after syncNone.
+			p.rs.bytes++
+			p.lost = true
+			p.B = packed[1:] // discard first byte and try again
 		} else {
-			n += copy(b[n:], fmt.Sprintln("WARNING:\aunknown ID ", triceID, "- ignoring trice ending with", hex.Dump(p.B)))
-			n += copy(b[n:], fmt.Sprintln(decoder.Hints))
+			p.rs.packages++
 			p.B = p.B[:0] // discard all
 		}
 		return
 	}
 
-	n += p.sprintTrice(b[n:]) // use param info
-	if len(p.B) < p.ParamSpace {
-		if p.packageFraming == packageFramingNone {
-			if decoder.Verbose {
-				n += copy(b[n:], fmt.Sprintln("wrn:discarding first byte", p.B0[0], "from", hex.Dump(p.B0)))
-			}
-			p.B0 = p.B0[1:] // discard first byte and try again
-			p.B = p.B0
-		} else {
-			n += copy(b[n:], fmt.Sprintln("ERROR:ignoring data garbage", hex.Dump(p.B)))
-			n += copy(b[n:], fmt.Sprintln(decoder.Hints))
-			p.B = p.B[:0] // discard all
-		}
+	if p.dropped(triceID) {
+		p.drop = true // no formatting for filtered trices
 	} else {
-		if p.packageFraming != packageFramingNone { // COBS | TCOBS are exact
-			p.B = p.B[p.ParamSpace:] // drop param info
-		} else { // no package framing
-			padding := (p.ParamSpace + 3) & ^3
-			if padding <= len(p.B) {
-				p.B = p.B[padding:]
-			} else {
-				// n += copy(b[n:], fmt.Sprintln("wrn: cannot discard padding bytes", ))
-			}
+		n += p.sprintTrice(b[n:]) // use param info
+	}
+	if metrics.Active {
+		metrics.Trice(triceID, time.Since(p.arrival))
+	}
+	if profile.Enabled && !p.isolated {
+		profile.Trice(triceID, p.TriceSize)
+	}
+	if p.packageFraming != packageFramingNone { // COBS | TCOBS are exact
+		p.B = p.B[p.ParamSpace:] // drop param info
+	} else { // no package framing, syncNone checked the param info is there
+		p.B = p.B[p.ParamSpace:]
+		if padding := (p.ParamSpace+3)&^3 - p.ParamSpace; padding <= len(p.B) && isZero(p.B[:padding]) {
+			p.B = p.B[padding:] // The direct output pads with zeroes, the deferred output not.
 		}
 	}
 	return
 }
 
+// resyncSummary writes the resync summary line into b, when skipped data are pending and ResyncInterval passed.
+func (p *trexDec) resyncSummary(b []byte) int {
+	if !p.rs.pending() {
+		return 0
+	}
+	return p.rs.summary(b, time.Now())
+}
+
+// dropped returns true, if the trice with triceID and format string p.Trice.Strg is filtered out by -ban or -pick.
+//
+// The channel is resolved only once per ID from the format string. Trices with a channel depending
+// on their values are not dropped here, but filtered after formatting by emitter.BanOrPickFilter.
+func (p *trexDec) dropped(triceID id.TriceID) bool {
+	if !emitter.Filtering() {
+		return false
+	}
+	if p.filter == nil {
+		p.filter = make([]triceFilter, 0x4000) // 14-bit IDs
+	}
+	f := &p.filter[triceID]
+	if !f.valid || f.strg != p.Trice.Strg {
+		f.show, _ = emitter.ChannelFilter(p.Trice.Strg)
+		f.strg, f.valid = p.Trice.Strg, true
+	}
+	return !f.show
+}
+
+// sprintDiagnostics decodes a target TriceLogDiagnostics record from p.B into b and returns that len.
+//
+// The values are also handed to the metrics package. A value exceeding its capacity is reported as error.
+func (p *trexDec) sprintDiagnostics(b []byte) (n int) {
+	var v metrics.TargetDiagnostics
+	for i := range v {
+		v[i] = p.ReadU32(p.B[4*i:])
+	}
+	metrics.Target(v)
+	channel := "diag:"
+	if v[0] != 0 || v[1] != 0 || v[2] != 0 || v[3] != 0 || v[4] > v[5] || v[6] >= v[7] || v[8] > v[9] || v[10] > v[11] {
+		channel = "err:"
+	}
+	return copy(b, fmt.Sprintf("%sTriceErrorCount=%d, TriceDirectOverflowCount=%d, TriceDeferredOverflowCount=%d, TriceDynBufTruncateCount=%d, "+
+		"triceSingleDepthMax=%d of %d, TriceDataOffsetDepthMax=%d of %d, deferredDepthMax=%d of %d, RTT0_writeDepthMax=%d of %d\n",
+		channel, v[0], v[1], v[2], v[3], v[4], v[5], int32(v[6]), v[7], v[8], v[9], v[10], v[11]))
+}
+
+// sprintPostMortem decodes a target post mortem marker from p.B into b and returns that len.
+//
+// The target transmits the trices, which were not transmitted before a target reset, after the reset between 2 markers.
+// The begin marker carries the trice count, the end marker 0.
+func (p *trexDec) sprintPostMortem(b []byte) (n int) {
+	count := p.ReadU32(p.B)
+	if count == 0 {
+		return copy(b, "sig:previous boot end\n")
+	}
+	return copy(b, fmt.Sprintf("sig:previous boot begin (%d trices)\n", count))
+}
+
+// sprintIdentity switches to the til.json version with the hash inside the firmware identity trice, when TilCache has it.
+// The trices of this stream are decoded with that version from now on.
+func (p *trexDec) sprintIdentity(b []byte) (n int) {
+	hash := p.ReadU32(p.B)
+	if hash == 0 {
+		return copy(b, "wrn:firmware til.json hash unknown (TRICE_TIL_HASH is 0)\n")
+	}
+	if TilCache == nil {
+		return copy(b, fmt.Sprintf("sig:firmware til.json %08x\n", hash))
+	}
+	lut, err := TilCache.Lut(hash)
+	if err != nil {
+		return copy(b, fmt.Sprintf("wrn:firmware til.json %08x: %v, keeping the actual ID table\n", hash, err))
+	}
+	p.LutMutex.Lock()
+	p.Lut = lut
+	p.LutMutex.Unlock()
+	return copy(b, fmt.Sprintf("sig:firmware til.json %08x\n", hash))
+}
+
 // sprintTrice writes a trice string or appropriate message into b and returns that len.
 //
 // p.Trice.Type is the received trice, in fact the name from til.json.
@@ -555,18 +793,8 @@ func (p *trexDec) sprintTrice(b []byte) (n int) {
 		ignoreSpecialCase:
 			ss := strings.Split(p.pFmt, `\n`)
 			if len(ss) >= 3 { // at least one "\n" before "\n" line end
-				if decoder.NewlineIndent == -1 { // auto sense
-					decoder.NewlineIndent = 12 + 1 // todo: strings.SplitN & len(decoder.TargetStamp0) // 12
-					if !(id.LIFnJSON == "off" || id.LIFnJSON == "none") {
-						decoder.NewlineIndent += 28 /* todo: length(decoder.LocationInformationFormatString), see https://stackoverflow.com/questions/32987215/find-numbers-in-string-using-golang-regexp*/
-						// todo: split channel info with format specifiers too, example: ["msg:%d\nsignal:%x %u\n", p0, p1, p2] -> ["msg:%d\n", p0] && ["signal:%x %u\n", p1, p2]
-					}
-					if decoder.ShowID != "" {
-						decoder.NewlineIndent += 5 // todo: automatic
-					}
-				}
 				skip := `\n`
-				spaces := decoder.NewlineIndent
+				spaces := p.newlineIndent
 				for spaces > 0 {
 					skip += " "
 					spaces--
@@ -939,13 +1167,13 @@ func (p *trexDec) unSignedOrSignedOut(b []byte, bitwidth, count int) int {
 var testTableVirgin = true
 
 // printTestTableLine is used to generate testdata
-func (p *trexDec) printTestTableLine(n int) {
+func (p *trexDec) printTestTableLine(raw []byte) {
 	if emitter.NextLine || testTableVirgin {
 		emitter.NextLine = false
 		testTableVirgin = false
 		fmt.Printf("{ []byte{ ")
 	}
-	for _, b := range p.IBuf[0:n] { // just to see trice bytes per trice
+	for _, b := range raw { // just to see trice bytes per trice
 		fmt.Printf("%3d,", b)
 	}
 }
@@ -5,15 +5,20 @@ package trexDecoder
 
 import (
 	"bytes"
+	"encoding/binary"
 	"fmt"
 	"io"
 	"os"
 	"strings"
 	"sync"
 	"testing"
+	"time"
 
+	cobs "github.com/rokath/cobs/go"
 	"github.com/rokath/trice/internal/decoder"
+	"github.com/rokath/trice/internal/emitter"
 	"github.com/rokath/trice/internal/id"
+	"github.com/spf13/afero"
 	"github.com/tj/assert"
 )
 
@@ -77,3 +82,277 @@ func TestTREX(t *testing.T) {
 	doTableTest(t, &out, New, decoder.LittleEndian, tt)
 	assert.Equal(t, "", out.String())
 }
+
+// TestBan checks, that banned trices are dropped inside the decoder, also when several trices follow each other.
+func TestBan(t *testing.T) {
+	in := []byte{0x81, 0x8e, 0x09, 0x23, 0xc0, 0x02, 0xb8, 0x01, 0xa4, 0x00, 0xa7, 0x83, 0x1b, 0x23, 0xc1, 0x10, 0x5c, 0x63, 0x80, 0x61, 0x50, 0x05, 0x62, 0x08, 0x41, 0x00}
+	tt := decoder.TestTable{
+		{in, ""},
+	}
+	decoder.PackageFraming = "TCOBSv1"
+	assert.Nil(t, emitter.Ban.Set("msg"))
+	defer func() { emitter.Ban = nil }()
+	var out bytes.Buffer
+	doTableTest(t, &out, New, decoder.LittleEndian, tt)
+	assert.Equal(t, "", out.String())
+
+	emitter.Ban = nil
+	assert.Nil(t, emitter.Pick.Set("MSG"))
+	defer func() { emitter.Pick = nil }()
+	tt[0].Exp = `MSG: 💚 START select = 440\nMSG:triceFifoDepthMax = 92 of max 128, triceStreamBufferDepthMax = 1360 of max 2048`
+	doTableTest(t, &out, New, decoder.LittleEndian, tt)
+	assert.Equal(t, "", out.String())
+}
+
+// arrivalBuffer is a test input reader with a fixed arrival time.
+type arrivalBuffer struct {
+	*bytes.Buffer
+	arrival time.Time
+}
+
+func (p arrivalBuffer) Arrival() time.Time { return p.arrival }
+
+// TestHostArrival checks, that the decoded trice gets the arrival time of the input reader.
+func TestHostArrival(t *testing.T) {
+	decoder.PackageFraming = "TCOBSv1"
+	ilu := make(id.TriceIDLookUp)
+	assert.Nil(t, ilu.FromJSON([]byte(`{"3713":{"Type":"TRICE16","Strg":"MSG: 💚 START select = %d\\n"}}`)))
+	arrival := time.Date(2024, 1, 2, 3, 4, 5, 6000, time.UTC)
+	in := arrivalBuffer{bytes.NewBuffer([]byte{0x81, 0x8e, 0x09, 0x23, 0xc0, 0x02, 0xb8, 0x01, 0xa4, 0x00}), arrival}
+	dec := New(io.Discard, ilu, new(sync.RWMutex), nil, in, decoder.LittleEndian)
+	b := make([]byte, decoder.DefaultSize)
+	n, _ := dec.Read(b)
+	assert.Equal(t, `MSG: 💚 START select = 440\n`, string(b[:n]))
+	assert.Equal(t, arrival, decoder.HostArrival)
+}
+
+// TestIsolated checks, that an isolated decoder keeps the trice values for itself.
+func TestIsolated(t *testing.T) {
+	decoder.PackageFraming = "TCOBSv1"
+	ilu := make(id.TriceIDLookUp)
+	assert.Nil(t, ilu.FromJSON([]byte(`{"3713":{"Type":"TRICE16","Strg":"MSG: 💚 START select = %d\\n"}}`)))
+	arrival := time.Date(2024, 1, 2, 3, 4, 5, 6000, time.UTC)
+	in := arrivalBuffer{bytes.NewBuffer([]byte{0x81, 0x8e, 0x09, 0x23, 0xc0, 0x02, 0xb8, 0x01, 0xa4, 0x00}), arrival}
+	decoder.LastTriceID, decoder.HostArrival = 0, time.Time{}
+	dec := NewIsolated(io.Discard, ilu, new(sync.RWMutex), nil, in, decoder.LittleEndian, 256)
+	b := make([]byte, 256)
+	n, _ := dec.Read(b)
+	assert.Equal(t, `MSG: 💚 START select = 440\n`, string(b[:n]))
+	assert.Equal(t, decoder.TriceInfo{ID: 3713, Arrival: arrival, StampSize: 2, Stamp: 9}, dec.(decoder.Informer).Info())
+	assert.Equal(t, id.TriceID(0), decoder.LastTriceID)
+	assert.True(t, decoder.HostArrival.IsZero())
+}
+
+// TestIdentity checks, that a firmware identity trice selects the matching til.json version for the following trices.
+func TestIdentity(t *testing.T) {
+	fSys := &afero.Afero{Fs: afero.NewMemMapFs()}
+	v2 := []byte(`{"3713":{"Type":"TRICE16","Strg":"MSG: version 2 select = %d\\n"}}`)
+	hash := id.TilHash(v2)
+	assert.Nil(t, fSys.WriteFile(fmt.Sprintf("tils/%08x.json", hash), v2, 0o644))
+	c, err := id.NewLutCache(io.Discard, fSys, "tils")
+	assert.Nil(t, err)
+	TilCache = c
+	defer func() { TilCache = nil }()
+
+	ilu := make(id.TriceIDLookUp)
+	assert.Nil(t, ilu.FromJSON([]byte(`{"3713":{"Type":"TRICE16","Strg":"MSG: version 1 select = %d\\n"}}`)))
+	var in bytes.Buffer
+	for _, record := range [][]byte{
+		{0x81, 0x4e, 0xc0, 0x02, 0xb8, 0x01},                                   // tyId = S0 | 3713, nc = 2 bytes and cycle 0xc0, value 440
+		binary.LittleEndian.AppendUint32([]byte{0xee, 0x7f, 0xc1, 0x04}, hash), // tyId = S0 | 16366, nc = 4 bytes and cycle 0xc1
+		{0x81, 0x4e, 0xc2, 0x02, 0xb8, 0x01},
+	} {
+		frame := make([]byte, len(record)+2)
+		n := cobs.Encode(frame, record)
+		in.Write(append(frame[:n], 0))
+	}
+	decoder.PackageFraming = "COBS"
+	defer func() { decoder.PackageFraming = "TCOBSv1" }()
+	dec := New(io.Discard, ilu, new(sync.RWMutex), nil, &in, decoder.LittleEndian)
+	var out strings.Builder
+	b := make([]byte, decoder.DefaultSize)
+	for i := 0; i < 3; i++ {
+		n, _ := dec.Read(b)
+		out.Write(b[:n])
+	}
+	assert.Equal(t, `MSG: version 1 select = 440\n`+fmt.Sprintf("sig:firmware til.json %08x\n", hash)+`MSG: version 2 select = 440\n`, out.String())
+}
+
+// TestDiagnostics checks the decoding of a target TriceLogDiagnostics record, which has no til.json entry.
+func TestDiagnostics(t *testing.T) {
+	record := []byte{0xf1, 0x7f, 0xc0, 0x30} // tyId = S0 | 16369, nc = 48 bytes and cycle 0xc0
+	for i := 1; i <= 12; i++ {               // values 0x01010101 ... 0x0c0c0c0c, no zero bytes
+		b := byte(i)
+		record = append(record, b, b, b, b)
+	}
+	frame := append(append([]byte{byte(len(record) + 1)}, record...), 0) // COBS without zeroes inside
+	tt := decoder.TestTable{
+		{frame, "err:TriceErrorCount=16843009, TriceDirectOverflowCount=33686018, TriceDeferredOverflowCount=50529027, TriceDynBufTruncateCount=67372036, " +
+			"triceSingleDepthMax=84215045 of 101058054, TriceDataOffsetDepthMax=117901063 of 134744072, deferredDepthMax=151587081 of 168430090, RTT0_writeDepthMax=185273099 of 202116108"},
+	}
+	decoder.PackageFraming = "COBS"
+	defer func() { decoder.PackageFraming = "TCOBSv1" }()
+	var out bytes.Buffer
+	doTableTest(t, &out, New, decoder.LittleEndian, tt)
+	assert.Equal(t, "", out.String())
+}
+
+// TestPostMortem checks the decoding of the target post mortem markers, which have no til.json entry.
+func TestPostMortem(t *testing.T) {
+	tt := decoder.TestTable{ // tyId = S0 | 16368, nc = 4 bytes and cycle 0xc0, COBS framed
+		{[]byte{0x06, 0xf0, 0x7f, 0xc0, 0x04, 0x03, 0x01, 0x01, 0x01, 0x00}, "sig:previous boot begin (3 trices)"},
+		{[]byte{0x05, 0xf0, 0x7f, 0xc0, 0x04, 0x01, 0x01, 0x01, 0x01, 0x00}, "sig:previous boot end"},
+	}
+	decoder.PackageFraming = "COBS"
+	defer func() { decoder.PackageFraming = "TCOBSv1" }()
+	var out bytes.Buffer
+	doTableTest(t, &out, New, decoder.LittleEndian, tt)
+	assert.Equal(t, "", out.String())
+}
+
+// TestResyncNone checks, that without package framing the decoder skips line noise within one read
+// and reports it with a single summary line per ResyncInterval.
+func TestResyncNone(t *testing.T) {
+	ilu := make(id.TriceIDLookUp)
+	assert.Nil(t, ilu.FromJSON([]byte(`{"3713":{"Type":"TRICE16","Strg":"MSG: 💚 START select = %d\\n"}}`)))
+	ilu.AddFmtCount(io.Discard)
+	noise := bytes.Repeat([]byte{0x55, 0x81, 0x4e, 0xc0}, 10) // contains the trice head, but with a wrong count
+	var in bytes.Buffer
+	in.Write(noise[:37])
+	in.Write([]byte{0x81, 0x4e, 0xc0, 0x02, 0xb8, 0x01, 0x00, 0x00}) // tyId = S0 | 3713, nc = 2 bytes and cycle 0xc0, value 440, padding
+	in.Write(noise)
+	in.Write([]byte{0x81, 0x4e, 0xc1, 0x02, 0xb9, 0x01, 0x00, 0x00})
+	decoder.PackageFraming = "none"
+	defer func() { decoder.PackageFraming = "TCOBSv1" }()
+	defer func(d time.Duration) { ResyncInterval = d }(ResyncInterval)
+	ResyncInterval = time.Hour
+	dec := New(io.Discard, ilu, new(sync.RWMutex), nil, &in, decoder.LittleEndian)
+	var out strings.Builder
+	b := make([]byte, decoder.DefaultSize)
+	for i := 0; i < 4; i++ {
+		n, _ := dec.Read(b)
+		out.Write(b[:n])
+	}
+	assert.Equal(t, "wrn:resync: skipped 37 bytes, 0 packages\n"+decoder.Hints+"\n"+`MSG: 💚 START select = 440\nMSG: 💚 START select = 441\n`, out.String())
+}
+
+// TestResyncCOBS checks, that not decodable packages and unknown IDs are dropped and reported as summary.
+func TestResyncCOBS(t *testing.T) {
+	ilu := make(id.TriceIDLookUp)
+	assert.Nil(t, ilu.FromJSON([]byte(`{"3713":{"Type":"TRICE16","Strg":"MSG: 💚 START select = %d\\n"}}`)))
+	var in bytes.Buffer
+	in.Write([]byte{0x09, 0x11, 0x00}) // COBS code byte behind the frame end
+	in.Write([]byte{0x07, 0x12, 0x00})
+	for _, record := range [][]byte{
+		{0x81, 0x7f, 0xc0, 0x00},             // tyId = S0 | 16257, not inside til.json
+		{0x81, 0x4e, 0xc0, 0x02, 0xb8, 0x01}, // tyId = S0 | 3713, nc = 2 bytes and cycle 0xc0, value 440
+	} {
+		frame := make([]byte, len(record)+2)
+		n := cobs.Encode(frame, record)
+		in.Write(append(frame[:n], 0))
+	}
+	decoder.PackageFraming = "COBS"
+	defer func() { decoder.PackageFraming = "TCOBSv1" }()
+	defer func(d time.Duration) { ResyncInterval = d }(ResyncInterval)
+	ResyncInterval = time.Hour
+	dec := New(io.Discard, ilu, new(sync.RWMutex), nil, &in, decoder.LittleEndian)
+	var out strings.Builder
+	b := make([]byte, decoder.DefaultSize)
+	for i := 0; i < 4; i++ {
+		n, _ := dec.Read(b)
+		out.Write(b[:n])
+	}
+	assert.Equal(t, "wrn:resync: skipped 0 bytes, 1 packages\n"+decoder.Hints+"\n"+`MSG: 💚 START select = 440\n`, out.String())
+
+	ResyncInterval = 0 // the collected rest is reported with the next read
+	n, _ := dec.Read(b)
+	assert.True(t, strings.HasPrefix(string(b[:n]), "wrn:resync: skipped 0 bytes, 2 packages, 1 with unknown ID (last 16257) in the last "))
+}
+
+// TestResyncBuffer checks, that dropped packages do not end the reading of a buffer input, which stops on the first n == 0.
+func TestResyncBuffer(t *testing.T) {
+	ilu := make(id.TriceIDLookUp)
+	assert.Nil(t, ilu.FromJSON([]byte(`{"3713":{"Type":"TRICE16","Strg":"MSG: 💚 START select = %d\\n"}}`)))
+	var in bytes.Buffer
+	for _, record := range [][]byte{
+		{0x81, 0x7f, 0xc0, 0x00},             // tyId = S0 | 16257, not inside til.json
+		{0x82, 0x7f, 0xc0, 0x00},             // tyId = S0 | 16258, not inside til.json
+		{0x81, 0x4e, 0xc0, 0x02, 0xb8, 0x01}, // tyId = S0 | 3713, nc = 2 bytes and cycle 0xc0, value 440
+	} {
+		frame := make([]byte, len(record)+2)
+		n := cobs.Encode(frame, record)
+		in.Write(append(frame[:n], 0))
+	}
+	decoder.PackageFraming = "COBS"
+	defer func() { decoder.PackageFraming = "TCOBSv1" }()
+	defer func(d time.Duration) { ResyncInterval = d }(ResyncInterval)
+	ResyncInterval = time.Hour
+	dec := New(io.Discard, ilu, new(sync.RWMutex), nil, &in, decoder.LittleEndian)
+	var out strings.Builder
+	b := make([]byte, decoder.DefaultSize)
+	for {
+		n, _ := dec.Read(b)
+		if n == 0 {
+			break
+		}
+		out.Write(b[:n])
+	}
+	assert.Equal(t, "wrn:resync: skipped 0 bytes, 1 packages, 1 with unknown ID (last 16257)\n"+decoder.Hints+"\n"+`MSG: 💚 START select = 440\n`, out.String())
+}
+
+// TestCompressedDrop checks, that after a dropped compressed package no trice is resolved against the outdated history before the next reset flag.
+func TestCompressedDrop(t *testing.T) {
+	ilu := make(id.TriceIDLookUp)
+	assert.Nil(t, ilu.FromJSON([]byte(`{"3713":{"Type":"TRICE","Strg":"msg:A\\n"},"3714":{"Type":"TRICE","Strg":"msg:B\\n"},`+
+		`"3715":{"Type":"TRICE","Strg":"msg:C\\n"},"3716":{"Type":"TRICE","Strg":"msg:D\\n"}}`)))
+	var in bytes.Buffer
+	for i, record := range [][]byte{
+		{0x01, 0x81, 0x4e, 0x00, 0xc0, 0x08, 0x82, 0x4e, 0x00}, // reset, S0 | 3713, count 0, cycle 0xc0 and next cycle, S0 | 3714, count 0
+		{0x08, 0x83, 0x4e, 0x00},                               // next cycle, S0 | 3715 into dict[2], count 0, lost
+		{0x08, 0x84, 0x4e, 0x00, 0xa8, 0x00},                   // next cycle, S0 | 3716 into dict[3], count 0 and dict[2] hit, next cycle, count 0
+		{0x01, 0x81, 0x4e, 0x00, 0xc2},                         // reset, S0 | 3713, count 0, cycle 0xc2
+	} {
+		frame := make([]byte, len(record)+2)
+		n := cobs.Encode(frame, record)
+		if i == 1 {
+			frame[0] = 0x20 // COBS code byte behind the frame end
+		}
+		in.Write(append(frame[:n], 0))
+	}
+	decoder.PackageFraming = "COBS"
+	defer func() { decoder.PackageFraming = "TCOBSv1" }()
+	defer func(d time.Duration) { ResyncInterval = d }(ResyncInterval)
+	ResyncInterval = time.Hour
+	Compressed = true
+	defer func() { Compressed = false }()
+	dec := New(io.Discard, ilu, new(sync.RWMutex), nil, &in, decoder.LittleEndian)
+	var out strings.Builder
+	b := make([]byte, decoder.DefaultSize)
+	for i := 0; i < 8; i++ {
+		n, _ := dec.Read(b)
+		out.Write(b[:n])
+	}
+	assert.Equal(t, `msg:A\nmsg:B\n`+"wrn:resync: skipped 0 bytes, 1 packages\n"+decoder.Hints+"\n"+`msg:A\n`, out.String())
+}
+
+// TestNewlineIndent checks, that concurrent decoders resolve the auto sensed newline indent each for itself.
+func TestNewlineIndent(t *testing.T) {
+	ilu := make(id.TriceIDLookUp)
+	assert.Nil(t, ilu.FromJSON([]byte(`{"3714":{"Type":"TRICE","Strg":"msg:a\\nb\\n"}}`)))
+	decoder.PackageFraming = "none"
+	defer func() { decoder.PackageFraming = "TCOBSv1" }()
+	var wg sync.WaitGroup
+	for i := 0; i < 4; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			in := bytes.NewBuffer([]byte{0x82, 0x4e, 0xc0, 0x00}) // tyId = S0 | 3714, nc = 0 bytes and cycle 0xc0
+			dec := NewIsolated(io.Discard, ilu, new(sync.RWMutex), nil, in, decoder.LittleEndian, 256)
+			b := make([]byte, 256)
+			n, _ := dec.Read(b)
+			assert.Equal(t, `msg:a\n`+strings.Repeat(" ", newlineIndent())+`b\n`, string(b[:n]))
+		}()
+	}
+	wg.Wait()
+	assert.Equal(t, -1, decoder.NewlineIndent)
+}
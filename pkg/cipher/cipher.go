@@ -10,6 +10,7 @@ import (
 	"crypto/sha1"
 	"fmt"
 	"io"
+	"strings"
 
 	"github.com/rokath/trice/pkg/msg"
 	"golang.org/x/crypto/xtea"
@@ -23,13 +24,22 @@ var (
 	// ShowKey if set, allows to see the encryption passphrase
 	ShowKey bool
 
+	// Mode is the target encryption: "XTEA" (TRICE_DEFERRED_XTEA_ENCRYPT) or "SPECK" (TRICE_DEFERRED_STREAM_ENCRYPT).
+	Mode = "XTEA"
+
 	key []byte
 
 	// cipher is a pointer to the crypto struct filled during initialization
 	ci *xtea.Cipher
 
+	// xt holds the XTEA round values for the allocation free Decrypt and Encrypt.
+	xt *xteaTable
+
 	// enabled set to true if a -password other than "" was given
 	enabled bool
+
+	// st is the SPECK mode decryption state. It is kept over SetUp calls, because the target package counter continues.
+	st stream
 )
 
 // SetUp uses the Password to create a cipher. If Password is "" encryption/decryption is disabled.
@@ -41,9 +51,26 @@ func SetUp(w io.Writer) error {
 	bsize := ci.BlockSize()
 	msg.FatalOnTrue(8 != bsize)
 
+	switch strings.ToUpper(Mode) {
+	case "XTEA":
+	case "SPECK":
+		st.sp = newSpeck64(key)
+	default:
+		return fmt.Errorf("unknown cipher %q, options are XTEA and SPECK", Mode)
+	}
 	return nil
 }
 
+// DecryptPackage decrypts the package b according to Mode and returns the trice data.
+// In XTEA mode b is decrypted in place and 0-7 padding bytes remain. In SPECK mode the package counter is removed.
+func DecryptPackage(b []byte) ([]byte, error) {
+	if st.sp != nil && strings.ToUpper(Mode) == "SPECK" {
+		return st.decrypt(b)
+	}
+	Decrypt(b, b)
+	return b, nil
+}
+
 // createCipher prepares decryption, with password "none" the encryption flag is set false, otherwise true
 func createCipher(w io.Writer) (*xtea.Cipher, bool, error) {
 	switch Password {
@@ -61,6 +88,7 @@ func createCipher(w io.Writer) (*xtea.Cipher, bool, error) {
 	}
 	c, err := xtea.NewCipher(key)
 	msg.FatalOnErr(err)
+	xt = newXTEATable(key)
 
 	var e bool
 	if "" != Password {
@@ -141,22 +169,36 @@ func encrypt8(dst, src []byte) {
 	_ = copy(dst, swap)
 }
 
+// blockCount returns the count of convertable bytes: The smaller length of dst and src rounded down to a multiple of 8.
+func blockCount(dst, src []byte) int {
+	c := len(src)
+	if len(dst) < c {
+		c = len(dst)
+	}
+	return c &^ 7
+}
+
 // Decrypt converts src into dst and returns count of converted bytes.
 // Only multiple of 8 are convertable, so last 0-7 bytes are not convertable and c is a multiple of 8.
-// The smaller byte slice limits the conversion.
+// The smaller byte slice limits the conversion. dst and src can be the same slice for in place decryption.
+// Decrypt does not allocate memory, so it is usable on high rate streams.
 func Decrypt(dst, src []byte) (c int) {
-	for c = 0; c+8 <= len(dst) && c+8 <= len(src); c += 8 {
-		decrypt8(dst[c:c+8], src[c:c+8])
+	c = blockCount(dst, src)
+	copy(dst[:c], src[:c])
+	if enabled {
+		xt.decryptBlocks(dst[:c])
 	}
 	return
 }
 
-//  // Encrypt converts src into dst and returns count of converted bytes.
-//  // Only multiple of 8 are convertable, so last 0-7 bytes are not convertable and c is a multiple of 8.
-//  // The smaller byte slice limits the conversion.
-//  func Encrypt(dst, src []byte) (c int) {
-//  	for c = 0; c+8 <= len(dst) && c+8 <= len(src); c += 8 {
-//  		encrypt8(dst[c:c+8], src[c:c+8])
-//  	}
-//  	return
-//  }
+// Encrypt converts src into dst like the target code and returns count of converted bytes.
+// Only multiple of 8 are convertable, so last 0-7 bytes are not convertable and c is a multiple of 8.
+// The smaller byte slice limits the conversion. dst and src can be the same slice for in place encryption.
+func Encrypt(dst, src []byte) (c int) {
+	c = blockCount(dst, src)
+	copy(dst[:c], src[:c])
+	if enabled {
+		xt.encryptBlocks(dst[:c])
+	}
+	return
+}
@@ -0,0 +1,97 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package cipher
+
+// Speck64/128 in counter mode for target code with TRICE_DEFERRED_STREAM_ENCRYPT == 1 (see src/speck.c and TriceStreamEncrypt in src/trice.c).
+
+import (
+	"encoding/binary"
+	"errors"
+	"math/bits"
+)
+
+// speckRounds is the Speck64/128 round count.
+const speckRounds = 27
+
+// speck64 holds the Speck64/128 round keys.
+type speck64 [speckRounds]uint32
+
+// newSpeck64 computes the round keys from the 16 bytes key. The key words are big endian like for XTEA, so the same target key is used.
+func newSpeck64(key []byte) *speck64 {
+	c := new(speck64)
+	rk := binary.BigEndian.Uint32(key)
+	l := [3]uint32{binary.BigEndian.Uint32(key[4:]), binary.BigEndian.Uint32(key[8:]), binary.BigEndian.Uint32(key[12:])}
+	for i := range c {
+		c[i] = rk
+		l[i%3] = (rk + bits.RotateLeft32(l[i%3], -8)) ^ uint32(i)
+		rk = bits.RotateLeft32(rk, 3) ^ l[i%3]
+	}
+	return c
+}
+
+// encrypt returns the encrypted Speck words x and y.
+func (c *speck64) encrypt(x, y uint32) (uint32, uint32) {
+	for _, k := range c {
+		x = (bits.RotateLeft32(x, -8) + y) ^ k
+		y = bits.RotateLeft32(y, 3) ^ x
+	}
+	return x, y
+}
+
+// stream is the decryption state for the target TriceStreamEncrypt packages.
+type stream struct {
+	sp      *speck64
+	nonce   uint32 // nonce is the target TRICE_STREAM_NONCE value from the last sync package.
+	counter uint32 // counter is the package counter of the last package.
+	synced  bool   // synced is true after the first sync package.
+	waiting bool   // waiting is true, when the missing sync was already reported.
+}
+
+// errStreamSync is reported once, when encrypted packages arrive before a sync package.
+var errStreamSync = errors.New("waiting for a stream cipher sync package (each 256th package)")
+
+// decrypt returns the decrypted trice data from package b. b is modified.
+//
+// A package starts with the 2 low bytes of the package counter. Each 256th package (low counter byte 0) carries
+// additionally the nonce and the 2 high counter bytes. All values are little endian.
+// The key stream is the Speck encrypted block {counter, nonce ^ blockIndex<<24} in little endian byte order.
+func (s *stream) decrypt(b []byte) ([]byte, error) {
+	if len(b) < 2 {
+		return b[:0], errors.New("stream cipher package too short")
+	}
+	low := uint32(binary.LittleEndian.Uint16(b))
+	b = b[2:]
+	if low&0xff == 0 { // sync package
+		if len(b) < 6 {
+			return b[:0], errors.New("stream cipher sync package too short")
+		}
+		s.nonce = binary.LittleEndian.Uint32(b)
+		s.counter = uint32(binary.LittleEndian.Uint16(b[4:]))<<16 | low
+		s.synced, s.waiting = true, false
+		b = b[6:]
+	} else {
+		if !s.synced {
+			if s.waiting {
+				return b[:0], nil
+			}
+			s.waiting = true
+			return b[:0], errStreamSync
+		}
+		c := s.counter&^0xffff | low
+		if c < s.counter { // low counter part wrapped
+			c += 0x10000
+		}
+		s.counter = c
+	}
+	var ks [8]byte
+	for i := 0; i < len(b); i++ {
+		if i&7 == 0 {
+			x, y := s.sp.encrypt(s.counter, s.nonce^uint32(i>>3)<<24)
+			binary.LittleEndian.PutUint32(ks[:], x)
+			binary.LittleEndian.PutUint32(ks[4:], y)
+		}
+		b[i] ^= ks[i&7]
+	}
+	return b, nil
+}
@@ -0,0 +1,62 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+// whitebox test
+package cipher
+
+import (
+	"encoding/binary"
+	"os"
+	"testing"
+
+	"github.com/tj/assert"
+)
+
+// TestSpeck64 checks the Speck64/128 test vector from the Speck paper.
+func TestSpeck64(t *testing.T) {
+	key := []byte{0x03, 0x02, 0x01, 0x00, 0x0b, 0x0a, 0x09, 0x08, 0x13, 0x12, 0x11, 0x10, 0x1b, 0x1a, 0x19, 0x18} // k0 l0 l1 l2
+	x, y := newSpeck64(key).encrypt(0x3b726574, 0x7475432d)
+	assert.Equal(t, uint32(0x8c6fa548), x)
+	assert.Equal(t, uint32(0x454e028b), y)
+}
+
+// streamEncrypt does the same as the target function TriceStreamEncrypt.
+func streamEncrypt(sp *speck64, nonce, counter uint32, b []byte) (p []byte) {
+	p = binary.LittleEndian.AppendUint16(p, uint16(counter))
+	if counter&0xff == 0 {
+		p = binary.LittleEndian.AppendUint32(p, nonce)
+		p = binary.LittleEndian.AppendUint16(p, uint16(counter>>16))
+	}
+	var ks [8]byte
+	for i, v := range b {
+		if i&7 == 0 {
+			x, y := sp.encrypt(counter, nonce^uint32(i>>3)<<24)
+			binary.LittleEndian.PutUint32(ks[:], x)
+			binary.LittleEndian.PutUint32(ks[4:], y)
+		}
+		p = append(p, v^ks[i&7])
+	}
+	return
+}
+
+// TestStreamDecrypt checks the synchronization and the counter extension over the 16-bit wrap.
+func TestStreamDecrypt(t *testing.T) {
+	Password, Mode = "MySecret", "SPECK"
+	defer func() { Password, Mode, st = "", "XTEA", stream{} }()
+	st = stream{}
+	assert.Nil(t, SetUp(os.Stdout))
+	src := []byte{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}
+
+	_, err := DecryptPackage(streamEncrypt(st.sp, 0x12345678, 0xfffe, src))
+	assert.Equal(t, errStreamSync, err)
+	d, err := DecryptPackage(streamEncrypt(st.sp, 0x12345678, 0xffff, src))
+	assert.Nil(t, err) // reported only once
+	assert.Equal(t, 0, len(d))
+
+	for _, c := range []uint32{0x10f00, 0x10f01, 0x1fffe, 0x20001, 0x20002} { // 0x1fffe to 0x20001: lost packages and wrap
+		d, err = DecryptPackage(streamEncrypt(st.sp, 0x12345678, c, src))
+		assert.Nil(t, err)
+		assert.Equal(t, src, d)
+		assert.Equal(t, c, st.counter)
+	}
+}
@@ -0,0 +1,111 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package cipher
+
+// Allocation free XTEA for the target code with TRICE_DEFERRED_XTEA_ENCRYPT == 1 (see src/xtea.c).
+
+import "encoding/binary"
+
+const (
+	xteaRounds = 64         // xteaRounds is the round count like in golang.org/x/crypto/xtea and in the target code.
+	xteaDelta  = 0x9E3779B9 // xteaDelta is the XTEA key schedule constant.
+)
+
+// xteaTable holds the precomputed round values like XTEAInitTable in src/xtea.c.
+type xteaTable [xteaRounds]uint32
+
+// newXTEATable computes the round values from the 16 bytes key. The key words are big endian like in golang.org/x/crypto/xtea.
+func newXTEATable(key []byte) *xteaTable {
+	var k [4]uint32
+	for i := range k {
+		k[i] = binary.BigEndian.Uint32(key[4*i:])
+	}
+	t := new(xteaTable)
+	var sum uint32
+	for i := 0; i < xteaRounds; i += 2 {
+		t[i] = sum + k[sum&3]
+		sum += xteaDelta
+		t[i+1] = sum + k[(sum>>11)&3]
+	}
+	return t
+}
+
+// decryptBlocks decrypts b in place. len(b) must be a multiple of 8.
+//
+// The target encrypts its little endian 32-bit words, so the byte swap is just reading and writing little endian.
+// 4 blocks are processed interleaved, because the rounds of one block depend on each other.
+func (t *xteaTable) decryptBlocks(b []byte) {
+	le := binary.LittleEndian
+	for ; len(b) >= 32; b = b[32:] {
+		a0, a1, b0, b1 := le.Uint32(b[0:]), le.Uint32(b[4:]), le.Uint32(b[8:]), le.Uint32(b[12:])
+		c0, c1, d0, d1 := le.Uint32(b[16:]), le.Uint32(b[20:]), le.Uint32(b[24:]), le.Uint32(b[28:])
+		for i := xteaRounds - 1; i > 0; i -= 2 {
+			k := t[i]
+			a1 -= ((a0<<4 ^ a0>>5) + a0) ^ k
+			b1 -= ((b0<<4 ^ b0>>5) + b0) ^ k
+			c1 -= ((c0<<4 ^ c0>>5) + c0) ^ k
+			d1 -= ((d0<<4 ^ d0>>5) + d0) ^ k
+			k = t[i-1]
+			a0 -= ((a1<<4 ^ a1>>5) + a1) ^ k
+			b0 -= ((b1<<4 ^ b1>>5) + b1) ^ k
+			c0 -= ((c1<<4 ^ c1>>5) + c1) ^ k
+			d0 -= ((d1<<4 ^ d1>>5) + d1) ^ k
+		}
+		le.PutUint32(b[0:], a0)
+		le.PutUint32(b[4:], a1)
+		le.PutUint32(b[8:], b0)
+		le.PutUint32(b[12:], b1)
+		le.PutUint32(b[16:], c0)
+		le.PutUint32(b[20:], c1)
+		le.PutUint32(b[24:], d0)
+		le.PutUint32(b[28:], d1)
+	}
+	for ; len(b) >= 8; b = b[8:] {
+		v0, v1 := le.Uint32(b), le.Uint32(b[4:])
+		for i := xteaRounds - 1; i > 0; i -= 2 {
+			v1 -= ((v0<<4 ^ v0>>5) + v0) ^ t[i]
+			v0 -= ((v1<<4 ^ v1>>5) + v1) ^ t[i-1]
+		}
+		le.PutUint32(b, v0)
+		le.PutUint32(b[4:], v1)
+	}
+}
+
+// encryptBlocks encrypts b in place like the target code. len(b) must be a multiple of 8.
+func (t *xteaTable) encryptBlocks(b []byte) {
+	le := binary.LittleEndian
+	for ; len(b) >= 32; b = b[32:] {
+		a0, a1, b0, b1 := le.Uint32(b[0:]), le.Uint32(b[4:]), le.Uint32(b[8:]), le.Uint32(b[12:])
+		c0, c1, d0, d1 := le.Uint32(b[16:]), le.Uint32(b[20:]), le.Uint32(b[24:]), le.Uint32(b[28:])
+		for i := 0; i < xteaRounds; i += 2 {
+			k := t[i]
+			a0 += ((a1<<4 ^ a1>>5) + a1) ^ k
+			b0 += ((b1<<4 ^ b1>>5) + b1) ^ k
+			c0 += ((c1<<4 ^ c1>>5) + c1) ^ k
+			d0 += ((d1<<4 ^ d1>>5) + d1) ^ k
+			k = t[i+1]
+			a1 += ((a0<<4 ^ a0>>5) + a0) ^ k
+			b1 += ((b0<<4 ^ b0>>5) + b0) ^ k
+			c1 += ((c0<<4 ^ c0>>5) + c0) ^ k
+			d1 += ((d0<<4 ^ d0>>5) + d0) ^ k
+		}
+		le.PutUint32(b[0:], a0)
+		le.PutUint32(b[4:], a1)
+		le.PutUint32(b[8:], b0)
+		le.PutUint32(b[12:], b1)
+		le.PutUint32(b[16:], c0)
+		le.PutUint32(b[20:], c1)
+		le.PutUint32(b[24:], d0)
+		le.PutUint32(b[28:], d1)
+	}
+	for ; len(b) >= 8; b = b[8:] {
+		v0, v1 := le.Uint32(b), le.Uint32(b[4:])
+		for i := 0; i < xteaRounds; i += 2 {
+			v0 += ((v1<<4 ^ v1>>5) + v1) ^ t[i]
+			v1 += ((v0<<4 ^ v0>>5) + v0) ^ t[i+1]
+		}
+		le.PutUint32(b, v0)
+		le.PutUint32(b[4:], v1)
+	}
+}
@@ -0,0 +1,70 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+// whitebox test
+package cipher
+
+import (
+	"math/rand"
+	"os"
+	"testing"
+
+	"github.com/tj/assert"
+)
+
+// decryptPerBlock is the former Decrypt implementation, kept as reference.
+func decryptPerBlock(dst, src []byte) (c int) {
+	for c = 0; c+8 <= len(dst) && c+8 <= len(src); c += 8 {
+		decrypt8(dst[c:c+8], src[c:c+8])
+	}
+	return
+}
+
+// TestDecryptBlocks compares Decrypt and Encrypt with the golang.org/x/crypto/xtea based per block functions.
+func TestDecryptBlocks(t *testing.T) {
+	Password, ShowKey = "MySecret", false
+	defer func() { Password = "" }()
+	assert.Nil(t, SetUp(os.Stdout))
+	for _, size := range []int{0, 7, 8, 20, 32, 40, 72, 1003} {
+		src := make([]byte, size)
+		rand.Read(src)
+		exp := make([]byte, size)
+		n := decryptPerBlock(exp, src)
+		act := append([]byte{}, src...)
+		assert.Equal(t, n, Decrypt(act, act)) // in place
+		assert.Equal(t, exp[:n], act[:n])
+
+		for i := 0; i+8 <= n; i += 8 {
+			encrypt8(exp[i:i+8], src[i:i+8])
+		}
+		assert.Equal(t, n, Encrypt(act, src))
+		assert.Equal(t, exp[:n], act[:n])
+		assert.Equal(t, n, Decrypt(act, act))
+		assert.Equal(t, src[:n], act[:n])
+	}
+}
+
+// benchmarkDecrypt measures decrypt with a package size of 4 KiB.
+func benchmarkDecrypt(b *testing.B, decrypt func(dst, src []byte) int) {
+	Password, ShowKey = "MySecret", false
+	defer func() { Password = "" }()
+	assert.Nil(b, SetUp(os.Stdout))
+	buf := make([]byte, 4096)
+	rand.Read(buf)
+	b.SetBytes(int64(len(buf)))
+	b.ReportAllocs()
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		decrypt(buf, buf)
+	}
+}
+
+// BenchmarkDecryptPerBlock measures the former per 8 bytes decryption with byte swap slices.
+func BenchmarkDecryptPerBlock(b *testing.B) {
+	benchmarkDecrypt(b, decryptPerBlock)
+}
+
+// BenchmarkDecrypt measures the allocation free 4-way interleaved decryption.
+func BenchmarkDecrypt(b *testing.B) {
+	benchmarkDecrypt(b, Decrypt)
+}
@@ -0,0 +1,47 @@
+/*! \file speck.c
+\brief Speck64/128 block cipher, used in counter mode for TRICE_DEFERRED_STREAM_ENCRYPT
+\author Thomas.Hoehenleitner [at] seerose.net
+*******************************************************************************/
+
+#include "speck.h"
+#include "trice.h"
+#include "xtea.h"
+
+#if (TRICE_DEFERRED_STREAM_ENCRYPT == 1) && TRICE_OFF == 0
+
+//! Speck64/128 works with 27 rounds
+#define SPECK_ROUNDS 27
+
+#define SPECK_ROR(x, r) (((x) >> (r)) | ((x) << (32 - (r)))) //!< SPECK_ROR rotates the 32-bit value x right by r bits.
+#define SPECK_ROL(x, r) (((x) << (r)) | ((x) >> (32 - (r)))) //!< SPECK_ROL rotates the 32-bit value x left by r bits.
+
+//! 128 bit static key, the same as for XTEA, so "trice log -password" works for both ciphers.
+static const uint32_t speckKey[4] = XTEA_ENCRYPT_KEY;
+
+//! precomputed round keys
+static uint32_t roundKey[SPECK_ROUNDS];
+
+//! SpeckInitTable computes the round keys from speckKey. speckKey[0] is the first round key and speckKey[1]...speckKey[3] are the key schedule words l0...l2.
+void SpeckInitTable(void) {
+	uint32_t rk = speckKey[0];
+	uint32_t l[3] = {speckKey[1], speckKey[2], speckKey[3]};
+	for (unsigned i = 0; i < SPECK_ROUNDS; i++) {
+		roundKey[i] = rk;
+		l[i % 3] = (rk + SPECK_ROR(l[i % 3], 8)) ^ i;
+		rk = SPECK_ROL(rk, 3) ^ l[i % 3];
+	}
+}
+
+//! SpeckEncrypt converts 64 bits in place. v[0] is the Speck word x and v[1] the word y.
+//! Only encryption is needed, because in counter mode the encrypted counter is the key stream.
+void SpeckEncrypt(uint32_t v[2]) {
+	uint32_t x = v[0], y = v[1];
+	for (unsigned i = 0; i < SPECK_ROUNDS; i++) {
+		x = (SPECK_ROR(x, 8) + y) ^ roundKey[i];
+		y = SPECK_ROL(y, 3) ^ x;
+	}
+	v[0] = x;
+	v[1] = y;
+}
+
+#endif // #if (TRICE_DEFERRED_STREAM_ENCRYPT == 1) && TRICE_OFF == 0
@@ -0,0 +1,21 @@
+/*! \file speck.h
+\author Thomas.Hoehenleitner [at] seerose.net
+*******************************************************************************/
+
+#ifndef TRICE_SPECK_H_
+#define TRICE_SPECK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h> //lint !e537 !e451  Warning 537: Repeated include file,  Warning 451: Header file repeatedly included but does not have a standard
+
+void SpeckInitTable(void);
+void SpeckEncrypt(uint32_t v[2]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRICE_SPECK_H_
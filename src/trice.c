@@ -5,6 +5,7 @@
 #include "trice.h"
 #include "cobs.h"
 #include "tcobs.h"
+#include "speck.h"
 #include "xtea.h"
 
 #if TRICE_OFF == 0
@@ -115,14 +116,38 @@
 #error configuration: only one RTT output channel is possible
 #endif
 
-#if (TRICE_BUFFER == TRICE_DOUBLE_BUFFER) && (TRICE_DEFERRED_BUFFER_SIZE / 2 < TRICE_BUFFER_SIZE)
+#if (TRICE_BUFFER == TRICE_DOUBLE_BUFFER) && (TRICE_DEFERRED_BUFFER_SIZE / TRICE_DEFERRED_BUFFER_SEGMENTS < TRICE_BUFFER_SIZE)
 #error configuration: TRICE_DEFERRED_BUFFER_SIZE too small
 #endif
 
+#if (TRICE_BUFFER == TRICE_DOUBLE_BUFFER) && (TRICE_DEFERRED_BUFFER_SEGMENTS < 2)
+#error configuration: TRICE_DEFERRED_BUFFER_SEGMENTS needs to be at least 2
+#endif
+
+#if (TRICE_BUFFER == TRICE_DOUBLE_BUFFER) && (TRICE_DEFERRED_BUFFER_SEGMENTS > 2) && (TRICE_PROTECT == 0)
+#error configuration: TRICE_DEFERRED_BUFFER_SEGMENTS > 2 needs TRICE_PROTECT == 1 for the segment change
+#endif
+
+#if (TRICE_BUFFER == TRICE_DOUBLE_BUFFER) && ((TRICE_DEFERRED_BUFFER_SIZE / 4) % TRICE_DEFERRED_BUFFER_SEGMENTS != 0)
+#error configuration: TRICE_DEFERRED_BUFFER_SIZE / 4 must be a multiple of TRICE_DEFERRED_BUFFER_SEGMENTS
+#endif
+
 #if (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_DEFERRED_BUFFER_SIZE < TRICE_BUFFER_SIZE)
 #error configuration: TRICE_DEFERRED_BUFFER_SIZE too small
 #endif
 
+#if (TRICE_RING_BUFFER_EXACT == 1) && (TRICE_BUFFER != TRICE_RING_BUFFER)
+#error configuration: TRICE_RING_BUFFER_EXACT == 1 needs TRICE_BUFFER == TRICE_RING_BUFFER
+#endif
+
+#if (TRICE_RING_BUFFER_EXACT == 1) && (TRICE_RING_BUFFER_EXACT_SIZE < TRICE_SINGLE_MAX_SIZE)
+#error configuration: TRICE_RING_BUFFER_EXACT == 1 needs TRICE_DEFERRED_BUFFER_SIZE >= 2 * TRICE_BUFFER_SIZE - TRICE_DATA_OFFSET + TRICE_SINGLE_MAX_SIZE
+#endif
+
+#if (TRICE_POST_MORTEM == 1) && ((TRICE_BUFFER != TRICE_RING_BUFFER) || (TRICE_RING_BUFFER_EXACT == 1))
+#error configuration: TRICE_POST_MORTEM == 1 needs TRICE_BUFFER == TRICE_RING_BUFFER and TRICE_RING_BUFFER_EXACT == 0
+#endif
+
 #if (TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1) && (TRICE_DIRECT_OUTPUT == 0)
 #error configuration: TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1 needs TRICE_DIRECT_OUTPUT == 1
 #endif
@@ -135,6 +160,37 @@
 #error configuration: BUFFER_SIZE_UP too small
 #endif
 
+#if (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1) && ((TRICE_BUFFER != TRICE_STATIC_BUFFER) || (TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 0))
+#error configuration: TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1 needs TRICE_BUFFER == TRICE_STATIC_BUFFER and TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1
+#endif
+
+#if (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1) && ((TRICE_DIRECT_OUT_FRAMING != TRICE_FRAMING_NONE) || (TRICE_DIRECT_XTEA_ENCRYPT == 1) || (TRICE_DIRECT_OUTPUT_IS_WITH_ROUTING == 1) || (TRICE_DIRECT_AUXILIARY32 == 1) || (TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0))
+#error configuration: TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1 needs unframed and unencrypted direct output without routing and auxiliary output
+#endif
+
+#if (TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0) && !defined(SEGGER_RTT)
+#error configuration: TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0 needs a SEGGER RTT output
+#endif
+
+#if (TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0) && (TRICE_SEGGER_RTT_ROUTED_CHANNEL >= SEGGER_RTT_MAX_NUM_UP_BUFFERS)
+#error configuration: SEGGER_RTT_MAX_NUM_UP_BUFFERS too small for TRICE_SEGGER_RTT_ROUTED_CHANNEL
+#endif
+
+#if (TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0) && (TRICE_BUFFER_SIZE > TRICE_SEGGER_RTT_ROUTED_CHANNEL_SIZE)
+#error configuration: TRICE_SEGGER_RTT_ROUTED_CHANNEL_SIZE too small
+#endif
+
+#if (TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0) && (TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE == 1) && (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE)
+#error configuration: TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0 needs TRICE_SINGLE_PACK_MODE for TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE, because a multi pack is routed by the ID of its last trice.
+#endif
+
+//! TRICE_RTT_ROUTES_ID is true, when id is inside the routed ID range.
+#define TRICE_RTT_ROUTES_ID(id) ((TRICE_SEGGER_RTT_ROUTED_CHANNEL_MIN_ID <= (id)) && ((id) <= TRICE_SEGGER_RTT_ROUTED_CHANNEL_MAX_ID))
+
+#if (TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0) && (TRICE_RTT_ROUTES_ID(TRICE_IDENTITY_ID) || TRICE_RTT_ROUTES_ID(TRICE_CLOCK_SYNC_ID) || TRICE_RTT_ROUTES_ID(TRICE_POST_MORTEM_ID) || TRICE_RTT_ROUTES_ID(TRICE_DIAGNOSTICS_ID))
+#error configuration: TRICE_SEGGER_RTT_ROUTED_CHANNEL_MIN_ID ... TRICE_SEGGER_RTT_ROUTED_CHANNEL_MAX_ID includes a reserved ID (TRICE_IDENTITY_ID, TRICE_CLOCK_SYNC_ID, TRICE_POST_MORTEM_ID or TRICE_DIAGNOSTICS_ID).
+#endif
+
 #if (TRICE_BUFFER == TRICE_STACK_BUFFER) && (TRICE_DIRECT_OUTPUT == 0)
 #error configuration: direct-only mode needs TRICE_DIRECT_OUTPUT == 1
 #endif
@@ -143,8 +199,12 @@
 #error configuration: direct-only mode needs TRICE_DIRECT_OUTPUT == 1
 #endif
 
-#if (TRICE_DEFERRED_OUTPUT == 1) && (TRICE_DEFERRED_UARTA == 0) && (TRICE_DEFERRED_UARTB == 0) && (TRICE_DEFERRED_AUXILIARY8 == 0) && (TRICE_DEFERRED_AUXILIARY32 == 0)
-#error configuration: deferred output needs TRICE_DFERRED_UARTx or TRICE_DEFERRED_AUXILIARYx
+#if (TRICE_DEFERRED_OUTPUT == 1) && (TRICE_DEFERRED_UARTA == 0) && (TRICE_DEFERRED_UARTB == 0) && (TRICE_DEFERRED_AUXILIARY8 == 0) && (TRICE_DEFERRED_AUXILIARY32 == 0) && (TRICE_DEFERRED_FLASH == 0)
+#error configuration: deferred output needs TRICE_DFERRED_UARTx or TRICE_DEFERRED_AUXILIARYx or TRICE_DEFERRED_FLASH
+#endif
+
+#if (TRICE_DEFERRED_FLASH == 1) && (TRICE_DEFERRED_OUTPUT == 0)
+#error configuration: TRICE_DEFERRED_FLASH == 1 needs TRICE_DEFERRED_OUTPUT == 1.
 #endif
 
 #if (TRICE_DEFERRED_UARTA == 1) && !defined(TRICE_UARTA)
@@ -167,6 +227,18 @@
 #error All size values must be a multiple of 4!
 #endif
 
+#if defined(TRICE_GENERATED_DEFAULT_PARAMETER_BIT_WIDTH) && (TRICE_GENERATED_DEFAULT_PARAMETER_BIT_WIDTH != TRICE_DEFAULT_PARAMETER_BIT_WIDTH)
+#error configuration: triceGenerated.h was generated for a different TRICE_DEFAULT_PARAMETER_BIT_WIDTH, see trice insert -generatedHeader.
+#endif
+
+#if defined(TRICE_GENERATED_DATA_OFFSET_MIN) && (TRICE_DATA_OFFSET < TRICE_GENERATED_DATA_OFFSET_MIN) && (TRICE_CONFIG_WARNINGS == 1)
+#warning configuration: TRICE_DATA_OFFSET is smaller than TRICE_GENERATED_DATA_OFFSET_MIN from triceGenerated.h.
+#endif
+
+#if defined(TRICE_GENERATED_DEFERRED_BUFFER_SIZE_MIN) && (TRICE_BUFFER == TRICE_DOUBLE_BUFFER) && (TRICE_DEFERRED_BUFFER_SIZE / TRICE_DEFERRED_BUFFER_SEGMENTS < TRICE_GENERATED_DEFERRED_BUFFER_SIZE_MIN / 2) && (TRICE_CONFIG_WARNINGS == 1)
+#warning configuration: TRICE_DEFERRED_BUFFER_SIZE is smaller than TRICE_GENERATED_DEFERRED_BUFFER_SIZE_MIN from triceGenerated.h.
+#endif
+
 #if (TRICE_DIRECT_OUTPUT_IS_WITH_ROUTING == 1)
 #warning configuration: TRICE_DIRECT_OUTPUT_IS_WITH_ROUTING is experimental
 #endif
@@ -179,6 +251,34 @@
 #error configuration: (TRICE_DIRECT_AUXILIARY8 == 1) allows (TRICE_DIRECT_SEGGER_RTT_8BIT_WRITE == 1) but not (TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1)
 #endif
 
+#if (TRICE_DIAGNOSTICS_INTERVAL > 0) && ((TRICE_DIAGNOSTICS == 0) || (TRICE_DEFERRED_OUTPUT == 0))
+#error configuration: TRICE_DIAGNOSTICS_INTERVAL > 0 needs TRICE_DIAGNOSTICS == 1 and TRICE_DEFERRED_OUTPUT == 1
+#endif
+
+#if TRICE_DIAGNOSTICS_INTERVAL == 1
+#error configuration: TRICE_DIAGNOSTICS_INTERVAL == 1 would cause endless diagnostics output, because each diagnostics record needs a transfer too.
+#endif
+
+#if (TRICE_DEFERRED_COMPRESS == 1) && ((TRICE_DEFERRED_OUT_FRAMING == TRICE_FRAMING_NONE) || (TRICE_DEFERRED_XTEA_ENCRYPT == 1))
+#error configuration: TRICE_DEFERRED_COMPRESS == 1 needs COBS or TCOBS framing and is not implemented together with XTEA encryption.
+#endif
+
+#if (TRICE_DEFERRED_STREAM_ENCRYPT == 1) && ((TRICE_DEFERRED_XTEA_ENCRYPT == 1) || (TRICE_DEFERRED_OUT_FRAMING == TRICE_FRAMING_NONE) || (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE))
+#error configuration: TRICE_DEFERRED_STREAM_ENCRYPT == 1 needs COBS or TCOBS framing, TRICE_SINGLE_PACK_MODE and no TRICE_DEFERRED_XTEA_ENCRYPT.
+#endif
+
+#if (TRICE_DEFERRED_STREAM_ENCRYPT == 1) && !defined(TRICE_STREAM_NONCE)
+#error configuration: TRICE_DEFERRED_STREAM_ENCRYPT == 1 needs a per boot different TRICE_STREAM_NONCE value.
+#endif
+
+#if (TRICE_DEFERRED_COMPRESS == 1) && (TRICE_DEFERRED_COMPRESS_RESET_INTERVAL < 1)
+#error configuration: TRICE_DEFERRED_COMPRESS_RESET_INTERVAL needs to be > 0.
+#endif
+
+#if (TRICE_DIAGNOSTICS_INTERVAL > 0) && (TRICE_SINGLE_MAX_SIZE < 56)
+#error configuration: TRICE_DIAGNOSTICS_INTERVAL > 0 needs TRICE_SINGLE_MAX_SIZE >= 56 for the diagnostics record.
+#endif
+
 // function prototypes:
 
 #if TRICE_DEFERRED_UARTA == 1
@@ -190,7 +290,7 @@ void TriceNonBlockingWriteUartB(const void* buf, size_t nByte);
 #endif
 
 #if TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1
-static void SEGGER_Write_RTT0_NoCheck32(const uint32_t* pData, unsigned NumW);
+static void SEGGER_Write_RTT_NoCheck32(unsigned upChannel, const uint32_t* pData, unsigned NumW);
 #endif
 
 // global variables:
@@ -232,18 +332,56 @@ unsigned TriceDeferredOverflowCount = 0;
 
 #endif
 
+#if TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0
+
+#if TRICE_CGO == 0
+
+//! triceRttRoutedBuffer is the memory of the SEGGER RTT up-channel TRICE_SEGGER_RTT_ROUTED_CHANNEL.
+static uint8_t triceRttRoutedBuffer[TRICE_SEGGER_RTT_ROUTED_CHANNEL_SIZE];
+
+#endif
+
+//! TRICE_RTT_CHANNEL returns the SEGGER RTT up-channel for triceID.
+#define TRICE_RTT_CHANNEL(triceID) (TRICE_RTT_ROUTES_ID(triceID) ? TRICE_SEGGER_RTT_ROUTED_CHANNEL : 0)
+
+#else // #if TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0
+
+#define TRICE_RTT_CHANNEL(triceID) 0
+
+#endif // #else // #if TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0
+
 //! TriceInit needs to run before the first trice macro is executed.
 //! Not neseecary for all configurations.
 void TriceInit(void) {
 #if defined(SEGGER_RTT) && (TRICE_CGO == 0)
 	// This is just to force the INIT() call inside SEGGER_RTT.c what allows to use
-	// SEGGER_RTT_WriteNoLock or SEGGER_Write_RTT0_NoCheck32 instead of SEGGER_RTT_Write.
+	// SEGGER_RTT_WriteNoLock or SEGGER_Write_RTT_NoCheck32 instead of SEGGER_RTT_Write.
 	SEGGER_RTT_Write(0, 0, 0); // lint !e534
 #endif
 
+#if (TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0) && (TRICE_CGO == 0)
+	SEGGER_RTT_ConfigUpBuffer(TRICE_SEGGER_RTT_ROUTED_CHANNEL, "TriceRouted", triceRttRoutedBuffer, sizeof(triceRttRoutedBuffer), SEGGER_RTT_MODE_NO_BLOCK_SKIP); // lint !e534
+#endif
+
 #if (TRICE_DIRECT_XTEA_ENCRYPT == 1) || (TRICE_DEFERRED_XTEA_ENCRYPT == 1)
 	XTEAInitTable();
 #endif
+
+#if TRICE_DEFERRED_STREAM_ENCRYPT == 1
+	TriceStreamInit();
+#endif
+
+#if TRICE_POST_MORTEM == 1
+	TricePostMortemInit();
+#endif
+
+#if TRICE_DEFERRED_FLASH == 1
+	TriceFlashLogInit();
+#endif
+
+#if TRICE_IDENTITY == 1
+	TriceIdentity();
+#endif
 }
 
 //! triceDataLen returns encoded len.
@@ -387,6 +525,223 @@ size_t TriceEncode(unsigned encrypt, unsigned framing, uint8_t* dst, const uint8
 	return 0; // unexpected
 }
 
+#if TRICE_DEFERRED_COMPRESS == 1
+
+// Compressed trice layout: hdr [tyId] [stamp] count [cycle] params
+// - hdr bit 7:    tyId is dict[hdr bits 6-4], otherwise the 2 tyId bytes follow and get into the dictionary.
+// - hdr bit 3:    cycle is previous cycle + 1
+// - hdr bit 2:    params are zigzag varints of the 32-bit words, rest bytes raw. Otherwise all params bytes raw.
+// - hdr bit 1:    cycle is previous cycle
+// - hdr bit 0:    state reset before this trice
+// - stamp:        zigzag varint of the difference to the previous stamp with the same width
+// - count:        varint of (count<<1 | long count flag)
+// - cycle:        only, if no long count and hdr bits 3 and 1 are 0
+// The trice tool internal/trexDecoder/decompress.go mirrors this code.
+
+#define TRICE_COMPRESS_DICT_HIT 0x80
+#define TRICE_COMPRESS_CYCLE_NEXT 0x08
+#define TRICE_COMPRESS_VARINT 0x04
+#define TRICE_COMPRESS_CYCLE_SAME 0x02
+#define TRICE_COMPRESS_RESET 0x01
+
+#if ((TRICE_MCU_IS_BIG_ENDIAN == 1) && (TRICE_TRANSFER_ORDER_IS_NOT_MCU_ENDIAN == 0)) || ((TRICE_MCU_IS_BIG_ENDIAN == 0) && (TRICE_TRANSFER_ORDER_IS_NOT_MCU_ENDIAN == 1))
+#define TRICE_TRANSFER_IS_BIG_ENDIAN 1
+#else
+#define TRICE_TRANSFER_IS_BIG_ENDIAN 0
+#endif
+
+//! triceCompressBuffer holds the compressed trice. A compressed trice is max 3 bytes longer than its original.
+uint8_t triceCompressBuffer[TRICE_SINGLE_MAX_SIZE + 8];
+
+//! triceCompressState is the compression history. The trice tool keeps an identical copy.
+static struct {
+	uint16_t dict[8]; //!< recent tyId values in transfer order, 0 is never a valid tyId
+	unsigned next;    //!< next dictionary replace index
+	uint16_t stamp16; //!< previous 16-bit stamp
+	uint32_t stamp32; //!< previous 32-bit stamp
+	uint8_t cycle;    //!< previous cycle
+	unsigned count;   //!< trices since last reset
+} triceCompressState;
+
+#if TRICE_DIAGNOSTICS == 1
+
+//! TriceCompressInCount is the sum of all trice bytes before compression.
+unsigned TriceCompressInCount = 0;
+
+//! TriceCompressOutCount is the sum of all trice bytes after compression.
+unsigned TriceCompressOutCount = 0;
+
+#endif
+
+//! TriceCompressReset lets the next trice start with a fresh compression state, for example after a host reconnect.
+void TriceCompressReset(void) {
+	triceCompressState.count = 0;
+}
+
+//! triceGet returns the 16-bit (n==2) or 32-bit (n==4) value at p in transfer order.
+static uint32_t triceGet(const uint8_t* p, unsigned n) {
+	uint32_t v = 0;
+	for (unsigned i = 0; i < n; i++) {
+#if TRICE_TRANSFER_IS_BIG_ENDIAN == 1
+		v = (v << 8) | p[i];
+#else
+		v |= (uint32_t)p[i] << (8 * i);
+#endif
+	}
+	return v;
+}
+
+//! triceVarint writes v as LEB128 varint to p and returns the next write position.
+static uint8_t* triceVarint(uint8_t* p, uint32_t v) {
+	while (v >= 0x80) {
+		*p++ = (uint8_t)(v | 0x80);
+		v >>= 7;
+	}
+	*p++ = (uint8_t)v;
+	return p;
+}
+
+//! triceZigzag maps small negative and positive values to small unsigned values.
+static uint32_t triceZigzag(int32_t v) {
+	return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+//! TriceCompress expects at src a single trice with net length len and writes its compressed form to dst.
+//! \retval is the compressed length. It is max len + 3.
+size_t TriceCompress(uint8_t* dst, const uint8_t* src, size_t len) {
+	uint8_t* d = dst + 1; // behind the header byte
+	const uint8_t* s = src;
+	const uint8_t* limit = src + len;
+	uint8_t hdr = 0;
+	if (triceCompressState.count == 0) {
+		memset(&triceCompressState, 0, sizeof(triceCompressState));
+		hdr = TRICE_COMPRESS_RESET;
+	}
+	triceCompressState.count = triceCompressState.count + 1 < TRICE_DEFERRED_COMPRESS_RESET_INTERVAL ? triceCompressState.count + 1 : 0;
+
+	uint16_t tyId;
+	memcpy(&tyId, s, 2);
+	unsigned triceType = triceGet(s, 2) >> 14;
+	s += 2;
+	unsigned i;
+	for (i = 0; i < 8; i++) {
+		if (triceCompressState.dict[i] == tyId) {
+			break;
+		}
+	}
+	if (i < 8) {
+		hdr |= TRICE_COMPRESS_DICT_HIT | (i << 4);
+	} else {
+		*d++ = src[0];
+		*d++ = src[1];
+		triceCompressState.dict[triceCompressState.next] = tyId;
+		triceCompressState.next = (triceCompressState.next + 1) & 7;
+	}
+
+	if (triceType == TRICE_TYPE_S2) {
+		uint16_t stamp = (uint16_t)triceGet(s, 2);
+		d = triceVarint(d, triceZigzag((int16_t)(stamp - triceCompressState.stamp16)));
+		triceCompressState.stamp16 = stamp;
+		s += 2;
+	} else if (triceType == TRICE_TYPE_S4) {
+		uint32_t stamp = triceGet(s, 4);
+		d = triceVarint(d, triceZigzag((int32_t)(stamp - triceCompressState.stamp32)));
+		triceCompressState.stamp32 = stamp;
+		s += 4;
+	}
+
+	uint16_t nc = (uint16_t)triceGet(s, 2);
+	s += 2;
+	if (nc & 0x8000) {
+		d = triceVarint(d, ((uint32_t)(nc & 0x7fff) << 1) | 1);
+	} else {
+		uint8_t cycle = (uint8_t)nc;
+		d = triceVarint(d, (uint32_t)(nc >> 8) << 1);
+		if (cycle == (uint8_t)(triceCompressState.cycle + 1)) {
+			hdr |= TRICE_COMPRESS_CYCLE_NEXT;
+		} else if (cycle == triceCompressState.cycle) {
+			hdr |= TRICE_COMPRESS_CYCLE_SAME;
+		} else {
+			*d++ = cycle;
+		}
+		triceCompressState.cycle = cycle;
+	}
+
+	// Try varint coded params and fall back to raw params, if they get not shorter.
+	size_t n = limit - s;
+	uint8_t* p = d;
+	uint8_t* pLimit = d + n;
+	const uint8_t* w = s;
+	for (; w + 4 <= limit && p < pLimit; w += 4) { // p stays inside triceCompressBuffer
+		p = triceVarint(p, triceZigzag((int32_t)triceGet(w, 4)));
+	}
+	if (w + 4 > limit && p + (limit - w) < pLimit) {
+		memcpy(p, w, limit - w);
+		d = p + (limit - w);
+		hdr |= TRICE_COMPRESS_VARINT;
+	} else {
+		memcpy(d, s, n);
+		d += n;
+	}
+	*dst = hdr;
+#if TRICE_DIAGNOSTICS == 1
+	TriceCompressInCount += len;
+	TriceCompressOutCount += d - dst;
+#endif
+	return d - dst;
+}
+
+#endif // #if TRICE_DEFERRED_COMPRESS == 1
+
+#if TRICE_DEFERRED_STREAM_ENCRYPT == 1
+
+//! triceStreamBuffer holds the encrypted trice with the package counter in front. The compressed trice can be 3 bytes longer.
+uint8_t triceStreamBuffer[8 + TRICE_SINGLE_MAX_SIZE + 8];
+
+//! triceStreamNonce is the TRICE_STREAM_NONCE value of this boot.
+static uint32_t triceStreamNonce;
+
+//! triceStreamCounter is the package counter. Each package gets its own key stream.
+static uint32_t triceStreamCounter;
+
+//! TriceStreamInit is called by TriceInit.
+void TriceStreamInit(void) {
+	SpeckInitTable();
+	triceStreamNonce = TRICE_STREAM_NONCE;
+	triceStreamCounter = 0;
+}
+
+//! TriceStreamEncrypt writes the package counter and the trice at src with length len XOR-ed with the key stream into dst.
+//! The key stream is the Speck encrypted counter block {package counter, nonce ^ (block index << 24)}, so no padding is needed.
+//! Each 256th package carries also the nonce and the counter high part, so the trice tool can synchronize at any time.
+//! \retval is the package length in dst.
+size_t TriceStreamEncrypt(uint8_t* dst, const uint8_t* src, size_t len) {
+	uint32_t c = triceStreamCounter++;
+	uint8_t* p = dst;
+	*p++ = (uint8_t)c;
+	*p++ = (uint8_t)(c >> 8);
+	if ((c & 0xff) == 0) { // sync package
+		*p++ = (uint8_t)triceStreamNonce;
+		*p++ = (uint8_t)(triceStreamNonce >> 8);
+		*p++ = (uint8_t)(triceStreamNonce >> 16);
+		*p++ = (uint8_t)(triceStreamNonce >> 24);
+		*p++ = (uint8_t)(c >> 16);
+		*p++ = (uint8_t)(c >> 24);
+	}
+	for (uint32_t block = 0; len; block++) {
+		uint32_t ks[2] = {c, triceStreamNonce ^ (block << 24)};
+		SpeckEncrypt(ks);
+		size_t n = len < 8 ? len : 8;
+		for (size_t i = 0; i < n; i++) {
+			*p++ = *src++ ^ (uint8_t)(ks[i >> 2] >> ((i & 3) << 3)); // little endian key stream byte order
+		}
+		len -= n;
+	}
+	return p - dst;
+}
+
+#endif // #if TRICE_DEFERRED_STREAM_ENCRYPT == 1
+
 #if (TRICE_DIAGNOSTICS == 1) && defined(SEGGER_RTT)
 
 unsigned RTT0_writeDepthMax = 0; //!< RTT0_writeDepthMax is usable for diagnostics.
@@ -444,18 +799,47 @@ static void triceSeggerRTTDiagnostics(void) {
 
 #if TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1
 
-//! SEGGER_Write_RTT0_NoCheck32 was derived from SEGGER_RTT.c version 7.60g function _WriteNoCheck for speed reasons. If using a different version please review the code first.
-static void SEGGER_Write_RTT0_NoCheck32(const uint32_t* pData, unsigned NumW) {
-#if TRICE_CGO == 1 // automated tests
-	TriceWriteDeviceCgo(pData, NumW << 2);
-#else // #if TRICE_CGO == 1
+#if (TRICE_CGO == 1) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1) // automated tests
+
+//! triceCgoRtt0Buffer replaces the SEGGER RTT up-buffer 0 memory in automated tests.
+static uint32_t triceCgoRtt0Buffer[BUFFER_SIZE_UP >> 2];
+
+//! triceCgoRtt0 replaces the SEGGER RTT up-buffer 0 control block in automated tests. triceCgoRtt0Read plays the J-Link part.
+static SEGGER_RTT_BUFFER_UP triceCgoRtt0 = {"Terminal", (char*)triceCgoRtt0Buffer, BUFFER_SIZE_UP, 0, 0, 0};
+
+#define TRICE_RTT_UP(upChannel) (&triceCgoRtt0)
+
+//! triceCgoRtt0Read copies the published up-buffer 0 data to the test output like the J-Link does.
+static void triceCgoRtt0Read(void) {
+	unsigned WrOff = triceCgoRtt0.WrOff;
+	unsigned RdOff = triceCgoRtt0.RdOff;
+	if (WrOff < RdOff) { // wrapped
+		TriceWriteDeviceCgo(triceCgoRtt0.pBuffer + RdOff, triceCgoRtt0.SizeOfBuffer - RdOff);
+		RdOff = 0;
+	}
+	TriceWriteDeviceCgo(triceCgoRtt0.pBuffer + RdOff, WrOff - RdOff);
+	triceCgoRtt0.RdOff = WrOff;
+}
+
+#else // #if (TRICE_CGO == 1) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1)
+
+//! TRICE_RTT_UP is the "to-host" ring buffer of upChannel. Access uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly.
+#define TRICE_RTT_UP(upChannel) ((SEGGER_RTT_BUFFER_UP*)((char*)&_SEGGER_RTT.aUp[upChannel] + SEGGER_RTT_UNCACHED_OFF))
+
+#endif // #else // #if (TRICE_CGO == 1) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1)
+
+//! SEGGER_Write_RTT_NoCheck32 was derived from SEGGER_RTT.c version 7.60g function _WriteNoCheck for speed reasons. If using a different version please review the code first.
+static void SEGGER_Write_RTT_NoCheck32(unsigned upChannel, const uint32_t* pData, unsigned NumW) {
+#if (TRICE_CGO == 1) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 0) // automated tests
+	TriceWriteDeviceCgoRtt(upChannel, pData, NumW << 2);
+#else // #if (TRICE_CGO == 1) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 0)
 
 	unsigned NumWordsAtOnce;
 	unsigned WrOff;
 	unsigned RemW;
 
-#if TRICE_PROTECT == 1
-	unsigned space = SEGGER_RTT_GetAvailWriteSpace(0);
+#if (TRICE_PROTECT == 1) && (TRICE_CGO == 0)
+	unsigned space = SEGGER_RTT_GetAvailWriteSpace(upChannel);
 	if (space < NumW << 2) {
 		for (;;)
 			;
@@ -463,7 +847,7 @@ static void SEGGER_Write_RTT0_NoCheck32(const uint32_t* pData, unsigned NumW) {
 #endif
 
 	// Get "to-host" ring buffer.
-	static SEGGER_RTT_BUFFER_UP* const pRingUp0 = (SEGGER_RTT_BUFFER_UP*)((char*)&_SEGGER_RTT.aUp[0] + SEGGER_RTT_UNCACHED_OFF); // Access uncached to make sure we see changes made by the J-Link side and all of our changes go into HW directly
+	SEGGER_RTT_BUFFER_UP* const pRingUp0 = TRICE_RTT_UP(upChannel);
 	WrOff = pRingUp0->WrOff;
 	RemW = (pRingUp0->SizeOfBuffer - WrOff) >> 2;
 	volatile uint32_t* pDstW = (uint32_t*)((pRingUp0->pBuffer + WrOff) + SEGGER_RTT_UNCACHED_OFF); // lint !e826
@@ -493,7 +877,7 @@ static void SEGGER_Write_RTT0_NoCheck32(const uint32_t* pData, unsigned NumW) {
 	triceSeggerRTTDiagnostics();
 #endif
 
-#endif // #else // #if TRICE_CGO == 1
+#endif // #else // #if (TRICE_CGO == 1) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 0)
 }
 
 #endif // #if TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1
@@ -520,7 +904,8 @@ static unsigned directXEncode32(uint32_t* enc, const void* buf, unsigned count)
 
 #endif // #if (TRICE_DIRECT_OUT_FRAMING == TRICE_FRAMING_COBS) ||  (TRICE_DIRECT_OUT_FRAMING == TRICE_FRAMING_TCOBS)
 
-static void TriceDirectWrite32(const uint32_t* buf, unsigned count) {
+//! TriceDirectWrite32 writes count words from buf to the direct 32-bit outputs. upChannel is the SEGGER RTT up-channel to use.
+static void TriceDirectWrite32(unsigned upChannel, const uint32_t* buf, unsigned count) {
 
 #if TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1
 
@@ -529,30 +914,68 @@ static void TriceDirectWrite32(const uint32_t* buf, unsigned count) {
 #if TRICE_CGO == 1               // automated tests
 	unsigned space = count << 2; // always enough space
 #else
-	unsigned space = SEGGER_RTT_GetAvailWriteSpace(0);
+	unsigned space = SEGGER_RTT_GetAvailWriteSpace(upChannel);
 #endif
 
 	if (space >= count << 2) {
-		SEGGER_Write_RTT0_NoCheck32(buf, count);
+		SEGGER_Write_RTT_NoCheck32(upChannel, buf, count);
 	} else {
 		TriceDirectOverflowCount++;
 	}
 
 #else  // #if TRICE_PROTECT == 1
-	SEGGER_Write_RTT0_NoCheck32(buf, count);
+	SEGGER_Write_RTT_NoCheck32(upChannel, buf, count);
 #endif // #else // #if TRICE_PROTECT == 1
 
 #if TRICE_DIAGNOSTICS == 1
 	triceSeggerRTTDiagnostics(); // todo: maybe not needed
 #endif
 
-#endif // #if TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1
+#else  // #if TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1
+	TRICE_UNUSED(upChannel)
+#endif // #else // #if TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1
 
 #if TRICE_DIRECT_AUXILIARY32 == 1
 	TriceNonBlockingDirectWrite32Auxiliary(buf, count);
 #endif // #if TRICE_DIRECT_AUXILIARY32 == 1
 }
 
+#if TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1
+
+//! TriceRTT0Reserve returns the write address for the next trice and is called inside TRICE_ENTER.
+//! That is the RTT up-buffer 0 write position, when more than TRICE_SINGLE_MAX_SIZE + 4 (padding scratch) bytes are free there without wrap.
+//! The host does not see these data before TriceRTT0Commit moves WrOff. Otherwise the static buffer is returned as bounce buffer.
+uint32_t* TriceRTT0Reserve(void) {
+	SEGGER_RTT_BUFFER_UP* const pRingUp0 = TRICE_RTT_UP(0);
+	unsigned WrOff = pRingUp0->WrOff;
+	unsigned RdOff = pRingUp0->RdOff;
+	unsigned contiguous = RdOff > WrOff ? RdOff - WrOff : pRingUp0->SizeOfBuffer - WrOff;
+	if (contiguous > TRICE_SINGLE_MAX_SIZE + 4) { // WrOff stays below RdOff and below the buffer end this way.
+		return (uint32_t*)((pRingUp0->pBuffer + WrOff) + SEGGER_RTT_UNCACHED_OFF); // lint !e826
+	}
+	return triceSingleBufferStartWritePosition;
+}
+
+//! TriceRTT0Commit publishes the trice with wordCount words at triceStart and is called inside TRICE_LEAVE.
+//! Only a trice inside the bounce buffer is copied, with wrap and TRICE_PROTECT check, like with TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE.
+void TriceRTT0Commit(uint32_t* triceStart, unsigned wordCount) {
+	if (triceStart == triceSingleBufferStartWritePosition) {
+		TriceDirectWrite32(0, triceStart, wordCount);
+	} else {
+		SEGGER_RTT_BUFFER_UP* const pRingUp0 = TRICE_RTT_UP(0);
+		RTT__DMB(); // Force data write to be complete before writing the <WrOff>, in case CPU is allowed to change the order of memory accesses
+		pRingUp0->WrOff += wordCount << 2;
+#if TRICE_DIAGNOSTICS == 1
+		triceSeggerRTTDiagnostics();
+#endif
+	}
+#if TRICE_CGO == 1
+	triceCgoRtt0Read();
+#endif
+}
+
+#endif // #if TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1
+
 #endif // #if TRICE_DIRECT32
 
 #if TRICE_DIRECT8
@@ -579,21 +1002,22 @@ static size_t directXEncode8(void* enc, const void* buf, unsigned len) {
 
 #if (TRICE_DIRECT_SEGGER_RTT_8BIT_WRITE == 1) || (TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE == 1)
 
-static void TriceWriteDeviceRtt0(const uint8_t* enc, size_t encLen) {
+//! TriceWriteDeviceRtt writes encLen bytes from enc into the SEGGER RTT up-channel upChannel.
+static void TriceWriteDeviceRtt(unsigned upChannel, const uint8_t* enc, size_t encLen) {
 
 #if TRICE_CGO == 1 // automated tests
-	TriceWriteDeviceCgo(enc, encLen);
+	TriceWriteDeviceCgoRtt(upChannel, enc, encLen);
 #else // #if TRICE_CGO == 1
 
 #if TRICE_PROTECT == 1
-	unsigned space = SEGGER_RTT_GetAvailWriteSpace(0);
+	unsigned space = SEGGER_RTT_GetAvailWriteSpace(upChannel);
 	if (encLen <= space) {
-		SEGGER_RTT_WriteNoLock(0, enc, encLen);
+		SEGGER_RTT_WriteNoLock(upChannel, enc, encLen);
 	} else {
 		TriceDirectOverflowCount++;
 	}
 #else  // #if TRICE_PROTECT == 1
-	SEGGER_RTT_WriteNoLock(0, enc, encLen);
+	SEGGER_RTT_WriteNoLock(upChannel, enc, encLen);
 #endif // #else // #if TRICE_PROTECT == 1
 
 #endif // #else // #if TRICE_CGO == 1
@@ -605,9 +1029,12 @@ static void TriceWriteDeviceRtt0(const uint8_t* enc, size_t encLen) {
 
 #endif // #if (TRICE_DIRECT_SEGGER_RTT_8BIT_WRITE == 1) || (TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE == 1)
 
-static void TriceDirectWrite8(const uint8_t* enc, size_t encLen) {
+//! TriceDirectWrite8 writes encLen bytes from enc to the direct 8-bit outputs. upChannel is the SEGGER RTT up-channel to use.
+static void TriceDirectWrite8(unsigned upChannel, const uint8_t* enc, size_t encLen) {
 #if TRICE_DIRECT_SEGGER_RTT_8BIT_WRITE == 1
-	TriceWriteDeviceRtt0(enc, encLen);
+	TriceWriteDeviceRtt(upChannel, enc, encLen);
+#else
+	TRICE_UNUSED(upChannel)
 #endif
 
 #if TRICE_DIRECT_AUXILIARY8
@@ -640,6 +1067,13 @@ void TriceNonBlockingDirectWrite(uint32_t* triceStart, unsigned wordCount) {
 
 	// What happens here, is similar to TriceEncode but this is time critical code and we can do in-place encoding too.
 
+#if TRICE_SEGGER_RTT_ROUTED_CHANNEL > 0
+	int triceID = 0x3FFF & TRICE_TTOHS(*(uint16_t*)triceStart); // lint !e826 The 16-bit stamped trices start with the doubled ID too.
+	unsigned upChannel = TRICE_RTT_CHANNEL(triceID);
+#else
+	unsigned upChannel = 0;
+#endif
+
 #if TRICE_DIRECT32_ONLY // Space at triceStart + wordCount is usable and we can destroy the data.
 
 #if (TRICE_DIRECT_XTEA_ENCRYPT == 1)
@@ -652,11 +1086,11 @@ void TriceNonBlockingDirectWrite(uint32_t* triceStart, unsigned wordCount) {
 	uint32_t* enc = triceStart;
 	unsigned count = wordCount;
 #else
-	static uint32_t enc[TRICE_BUFFER_SIZE >> 2]; // static buffer!
+	static TRICE_THREAD_LOCAL uint32_t enc[TRICE_BUFFER_SIZE >> 2]; // static buffer!
 	unsigned count = directXEncode32(enc, triceStart, wordCount);
 #endif
 
-	TriceDirectWrite32(enc, count);
+	TriceDirectWrite32(upChannel, enc, count);
 	return;
 
 #elif TRICE_DIRECT8_ONLY // Space at triceStart + wordCount is usable and we can destroy the data.
@@ -671,17 +1105,17 @@ void TriceNonBlockingDirectWrite(uint32_t* triceStart, unsigned wordCount) {
 	uint8_t* enc = (uint8_t*)triceStart;
 	unsigned len = wordCount << 2;
 #else
-	static uint8_t enc[TRICE_BUFFER_SIZE];                          // stack buffer!
+	static TRICE_THREAD_LOCAL uint8_t enc[TRICE_BUFFER_SIZE];       // stack buffer!
 	unsigned len = directXEncode8(enc, triceStart, wordCount << 2); // Up to 3 trailing zeroes are packed as well here.
 #endif
 
-	TriceDirectWrite8(enc, len);
+	TriceDirectWrite8(upChannel, enc, len);
 	return;
 
 #elif TRICE_DIRECT32_ALSO // Space at triceStart + wordCount is NOT usable and we can NOT destroy the data.
 
 #if (TRICE_DIRECT_XTEA_ENCRYPT == 1) || (TRICE_DIRECT_OUT_FRAMING != TRICE_FRAMING_NONE)
-	static uint32_t enc[TRICE_BUFFER_SIZE >> 2]; // stack buffer!
+	static TRICE_THREAD_LOCAL uint32_t enc[TRICE_BUFFER_SIZE >> 2]; // stack buffer!
 #endif
 
 #if (TRICE_DIRECT_XTEA_ENCRYPT == 1)
@@ -695,17 +1129,17 @@ void TriceNonBlockingDirectWrite(uint32_t* triceStart, unsigned wordCount) {
 #endif
 
 #if (TRICE_DIRECT_OUT_FRAMING == TRICE_FRAMING_NONE)
-	TriceDirectWrite32(dat, wordCount);
+	TriceDirectWrite32(upChannel, dat, wordCount);
 #else
 	unsigned count = directXEncode32(enc, dat, wordCount); // Up to 3 trailing zeroes are packed as well here.
-	TriceDirectWrite32(enc, count);
+	TriceDirectWrite32(upChannel, enc, count);
 #endif
 
 	return;
 
 #elif TRICE_DIRECT8_ALSO // Space at triceStart + wordCount is NOT usable and we can NOT destroy the data.
 
-	static uint32_t enc[TRICE_BUFFER_SIZE >> 2]; // stack buffer!
+	static TRICE_THREAD_LOCAL uint32_t enc[TRICE_BUFFER_SIZE >> 2]; // stack buffer!
 
 #if (TRICE_DIRECT_XTEA_ENCRYPT == 1)
 	uint32_t* dat = enc + (TRICE_DATA_OFFSET >> 2);
@@ -718,10 +1152,10 @@ void TriceNonBlockingDirectWrite(uint32_t* triceStart, unsigned wordCount) {
 #endif
 
 #if (TRICE_DIRECT_OUT_FRAMING == TRICE_FRAMING_NONE)
-	TriceDirectWrite8((uint8_t*)dat, wordCount << 2);
+	TriceDirectWrite8(upChannel, (uint8_t*)dat, wordCount << 2);
 #else
 	unsigned len = directXEncode8(enc, dat, wordCount << 2); // Up to 3 trailing zeroes are packed as well here.
-	TriceDirectWrite8((uint8_t*)enc, len);
+	TriceDirectWrite8(upChannel, (uint8_t*)enc, len);
 #endif
 
 	return;
@@ -771,6 +1205,17 @@ void TriceNonBlockingDeferredWrite8(int triceID, const uint8_t* enc, size_t encL
 	}
 #endif
 
+#if (TRICE_DEFERRED_FLASH == 1)
+#if defined(TRICE_DEFERRED_FLASH_MIN_ID) && defined(TRICE_DEFERRED_FLASH_MAX_ID)
+	if ((TRICE_DEFERRED_FLASH_MIN_ID < triceID) && (triceID < TRICE_DEFERRED_FLASH_MAX_ID))
+#else
+	TRICE_UNUSED(triceID)
+#endif
+	{
+		TriceNonBlockingDeferredWriteFlash(enc, encLen);
+	}
+#endif
+
 #if (TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE == 1)
 #if defined(TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE_MIN_ID) && defined(TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE_MAX_ID)
 	if ((TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE_MIN_ID < triceID) && (triceID < TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE_MAX_ID))
@@ -778,7 +1223,7 @@ void TriceNonBlockingDeferredWrite8(int triceID, const uint8_t* enc, size_t encL
 	TRICE_UNUSED(triceID)
 #endif
 	{
-		TriceWriteDeviceRtt0(enc, encLen);
+		TriceWriteDeviceRtt(TRICE_RTT_CHANNEL(triceID), enc, encLen);
 	}
 #endif
 
@@ -815,6 +1260,11 @@ unsigned TriceOutDepth(void) {
 	depth = d > depth ? d : depth;
 #endif
 
+#if TRICE_DEFERRED_FLASH == 1
+	d = TriceOutDepthFlash();
+	depth = d > depth ? d : depth;
+#endif
+
 #if TRICE_CGO == 1 // automated tests
 	d = TriceOutDepthCGO();
 	depth = d > depth ? d : depth;
@@ -877,6 +1327,86 @@ void TRiceAssertFalse(int idN, char* msg, int flag) {
 	}
 }
 
+#if (TRICE_DIAGNOSTICS == 1) && (TRICE_SINGLE_MAX_SIZE >= 56)
+
+//! TriceLogDiagnostics emits all diagnostic values as one compact record with the reserved ID TRICE_DIAGNOSTICS_ID.
+//! The trice tool knows the record layout and decodes it without til.json entry into structured values:
+//! - 0: TriceErrorCount
+//! - 1: TriceDirectOverflowCount (0 when TRICE_PROTECT == 0)
+//! - 2: TriceDeferredOverflowCount (0 when TRICE_PROTECT == 0)
+//! - 3: TriceDynBufTruncateCount
+//! - 4: max used single trice buffer space (TRICE_DATA_OFFSET + 4 * TriceSingleMaxWordCount) and 5: TRICE_BUFFER_SIZE
+//! - 6: TriceDataOffsetDepthMax and 7: TRICE_DATA_OFFSET
+//! - 8: TriceHalfBufferDepthMax or TriceRingBufferDepthMax and 9: the appropriate capacity (0 for direct-only modes)
+//! - 10: RTT0_writeDepthMax and 11: BUFFER_SIZE_UP (0 without SEGGER RTT)
+//! Use this function as alternative to the user-written TriceLogDiagnosticValues.
+void TriceLogDiagnostics(void) {
+#if TRICE_PROTECT == 1
+	unsigned directOverflowCount = TriceDirectOverflowCount;
+	unsigned deferredOverflowCount = TriceDeferredOverflowCount;
+#else
+	unsigned directOverflowCount = 0;
+	unsigned deferredOverflowCount = 0;
+#endif
+#if TRICE_BUFFER == TRICE_DOUBLE_BUFFER
+	unsigned deferredDepthMax = TriceHalfBufferDepthMax;
+	unsigned deferredSize = TRICE_DEFERRED_BUFFER_SIZE / TRICE_DEFERRED_BUFFER_SEGMENTS;
+#elif (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_RING_BUFFER_EXACT == 1)
+	unsigned deferredDepthMax = TriceRingBufferDepthMax;
+	unsigned deferredSize = TRICE_RING_BUFFER_EXACT_SIZE;
+#elif TRICE_BUFFER == TRICE_RING_BUFFER
+	unsigned deferredDepthMax = TriceRingBufferDepthMax;
+	unsigned deferredSize = TRICE_DEFERRED_BUFFER_SIZE;
+#else
+	unsigned deferredDepthMax = 0;
+	unsigned deferredSize = 0;
+#endif
+#ifdef SEGGER_RTT
+	unsigned rttDepthMax = RTT0_writeDepthMax;
+	unsigned rttSize = BUFFER_SIZE_UP;
+#else
+	unsigned rttDepthMax = 0;
+	unsigned rttSize = 0;
+#endif
+	unsigned triceSingleDepthMax = TRICE_DATA_OFFSET + (TriceSingleMaxWordCount << 2);
+	TRICE32_12(ID(TRICE_DIAGNOSTICS_ID), "diag:%u %u %u %u %u %u %d %u %u %u %u %u\n",
+	           TriceErrorCount, directOverflowCount, deferredOverflowCount, TriceDynBufTruncateCount,
+	           triceSingleDepthMax, TRICE_BUFFER_SIZE, TriceDataOffsetDepthMax, TRICE_DATA_OFFSET,
+	           deferredDepthMax, deferredSize, rttDepthMax, rttSize);
+}
+
+#endif // #if (TRICE_DIAGNOSTICS == 1) && (TRICE_SINGLE_MAX_SIZE >= 56)
+
+//! TriceClockSync emits a parameterless trice with the reserved ID TRICE_CLOCK_SYNC_ID and a 32-bit stamp.
+//! The trice tool does not display it, but uses its stamp for the target clock correlation (trice log -correlate).
+//! Call it periodically, for example once per second, when the target logs seldom or with 16-bit stamps only.
+//! Calling it right after a transfer gives the best fit, because the trice is not delayed by queued trices then.
+void TriceClockSync(void) {
+	TRICE0(ID(TRICE_CLOCK_SYNC_ID), "sig:clock sync\n");
+}
+
+//! TriceIdentity emits a trice with the reserved ID TRICE_IDENTITY_ID and the til.json hash TRICE_TIL_HASH.
+//! The trice tool decodes the following trices of this target with the matching til.json version (trice log -tilCache).
+//! Call it at startup (see TRICE_IDENTITY) and optionally periodically, so a later started trice tool finds the version too.
+void TriceIdentity(void) {
+	TRICE32_1(id(TRICE_IDENTITY_ID), "sig:firmware til.json %08x\n", TRICE_TIL_HASH);
+}
+
+#if TRICE_DIAGNOSTICS_INTERVAL > 0
+
+//! TriceDiagnosticsTick is called by TriceTransfer after each deferred transfer and
+//! emits every TRICE_DIAGNOSTICS_INTERVAL calls a diagnostics record.
+void TriceDiagnosticsTick(void) {
+	static unsigned transferCount = 0;
+	transferCount++;
+	if (transferCount >= TRICE_DIAGNOSTICS_INTERVAL) {
+		transferCount = 0;
+		TriceLogDiagnostics();
+	}
+}
+
+#endif // #if TRICE_DIAGNOSTICS_INTERVAL > 0
+
 #endif // #else // #if TRICE_OFF == 1 || TRICE_CLEAN == 1
 
 #ifdef TRICE_N
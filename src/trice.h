@@ -241,6 +241,19 @@ void WatchRingBufferMargins(void);
 
 #endif
 
+#if TRICE_LINUX == 1
+
+#include <time.h>
+
+//! TriceLinuxStamp32 returns the monotonic clock in microseconds as 32-bit value. It is the default TriceStamp32 for TRICE_LINUX == 1.
+TRICE_INLINE uint32_t TriceLinuxStamp32(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint32_t)ts.tv_sec * 1000000u + (uint32_t)(ts.tv_nsec / 1000);
+}
+
+#endif
+
 // global function prototypes:
 
 void TriceCheck(int index); //!< tests and examples
@@ -254,6 +267,10 @@ void TriceNonBlockingDirectWrite32Auxiliary(const uint32_t* enc, unsigned count)
 void TriceNonBlockingDeferredWrite32Auxiliary(const uint32_t* enc, unsigned count);
 void TriceInit(void);
 void TriceLogDiagnosticValues(void);
+void TriceLogDiagnostics(void);
+void TriceDiagnosticsTick(void);
+void TriceClockSync(void);
+void TriceIdentity(void);
 void TriceLogSeggerDiagnostics(void);
 void TriceNonBlockingDeferredWrite8(int ticeID, const uint8_t* enc, size_t encLen);
 void TriceTransfer(void);
@@ -267,6 +284,9 @@ size_t TriceEncode(unsigned encrypt, unsigned framing, uint8_t* dst, const uint8
 void TriceWriteDeviceCgo(const void* buf, unsigned len); //!< TriceWriteDeviceCgo is only needed for testing C-sources from Go.
 unsigned TriceOutDepthCGO(void);                         //!< TriceOutDepthCGO is only needed for testing C-sources from Go.
 
+//! TriceWriteDeviceCgoRtt is only needed for testing C-sources from Go. It records the SEGGER RTT up-channel.
+void TriceWriteDeviceCgoRtt(unsigned upChannel, const void* buf, unsigned len);
+
 // global defines
 
 #define TRICE_TYPE_X0 0 //!< TRICE_TYPE_X0 is an unspecified trice (reserved)
@@ -290,8 +310,49 @@ extern uint32_t* const TriceRingBufferStart;
 extern uint32_t* const triceRingBufferLimit;
 extern int TriceRingBufferDepthMax;
 
+#if TRICE_RING_BUFFER_EXACT == 1
+
+extern uint32_t TriceRingBufferStaging[];
+void TriceRingBufferCommit(unsigned wordCount);
+
+#endif
+
+#if TRICE_POST_MORTEM == 1
+
+void TricePostMortemInit(void);
+
+#endif
+
 #endif // #if (TRICE_BUFFER == TRICE_RING_BUFFER)
 
+#if TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1
+
+uint32_t* TriceRTT0Reserve(void);
+void TriceRTT0Commit(uint32_t* triceStart, unsigned wordCount);
+
+#endif
+
+#if TRICE_DEFERRED_COMPRESS == 1
+
+extern uint8_t triceCompressBuffer[];
+void TriceCompressReset(void);
+size_t TriceCompress(uint8_t* dst, const uint8_t* src, size_t len);
+
+#if TRICE_DIAGNOSTICS == 1
+extern unsigned TriceCompressInCount;
+extern unsigned TriceCompressOutCount;
+#endif
+
+#endif // #if TRICE_DEFERRED_COMPRESS == 1
+
+#if TRICE_DEFERRED_STREAM_ENCRYPT == 1
+
+extern uint8_t triceStreamBuffer[];
+void TriceStreamInit(void);
+size_t TriceStreamEncrypt(uint8_t* dst, const uint8_t* src, size_t len);
+
+#endif
+
 #if (TRICE_DIAGNOSTICS == 1)
 
 extern int TriceDataOffsetDepthMax;
@@ -332,6 +393,14 @@ extern uint32_t* TriceBufferWritePosition;
 //! trice gets formally the padding space cleared.
 #define TRICE_BUFFER_SIZE (TRICE_DATA_OFFSET + TRICE_SINGLE_MAX_SIZE + 4)
 
+#if TRICE_RING_BUFFER_EXACT == 1
+
+//! TRICE_RING_BUFFER_EXACT_SIZE is the ring buffer size, when TRICE_RING_BUFFER_EXACT == 1. The staging buffer and the read buffer
+//! are taken from TRICE_DEFERRED_BUFFER_SIZE and the TRICE_DATA_OFFSET space in front, so the RAM is the same as without.
+#define TRICE_RING_BUFFER_EXACT_SIZE (TRICE_DEFERRED_BUFFER_SIZE + TRICE_DATA_OFFSET - 2 * TRICE_BUFFER_SIZE)
+
+#endif
+
 #if TRICE_CYCLE_COUNTER == 1
 
 #define TRICE_CYCLE TriceCycle++ //! TRICE_CYCLE is the trice cycle counter as 8 bit count 0-255.
@@ -387,7 +456,7 @@ extern uint32_t* TriceBufferWritePosition;
 
 	#endif // #if TRICE_BUFFER == TRICE_STACK_BUFFER
 
-	#if TRICE_BUFFER == TRICE_STATIC_BUFFER
+	#if (TRICE_BUFFER == TRICE_STATIC_BUFFER) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 0)
 
 		//! TRICE_ENTER is the start of TRICE macro.
 		#define TRICE_ENTER                \
@@ -395,7 +464,18 @@ extern uint32_t* TriceBufferWritePosition;
 				{                          \
 					uint32_t* TriceBufferWritePosition = triceSingleBufferStartWritePosition;
 
-	#endif // #if TRICE_BUFFER == TRICE_STATIC_BUFFER
+	#endif // #if (TRICE_BUFFER == TRICE_STATIC_BUFFER) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 0)
+
+	#if (TRICE_BUFFER == TRICE_STATIC_BUFFER) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1)
+
+		//! TRICE_ENTER is the start of TRICE macro. The trice is written directly into the RTT up-buffer 0, if possible.
+		#define TRICE_ENTER                                                                   \
+			TRICE_ENTER_CRITICAL_SECTION {                                                    \
+				{                                                                             \
+					uint32_t* const triceSingleBufferStartWritePosition = TriceRTT0Reserve(); \
+					uint32_t* TriceBufferWritePosition = triceSingleBufferStartWritePosition;
+
+	#endif // #if (TRICE_BUFFER == TRICE_STATIC_BUFFER) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1)
 
 	#if (TRICE_BUFFER == TRICE_DOUBLE_BUFFER) && (TRICE_DIRECT_OUTPUT == 1)
 
@@ -441,7 +521,7 @@ extern uint32_t* TriceBufferWritePosition;
 
 	#endif // #if (TRICE_BUFFER == TRICE_DOUBLE_BUFFER) && (TRICE_DIRECT_OUTPUT == 0)
 
-	#if (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_DIRECT_OUTPUT == 1)
+	#if (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_RING_BUFFER_EXACT == 0) && (TRICE_DIRECT_OUTPUT == 1)
 
 		#if TRICE_PROTECT == 1
 
@@ -477,7 +557,7 @@ extern uint32_t* TriceBufferWritePosition;
 
 	#endif // #if TRICE_BUFFER == TRICE_RING_BUFFER && (TRICE_DIRECT_OUTPUT == 1)
 
-	#if (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_DIRECT_OUTPUT == 0)
+	#if (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_RING_BUFFER_EXACT == 0) && (TRICE_DIRECT_OUTPUT == 0)
 
 		#if TRICE_PROTECT == 1
 
@@ -505,11 +585,57 @@ extern uint32_t* TriceBufferWritePosition;
 
 	#endif // #if TRICE_BUFFER == TRICE_RING_BUFFER && (TRICE_DIRECT_OUTPUT == 0)
 
+	#if (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_RING_BUFFER_EXACT == 1)
+
+		//! TRICE_ENTER is the start of TRICE macro. The Trice is written into the staging buffer first, because its size is unknown here.
+		//! TRICE_LEAVE copies it then into the ring buffer, if there is enough space for exactly this Trice. So no TriceEnoughSpace call is needed.
+		#define TRICE_ENTER                                                                                                        \
+			TRICE_ENTER_CRITICAL_SECTION {                                                                                         \
+				{                                                                                                                  \
+					TriceBufferWritePosition = &TriceRingBufferStaging[TRICE_DATA_OFFSET >> 2]; /* space for in buffer encoding */ \
+					uint32_t* const triceSingleBufferStartWritePosition = TriceBufferWritePosition;
+
+	#endif // #if (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_RING_BUFFER_EXACT == 1)
+
 #endif // #ifndef TRICE_ENTER
 
 #ifndef TRICE_LEAVE
 
-	#if TRICE_DIRECT_OUTPUT == 1
+	#if (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_RING_BUFFER_EXACT == 1) && (TRICE_DIRECT_OUTPUT == 1)
+
+		//! TRICE_LEAVE is the end of TRICE macro. The Trice is committed into the ring buffer before the direct write is allowed to modify it.
+		#define TRICE_LEAVE                                                                      \
+			unsigned wordCount = TriceBufferWritePosition - triceSingleBufferStartWritePosition; \
+			TRICE_DIAGNOSTICS_SINGLE_BUFFER_USING_WORD_COUNT                                     \
+			TriceRingBufferCommit(wordCount);                                                    \
+			TriceNonBlockingDirectWrite(triceSingleBufferStartWritePosition, wordCount);         \
+			}                                                                                    \
+			}                                                                                    \
+			TRICE_LEAVE_CRITICAL_SECTION
+
+	#elif (TRICE_BUFFER == TRICE_RING_BUFFER) && (TRICE_RING_BUFFER_EXACT == 1)
+
+		//! TRICE_LEAVE is the end of TRICE macro. The finished Trice gets copied from the staging buffer into the ring buffer.
+		#define TRICE_LEAVE                                                                      \
+			unsigned wordCount = TriceBufferWritePosition - triceSingleBufferStartWritePosition; \
+			TRICE_DIAGNOSTICS_SINGLE_BUFFER_USING_WORD_COUNT                                     \
+			TriceRingBufferCommit(wordCount);                                                    \
+			}                                                                                    \
+			}                                                                                    \
+			TRICE_LEAVE_CRITICAL_SECTION
+
+	#elif (TRICE_BUFFER == TRICE_STATIC_BUFFER) && (TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1)
+
+		//! TRICE_LEAVE is the end of TRICE macro. The trice gets published inside the RTT up-buffer 0.
+		#define TRICE_LEAVE                                                                      \
+			unsigned wordCount = TriceBufferWritePosition - triceSingleBufferStartWritePosition; \
+			TRICE_DIAGNOSTICS_SINGLE_BUFFER_USING_WORD_COUNT                                     \
+			TriceRTT0Commit(triceSingleBufferStartWritePosition, wordCount);                     \
+			}                                                                                    \
+			}                                                                                    \
+			TRICE_LEAVE_CRITICAL_SECTION
+
+	#elif TRICE_DIRECT_OUTPUT == 1
 
 		//! TRICE_LEAVE is the end of TRICE macro. It is the same for all buffer variants.
 		#define TRICE_LEAVE                                                                                          \
@@ -624,6 +750,13 @@ void XTEAInitTable(void);
 
 #endif
 
+#if TRICE_DEFERRED_STREAM_ENCRYPT == 1
+
+void SpeckEncrypt(uint32_t v[2]);
+void SpeckInitTable(void);
+
+#endif
+
 //
 ///////////////////////////////////////////////////////////////////////////////
 
@@ -913,6 +1046,46 @@ typedef void (*Write32AuxiliaryFn_t)(const uint32_t* enc, unsigned count);
 extern Write32AuxiliaryFn_t UserNonBlockingDirectWrite32AuxiliaryFn;
 extern Write32AuxiliaryFn_t UserNonBlockingDeferredWrite32AuxiliaryFn;
 
+#if TRICE_DEFERRED_FLASH == 1
+
+typedef void (*TriceFlashReadFn_t)(uint32_t address, void* buf, size_t len);
+typedef int (*TriceFlashProgramFn_t)(uint32_t address, const void* buf, size_t len); //!< TriceFlashProgramFn_t returns 0 on success.
+typedef int (*TriceFlashEraseFn_t)(uint32_t address);                               //!< TriceFlashEraseFn_t returns 0 on success.
+extern TriceFlashReadFn_t UserTriceFlashReadFn;
+extern TriceFlashProgramFn_t UserTriceFlashProgramFn;
+extern TriceFlashEraseFn_t UserTriceFlashEraseFn;
+extern unsigned TriceFlashDropCount;
+
+void TriceFlashLogInit(void);
+void TriceNonBlockingDeferredWriteFlash(const uint8_t* enc, size_t encLen);
+unsigned TriceOutDepthFlash(void);
+void TriceFlashTransfer(void);
+size_t TriceFlashLogRead(uint32_t* pCursor, uint8_t* buf, size_t size);
+void TriceFlashLogErase(void);
+
+#endif
+
+#if TRICE_SHM == 1
+
+extern unsigned TriceShmDropCount;
+
+int TriceShmOpen(const char* name);
+void TriceNonBlockingDeferredWriteShm(const uint8_t* enc, size_t encLen);
+void TriceShmClose(void);
+
+#endif
+
+#if TRICE_LINUX == 1
+
+extern unsigned TriceLinuxDropCount;
+extern unsigned TriceLinuxWriteErrorCount;
+
+int TriceLinuxStart(int fd);
+void TriceLinuxStop(void);
+void TriceNonBlockingDirectWriteLinux(const uint8_t* enc, size_t encLen);
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
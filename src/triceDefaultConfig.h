@@ -102,17 +102,32 @@ extern "C" {
 #define TRICE_CONFIG_WARNINGS 1 //!< TRICE_CONFIG_WARNINGS == 0 can suppress some unwanted configuration warnings. Set to 0 only if you know what you are doing.
 #endif
 
+#ifndef TRICE_LINUX
+//! TRICE_LINUX == 1 makes the target code a backend for multi-threaded Linux applications, see triceLinux.c.
+//! Each thread writes its trices lock-free into an own ring and a flusher thread started with TriceLinuxStart writes them to a file, pipe or socket.
+//! The stamps default to the monotonic clock in microseconds.
+#define TRICE_LINUX 0
+#endif
+
 #ifndef TriceStamp16
 //! TriceStamp16 returns a 16-bit value to stamp `Id` TRICE and `Trice` macros. Usually it is a timestamp, but could also be a destination address or a counter for example.
 //! The user has to provide this value. Defining a macro here, instead if providing a fuction has significant speed impact.
+#if TRICE_LINUX == 1
+#define TriceStamp16 ((uint16_t)TriceLinuxStamp32())
+#else
 #define TriceStamp16 0x1616
 #endif
+#endif
 
 #ifndef TriceStamp32
 //! TriceStamp32 returns a 32-bit value to stamp `ID` TRICE and `TRice` macros. Usually it is a timestamp, but could also be a destination address or a counter for example.
 //! The user has to provide this function. Defining a macro here, instead a function if providing has significant speed impact.
+#if TRICE_LINUX == 1
+#define TriceStamp32 TriceLinuxStamp32()
+#else
 #define TriceStamp32 0x32323232
 #endif
+#endif
 
 #ifndef TRICE_PROTECT
 //! The TRICE_PROTECT switch is only relevant for the deferred trice modes TRICE_DOUBLE_BUFFER and TRICE_RING_BUFFER.
@@ -153,6 +168,37 @@ extern "C" {
 #define TRICE_RING_BUFFER_OVERFLOW_WATCH 0
 #endif
 
+#ifndef TRICE_RING_BUFFER_EXACT
+//! TRICE_RING_BUFFER_EXACT == 1 lets each Trice occupy exactly its length inside the ring buffer, also split across the buffer end.
+//! The TRICE macros write into a TRICE_BUFFER_SIZE staging buffer and TRICE_LEAVE copies the finished Trice into the ring buffer, if it fits.
+//! TriceTransfer reassembles wrapped Trices in a second TRICE_BUFFER_SIZE buffer. Both buffers are taken from TRICE_DEFERRED_BUFFER_SIZE,
+//! so the RAM stays the same and the ring buffer gets TRICE_RING_BUFFER_EXACT_SIZE = TRICE_DEFERRED_BUFFER_SIZE + TRICE_DATA_OFFSET - 2*TRICE_BUFFER_SIZE bytes.
+//! These are usable to the last byte: A full ring buffer drops only Trices not fitting anymore. The default ring buffer instead needs
+//! TRICE_DATA_OFFSET + 2*TRICE_SINGLE_MAX_SIZE - 4 bytes free for any Trice and loses up to TRICE_BUFFER_SIZE - 4 bytes at its end,
+//! when it jumps back to the buffer start. So the exact mode holds a burst, which fits its TRICE_RING_BUFFER_EXACT_SIZE, independent of the write position.
+//! Like with TRICE_STATIC_BUFFER, TRICE_ENTER_CRITICAL_SECTION must be effective, when Trices are used inside interrupts.
+//! This value is only relevant for TRICE_BUFFER == TRICE_RING_BUFFER.
+#define TRICE_RING_BUFFER_EXACT 0
+#endif
+
+#ifndef TRICE_POST_MORTEM
+//! TRICE_POST_MORTEM == 1 keeps the ring buffer and its positions in retained RAM (TRICE_NOINIT) over a reset.
+//! TriceInit checks the retained state and TriceTransfer sends the not yet transmitted trices of the previous boot first,
+//! enclosed in TRICE_POST_MORTEM_ID markers. The trice tool shows them as "previous boot" block (see trice log -postMortemID).
+//! Needs TRICE_BUFFER == TRICE_RING_BUFFER with TRICE_RING_BUFFER_EXACT == 0 and a linker section, which is not initialized at startup.
+#define TRICE_POST_MORTEM 0
+#endif
+
+#ifndef TRICE_POST_MORTEM_ID
+//! TRICE_POST_MORTEM_ID is the reserved ID of the post mortem markers. Keep it outside the -IDMin ... -IDMax range.
+#define TRICE_POST_MORTEM_ID 16368
+#endif
+
+#ifndef TRICE_NOINIT
+//! TRICE_NOINIT places a variable into a RAM section, which is not initialized by the startup code. Adapt it to the linker script.
+#define TRICE_NOINIT __attribute__((section(".noinit")))
+#endif
+
 #ifndef TRICE_DIRECT_OUTPUT
 //! TRICE_DIRECT_OUTPUT == 0: only deferred output, usually UART output only
 //! TRICE_DIRECT_OUTPUT == 1: with direct output, SEGGER_RTT output and/or TRICE_DIRECT_AUXILIARY8 output
@@ -192,7 +238,7 @@ extern "C" {
 //! - Without encoding/framing this value can be 0.
 //! - When using XTEA, this value should incorporate additional 4 bytes, because of the 64-bit encryption units.
 //! With TRICE_BUFFER == TRICE_RING_BUFFER, this amount of space is allocated in front of the ring buffer.
-//! With TRICE_BUFFER == TRICE_DOUBLE_BUFFER, this amount of space is allocated once in front of each half buffer.
+//! With TRICE_BUFFER == TRICE_DOUBLE_BUFFER, this amount of space is allocated once in front of each segment.
 //! Must be a multiple of 4. 64 is a _very_ safe value. In most cases you can reduce this to 16 or less.
 #define TRICE_DATA_OFFSET 64
 #endif
@@ -215,11 +261,21 @@ extern "C" {
 //! TRICE_DEFERRED_BUFFER_SIZE needs to be capable to hold trice bursts until they are transmitted.
 //! When TRICE_BUFFER == TRICE_STACK_BUFFER this value is not used.
 //! When TRICE_BUFFER == TRICE_STATIC_BUFFER this value is not used.
-//! When TRICE_BUFFER == TRICE_DOUBLE_BUFFER, this is the sum of both half buffers.
+//! When TRICE_BUFFER == TRICE_DOUBLE_BUFFER, this is the sum of all TRICE_DEFERRED_BUFFER_SEGMENTS segments.
 //! When TRICE_BUFFER == TRICE_RING_BUFFER, this is the whole buffer.
 #define TRICE_DEFERRED_BUFFER_SIZE 1024 // must be a multiple of 4
 #endif
 
+#ifndef TRICE_DEFERRED_BUFFER_SEGMENTS
+//! TRICE_DEFERRED_BUFFER_SEGMENTS is the count of equal segments TRICE_DEFERRED_BUFFER_SIZE is divided into, when TRICE_BUFFER == TRICE_DOUBLE_BUFFER.
+//! - 2 is the classic double buffer: TriceTransfer swaps the half buffers, when the last transmission is finished.
+//! - With more segments the TRICE macros continue in the next free segment, when the current one has less than TRICE_SINGLE_MAX_SIZE space left.
+//!   TriceTransfer transmits the filled segments in order. So a burst can fill all segments except the one in transmission.
+//!   The segment change happens inside TriceEnoughSpace, so more than 2 segments need TRICE_PROTECT == 1. The TRICE_PUT macros stay unchanged.
+//! Each segment has TRICE_DATA_OFFSET space in front and must be able to hold a TRICE_SINGLE_MAX_SIZE Trice.
+#define TRICE_DEFERRED_BUFFER_SEGMENTS 2 // must be a divisor of TRICE_DEFERRED_BUFFER_SIZE / 4
+#endif
+
 #ifndef TRICE_MCU_IS_BIG_ENDIAN
 //! TRICE_MCU_IS_BIG_ENDIAN needs to be 1 for TRICE64 macros on big endian MCUs for correct 64-bit values and 32-bit timestamp encoding.
 #define TRICE_MCU_IS_BIG_ENDIAN 0 // todo: Set this value automatically thru the used compiler.
@@ -275,12 +331,76 @@ extern "C" {
 #define TRICE_DEFERRED_XTEA_ENCRYPT 0
 #endif
 
+#ifndef TRICE_DEFERRED_STREAM_ENCRYPT
+//! TRICE_DEFERRED_STREAM_ENCRYPT == 1 encrypts the deferred output with Speck64/128 in counter mode and the XTEA_ENCRYPT_KEY.
+//! Unlike XTEA no padding to a multiple of 8 bytes is needed and the encryption costs less than half of the computing time.
+//! Each package starts with a 2 bytes package counter, each 256th package additionally with the nonce and the counter high part.
+//! Needs COBS or TCOBS framing, TRICE_SINGLE_PACK_MODE and the trice tool switch `-cipher SPECK`.
+//! Define TRICE_STREAM_NONCE as a value, which is different after each reset, for example from a hardware random generator
+//! or a boot counter. Different values should differ in the lower 24 bits. The same nonce after a reset would repeat the key stream.
+#define TRICE_DEFERRED_STREAM_ENCRYPT 0
+#endif
+
+#ifndef TRICE_DEFERRED_COMPRESS
+//! TRICE_DEFERRED_COMPRESS == 1 compresses each trice before the deferred framing for low-bandwidth links.
+//! The 14-bit ID gets replaced by an index into a small dictionary of recent IDs, stamps are delta encoded and
+//! parameters varint encoded, when that is shorter. Needs COBS or TCOBS framing and the `trice log -compressed` switch.
+//! A compressed trice can be up to 3 bytes longer than the original. Therefore the double buffer in TRICE_MULTI_PACK_MODE
+//! packs the compressed trices into an additional static buffer of one segment size.
+#define TRICE_DEFERRED_COMPRESS 0
+#endif
+
+#ifndef TRICE_DEFERRED_COMPRESS_RESET_INTERVAL
+//! TRICE_DEFERRED_COMPRESS_RESET_INTERVAL is the trice count after which the compression state is reset.
+//! A reset marked trice is decodable without history, so this is the maximum trice count lost after a lost package.
+#define TRICE_DEFERRED_COMPRESS_RESET_INTERVAL 64
+#endif
+
 #ifndef TRICE_DIAGNOSTICS
 //! With TRICE_DIAGNOSTICS == 0, additional trice diagnostics code is removed.
 //! During development TRICE_DIAGNOSTICS == 1 helps to optimize the trice buffer sizes.
 #define TRICE_DIAGNOSTICS 1
 #endif
 
+#ifndef TRICE_DIAGNOSTICS_ID
+//! TRICE_DIAGNOSTICS_ID is the reserved ID used by TriceLogDiagnostics. Keep it outside the -IDMin ... -IDMax range.
+//! The trice tool decodes this ID without til.json into structured diagnostic values (see trice log -diagID).
+#define TRICE_DIAGNOSTICS_ID 16369
+#endif
+
+#ifndef TRICE_CLOCK_SYNC_ID
+//! TRICE_CLOCK_SYNC_ID is the reserved ID used by TriceClockSync. Keep it outside the -IDMin ... -IDMax range.
+//! The trice tool uses these trices without til.json entry only for the target clock correlation (see trice log -correlate -syncID).
+#define TRICE_CLOCK_SYNC_ID 16367
+#endif
+
+#ifndef TRICE_IDENTITY_ID
+//! TRICE_IDENTITY_ID is the reserved ID used by TriceIdentity. Keep it outside the -IDMin ... -IDMax range.
+//! The trice tool selects with the transmitted til.json hash the ID table for the stream (see trice log -tilCache -identityID).
+#define TRICE_IDENTITY_ID 16366
+#endif
+
+#ifndef TRICE_TIL_HASH
+#ifdef TRICE_GENERATED_TIL_HASH
+//! TRICE_TIL_HASH identifies the til.json of this firmware build. "trice insert -generatedHeader" writes it as TRICE_GENERATED_TIL_HASH.
+#define TRICE_TIL_HASH TRICE_GENERATED_TIL_HASH
+#else
+//! TRICE_TIL_HASH 0 means unknown, because no generated header is included.
+#define TRICE_TIL_HASH 0
+#endif
+#endif
+
+#ifndef TRICE_IDENTITY
+//! TRICE_IDENTITY == 1 lets TriceInit call TriceIdentity, so the trice tool knows the til.json of the firmware from the start.
+#define TRICE_IDENTITY 0
+#endif
+
+#ifndef TRICE_DIAGNOSTICS_INTERVAL
+//! TRICE_DIAGNOSTICS_INTERVAL > 0 lets TriceTransfer call TriceLogDiagnostics automatically after each TRICE_DIAGNOSTICS_INTERVAL deferred transfers.
+//! With TRICE_DIAGNOSTICS_INTERVAL == 0 (default) TriceLogDiagnostics needs to be called by the user, if wanted.
+#define TRICE_DIAGNOSTICS_INTERVAL 0
+#endif
+
 #ifndef TRICE_DIRECT_SEGGER_RTT_8BIT_WRITE
 //! TRICE_DIRECT_SEGGER_RTT_8BIT_WRITE==1 uses standard RTT transfer by using function SEGGER_RTT_WriteNoLock and needs ((TRICE_DIRECT_OUTPUT == 1).
 //! - This setting results in unframed RTT trice packages and requires the `-packageFraming none` switch for the appropriate trice tool instance.
@@ -297,6 +417,39 @@ extern "C" {
 #define TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE 0
 #endif
 
+#ifndef TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY
+//! TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY == 1 lets the TRICE macros write directly into the SEGGER RTT up-buffer 0 and avoids the copy.
+//! - TRICE_ENTER returns the up-buffer write position, when TRICE_SINGLE_MAX_SIZE + 4 bytes are free there without wrap, otherwise the static buffer.
+//! - TRICE_LEAVE publishes WrOff after RTT__DMB() or, only for trices from the static buffer, copies them with wrap like TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE.
+//! - Needs TRICE_BUFFER == TRICE_STATIC_BUFFER, TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE == 1 and unframed, unencrypted direct output without routing.
+#define TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY 0
+#endif
+
+#ifndef TRICE_SEGGER_RTT_ROUTED_CHANNEL
+//! TRICE_SEGGER_RTT_ROUTED_CHANNEL, if > 0, is an additional SEGGER RTT up-channel for the trices with IDs inside
+//! TRICE_SEGGER_RTT_ROUTED_CHANNEL_MIN_ID ... TRICE_SEGGER_RTT_ROUTED_CHANNEL_MAX_ID, for example the error trices.
+//! These trices never wait behind bulk data in up-channel 0 then. Use "trice log -rttChannels 0,1" to read both channels.
+//! - Applies to TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE, TRICE_DIRECT_SEGGER_RTT_8BIT_WRITE and TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE.
+//! - SEGGER_RTT_MAX_NUM_UP_BUFFERS needs to be bigger than TRICE_SEGGER_RTT_ROUTED_CHANNEL.
+//! - The ID range must not include the reserved IDs TRICE_IDENTITY_ID, TRICE_CLOCK_SYNC_ID, TRICE_POST_MORTEM_ID and TRICE_DIAGNOSTICS_ID.
+//! - TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE needs TRICE_SINGLE_PACK_MODE, because a multi pack has no single ID to route.
+//! - Set TRICE_CYCLE_COUNTER to 0 or give all trices a 32-bit stamp. The host merges the channels only by the 32-bit stamps,
+//!   so unstamped trices of both channels interleave and the one global cycle counter would show false cycle errors.
+#define TRICE_SEGGER_RTT_ROUTED_CHANNEL 0
+#endif
+
+#ifndef TRICE_SEGGER_RTT_ROUTED_CHANNEL_MIN_ID
+#define TRICE_SEGGER_RTT_ROUTED_CHANNEL_MIN_ID 0 //!< TRICE_SEGGER_RTT_ROUTED_CHANNEL_MIN_ID is the smallest ID routed to TRICE_SEGGER_RTT_ROUTED_CHANNEL.
+#endif
+
+#ifndef TRICE_SEGGER_RTT_ROUTED_CHANNEL_MAX_ID
+#define TRICE_SEGGER_RTT_ROUTED_CHANNEL_MAX_ID 0 //!< TRICE_SEGGER_RTT_ROUTED_CHANNEL_MAX_ID is the largest ID routed to TRICE_SEGGER_RTT_ROUTED_CHANNEL.
+#endif
+
+#ifndef TRICE_SEGGER_RTT_ROUTED_CHANNEL_SIZE
+#define TRICE_SEGGER_RTT_ROUTED_CHANNEL_SIZE 256 //!< TRICE_SEGGER_RTT_ROUTED_CHANNEL_SIZE is the byte count of the TRICE_SEGGER_RTT_ROUTED_CHANNEL buffer.
+#endif
+
 #ifndef TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE
 //! TRICE_DEFERRED_SEGGER_RTT_8BIT_WRITE == 1 enables channel number 0 for SeggerRTT usage. Only channel 0 works right now for some reason.
 //! Than the RTT trice packages can be framed according to the set TRICE_DIRECT_OUT_FRAMING.
@@ -325,6 +478,55 @@ extern "C" {
 #define TRICE_DEFERRED_AUXILIARY32 0
 #endif
 
+#ifndef TRICE_DEFERRED_FLASH
+//! TRICE_DEFERRED_FLASH enables a persistent deferred trice log in flash memory, see triceFlash.c.
+//! The user needs to assign UserTriceFlashReadFn, UserTriceFlashProgramFn and UserTriceFlashEraseFn before TriceInit.
+//! With TRICE_DEFERRED_FLASH_MIN_ID and TRICE_DEFERRED_FLASH_MAX_ID defined, only the IDs between are stored, for example the error trices.
+#define TRICE_DEFERRED_FLASH 0
+#endif
+
+#ifndef TRICE_FLASH_BASE_ADDRESS
+//! TRICE_FLASH_BASE_ADDRESS is the page aligned start address of the flash area reserved for the trice log.
+#define TRICE_FLASH_BASE_ADDRESS 0
+#endif
+
+#ifndef TRICE_FLASH_PAGE_SIZE
+//! TRICE_FLASH_PAGE_SIZE is the flash erase unit in bytes. The biggest trice package must fit into one page.
+#define TRICE_FLASH_PAGE_SIZE 2048
+#endif
+
+#ifndef TRICE_FLASH_PAGE_COUNT
+//! TRICE_FLASH_PAGE_COUNT is the number of flash pages used round robin for the trice log. The oldest page is erased, when the log wraps.
+#define TRICE_FLASH_PAGE_COUNT 4
+#endif
+
+#ifndef TRICE_FLASH_PROGRAM_SIZE
+//! TRICE_FLASH_PROGRAM_SIZE is the flash programming unit in bytes. Options: 4, 8, 16
+#define TRICE_FLASH_PROGRAM_SIZE 4
+#endif
+
+#ifndef TRICE_SHM
+//! TRICE_SHM == 1 adds a POSIX shared memory ring writer for targets running on Linux, like simulations, see triceShm.c.
+//! After TriceShmOpen the deferred trice packages go with TRICE_DEFERRED_AUXILIARY8 == 1 into the ring (trice log -p SHM).
+#define TRICE_SHM 0
+#endif
+
+#ifndef TRICE_SHM_SIZE
+//! TRICE_SHM_SIZE is the shared memory ring data size in bytes. It needs to be a power of 2.
+#define TRICE_SHM_SIZE 0x100000
+#endif
+
+#ifndef TRICE_LINUX_RING_SIZE
+//! TRICE_LINUX_RING_SIZE is the ring size in bytes for each thread using trices with TRICE_LINUX == 1. It needs to be a power of 2.
+//! A thread writing more bytes between 2 flusher rounds loses the not fitting trices, see TriceLinuxDropCount.
+#define TRICE_LINUX_RING_SIZE 0x10000
+#endif
+
+#ifndef TRICE_LINUX_FLUSH_INTERVAL_US
+//! TRICE_LINUX_FLUSH_INTERVAL_US is the sleep time of the flusher thread in microseconds, when all rings are empty.
+#define TRICE_LINUX_FLUSH_INTERVAL_US 1000
+#endif
+
 #ifndef TRICE_CGO
 //! CGO interface for testing the target code with Go only, do not enable normally. Usage examples can be found in the trice/test folder.
 #define TRICE_CGO 0
@@ -366,6 +568,15 @@ extern "C" {
 #define TRICE_LEAVE_CRITICAL_SECTION }
 #endif
 
+#ifndef TRICE_THREAD_LOCAL
+//! TRICE_THREAD_LOCAL makes the static encoding buffers of the direct output thread local, when trices are written from several threads.
+#if TRICE_LINUX == 1
+#define TRICE_THREAD_LOCAL __thread
+#else
+#define TRICE_THREAD_LOCAL
+#endif
+#endif
+
 #ifndef TRICE_INLINE
 #define TRICE_INLINE static inline //! TRICE_INLINE is used for inlining trice code.
 #endif
@@ -390,6 +601,8 @@ extern "C" {
 
 // According to TRICE_SINGLE_MAX_SIZE the Trice functions are enabled/disabled automatically.
 // To force that manually, the user can for example `#define ENABLE_trice32fn_12 0` or `#define ENABLE_trice32fn_12 1` for all variations. See trice8.c trice16.c, ... .
+// "trice insert -generatedHeader triceGenerated.h" writes these switches for only the Trice variants in use together with the derived TRICE_SINGLE_MAX_SIZE.
+// Include triceGenerated.h at the begin of triceConfig.h then.
 
 //
 ///////////////////////////////////////////////////////////////////////////////
@@ -9,31 +9,63 @@
 
 static void TriceOut(uint32_t* tb, size_t tLen);
 
-//! triceBuffer is a double buffer for better write speed.
-//! halfBufferStart     writePosition
-//! ^-TRICE_DATA_OFFSET-^-restOf_TRICE_DEFERRED_BUFFER_SIZE-^-2ndBuf...
-//! ^-TRICE_DATA_OFFSET-^-restOf_TRICE_DEFERRED_BUFFER_SIZE-Limit
-static uint32_t triceBuffer[2][TRICE_DEFERRED_BUFFER_SIZE >> 3] = {0};
+//! TRICE_SEGMENT_SIZE32 is the size of one triceBuffer segment in 32-bit units.
+#define TRICE_SEGMENT_SIZE32 ((TRICE_DEFERRED_BUFFER_SIZE / TRICE_DEFERRED_BUFFER_SEGMENTS) >> 2)
 
-static uint32_t* const triceWriteStartHalfBuffer0 = &triceBuffer[0][TRICE_DATA_OFFSET >> 2];
-static uint32_t* const triceWriteLimitHalfBuffer0 = &triceBuffer[0][TRICE_DEFERRED_BUFFER_SIZE >> 3];
-static uint32_t* const triceWriteStartHalfBuffer1 = &triceBuffer[1][TRICE_DATA_OFFSET >> 2];
-static uint32_t* const triceWriteLimitHalfBuffer1 = &triceBuffer[1][TRICE_DEFERRED_BUFFER_SIZE >> 3];
+//! triceBuffer is a queue of equal segments for better write speed. With 2 segments it is a double buffer.
+//! segmentStart        writePosition
+//! ^-TRICE_DATA_OFFSET-^-restOf_segment-^-nextSegment...
+//! ^-TRICE_DATA_OFFSET-^-restOf_segment-Limit
+static uint32_t triceBuffer[TRICE_DEFERRED_BUFFER_SEGMENTS][TRICE_SEGMENT_SIZE32] = {0};
 
-//! triceActiveHalfBuffer is the index of the active write buffer. !triceActiveHalfBuffer is the active read buffer index.
-static int triceActiveHalfBuffer = 0;
+//! triceSegmentWrite is the index of the active write segment.
+static unsigned triceSegmentWrite = 0;
+
+//! triceSegmentsUsed is the count of closed segments, which are transmitted or waiting for transmission.
+//! They follow each other in front of triceSegmentWrite. All other segments are free.
+static unsigned triceSegmentsUsed = 0;
+
+//! triceSegmentTransmitting is 1, when the oldest closed segment is in transmission.
+static int triceSegmentTransmitting = 0;
+
+//! triceSegmentLength32 holds the trice data length in 32-bit units of each closed segment.
+static size_t triceSegmentLength32[TRICE_DEFERRED_BUFFER_SEGMENTS];
 
 //! TriceBufferWritePosition is the active write position and is used by TRICE_PUT macros.
-uint32_t* TriceBufferWritePosition = triceWriteStartHalfBuffer0;
+uint32_t* TriceBufferWritePosition = &triceBuffer[0][TRICE_DATA_OFFSET >> 2];
 
 //! TriceBufferWritePositionStart is the begin of the active write buffer.
-uint32_t* TriceBufferWritePositionStart = triceWriteStartHalfBuffer0;
+uint32_t* TriceBufferWritePositionStart = &triceBuffer[0][TRICE_DATA_OFFSET >> 2];
+
+#if TRICE_PROTECT == 1
+//! TriceBufferWritePositionLimit is the first not usable address of the current written segment.
+static uint32_t* TriceBufferWritePositionLimit = &triceBuffer[0][TRICE_SEGMENT_SIZE32];
+#endif
+
+//! triceSegmentNext closes the active write segment and continues writing in the next free one.
+//! It is called inside a critical section.
+//! \retval 0, when no free segment is available and nothing was changed
+//! \retval 1, when the next segment is the active write segment now
+static int triceSegmentNext(void) {
+	if (triceSegmentsUsed >= TRICE_DEFERRED_BUFFER_SEGMENTS - 1) {
+		return 0;
+	}
+	triceSegmentLength32[triceSegmentWrite] = TriceBufferWritePosition - TriceBufferWritePositionStart;
+	triceSegmentsUsed++;
+	triceSegmentWrite = (triceSegmentWrite + 1) % TRICE_DEFERRED_BUFFER_SEGMENTS;
+	TriceBufferWritePositionStart = &triceBuffer[triceSegmentWrite][TRICE_DATA_OFFSET >> 2];
+	TriceBufferWritePosition = TriceBufferWritePositionStart;
+#if TRICE_PROTECT == 1
+	TriceBufferWritePositionLimit = &triceBuffer[triceSegmentWrite][TRICE_SEGMENT_SIZE32];
+#endif
+	return 1;
+}
 
 #if TRICE_PROTECT == 1
-//! TriceBufferWritePositionLimit is the first not usable address of the current written half buffer.
-static uint32_t* TriceBufferWritePositionLimit = triceWriteLimitHalfBuffer0;
 
 //! TriceEnoughSpace checks, if at least TRICE_SINGLE_MAX_SIZE bytes available for the next trice.
+//! With more than 2 segments a full write segment gets closed here, if there is a free one.
+//! With 2 segments the writer stays in its segment until TriceTransfer swaps, like the double buffer always did.
 //! \retval 0, when not enough space
 //! \retval 1, when enough space
 int TriceEnoughSpace(void) {
@@ -42,57 +74,56 @@ int TriceEnoughSpace(void) {
 	// there need to be at least TRICE_SINGLE_MAX_SIZE bytes space in the current write buffer.
 	if (space32 >= (TRICE_SINGLE_MAX_SIZE >> 2)) {
 		return 1;
-	} else {
+	}
+#if TRICE_DEFERRED_BUFFER_SEGMENTS > 2
+	if (triceSegmentNext()) { // TRICE_ENTER holds the critical section.
+		return 1;
+	}
+#endif
 #if TRICE_DIAGNOSTICS == 1
-		TriceDeferredOverflowCount++;
+	TriceDeferredOverflowCount++;
 #endif
-		return 0;
-	}
+	return 0;
 }
 
 #endif // #if TRICE_PROTECT == 1
 
-//! triceBufferSwap swaps the trice double buffer and returns the read buffer address.
-static uint32_t* triceBufferSwap(void) {
-	if (triceActiveHalfBuffer == 0) {
-		triceActiveHalfBuffer = 1;
-		TriceBufferWritePositionStart = triceWriteStartHalfBuffer1;
-		TriceBufferWritePosition = TriceBufferWritePositionStart;
-#if TRICE_PROTECT == 1
-		TriceBufferWritePositionLimit = triceWriteLimitHalfBuffer1;
-#endif
-		return triceWriteStartHalfBuffer0;
-	} else {
-		triceActiveHalfBuffer = 0;
-		TriceBufferWritePositionStart = triceWriteStartHalfBuffer0;
-		TriceBufferWritePosition = TriceBufferWritePositionStart;
-#if TRICE_PROTECT == 1
-		TriceBufferWritePositionLimit = triceWriteLimitHalfBuffer0;
-#endif
-		return triceWriteStartHalfBuffer1;
-	}
-}
-
 #if TRICE_DIAGNOSTICS == 1
-//! TriceHalfBufferDepthMax is a diagnostics value usable to optimize buffer size.
+//! TriceHalfBufferDepthMax is a diagnostics value usable to optimize buffer size. It is the max used segment space.
 unsigned TriceHalfBufferDepthMax = 0;
 #endif
 
-//! TriceTransfer, if possible, swaps the double buffer and initiates a write.
+//! TriceTransfer, if possible, transmits the oldest filled segment.
+//! When the last transmission is done, its segment is free again. Without waiting segments the write segment gets swapped out.
 //! It is the responsibility of the app to call this function once every 10-100 milliseconds.
+//! With more than 2 segments, call it until TriceOutDepth() stays 0 to get a burst out quickly.
 void TriceTransfer(void) {
-	if (0 == TriceOutDepth()) { // transmission done for slowest output channel, so a swap is possible.
+	if (0 == TriceOutDepth()) { // transmission done for slowest output channel, so the transmitted segment is free again.
 		uint32_t* readBuf;
-		size_t tLen32;
+		size_t tLen32 = 0;
 		TRICE_ENTER_CRITICAL_SECTION
-		tLen32 = TriceBufferWritePosition - TriceBufferWritePositionStart;
-		if (tLen32) { // Some Trice data are available.
-			readBuf = triceBufferSwap();
-			readBuf -= (TRICE_DATA_OFFSET >> 2);
+		if (triceSegmentTransmitting) {
+			triceSegmentTransmitting = 0;
+			triceSegmentsUsed--;
+		}
+		if (triceSegmentsUsed == 0 && TriceBufferWritePosition != TriceBufferWritePositionStart) { // Only the write segment holds Trice data.
+			triceSegmentNext();
+		}
+		if (triceSegmentsUsed) { // Some Trice data are available.
+			unsigned oldest = (triceSegmentWrite + TRICE_DEFERRED_BUFFER_SEGMENTS - triceSegmentsUsed) % TRICE_DEFERRED_BUFFER_SEGMENTS;
+			readBuf = triceBuffer[oldest];
+			tLen32 = triceSegmentLength32[oldest];
+			triceSegmentTransmitting = 1;
 		}
 		TRICE_LEAVE_CRITICAL_SECTION
 		if (tLen32) {
 			TriceOut(readBuf, tLen32 << 2);
+#if TRICE_DEFERRED_FLASH == 1
+			TriceFlashTransfer(); // outside the critical section
+#endif
+#if TRICE_DIAGNOSTICS_INTERVAL > 0
+			TriceDiagnosticsTick();
+#endif
 		}
 	}
 }
@@ -164,13 +195,25 @@ static int TriceNext(uint8_t** buf, size_t* pSize, const uint8_t** pStart, size_
 	return triceID;
 }
 
+#if (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE) && ((TRICE_DEFERRED_COMPRESS == 1) || (TRICE_DEFERRED_STREAM_ENCRYPT == 1))
+
+//! TRICE_MULTI_PACK_STAGING_SIZE is the packed trice data limit. It keeps the framed package inside one segment.
+#define TRICE_MULTI_PACK_STAGING_SIZE ((TRICE_SEGMENT_SIZE32 << 2) - TRICE_DATA_OFFSET)
+
+//! triceMultiPackStaging collects the compressed or encrypted trices of one segment.
+//! These can be up to some bytes longer than their origin, so packing them in place would overwrite not yet read trices.
+//! The 8 additional bytes are the XTEA scratch pad.
+static uint8_t triceMultiPackStaging[TRICE_MULTI_PACK_STAGING_SIZE + 8];
+
+#endif
+
 uint8_t* firstNotModifiedAddress;
 int distance;
 int triceDataOffsetDepth;
 
 //! TriceOut encodes trices and writes them in one step to the output.
 //! This function is called only, when the slowest deferred output device has finished its last buffer.
-//! At the half buffer start tb are TRICE_DATA_OFFSET bytes space followed by a number of trice messages which all contain
+//! At the segment start tb are TRICE_DATA_OFFSET bytes space followed by a number of trice messages which all contain
 //! 0-3 padding bytes and therefore have a length of a multiple of 4. There is no additional space between these trice messages.
 //! When XTEA enabled, only (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE) is allowed, because the 4 bytes behind a trice messages
 //! are changed, when the trice length is not a multiple of 8, but only of 4. (XTEA can encrypt only multiple of 8 lenth packages.)
@@ -180,6 +223,11 @@ static void TriceOut(uint32_t* tb, size_t tLen) {
 	uint8_t* enc = (uint8_t*)tb;            // This is the later encoded data starting address.
 	uint8_t* dat = enc + TRICE_DATA_OFFSET; // Thid is the start of      32-bit aligned trices.
 	uint8_t* nxt = dat;                     // Thid is the start of next 32-bit aligned trices.
+#if (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE) && ((TRICE_DEFERRED_COMPRESS == 1) || (TRICE_DEFERRED_STREAM_ENCRYPT == 1))
+	uint8_t* pack = triceMultiPackStaging; // The packed data do not fit in place.
+#elif TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE
+	uint8_t* pack = dat; // The packed data are never longer than the read ones.
+#endif
 	size_t encLen = 0;
 	uint8_t* dst = enc; // This value dst must not get > nxt to avoid overwrites.
 	int triceID = 0;    // This assignment is only needed to silence compiler complains about being uninitialized.
@@ -205,6 +253,14 @@ static void TriceOut(uint32_t* tb, size_t tLen) {
 			TriceErrorCount++;
 			break; // ignore following data
 		}
+#if TRICE_DEFERRED_COMPRESS == 1
+		triceNettoLen = TriceCompress(triceCompressBuffer, triceNettoStart, triceNettoLen);
+		triceNettoStart = triceCompressBuffer;
+#endif
+#if TRICE_DEFERRED_STREAM_ENCRYPT == 1
+		triceNettoLen = TriceStreamEncrypt(triceStreamBuffer, triceNettoStart, triceNettoLen);
+		triceNettoStart = triceStreamBuffer;
+#endif
 #if TRICE_DEFERRED_TRANSFER_MODE == TRICE_SINGLE_PACK_MODE
 		uint8_t* dst = enc + encLen;
 #if (TRICE_DEFERRED_XTEA_ENCRYPT == 1) && (TRICE_DEFERRED_OUT_FRAMING == TRICE_FRAMING_TCOBS)
@@ -247,12 +303,25 @@ static void TriceOut(uint32_t* tb, size_t tLen) {
 #endif
 #elif TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE
 		// pack data
-		uint8_t* packed = dat + encLen;                  // After the loop, the packed data start at dat.
+#if (TRICE_DEFERRED_COMPRESS == 1) || (TRICE_DEFERRED_STREAM_ENCRYPT == 1)
+		if (encLen + triceNettoLen > TRICE_MULTI_PACK_STAGING_SIZE) { // The data grew too much, what should be a rare case.
+			TriceErrorCount++;
+#if TRICE_DEFERRED_COMPRESS == 1
+			TriceCompressReset(); // The host did not get this trice and would decompress the following ones wrong otherwise.
+#endif
+			break; // The packed trices so far are transmitted.
+		}
+#endif
+		uint8_t* packed = pack + encLen;                 // After the loop, the packed data start at pack.
 		memmove(packed, triceNettoStart, triceNettoLen); // This action removes all padding bytes of the trices, compacting their sequence this way
 		encLen += triceNettoLen;
 #endif // #elif  TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE
 
+#if (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE) && ((TRICE_DEFERRED_COMPRESS == 1) || (TRICE_DEFERRED_STREAM_ENCRYPT == 1))
+		dst = nxt; // The packed data are outside the segment.
+#else
 		dst = enc + encLen; // When several Trices in the double buffer, with each encoding the new dst could drift a bit closer towards triceNettoStart.
+#endif
 
 #if (TRICE_PROTECT == 1) || (TRICE_DIAGNOSTICS == 1)
 		int triceDataOffsetSpaceRemained = nxt - dst; // THe begin of unprocessed data MINUS next dst must not be negative.
@@ -269,33 +338,34 @@ static void TriceOut(uint32_t* tb, size_t tLen) {
 #endif
 	}
 #if TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE
-// At this point the compacted trice messages start TRICE_DATA_OFFSET bytes after tb (now dat) and the encLen is their total netto length.
-// Behind this up to 7 bytes can be used as scratch pad when XTEA is active. That is ok, because the half buffer should not get totally filled.
+// At this point the compacted trice messages start at pack and the encLen is their total netto length.
+// pack is TRICE_DATA_OFFSET bytes after tb (dat) or triceMultiPackStaging.
+// Behind this up to 7 bytes can be used as scratch pad when XTEA is active. That is ok, because the segment should not get totally filled.
 // encLen = TriceEncode( TRICE_DEFERRED_XTEA_ENCRYPT, TRICE_DEFERRED_OUT_FRAMING, enc, dat, encLen );
 #if (TRICE_DEFERRED_XTEA_ENCRYPT == 1) && (TRICE_DEFERRED_OUT_FRAMING == TRICE_FRAMING_TCOBS) // && (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE)
-	// special case: The data are at dat and can be big, are compacted and behind them is space. So we can encrypt them in space
+	// special case: The data are at pack and can be big, are compacted and behind them is space. So we can encrypt them in space
 	size_t len8 = (encLen + 7) & ~7;                    // Only multiple of 8 encryptable, so we adjust len.
-	memset(((uint8_t*)dat) + encLen, 0, len8 - encLen); // clear padding space: ATTENTION! OK only for this compiler switch setting.
-	XTEAEncrypt((uint32_t*)dat, len8 >> 2);
-	size_t eLen = (size_t)TCOBSEncode(enc, dat, len8);                                          // encLen is re-used here
+	memset(pack + encLen, 0, len8 - encLen); // clear padding space: ATTENTION! OK only for this compiler switch setting.
+	XTEAEncrypt((uint32_t*)pack, len8 >> 2);
+	size_t eLen = (size_t)TCOBSEncode(enc, pack, len8);                                          // encLen is re-used here
 	enc[eLen++] = 0;                                                                            // Add zero as package delimiter.
 #elif (TRICE_DEFERRED_XTEA_ENCRYPT == 1) && (TRICE_DEFERRED_OUT_FRAMING == TRICE_FRAMING_COBS)  // && (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE)
-	// special case: The data are at dat and can be big, are compacted and behind them is space. So we can encrypt them in space
+	// special case: The data are at pack and can be big, are compacted and behind them is space. So we can encrypt them in space
 	size_t len8 = (encLen + 7) & ~7;                    // Only multiple of 8 encryptable, so we adjust len.
-	memset(((uint8_t*)dat) + encLen, 0, len8 - encLen); // clear padding space: ATTENTION! OK only for this compiler switch setting.
-	XTEAEncrypt((uint32_t*)dat, len8 >> 2);
-	size_t eLen = (size_t)COBSEncode(enc, dat, len8); // encLen is re-used here
+	memset(pack + encLen, 0, len8 - encLen); // clear padding space: ATTENTION! OK only for this compiler switch setting.
+	XTEAEncrypt((uint32_t*)pack, len8 >> 2);
+	size_t eLen = (size_t)COBSEncode(enc, pack, len8); // encLen is re-used here
 	enc[eLen++] = 0;                                  // Add zero as package delimiter.
 #elif (TRICE_DEFERRED_XTEA_ENCRYPT == 1) && (TRICE_DEFERRED_OUT_FRAMING == TRICE_FRAMING_NONE)  // && (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE)
-	size_t eLen = TriceEncode(TRICE_DEFERRED_XTEA_ENCRYPT, TRICE_DEFERRED_OUT_FRAMING, enc, dat, encLen);
+	size_t eLen = TriceEncode(TRICE_DEFERRED_XTEA_ENCRYPT, TRICE_DEFERRED_OUT_FRAMING, enc, pack, encLen);
 #elif (TRICE_DEFERRED_XTEA_ENCRYPT == 0) && (TRICE_DEFERRED_OUT_FRAMING == TRICE_FRAMING_TCOBS) // && (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE)
-	size_t eLen = TCOBSEncode(enc, dat, encLen);
+	size_t eLen = TCOBSEncode(enc, pack, encLen);
 	enc[eLen++] = 0; // Add zero as package delimiter.
 #elif (TRICE_DEFERRED_XTEA_ENCRYPT == 0) && (TRICE_DEFERRED_OUT_FRAMING == TRICE_FRAMING_COBS)  // && (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE)
-	size_t eLen = (size_t)COBSEncode(enc, dat, encLen);
+	size_t eLen = (size_t)COBSEncode(enc, pack, encLen);
 	enc[eLen++] = 0; // Add zero as package delimiter.
 #elif (TRICE_DEFERRED_XTEA_ENCRYPT == 0) && (TRICE_DEFERRED_OUT_FRAMING == TRICE_FRAMING_NONE)  // && (TRICE_DEFERRED_TRANSFER_MODE == TRICE_MULTI_PACK_MODE)
-	enc = dat;
+	enc = pack;
 	size_t eLen = encLen;
 #else
 #error configuration:
@@ -312,7 +382,7 @@ static void TriceOut(uint32_t* tb, size_t tLen) {
 	encLen = eLen;
 #endif
 
-	// Reaching here means all trice data in the current half buffer are encoded
+	// Reaching here means all trice data in the current segment are encoded
 	// into a single continuous buffer having 0-delimiters between them or not but at the ent is a 0-delimiter.
 	//
 	// output
@@ -0,0 +1,287 @@
+//! \file triceFlash.c
+//! \author Thomas.Hoehenleitner [at] seerose.net
+//! \brief Persistent deferred trice log in flash memory.
+//!
+//! The log uses TRICE_FLASH_PAGE_COUNT pages round robin. Each page starts with a triceFlashPageHeader_t.
+//! The page with the highest sequence number is the current one. Equal page usage is the wear leveling.
+//! Each framed trice package is stored as record: A header programming unit (16-bit length, 16-bit inverted length, rest 0xFF)
+//! followed by the package data, zero padded to a multiple of TRICE_FLASH_PROGRAM_SIZE. The data are programmed first and
+//! the record header last, so a power fail leaves either a complete record or a not valid record at the page end.
+//! After a power fail TriceFlashLogInit continues on the next page. The trice tool reads a dumped flash image with "trice log -p FLASHIMAGE".
+//! //////////////////////////////////////////////////////////////////////////
+#include "trice.h"
+#include <string.h>
+
+#if TRICE_DEFERRED_FLASH == 1 && TRICE_OFF == 0
+
+#if TRICE_FLASH_PAGE_COUNT < 2
+#error configuration: TRICE_FLASH_PAGE_COUNT needs to be at least 2.
+#endif
+
+#if (TRICE_FLASH_PROGRAM_SIZE != 4) && (TRICE_FLASH_PROGRAM_SIZE != 8) && (TRICE_FLASH_PROGRAM_SIZE != 16)
+#error configuration: TRICE_FLASH_PROGRAM_SIZE needs to be 4, 8 or 16.
+#endif
+
+#if (TRICE_FLASH_PAGE_SIZE % TRICE_FLASH_PROGRAM_SIZE) || (TRICE_FLASH_PAGE_SIZE < 16 + TRICE_FLASH_PROGRAM_SIZE + TRICE_SINGLE_MAX_SIZE)
+#error configuration: TRICE_FLASH_PAGE_SIZE needs to be a multiple of TRICE_FLASH_PROGRAM_SIZE and big enough for the biggest trice.
+#endif
+
+//! TRICE_FLASH_MAGIC marks a used trice log page ("TRCF").
+#define TRICE_FLASH_MAGIC 0x54524346
+
+//! TRICE_FLASH_PAGE_ADDRESS is the flash address of page.
+#define TRICE_FLASH_PAGE_ADDRESS(page) (TRICE_FLASH_BASE_ADDRESS + (uint32_t)(page) * TRICE_FLASH_PAGE_SIZE)
+
+//! TRICE_FLASH_ROUND rounds n up to a multiple of TRICE_FLASH_PROGRAM_SIZE.
+#define TRICE_FLASH_ROUND(n) (((n) + TRICE_FLASH_PROGRAM_SIZE - 1) & ~(TRICE_FLASH_PROGRAM_SIZE - 1))
+
+//! triceFlashPageHeader_t starts each used page. Its size is a multiple of all possible TRICE_FLASH_PROGRAM_SIZE values.
+typedef struct {
+	uint32_t magic;       //!< magic is TRICE_FLASH_MAGIC.
+	uint32_t sequence;    //!< sequence is incremented with each new page.
+	uint32_t pageSize;    //!< pageSize is TRICE_FLASH_PAGE_SIZE, so the trice tool can read an image without configuration.
+	uint16_t programSize; //!< programSize is TRICE_FLASH_PROGRAM_SIZE.
+	uint16_t check;       //!< check is the result of triceFlashCheck and detects a partially programmed header.
+} triceFlashPageHeader_t;
+
+//! TRICE_FLASH_HEADER_SIZE is the byte count of triceFlashPageHeader_t.
+#define TRICE_FLASH_HEADER_SIZE 16
+
+//! UserTriceFlashReadFn needs to get a user function address for reading the flash.
+TriceFlashReadFn_t UserTriceFlashReadFn = (void*)0;
+
+//! UserTriceFlashProgramFn needs to get a user function address for flash programming. len is a multiple of TRICE_FLASH_PROGRAM_SIZE.
+TriceFlashProgramFn_t UserTriceFlashProgramFn = (void*)0;
+
+//! UserTriceFlashEraseFn needs to get a user function address for erasing the flash page at address.
+TriceFlashEraseFn_t UserTriceFlashEraseFn = (void*)0;
+
+//! TriceFlashDropCount counts the trice packages not fitting into a flash page.
+unsigned TriceFlashDropCount = 0;
+
+static unsigned triceFlashPage;     //!< triceFlashPage is the current page index.
+static uint32_t triceFlashOffset;   //!< triceFlashOffset is the next record position inside the current page.
+static uint32_t triceFlashSequence; //!< triceFlashSequence is the sequence number of the current page.
+
+//! triceFlashCheck returns the check value for a page header with sequence.
+static uint16_t triceFlashCheck(uint32_t sequence) {
+	return (uint16_t)~(sequence ^ (sequence >> 16) ^ TRICE_FLASH_PAGE_SIZE ^ TRICE_FLASH_PROGRAM_SIZE);
+}
+
+//! triceFlashPageValid returns 1 and the page sequence number in *pSequence, when page has a valid header.
+static int triceFlashPageValid(unsigned page, uint32_t* pSequence) {
+	triceFlashPageHeader_t h;
+	UserTriceFlashReadFn(TRICE_FLASH_PAGE_ADDRESS(page), &h, sizeof(h));
+	if (h.magic != TRICE_FLASH_MAGIC || h.pageSize != TRICE_FLASH_PAGE_SIZE || h.programSize != TRICE_FLASH_PROGRAM_SIZE || h.check != triceFlashCheck(h.sequence)) {
+		return 0;
+	}
+	*pSequence = h.sequence;
+	return 1;
+}
+
+//! triceFlashRecordLength returns the package length of the record at offset inside page.
+//! \retval -1 for an unprogrammed record header
+//! \retval -2 for a not valid record, what is possible after a power fail
+static int triceFlashRecordLength(unsigned page, uint32_t offset) {
+	uint8_t h[TRICE_FLASH_PROGRAM_SIZE];
+	uint16_t len, inv;
+	UserTriceFlashReadFn(TRICE_FLASH_PAGE_ADDRESS(page) + offset, h, sizeof(h));
+	memcpy(&len, h, 2);
+	memcpy(&inv, h + 2, 2);
+	if (len == 0xFFFF && inv == 0xFFFF) {
+		return -1;
+	}
+	if ((len ^ inv) != 0xFFFF || len == 0 || offset + TRICE_FLASH_PROGRAM_SIZE + TRICE_FLASH_ROUND((uint32_t)len) > (uint32_t)TRICE_FLASH_PAGE_SIZE) {
+		return -2;
+	}
+	return len;
+}
+
+//! triceFlashBlank returns 1, when page is erased from offset to its end.
+static int triceFlashBlank(unsigned page, uint32_t offset) {
+	uint8_t b[TRICE_FLASH_PROGRAM_SIZE];
+	for (; offset < TRICE_FLASH_PAGE_SIZE; offset += TRICE_FLASH_PROGRAM_SIZE) {
+		UserTriceFlashReadFn(TRICE_FLASH_PAGE_ADDRESS(page) + offset, b, sizeof(b));
+		for (unsigned i = 0; i < sizeof(b); i++) {
+			if (b[i] != 0xFF) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+//! triceFlashNewPage erases the next page and programs its header.
+//! The next page is the oldest one, so all pages get the same erase count.
+static void triceFlashNewPage(void) {
+	triceFlashPageHeader_t h;
+	triceFlashPage = (triceFlashPage + 1) % TRICE_FLASH_PAGE_COUNT;
+	triceFlashSequence++;
+	triceFlashOffset = TRICE_FLASH_HEADER_SIZE;
+	h.magic = TRICE_FLASH_MAGIC;
+	h.sequence = triceFlashSequence;
+	h.pageSize = TRICE_FLASH_PAGE_SIZE;
+	h.programSize = TRICE_FLASH_PROGRAM_SIZE;
+	h.check = triceFlashCheck(triceFlashSequence);
+	if (UserTriceFlashEraseFn(TRICE_FLASH_PAGE_ADDRESS(triceFlashPage)) || UserTriceFlashProgramFn(TRICE_FLASH_PAGE_ADDRESS(triceFlashPage), &h, sizeof(h))) {
+		TriceErrorCount++;
+		triceFlashOffset = TRICE_FLASH_PAGE_SIZE; // The next record tries the following page.
+	}
+}
+
+//! TriceFlashLogInit finds the current page and the next record position. It is called by TriceInit.
+//! A not clean page end, possible after a power fail, is left as it is and the log continues on the next page.
+void TriceFlashLogInit(void) {
+	uint32_t sequence, newest = 0;
+	int found = 0;
+	for (unsigned page = 0; page < TRICE_FLASH_PAGE_COUNT; page++) {
+		if (triceFlashPageValid(page, &sequence) && (!found || (int32_t)(sequence - newest) > 0)) {
+			found = 1;
+			newest = sequence;
+			triceFlashPage = page;
+		}
+	}
+	if (!found) { // empty or foreign flash area
+		triceFlashPage = TRICE_FLASH_PAGE_COUNT - 1;
+		triceFlashSequence = 0;
+		triceFlashNewPage();
+		return;
+	}
+	triceFlashSequence = newest;
+	triceFlashOffset = TRICE_FLASH_HEADER_SIZE;
+	while (triceFlashOffset + TRICE_FLASH_PROGRAM_SIZE <= TRICE_FLASH_PAGE_SIZE) {
+		int len = triceFlashRecordLength(triceFlashPage, triceFlashOffset);
+		if (len == -1 && triceFlashBlank(triceFlashPage, triceFlashOffset)) {
+			return;
+		}
+		if (len < 0) {
+			triceFlashNewPage();
+			return;
+		}
+		triceFlashOffset += TRICE_FLASH_PROGRAM_SIZE + TRICE_FLASH_ROUND((uint32_t)len);
+	}
+}
+
+//! triceFlashQueued is the framed trice package waiting for TriceFlashTransfer.
+static const uint8_t* triceFlashQueued;
+
+//! triceFlashQueuedLength is the byte count of triceFlashQueued. It is 0, when no package is waiting.
+static size_t triceFlashQueuedLength;
+
+//! TriceNonBlockingDeferredWriteFlash queues the framed trice package enc for the flash log.
+//! It is called inside the TriceOut critical section, so it only keeps the address. TriceFlashTransfer programs the record later.
+//! TriceOutDepthFlash keeps the buffer enc in use until then.
+void TriceNonBlockingDeferredWriteFlash(const uint8_t* enc, size_t encLen) {
+	if (triceFlashQueuedLength) { // TriceTransfer did not program the last package.
+		TriceFlashDropCount++;
+		return;
+	}
+	triceFlashQueued = enc;
+	triceFlashQueuedLength = encLen;
+}
+
+//! TriceOutDepthFlash returns the byte count of the queued package not programmed yet.
+unsigned TriceOutDepthFlash(void) {
+	return (unsigned)triceFlashQueuedLength;
+}
+
+//! TriceFlashTransfer appends the queued trice package as record to the flash log. It is called by TriceTransfer
+//! outside the critical section, because erasing and programming flash take milliseconds.
+void TriceFlashTransfer(void) {
+	const uint8_t* enc = triceFlashQueued;
+	size_t encLen = triceFlashQueuedLength;
+	uint8_t unit[TRICE_FLASH_PROGRAM_SIZE];
+	uint32_t size = TRICE_FLASH_PROGRAM_SIZE + TRICE_FLASH_ROUND((uint32_t)encLen);
+	size_t body = encLen & ~(size_t)(TRICE_FLASH_PROGRAM_SIZE - 1);
+	uint32_t address;
+	uint16_t len = (uint16_t)encLen;
+	uint16_t inv = (uint16_t)~len;
+	int err = 0;
+	if (encLen == 0) {
+		return; // nothing queued
+	}
+	triceFlashQueuedLength = 0; // The package is done here in any case.
+	if (size > TRICE_FLASH_PAGE_SIZE - TRICE_FLASH_HEADER_SIZE) {
+		TriceFlashDropCount++;
+		return;
+	}
+	if (triceFlashOffset + size > TRICE_FLASH_PAGE_SIZE) {
+		triceFlashNewPage();
+		if (triceFlashOffset + size > TRICE_FLASH_PAGE_SIZE) {
+			return; // flash error
+		}
+	}
+	address = TRICE_FLASH_PAGE_ADDRESS(triceFlashPage) + triceFlashOffset;
+	if (body > 0) {
+		err |= UserTriceFlashProgramFn(address + TRICE_FLASH_PROGRAM_SIZE, enc, body);
+	}
+	if (body < encLen) {
+		memset(unit, 0, sizeof(unit));
+		memcpy(unit, enc + body, encLen - body);
+		err |= UserTriceFlashProgramFn(address + TRICE_FLASH_PROGRAM_SIZE + body, unit, sizeof(unit));
+	}
+	memset(unit, 0xFF, sizeof(unit));
+	memcpy(unit, &len, 2);
+	memcpy(unit + 2, &inv, 2);
+	err |= UserTriceFlashProgramFn(address, unit, sizeof(unit)); // The record is valid only after this.
+	if (err) {
+		TriceErrorCount++;
+		triceFlashOffset = TRICE_FLASH_PAGE_SIZE; // Do not program into a possibly damaged page anymore.
+		return;
+	}
+	triceFlashOffset += size;
+}
+
+//! TriceFlashLogRead copies the next logged trice packages into buf and returns their byte count.
+//! The log is read from the oldest to the newest record. Only complete packages are copied. A package bigger than size is skipped.
+//! \param pCursor is the read position. It needs to be 0 for the first call and is advanced by each call.
+//! \param buf is the destination.
+//! \param size is the byte count of buf. With size >= TRICE_FLASH_PAGE_SIZE each call copies at least one record.
+//! \retval is the copied byte count. 0 means, that all records are read.
+size_t TriceFlashLogRead(uint32_t* pCursor, uint8_t* buf, size_t size) {
+	size_t count = 0;
+	unsigned step = *pCursor / TRICE_FLASH_PAGE_SIZE; // step 0 is the oldest page.
+	uint32_t offset = *pCursor % TRICE_FLASH_PAGE_SIZE;
+	for (; step < TRICE_FLASH_PAGE_COUNT; step++, offset = 0) {
+		unsigned page = (triceFlashPage + 1 + step) % TRICE_FLASH_PAGE_COUNT;
+		uint32_t sequence;
+		if (!triceFlashPageValid(page, &sequence) || (uint32_t)(triceFlashSequence - sequence) >= TRICE_FLASH_PAGE_COUNT) {
+			continue;
+		}
+		if (offset < TRICE_FLASH_HEADER_SIZE) {
+			offset = TRICE_FLASH_HEADER_SIZE;
+		}
+		while (offset + TRICE_FLASH_PROGRAM_SIZE <= TRICE_FLASH_PAGE_SIZE) {
+			int len = triceFlashRecordLength(page, offset);
+			if (len < 0) {
+				break;
+			}
+			if (count + (size_t)len > size) {
+				if (count > 0) {
+					*pCursor = step * TRICE_FLASH_PAGE_SIZE + offset;
+					return count;
+				}
+			} else {
+				UserTriceFlashReadFn(TRICE_FLASH_PAGE_ADDRESS(page) + offset + TRICE_FLASH_PROGRAM_SIZE, buf + count, (size_t)len);
+				count += (size_t)len;
+			}
+			offset += TRICE_FLASH_PROGRAM_SIZE + TRICE_FLASH_ROUND((uint32_t)len);
+		}
+	}
+	*pCursor = step * TRICE_FLASH_PAGE_SIZE;
+	return count;
+}
+
+//! TriceFlashLogErase erases all trice log pages and starts a new log.
+void TriceFlashLogErase(void) {
+	for (unsigned page = 1; page < TRICE_FLASH_PAGE_COUNT; page++) { // Page 0 is erased by triceFlashNewPage.
+		if (UserTriceFlashEraseFn(TRICE_FLASH_PAGE_ADDRESS(page))) {
+			TriceErrorCount++;
+		}
+	}
+	triceFlashPage = TRICE_FLASH_PAGE_COUNT - 1;
+	triceFlashSequence = 0;
+	triceFlashNewPage();
+}
+
+#endif // #if TRICE_DEFERRED_FLASH == 1 && TRICE_OFF == 0
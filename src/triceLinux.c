@@ -0,0 +1,250 @@
+//! \file triceLinux.c
+//! \author Thomas.Hoehenleitner [at] seerose.net
+//! \brief Trice backend for multi-threaded Linux applications.
+//!
+//! Each thread builds its trices on the stack (TRICE_STACK_BUFFER) and frames them with the thread local direct output buffer.
+//! The framed package goes into a ring owned by the thread, which gets allocated with the first trice of the thread.
+//! The ring is a single producer single consumer queue, so trices of different threads never wait for each other.
+//! The flusher thread collects the packages of all rings and writes them with one writev call to the file descriptor.
+//! The trices of a thread stay in order, the trices of different threads interleave as whole packages.
+//! The rings are not blocking: A package not fitting into the ring of its thread is dropped and counted in TriceLinuxDropCount.
+//! That happens, when a thread writes more than TRICE_LINUX_RING_SIZE bytes before the flusher comes around, for example during
+//! a burst longer than the flusher sleep TRICE_LINUX_FLUSH_INTERVAL_US or when the file descriptor is slower than the trice data.
+//! Only a ring bigger than the longest expected burst avoids losses.
+//! //////////////////////////////////////////////////////////////////////////
+#include "trice.h"
+
+#if TRICE_LINUX == 1 && TRICE_OFF == 0
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#if TRICE_BUFFER != TRICE_STACK_BUFFER
+#error configuration: TRICE_LINUX == 1 needs TRICE_BUFFER == TRICE_STACK_BUFFER, because the other buffers are shared by all threads.
+#endif
+
+#if TRICE_DIRECT_OUTPUT != 1 || TRICE_DIRECT_AUXILIARY8 != 1
+#error configuration: TRICE_LINUX == 1 needs TRICE_DIRECT_OUTPUT == 1 and TRICE_DIRECT_AUXILIARY8 == 1.
+#endif
+
+#if TRICE_CYCLE_COUNTER == 1
+#error configuration: TRICE_LINUX == 1 needs TRICE_CYCLE_COUNTER == 0, because the trices of different threads interleave.
+#endif
+
+#if (TRICE_LINUX_RING_SIZE < 256) || (TRICE_LINUX_RING_SIZE & (TRICE_LINUX_RING_SIZE - 1))
+#error configuration: TRICE_LINUX_RING_SIZE needs to be a power of 2 and at least 256.
+#endif
+
+//! triceLinuxRing_t is the trice ring of one thread. The indices are free running byte counters in separate cache lines.
+typedef struct triceLinuxRing {
+	uint32_t writeIndex;         //!< writeIndex is only changed by the owning thread.
+	uint8_t reserved0[60];
+	uint32_t readIndex;          //!< readIndex is only changed by the flusher thread.
+	int closed;                  //!< closed is set, when the owning thread ended.
+	struct triceLinuxRing* next; //!< next is the next registered ring.
+	uint8_t reserved1[48];
+	uint8_t data[TRICE_LINUX_RING_SIZE];
+} triceLinuxRing_t;
+
+//! TriceLinuxDropCount is the count of packages not fitting into the ring of their thread.
+unsigned TriceLinuxDropCount = 0;
+
+//! TriceLinuxWriteErrorCount is the count of failed writes. The data of a failed write are discarded.
+unsigned TriceLinuxWriteErrorCount = 0;
+
+//! triceLinuxThreadRing is the ring of the actual thread or NULL before its first trice.
+static __thread triceLinuxRing_t* triceLinuxThreadRing = NULL;
+
+//! triceLinuxRings is the list of all registered rings. New rings are added at the head.
+static triceLinuxRing_t* triceLinuxRings = NULL;
+
+//! triceLinuxMutex serializes the ring list changes.
+static pthread_mutex_t triceLinuxMutex = PTHREAD_MUTEX_INITIALIZER;
+
+//! triceLinuxKey is used to get notified, when a thread ends.
+static pthread_key_t triceLinuxKey;
+
+//! triceLinuxKeyOnce creates triceLinuxKey once.
+static pthread_once_t triceLinuxKeyOnce = PTHREAD_ONCE_INIT;
+
+static pthread_t triceLinuxFlusherThread;
+static int triceLinuxFd = -1;
+static int triceLinuxStopFlag = 0;
+
+//! triceLinuxStarted is 1 between a successful TriceLinuxStart and TriceLinuxStop.
+static int triceLinuxStarted = 0;
+
+//! triceLinuxThreadEnd marks the ring of an ending thread as closed. The flusher frees it after transmitting the rest.
+//! A trice from a later thread specific data destructor of the same thread registers a new ring then.
+static void triceLinuxThreadEnd(void* p) {
+	triceLinuxThreadRing = NULL;
+	__atomic_store_n(&((triceLinuxRing_t*)p)->closed, 1, __ATOMIC_RELEASE);
+}
+
+static void triceLinuxCreateKey(void) {
+	pthread_key_create(&triceLinuxKey, triceLinuxThreadEnd);
+}
+
+//! triceLinuxRegister allocates and registers the ring of the actual thread.
+static triceLinuxRing_t* triceLinuxRegister(void) {
+	triceLinuxRing_t* r = aligned_alloc(64, sizeof(triceLinuxRing_t));
+	if (r == NULL) {
+		return NULL;
+	}
+	r->writeIndex = 0;
+	r->readIndex = 0;
+	r->closed = 0;
+	pthread_once(&triceLinuxKeyOnce, triceLinuxCreateKey);
+	pthread_setspecific(triceLinuxKey, r);
+	pthread_mutex_lock(&triceLinuxMutex);
+	r->next = triceLinuxRings;
+	__atomic_store_n(&triceLinuxRings, r, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&triceLinuxMutex);
+	triceLinuxThreadRing = r;
+	return r;
+}
+
+//! TriceNonBlockingDirectWriteLinux appends the package enc with encLen bytes to the ring of the actual thread or drops it, when the ring is full.
+void TriceNonBlockingDirectWriteLinux(const uint8_t* enc, size_t encLen) {
+	triceLinuxRing_t* r = triceLinuxThreadRing;
+	if (r == NULL && (r = triceLinuxRegister()) == NULL) {
+		__atomic_fetch_add(&TriceLinuxDropCount, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	uint32_t w = r->writeIndex;
+	uint32_t rd = __atomic_load_n(&r->readIndex, __ATOMIC_ACQUIRE);
+	if (encLen > TRICE_LINUX_RING_SIZE - (w - rd)) {
+		__atomic_fetch_add(&TriceLinuxDropCount, 1, __ATOMIC_RELAXED);
+		return;
+	}
+	uint32_t at = w & (TRICE_LINUX_RING_SIZE - 1);
+	size_t first = TRICE_LINUX_RING_SIZE - at;
+	if (first > encLen) {
+		first = encLen;
+	}
+	memcpy(r->data + at, enc, first);
+	memcpy(r->data, enc + first, encLen - first);
+	__atomic_store_n(&r->writeIndex, w + (uint32_t)encLen, __ATOMIC_RELEASE);
+}
+
+//! triceLinuxWritev writes all count iov buffers and handles partial writes.
+static void triceLinuxWritev(struct iovec* iov, int count) {
+	while (count > 0) {
+		ssize_t n = writev(triceLinuxFd, iov, count);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			TriceLinuxWriteErrorCount++;
+			return;
+		}
+		while (count > 0 && (size_t)n >= iov->iov_len) {
+			n -= iov->iov_len;
+			iov++;
+			count--;
+		}
+		if (count > 0) {
+			iov->iov_base = (uint8_t*)iov->iov_base + n;
+			iov->iov_len -= n;
+		}
+	}
+}
+
+//! TRICE_LINUX_IOV_MAX is the max ring count written with one writev call.
+#define TRICE_LINUX_IOV_MAX 32
+
+//! triceLinuxFlush writes the data of all rings and frees the rings of ended threads.
+//! \retval is the written byte count.
+static size_t triceLinuxFlush(void) {
+	struct iovec iov[2 * TRICE_LINUX_IOV_MAX];
+	triceLinuxRing_t* ring[TRICE_LINUX_IOV_MAX];
+	uint32_t end[TRICE_LINUX_IOV_MAX];
+	size_t total = 0;
+	int k = 0, n = 0;
+	for (triceLinuxRing_t* r = __atomic_load_n(&triceLinuxRings, __ATOMIC_ACQUIRE); r != NULL; r = r->next) {
+		uint32_t w = __atomic_load_n(&r->writeIndex, __ATOMIC_ACQUIRE);
+		uint32_t count = w - r->readIndex;
+		if (count != 0) {
+			uint32_t at = r->readIndex & (TRICE_LINUX_RING_SIZE - 1);
+			uint32_t first = TRICE_LINUX_RING_SIZE - at;
+			if (first > count) {
+				first = count;
+			}
+			iov[n].iov_base = r->data + at;
+			iov[n++].iov_len = first;
+			if (count > first) {
+				iov[n].iov_base = r->data;
+				iov[n++].iov_len = count - first;
+			}
+			ring[k] = r;
+			end[k++] = w;
+			total += count;
+		}
+		if (k == TRICE_LINUX_IOV_MAX || (r->next == NULL && k > 0)) {
+			triceLinuxWritev(iov, n);
+			for (int i = 0; i < k; i++) {
+				__atomic_store_n(&ring[i]->readIndex, end[i], __ATOMIC_RELEASE);
+			}
+			k = n = 0;
+		}
+	}
+	pthread_mutex_lock(&triceLinuxMutex);
+	for (triceLinuxRing_t** p = &triceLinuxRings; *p != NULL;) {
+		triceLinuxRing_t* r = *p;
+		if (__atomic_load_n(&r->closed, __ATOMIC_ACQUIRE) && __atomic_load_n(&r->writeIndex, __ATOMIC_ACQUIRE) == r->readIndex) {
+			*p = r->next;
+			free(r);
+		} else {
+			p = &r->next;
+		}
+	}
+	pthread_mutex_unlock(&triceLinuxMutex);
+	return total;
+}
+
+//! triceLinuxFlusher writes the rings until TriceLinuxStop is called and sleeps TRICE_LINUX_FLUSH_INTERVAL_US, when they are empty.
+static void* triceLinuxFlusher(void* arg) {
+	TRICE_UNUSED(arg)
+	const struct timespec interval = {TRICE_LINUX_FLUSH_INTERVAL_US / 1000000, (TRICE_LINUX_FLUSH_INTERVAL_US % 1000000) * 1000};
+	while (!__atomic_load_n(&triceLinuxStopFlag, __ATOMIC_ACQUIRE)) {
+		if (triceLinuxFlush() == 0) {
+			nanosleep(&interval, NULL);
+		}
+	}
+	while (triceLinuxFlush() != 0) {
+	}
+	return NULL;
+}
+
+//! TriceLinuxStart starts the flusher thread writing the trices of all threads to the file, pipe or socket fd.
+//! \retval is 0 on success, EBUSY when already started, otherwise the pthread_create error.
+int TriceLinuxStart(int fd) {
+	if (triceLinuxStarted) {
+		return EBUSY;
+	}
+	triceLinuxFd = fd;
+	__atomic_store_n(&triceLinuxStopFlag, 0, __ATOMIC_RELEASE);
+	int err = pthread_create(&triceLinuxFlusherThread, NULL, triceLinuxFlusher, NULL);
+	if (err == 0) {
+		triceLinuxStarted = 1;
+		UserNonBlockingDirectWrite8AuxiliaryFn = TriceNonBlockingDirectWriteLinux;
+	}
+	return err;
+}
+
+//! TriceLinuxStop writes all pending trices and ends the flusher thread. The file descriptor is not closed.
+//! Trices written after TriceLinuxStop stay in the rings until the next TriceLinuxStart. Without a running flusher it does nothing.
+void TriceLinuxStop(void) {
+	if (!triceLinuxStarted) {
+		return;
+	}
+	__atomic_store_n(&triceLinuxStopFlag, 1, __ATOMIC_RELEASE);
+	pthread_join(triceLinuxFlusherThread, NULL);
+	triceLinuxStarted = 0;
+}
+
+#endif // #if TRICE_LINUX == 1 && TRICE_OFF == 0
@@ -27,8 +27,49 @@ static int TriceSingleDeferredOut(uint32_t* addr);
 
 #endif
 
+#if TRICE_POST_MORTEM == 1
+
+#define TRICE_RETAINED TRICE_NOINIT //!< TRICE_RETAINED variables keep their values over a reset. TricePostMortemInit initializes them, if needed.
+#define TRICE_RETAINED_INIT(x)      //!< TRICE_RETAINED_INIT(x) is empty, because retained variables are not initialized by the startup code.
+
+#define TRICE_POST_MORTEM_MAGIC 0x5452504d //!< TRICE_POST_MORTEM_MAGIC is "TRPM" and marks valid retained ring buffer values.
+
+#else
+
+#define TRICE_RETAINED              //!< TRICE_RETAINED is empty without TRICE_POST_MORTEM.
+#define TRICE_RETAINED_INIT(x) = x //!< TRICE_RETAINED_INIT(x) is the usual variable initialization without TRICE_POST_MORTEM.
+
+#endif
+
+#if TRICE_RING_BUFFER_EXACT == 1
+
+//! TriceRingBuffer holds the trice messages without gaps. A trice can be split at the buffer end. It needs to be initialized with 0.
+//! No TRICE_DATA_OFFSET space is needed in front, because TriceTransfer encodes inside triceRingBufferReadBuffer.
+//! Together with the staging and the read buffer it needs the same RAM as the ring buffer without TRICE_RING_BUFFER_EXACT.
+uint32_t TriceRingBuffer[TRICE_RING_BUFFER_LOWER_MARGIN + (TRICE_RING_BUFFER_EXACT_SIZE >> 2) + TRICE_RING_BUFFER_UPPER_MARGIN] = {0};
+
+uint32_t* const TriceRingBufferStart = TriceRingBuffer + TRICE_RING_BUFFER_LOWER_MARGIN;
+
+//! triceRingBufferLimit is the first address behind the ring buffer. Trice data continue at TriceRingBufferStart there.
+uint32_t* const triceRingBufferLimit = TriceRingBufferStart + (TRICE_RING_BUFFER_EXACT_SIZE >> 2);
+
+//! TriceRingBufferStaging is the write buffer for the TRICE macros. TRICE_LEAVE copies the finished trice into the ring buffer.
+uint32_t TriceRingBufferStaging[TRICE_BUFFER_SIZE >> 2];
+
+//! triceRingBufferReadBuffer gets the next trice copied in one piece. It is also the scratch pad for the encoding and holds
+//! the encoded data until they are transmitted. TriceTransfer does not read the next trice before that.
+static uint32_t triceRingBufferReadBuffer[TRICE_BUFFER_SIZE >> 2];
+
+//! triceRingBufferCommitPosition is the ring buffer address, where TriceRingBufferCommit writes the next trice.
+static uint32_t* triceRingBufferCommitPosition = TriceRingBufferStart;
+
+//! triceRingBufferDepth32 is the used ring buffer space in 32-bit words. It distinguishes a full from an empty buffer.
+static unsigned triceRingBufferDepth32 = 0;
+
+#else // #if TRICE_RING_BUFFER_EXACT == 1
+
 //! TriceRingBuffer is a kind of heap for trice messages. It needs to be initialized with 0.
-uint32_t TriceRingBuffer[TRICE_RING_BUFFER_LOWER_MARGIN + (TRICE_DATA_OFFSET >> 2) + (TRICE_DEFERRED_BUFFER_SIZE >> 2) + TRICE_RING_BUFFER_UPPER_MARGIN] = {0};
+TRICE_RETAINED uint32_t TriceRingBuffer[TRICE_RING_BUFFER_LOWER_MARGIN + (TRICE_DATA_OFFSET >> 2) + (TRICE_DEFERRED_BUFFER_SIZE >> 2) + TRICE_RING_BUFFER_UPPER_MARGIN] TRICE_RETAINED_INIT({0});
 
 uint32_t* const TriceRingBufferStart = TriceRingBuffer + TRICE_RING_BUFFER_LOWER_MARGIN + (TRICE_DATA_OFFSET >> 2);
 
@@ -38,11 +79,13 @@ uint32_t* const TriceRingBufferStart = TriceRingBuffer + TRICE_RING_BUFFER_LOWER
 //! See also comment inside TriceSingleDeferredOut.
 uint32_t* const triceRingBufferLimit = TriceRingBufferStart + (TRICE_DEFERRED_BUFFER_SIZE >> 2) - TRICE_DEFERRED_XTEA_ENCRYPT;
 
+#endif // #else // #if TRICE_RING_BUFFER_EXACT == 1
+
 //! SingleTricesRingCount holds the readable trices count inside TriceRingBuffer.
-unsigned SingleTricesRingCount = 0;
+TRICE_RETAINED unsigned SingleTricesRingCount TRICE_RETAINED_INIT(0);
 
 //! TriceBufferWritePosition is used by the TRICE_PUT macros.
-uint32_t* TriceBufferWritePosition = TriceRingBufferStart;
+TRICE_RETAINED uint32_t* TriceBufferWritePosition TRICE_RETAINED_INIT(TriceRingBufferStart);
 
 // ARM5 #pragma push
 // ARM5 #pragma diag_suppress=170 //warning:  #170-D: pointer points outside of underlying object
@@ -51,9 +94,29 @@ uint32_t* TriceBufferWritePosition = TriceRingBufferStart;
 //! Initially this value is set to TriceRingBufferStart minus TRICE_DATA_OFFSET byte space
 //! to get a correct value for the very first call of triceNextRingBufferRead
 // uint32_t* TriceRingBufferReadPosition = TriceRingBufferStart - (TRICE_DATA_OFFSET>>2); //lint !e428 Warning 428: negative subscript (-4) in operator 'ptr-int'
-uint32_t* TriceRingBufferReadPosition = TriceRingBufferStart;
+TRICE_RETAINED uint32_t* TriceRingBufferReadPosition TRICE_RETAINED_INIT(TriceRingBufferStart);
 // ARM5 #pragma  pop
 
+#if TRICE_RING_BUFFER_EXACT == 0
+
+//! triceRingBufferLastWordCount is the word count of the trice at TriceRingBufferReadPosition, when it was already read.
+static TRICE_RETAINED int triceRingBufferLastWordCount TRICE_RETAINED_INIT(0);
+
+#endif
+
+#if TRICE_POST_MORTEM == 1
+
+//! tricePostMortemHeader holds TRICE_POST_MORTEM_MAGIC and the layout check value, when the retained values are valid.
+static TRICE_RETAINED uint32_t tricePostMortemHeader[2];
+
+//! tricePostMortemLeft is the count of trices from the previous boot still to transmit plus 1 for the end marker.
+static unsigned tricePostMortemLeft = 0;
+
+//! tricePostMortemBegin is 1, when the begin marker is not transmitted yet.
+static int tricePostMortemBegin = 0;
+
+#endif
+
 #if TRICE_DIAGNOSTICS == 1
 
 //! SingleTricesRingCountMax holds the max count of trices occurred inside the ring buffer.
@@ -65,7 +128,7 @@ int TriceRingBufferDepthMax = 0;
 
 #endif // #if TRICE_DIAGNOSTICS == 1
 
-#if TRICE_PROTECT == 1
+#if (TRICE_PROTECT == 1) && (TRICE_RING_BUFFER_EXACT == 0)
 
 //! TriceEnoughSpace checks, if enough bytes available for the next trice.
 //! \retval 0, when not enough space
@@ -96,7 +159,120 @@ int TriceEnoughSpace(void) {
 	}
 }
 
-#endif // #if TRICE_PROTECT == 1
+#endif // #if (TRICE_PROTECT == 1) && (TRICE_RING_BUFFER_EXACT == 0)
+
+#if (TRICE_RING_BUFFER_EXACT == 1) || (TRICE_POST_MORTEM == 1)
+
+//! triceRingBufferWordCount returns the ring buffer word count of the trice starting at p, including the padding bytes.
+//! The 16-bit stamped trices start with 2 additional bytes. 0 is returned for the not supported extended trices.
+static unsigned triceRingBufferWordCount(const uint32_t* p) {
+	const uint8_t* b = (const uint8_t*)p;
+	uint16_t TID = TRICE_TTOHS(*(uint16_t*)p); // type and id
+	switch (TID >> 14) {
+	case TRICE_TYPE_S0:
+		return (4 + triceDataLen(b + 2) + 3) >> 2; // tyId nc
+	case TRICE_TYPE_S2:
+		return (8 + triceDataLen(b + 6) + 3) >> 2; // tyId tyId ts16 nc
+	case TRICE_TYPE_S4:
+		return (8 + triceDataLen(b + 6) + 3) >> 2; // tyId ts32 nc
+	default:
+		return 0;
+	}
+}
+
+#endif // #if (TRICE_RING_BUFFER_EXACT == 1) || (TRICE_POST_MORTEM == 1)
+
+#if TRICE_RING_BUFFER_EXACT == 1
+
+//! triceRingBufferCopy copies wordCount words from ring buffer address src into dst and returns the ring buffer address behind them.
+//! At the ring buffer end the copying continues at TriceRingBufferStart.
+static uint32_t* triceRingBufferCopy(uint32_t* dst, uint32_t* src, unsigned wordCount) {
+	unsigned room = triceRingBufferLimit - src;
+	if (wordCount < room) {
+		memcpy(dst, src, wordCount << 2);
+		return src + wordCount;
+	}
+	memcpy(dst, src, room << 2);
+	memcpy(dst + room, TriceRingBufferStart, (wordCount - room) << 2);
+	return TriceRingBufferStart + (wordCount - room);
+}
+
+//! TriceRingBufferCommit copies the finished trice with wordCount words from TriceRingBufferStaging into the ring buffer.
+//! The trice is split at the ring buffer end, if needed. Without enough space the trice is dropped, because it would overwrite unread trices.
+//! It is called inside TRICE_LEAVE and therefore inside the TRICE critical section.
+void TriceRingBufferCommit(unsigned wordCount) {
+	unsigned depth32 = triceRingBufferDepth32 + wordCount;
+	if (depth32 > (TRICE_RING_BUFFER_EXACT_SIZE >> 2)) {
+#if (TRICE_PROTECT == 1) && (TRICE_DIAGNOSTICS == 1)
+		TriceDeferredOverflowCount++;
+#endif
+		return;
+	}
+	uint32_t* src = &TriceRingBufferStaging[TRICE_DATA_OFFSET >> 2];
+	unsigned room = triceRingBufferLimit - triceRingBufferCommitPosition;
+	if (wordCount < room) {
+		memcpy(triceRingBufferCommitPosition, src, wordCount << 2);
+		triceRingBufferCommitPosition += wordCount;
+	} else {
+		memcpy(triceRingBufferCommitPosition, src, room << 2);
+		memcpy(TriceRingBufferStart, src + room, (wordCount - room) << 2);
+		triceRingBufferCommitPosition = TriceRingBufferStart + (wordCount - room);
+	}
+	triceRingBufferDepth32 = depth32;
+	SingleTricesRingCount++;
+#if TRICE_DIAGNOSTICS == 1
+	int depth = depth32 << 2;
+	TriceRingBufferDepthMax = (depth > TriceRingBufferDepthMax) ? depth : TriceRingBufferDepthMax;
+#endif
+}
+
+//! triceRingBufferRead copies the next trice in one piece to dst and releases its ring buffer space.
+//! Implicit assumed is, that the pre-condition "SingleTricesRingCount > 0" is fulfilled.
+//! \retval is the trice word count or 0 on inconsistent data. In that case all buffered trices are dropped to resynchronize.
+static unsigned triceRingBufferRead(uint32_t* dst) {
+	unsigned depth32 = triceRingBufferDepth32; // Trices committed meanwhile only increase the value.
+	triceRingBufferCopy(dst, TriceRingBufferReadPosition, depth32 < 2 ? depth32 : 2); // The longest trice header has 8 bytes.
+	unsigned wordCount = triceRingBufferWordCount(dst);
+	if (wordCount == 0 || wordCount > depth32 || wordCount > (TRICE_SINGLE_MAX_SIZE >> 2)) {
+		TRICE_ENTER_CRITICAL_SECTION
+		TriceRingBufferReadPosition = triceRingBufferCommitPosition;
+		triceRingBufferDepth32 = 0;
+		SingleTricesRingCount = 0;
+		TRICE_LEAVE_CRITICAL_SECTION
+		TriceErrorCount++;
+		return 0;
+	}
+	TriceRingBufferReadPosition = triceRingBufferCopy(dst, TriceRingBufferReadPosition, wordCount);
+	TRICE_ENTER_CRITICAL_SECTION
+	triceRingBufferDepth32 -= wordCount;
+	SingleTricesRingCount--;
+	TRICE_LEAVE_CRITICAL_SECTION
+	return wordCount;
+}
+
+//! TriceTransfer needs to be called cyclically to read out the Ring Buffer.
+void TriceTransfer(void) {
+	if (SingleTricesRingCount == 0) { // no data
+		return;
+	}
+#if TRICE_CGO == 0         // In automated tests we assume last transmission is finished, so we do not test depth to be able to test multiple Trices in deferred mode.
+	if (TriceOutDepth()) { // last transmission not finished
+		return;
+	}
+#endif
+	uint32_t* addr = &triceRingBufferReadBuffer[TRICE_DATA_OFFSET >> 2];
+	if (triceRingBufferRead(addr)) {
+		TriceSingleDeferredOut(addr);
+#if TRICE_DEFERRED_FLASH == 1
+		TriceFlashTransfer();
+#endif
+	}
+#if TRICE_DIAGNOSTICS_INTERVAL > 0
+	TriceDiagnosticsTick();
+#endif
+}
+
+#else // #if TRICE_RING_BUFFER_EXACT == 1
 
 //! triceNextRingBufferRead returns a single trice data buffer address. The trice data are starting at byte offset TRICE_DATA_OFFSET from this address.
 //! Implicit assumed is, that the pre-condition "SingleTricesRingCount > 0" is fulfilled.
@@ -120,24 +296,148 @@ static uint32_t* triceNextRingBufferRead(int lastWordCount) {
 	return TriceRingBufferReadPosition; // lint !e674 Warning 674: Returning address of auto through variable 'TriceRingBufferReadPosition'
 }
 
+#if TRICE_POST_MORTEM == 1
+
+//! tricePostMortemLayout returns a value, which changes with the ring buffer location and size, for example after a firmware update.
+static uint32_t tricePostMortemLayout(void) {
+	return (uint32_t)(uintptr_t)TriceRingBufferStart ^ ((uint32_t)TRICE_DEFERRED_BUFFER_SIZE << 8) ^ TRICE_DATA_OFFSET;
+}
+
+//! tricePostMortemRecover checks the retained ring buffer values and returns the count of complete trices from the previous boot.
+//! It follows the trices from the first not transmitted one to TriceBufferWritePosition the same way TriceTransfer does.
+//! A trice, which was not finished before the reset, is removed. The data itself are not checked, so this costs nothing at runtime.
+//! \retval -1 on inconsistent values
+static int tricePostMortemRecover(void) {
+	uint32_t* r = TriceRingBufferReadPosition;
+	uint32_t* w = TriceBufferWritePosition;
+	int last = triceRingBufferLastWordCount;
+	if (tricePostMortemHeader[0] != TRICE_POST_MORTEM_MAGIC || tricePostMortemHeader[1] != tricePostMortemLayout() ||
+	    r < TriceRingBufferStart || r > triceRingBufferLimit || w < TriceRingBufferStart || w > triceRingBufferLimit ||
+	    last < 0 || last > (TRICE_SINGLE_MAX_SIZE >> 2) || SingleTricesRingCount > (TRICE_DEFERRED_BUFFER_SIZE >> 2)) {
+		return -1;
+	}
+	uint32_t* p = r + last;
+	if ((p + (TRICE_BUFFER_SIZE >> 2)) > triceRingBufferLimit) {
+		p = TriceRingBufferStart;
+	}
+	uint32_t* first = p;
+	unsigned count = 0;
+	while (p != w) {
+		if ((p + (TRICE_BUFFER_SIZE >> 2)) > triceRingBufferLimit) {
+			p = TriceRingBufferStart;
+			if (p == w) {
+				break;
+			}
+		}
+		unsigned wordCount = triceRingBufferWordCount(p);
+		if (wordCount == 0 || wordCount > (TRICE_SINGLE_MAX_SIZE >> 2) || (p < w && p + wordCount > w)) {
+			break; // not finished trice
+		}
+		p += wordCount;
+		count++;
+		if (count > SingleTricesRingCount + 1) { // TriceTransfer decrements SingleTricesRingCount before it moves the read position.
+			return -1;
+		}
+	}
+	if (count < SingleTricesRingCount) {
+		return -1;
+	}
+	TriceBufferWritePosition = p;
+	TriceRingBufferReadPosition = first;
+	triceRingBufferLastWordCount = 0;
+	SingleTricesRingCount = count;
+	return count;
+}
+
+//! TricePostMortemInit is called by TriceInit. It keeps the not transmitted trices of the previous boot or initializes the ring buffer.
+void TricePostMortemInit(void) {
+	int count = tricePostMortemRecover();
+	if (count < 0) {
+		TriceBufferWritePosition = TriceRingBufferStart;
+		TriceRingBufferReadPosition = TriceRingBufferStart;
+		triceRingBufferLastWordCount = 0;
+		SingleTricesRingCount = 0;
+		count = 0;
+	}
+	tricePostMortemBegin = count > 0;
+	tricePostMortemLeft = count > 0 ? count + 1 : 0;
+	tricePostMortemHeader[0] = TRICE_POST_MORTEM_MAGIC;
+	tricePostMortemHeader[1] = tricePostMortemLayout();
+}
+
+//! tricePostMortemMarker transmits a TRICE_POST_MORTEM_ID marker with value.
+//! The value is the trice count of the previous boot for the begin marker and 0 for the end marker.
+static void tricePostMortemMarker(uint32_t value) {
+	static uint32_t buf[(TRICE_DATA_OFFSET >> 2) + 3]; // 2 words marker and 1 word scratch pad for encryption
+	uint32_t* addr = &buf[TRICE_DATA_OFFSET >> 2];
+	uint16_t* p = (uint16_t*)addr;
+	p[0] = TRICE_HTOTS((TRICE_TYPE_S0 << 14) | TRICE_POST_MORTEM_ID);
+	p[1] = TRICE_HTOTS(0x04C0); // 4 data bytes and the cycle counter start value
+	addr[1] = TRICE_HTOTL(value);
+	TriceSingleDeferredOut(addr);
+}
+
+//! tricePostMortemTransfer transmits the post mortem markers in front of and behind the trices from the previous boot.
+//! \retval 1, when a marker was transmitted
+static int tricePostMortemTransfer(void) {
+	if (tricePostMortemBegin) {
+		tricePostMortemBegin = 0;
+		tricePostMortemMarker(tricePostMortemLeft - 1);
+		return 1;
+	}
+	if (tricePostMortemLeft == 1) {
+		tricePostMortemLeft = 0;
+		tricePostMortemMarker(0);
+		return 1;
+	}
+	tricePostMortemLeft--;
+	return 0;
+}
+
+#endif // #if TRICE_POST_MORTEM == 1
+
 //! TriceTransfer needs to be called cyclically to read out the Ring Buffer.
 void TriceTransfer(void) {
+#if TRICE_POST_MORTEM == 1
+	if (SingleTricesRingCount == 0 && tricePostMortemLeft == 0) { // no data
+#else
 	if (SingleTricesRingCount == 0) { // no data
+#endif
 		return;
 	}
 #if TRICE_CGO == 0         // In automated tests we assume last transmission is finished, so we do not test depth to be able to test multiple Trices in deferred mode.
 	if (TriceOutDepth()) { // last transmission not finished
 		return;
 	}
+#endif
+#if TRICE_POST_MORTEM == 1
+	if (tricePostMortemLeft && tricePostMortemTransfer()) {
+#if TRICE_DEFERRED_FLASH == 1
+		TriceFlashTransfer();
+#endif
+		return;
+	}
 #endif
 	TRICE_ENTER_CRITICAL_SECTION
 	SingleTricesRingCount--;
 	TRICE_LEAVE_CRITICAL_SECTION
-	static int lastWordCount = 0;
-	uint32_t* addr = triceNextRingBufferRead(lastWordCount);
-	lastWordCount = TriceSingleDeferredOut(addr);
+	uint32_t* addr = triceNextRingBufferRead(triceRingBufferLastWordCount);
+#if TRICE_POST_MORTEM == 1
+	triceRingBufferLastWordCount = triceRingBufferWordCount(addr); // The retained values need to be valid already during the transmission.
+	TriceSingleDeferredOut(addr);
+#else
+	triceRingBufferLastWordCount = TriceSingleDeferredOut(addr);
+#endif
+#if TRICE_DEFERRED_FLASH == 1
+	TriceFlashTransfer();
+#endif
+#if TRICE_DIAGNOSTICS_INTERVAL > 0
+	TriceDiagnosticsTick();
+#endif
 }
 
+#endif // #else // #if TRICE_RING_BUFFER_EXACT == 1
+
 //! TriceIDAndBuffer evaluates a trice message and returns the ID for routing.
 //! \param pData is where the trice message starts.
 //! \param pWordCount is filled with the word count the trice data occupy from pData.
@@ -205,6 +505,18 @@ static int TriceSingleDeferredOut(uint32_t* addr) {
 	uint8_t* pTriceNetStart;
 	size_t triceNetLength; // without padding bytes
 	int triceID = TriceIDAndBuffer(addr, &wordCount, &pTriceNetStart, &triceNetLength);
+#if TRICE_DEFERRED_COMPRESS == 1
+	if (triceNetLength) {
+		triceNetLength = TriceCompress(triceCompressBuffer, pTriceNetStart, triceNetLength);
+		pTriceNetStart = triceCompressBuffer;
+	}
+#endif
+#if TRICE_DEFERRED_STREAM_ENCRYPT == 1
+	if (triceNetLength) {
+		triceNetLength = TriceStreamEncrypt(triceStreamBuffer, pTriceNetStart, triceNetLength);
+		pTriceNetStart = triceStreamBuffer;
+	}
+#endif
 	// We can let TRICE_DATA_OFFSET only in front of the ring buffer and pack the Trices without offset space.
 	// And if we allow as max depth only ring buffer size minus TRICE_DATA_OFFSET, we can use space in front of each Trice.
 
@@ -248,7 +560,11 @@ static int TriceSingleDeferredOut(uint32_t* addr) {
 	// enc                 addr  pTriceNetStart           nextData
 	// ^-TRICE_DATA_OFFSET-^-0|2-^-triceNetLength+(0...3)-^
 	// ^-encLen->firstNotModifiedAddress
+#if (TRICE_DEFERRED_COMPRESS == 1) || (TRICE_DEFERRED_STREAM_ENCRYPT == 1)
+	uint8_t* nextData = (uint8_t*)(addr + wordCount); // pTriceNetStart points into triceCompressBuffer or triceStreamBuffer here.
+#else
 	uint8_t* nextData = (uint8_t*)(((uintptr_t)(pTriceNetStart + triceNetLength + 3)) & ~3);
+#endif
 	uint8_t* firstNotModifiedAddress = enc + encLen;
 	int distance = nextData - firstNotModifiedAddress;
 	int triceDataOffsetDepth = TRICE_DATA_OFFSET - distance; // distance could get > TRICE_DATA_OFFSET, so TriceDataOffsetDepthMax stays unchanged then.
@@ -0,0 +1,120 @@
+//! \file triceShm.c
+//! \author Thomas.Hoehenleitner [at] seerose.net
+//! \brief Deferred trice output into a POSIX shared memory ring for targets running on Linux.
+//!
+//! The ring is a single producer single consumer byte queue. The writer is this code, the reader is "trice log -p SHM".
+//! The shared memory starts with a triceShmHeader_t followed by TRICE_SHM_SIZE data bytes. Write and read index are
+//! free running 32-bit byte counters in separate cache lines, each changed only by one side. A package is copied into
+//! the ring first and published afterwards with the write index, so the reader sees only complete packages.
+//! A package not fitting into the free space is dropped and counted in the header, which the trice tool reports as lost.
+//! No system call is needed for writing or reading, when data are there.
+//! //////////////////////////////////////////////////////////////////////////
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L //!< ftruncate, shm_open and mmap are POSIX and not declared with -std=c99 otherwise.
+#endif
+#include "trice.h"
+
+#if TRICE_SHM == 1 && TRICE_OFF == 0
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if TRICE_DEFERRED_AUXILIARY8 == 0
+#error configuration: TRICE_SHM == 1 needs TRICE_DEFERRED_AUXILIARY8 == 1.
+#endif
+
+#if (TRICE_SHM_SIZE < 1024) || (TRICE_SHM_SIZE & (TRICE_SHM_SIZE - 1))
+#error configuration: TRICE_SHM_SIZE needs to be a power of 2 and at least 1024.
+#endif
+
+//! TRICE_SHM_MAGIC marks an initialized trice shared memory ring ("TRSH").
+#define TRICE_SHM_MAGIC 0x54525348
+
+//! triceShmHeader_t is the shared memory layout in front of the ring data. The trice tool uses the same offsets.
+typedef struct {
+	uint32_t magic;      //!< magic is TRICE_SHM_MAGIC, when the other values are valid.
+	uint32_t size;       //!< size is TRICE_SHM_SIZE.
+	uint32_t drop;       //!< drop is the count of dropped packages.
+	uint8_t reserved0[52];
+	uint32_t writeIndex; //!< writeIndex is only changed by the writer.
+	uint8_t reserved1[60];
+	uint32_t readIndex;  //!< readIndex is only changed by the reader.
+	uint8_t reserved2[60];
+} triceShmHeader_t;
+
+//! TriceShmDropCount is the count of packages not fitting into the ring.
+unsigned TriceShmDropCount = 0;
+
+//! triceShm is the mapped shared memory or NULL.
+static triceShmHeader_t* triceShm = NULL;
+
+//! triceShmData is the ring data start.
+static uint8_t* triceShmData;
+
+//! TriceShmOpen creates or opens the shared memory name (like "/trice") and assigns UserNonBlockingDeferredWrite8AuxiliaryFn.
+//! An existing ring with the same size is continued, so a restarted simulation does not disturb a running trice tool.
+//! \retval 0 on success, -1 on failure.
+int TriceShmOpen(const char* name) {
+	size_t size = sizeof(triceShmHeader_t) + TRICE_SHM_SIZE;
+	int fd = shm_open(name, O_RDWR | O_CREAT, 0666);
+	if (fd < 0) {
+		return -1;
+	}
+	if (ftruncate(fd, (off_t)size) != 0) {
+		close(fd);
+		return -1;
+	}
+	void* p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (p == MAP_FAILED) {
+		return -1;
+	}
+	triceShm = (triceShmHeader_t*)p;
+	triceShmData = (uint8_t*)p + sizeof(triceShmHeader_t);
+	if (__atomic_load_n(&triceShm->magic, __ATOMIC_ACQUIRE) != TRICE_SHM_MAGIC || triceShm->size != TRICE_SHM_SIZE) {
+		__atomic_store_n(&triceShm->magic, 0, __ATOMIC_RELEASE); // a reader detaches
+		triceShm->size = TRICE_SHM_SIZE;
+		triceShm->drop = 0;
+		triceShm->writeIndex = 0;
+		triceShm->readIndex = 0;
+		__atomic_store_n(&triceShm->magic, TRICE_SHM_MAGIC, __ATOMIC_RELEASE);
+	}
+	UserNonBlockingDeferredWrite8AuxiliaryFn = TriceNonBlockingDeferredWriteShm;
+	return 0;
+}
+
+//! TriceNonBlockingDeferredWriteShm appends the package enc with encLen bytes to the ring or drops it, when the ring is full.
+void TriceNonBlockingDeferredWriteShm(const uint8_t* enc, size_t encLen) {
+	if (triceShm == NULL) {
+		return;
+	}
+	uint32_t w = triceShm->writeIndex;
+	uint32_t r = __atomic_load_n(&triceShm->readIndex, __ATOMIC_ACQUIRE);
+	if (encLen > TRICE_SHM_SIZE - (w - r)) {
+		TriceShmDropCount++;
+		__atomic_store_n(&triceShm->drop, triceShm->drop + 1, __ATOMIC_RELAXED);
+		return;
+	}
+	uint32_t at = w & (TRICE_SHM_SIZE - 1);
+	size_t first = TRICE_SHM_SIZE - at;
+	if (first > encLen) {
+		first = encLen;
+	}
+	memcpy(triceShmData + at, enc, first);
+	memcpy(triceShmData, enc + first, encLen - first);
+	__atomic_store_n(&triceShm->writeIndex, w + (uint32_t)encLen, __ATOMIC_RELEASE);
+}
+
+//! TriceShmClose unmaps the shared memory. The ring stays for the reader until it is removed with shm_unlink.
+void TriceShmClose(void) {
+	if (triceShm != NULL) {
+		UserNonBlockingDeferredWrite8AuxiliaryFn = (void*)0;
+		munmap(triceShm, sizeof(triceShmHeader_t) + TRICE_SHM_SIZE);
+		triceShm = NULL;
+	}
+}
+
+#endif // #if TRICE_SHM == 1 && TRICE_OFF == 0
@@ -0,0 +1,6 @@
+#include "trice.h"
+
+// TargetActivity writes a 104 bytes TRice64 with n as first value.
+void TargetActivity(int n) {
+	TRice64(iD(16202), "msg:Twelve 64-bit values: %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", n, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11, -12);
+}
@@ -0,0 +1,62 @@
+package cgot
+
+// For some reason inside the trice_test.go an 'import "C"' is not possible.
+
+// #include <stdlib.h>
+// #include "../testdata/cgoFlash.c"
+// void TargetActivity( int n );
+import "C"
+
+import (
+	"os"
+	"path/filepath"
+	"unsafe"
+)
+
+// flashImage is the file emulating the flash memory.
+var flashImage = filepath.Join(os.TempDir(), "dblB_de_flash_tcobs_ua.img")
+
+// init runs before the init function inside generated_cgoPackage.go, because of the file name order, so TriceInit finds the flash emulator.
+func init() {
+	fn := C.CString(flashImage)
+	defer C.free(unsafe.Pointer(fn))
+	if C.CgoFlashOpen(fn) != 0 {
+		panic("cannot create " + flashImage)
+	}
+}
+
+func targetActivity(n int) {
+	C.TargetActivity(C.int(n))
+}
+
+// triceFlashLogInit is like a target reset.
+func triceFlashLogInit() {
+	C.TriceFlashLogInit()
+}
+
+func triceFlashLogErase() {
+	C.TriceFlashLogErase()
+}
+
+// triceFlashLogRead returns the whole flash log using the target read-out function with buffer size size.
+func triceFlashLogRead(size int) (log []byte) {
+	b := make([]byte, size)
+	var cursor C.uint32_t
+	for {
+		n := int(C.TriceFlashLogRead(&cursor, (*C.uint8_t)(unsafe.Pointer(&b[0])), C.size_t(size)))
+		if n == 0 {
+			return
+		}
+		log = append(log, b[:n]...)
+	}
+}
+
+// cgoFlashInCriticalSection returns the count of flash operations inside a critical section.
+func cgoFlashInCriticalSection() int {
+	return int(C.CgoFlashInCriticalSection)
+}
+
+// cgoFlashPowerFail lets flash programming stop after count operations. count -1 ends the power fail.
+func cgoFlashPowerFail(count int) {
+	C.CgoFlashPowerFail(C.int(count))
+}
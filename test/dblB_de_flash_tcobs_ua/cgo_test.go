@@ -0,0 +1,92 @@
+package cgot
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"path"
+	"strings"
+	"testing"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+func TestLogs(t *testing.T) {
+
+	// triceLog is the log function for executing the trice logging on binary log data in buffer as space separated numbers.
+	// It uses the inside fSys specified til.json and returns the log output.
+	triceLog := func(t *testing.T, fSys *afero.Afero, buffer string) string {
+		var o bytes.Buffer
+		assert.Nil(t, args.Handler(io.Writer(&o), fSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buffer, "-hs=off", "-prefix=off", "-li=off", "-color=off"}))
+		return o.String()
+	}
+
+	triceLogTest(t, triceLog, testLines)
+}
+
+// flashActivity executes targetActivity for each value in values as separate TriceTransfer.
+// It returns the framed package size of the last trice.
+func flashActivity(values ...int) (size int) {
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+	for _, n := range values {
+		targetActivity(n)
+		triceTransfer()
+		size = triceOutDepth()
+		triceClearOutBuffer()
+	}
+	return
+}
+
+// sequence returns the values from first to last.
+func sequence(first, last int) (values []int) {
+	for n := first; n <= last; n++ {
+		values = append(values, n)
+	}
+	return
+}
+
+// checkFlashLog compares the flash log, got with the target read-out function and from the flash image, with the expected values.
+func checkFlashLog(t *testing.T, values ...int) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	var exp []string
+	for _, n := range values {
+		exp = append(exp, fmt.Sprintf(" 842,150_450 Twelve 64-bit values: %d,-2,-3,-4,-5,-6,-7,-8,-9,-10,-11,-12", n))
+	}
+	logArgs := []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-hs=off", "-prefix=off", "-li=off", "-color=none"}
+
+	for _, size := range []int{512, 200} { // 200 bytes hold only one record per call.
+		buf := fmt.Sprint(triceFlashLogRead(size))
+		var o bytes.Buffer
+		assert.Nil(t, args.Handler(io.Writer(&o), osFSys, append(logArgs, "-p=BUFFER", "-args", buf[1:len(buf)-1])))
+		assert.Equal(t, strings.Join(exp, "\n"), strings.TrimSuffix(o.String(), "\n"))
+	}
+
+	var o bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&o), osFSys, append(logArgs, "-p=FLASHIMAGE", "-args", flashImage)))
+	assert.Equal(t, strings.Join(exp, "\n"), strings.TrimSuffix(o.String(), "\n"))
+}
+
+// TestFlashLogWrap checks, that the oldest page is erased, when the log wraps.
+func TestFlashLogWrap(t *testing.T) {
+	triceFlashLogErase()
+	size := flashActivity(0)
+	perPage := (512 - 16) / (8 + (size+7)&^7)  // page size minus page header divided by the record size
+	flashActivity(sequence(1, 4*perPage+1)...) // The 2 last records need the 5th page, so page 0 gets erased.
+	checkFlashLog(t, sequence(perPage, 4*perPage+1)...)
+	assert.Equal(t, 0, cgoFlashInCriticalSection()) // TriceTransfer erases and programs outside the critical section.
+}
+
+// TestFlashLogPowerFail checks, that an incomplete record from a power fail is ignored and the log continues after a reset.
+func TestFlashLogPowerFail(t *testing.T) {
+	triceFlashLogErase()
+	flashActivity(0, 1, 2, 3, 4, 5)
+	cgoFlashPowerFail(1) // The record data get programmed only partially and the record header not.
+	flashActivity(6)
+	cgoFlashPowerFail(-1)
+	triceFlashLogInit() // reset
+	flashActivity(7, 8, 9)
+	checkFlashLog(t, 0, 1, 2, 3, 4, 5, 7, 8, 9)
+}
@@ -0,0 +1,39 @@
+/*! \file triceConfig.h
+\author Thomas.Hoehenleitner [at] seerose.net
+*******************************************************************************/
+
+#ifndef TRICE_CONFIG_H_
+#define TRICE_CONFIG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRICE_DEFERRED_OUTPUT 1
+#define TRICE_DEFERRED_UARTA 1
+#define TRICE_UARTA
+
+#define TRICE_DEFERRED_FLASH 1
+#define TRICE_FLASH_PAGE_SIZE 512
+#define TRICE_FLASH_PAGE_COUNT 4
+#define TRICE_FLASH_PROGRAM_SIZE 8
+
+//! CgoCriticalSection counts the open critical sections, so the flash emulator detects operations inside.
+extern int CgoCriticalSection;
+#define TRICE_ENTER_CRITICAL_SECTION \
+	{                                \
+		CgoCriticalSection++;        \
+		{
+#define TRICE_LEAVE_CRITICAL_SECTION \
+	}                                \
+	CgoCriticalSection--;            \
+	}
+
+#define TRICE_CGO 1
+#define TRICE_CYCLE_COUNTER 0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRICE_CONFIG_H_ */
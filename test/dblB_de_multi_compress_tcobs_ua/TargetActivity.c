@@ -0,0 +1,11 @@
+#include "trice.h"
+
+// TargetActivity writes several Trices for one transfer. Some get longer by the compression, some shorter.
+void TargetActivity(void) {
+	TRice(iD(16200), "Hello ");
+	TRice(iD(16201), "World!\n");
+	trice(iD(16203), "Hello again\n");
+	trice(iD(16203), "Hello again\n");
+	TRice64(iD(16202), "msg:Twelve 64-bit values: %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", -1, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11, -12);
+	trice(iD(16203), "Hello again\n");
+}
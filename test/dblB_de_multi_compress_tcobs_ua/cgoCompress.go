@@ -0,0 +1,13 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package cgot
+
+// #include <stdint.h>
+// void TriceCompressReset( void );
+import "C"
+
+// triceCompressReset lets the next trice start with a fresh compression state.
+func triceCompressReset() {
+	C.TriceCompressReset()
+}
@@ -0,0 +1,16 @@
+package cgot
+
+// For some reason inside the trice_test.go an 'import "C"' is not possible.
+
+// void TargetActivity( void );
+// extern unsigned TriceErrorCount;
+import "C"
+
+func targetActivity() {
+	C.TargetActivity()
+}
+
+// triceErrorCount returns the target internal error count.
+func triceErrorCount() int {
+	return int(C.TriceErrorCount)
+}
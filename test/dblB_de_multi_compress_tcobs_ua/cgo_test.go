@@ -0,0 +1,72 @@
+package cgot
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"path"
+	"strings"
+	"testing"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+func TestLogs(t *testing.T) {
+
+	// triceLog is the log function for executing the trice logging on binary log data in buffer as space separated numbers.
+	// It uses the inside fSys specified til.json and returns the log output.
+	triceLog := func(t *testing.T, fSys *afero.Afero, buffer string) string {
+		var o bytes.Buffer
+		assert.Nil(t, args.Handler(io.Writer(&o), fSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buffer, "-hs=off", "-prefix=off", "-li=off", "-color=off", "-compressed"}))
+		return o.String()
+	}
+
+	compressLogTest(t, triceLog, testLines)
+}
+
+// compressLogTest works like triceLogTest but resets the target compression state for each line,
+// because each triceLog call starts with a fresh trice tool decompression state.
+func compressLogTest(t *testing.T, triceLog logF, limit int) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+	result := getExpectedResults(osFSys, path.Join(triceDir, "./test/testdata/triceCheck.c"))
+	for i, r := range result {
+		if limit >= 0 && i+1 >= limit {
+			return
+		}
+		fmt.Println(i, r)
+		triceCompressReset()
+		triceCheck(r.line)
+		triceTransfer()
+		bin := out[:triceOutDepth()]
+		buf := fmt.Sprint(bin)
+		act := triceLog(t, osFSys, buf[1:len(buf)-1])
+		triceClearOutBuffer()
+		assert.Equal(t, r.exps, strings.TrimSuffix(act, "\n"))
+	}
+}
+
+// TestMultiPack checks several compressed Trices in one package. Compressed Trices can be longer than the original ones.
+func TestMultiPack(t *testing.T) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+	triceTransfer() // The buffer of the last transmission in TestLogs gets free only here.
+	triceClearOutBuffer()
+	triceCompressReset()
+	errorCount := triceErrorCount()
+
+	targetActivity()
+	triceTransfer()
+
+	buf := fmt.Sprint(out[:triceOutDepth()])
+	var o bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&o), osFSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buf[1 : len(buf)-1], "-hs=off", "-prefix=off", "-li=off", "-color=none", "-compressed"}))
+
+	exp := " 842,150_450 Hello World!\n             Hello again\n             Hello again\n 842,150_450 Twelve 64-bit values: -1,-2,-3,-4,-5,-6,-7,-8,-9,-10,-11,-12\n             Hello again"
+	assert.Equal(t, exp, strings.TrimSuffix(o.String(), "\n"))
+	assert.Equal(t, errorCount, triceErrorCount())
+}
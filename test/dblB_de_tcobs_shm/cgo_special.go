@@ -0,0 +1,32 @@
+package cgot
+
+// For some reason inside the trice_test.go an 'import "C"' is not possible.
+
+// #include <stdlib.h>
+// #include "../../src/triceShm.c"
+// static unsigned triceShmPending(void) { return triceShm->writeIndex - __atomic_load_n(&triceShm->readIndex, __ATOMIC_ACQUIRE); }
+import "C"
+
+import "unsafe"
+
+// triceShmOpen creates the shared memory ring name and lets the deferred auxiliary output write into it.
+func triceShmOpen(name string) int {
+	s := C.CString(name)
+	defer C.free(unsafe.Pointer(s))
+	return int(C.TriceShmOpen(s))
+}
+
+// triceShmClose unmaps the shared memory ring.
+func triceShmClose() {
+	C.TriceShmClose()
+}
+
+// triceShmPending returns the count of ring bytes not read yet.
+func triceShmPending() int {
+	return int(C.triceShmPending())
+}
+
+// triceShmDropCount returns the count of packages not fitting into the ring.
+func triceShmDropCount() int {
+	return int(C.TriceShmDropCount)
+}
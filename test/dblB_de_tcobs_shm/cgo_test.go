@@ -0,0 +1,135 @@
+package cgot
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"os"
+	"path"
+	"regexp"
+	"strings"
+	"sync"
+	"testing"
+	"time"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/rokath/trice/internal/receiver"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+// shmName returns the shared memory name for the test and removes the ring after the test.
+func shmName(t *testing.T) string {
+	if _, err := os.Stat("/dev/shm"); err != nil {
+		t.Skip("no /dev/shm")
+	}
+	name := fmt.Sprint("/triceCgoTest", os.Getpid())
+	t.Cleanup(func() { os.Remove("/dev/shm" + name) })
+	return name
+}
+
+// checkResults returns the expected triceCheck results, which are compiled without TRICE_CGO == 1.
+// The auxiliary output needs TRICE_CGO == 0 here, so the trices behind "#if TRICE_CGO == 1" in triceCheck.c do not exist.
+func checkResults(t *testing.T, fSys *afero.Afero) []results {
+	fn := path.Join(triceDir, "./test/testdata/triceCheck.c")
+	f, err := fSys.Open(fn)
+	assert.Nil(t, err)
+	defer f.Close()
+	result := getExpectedResults(fSys, fn)
+	for i, line := range linesInFile(f) {
+		if line == "#if TRICE_CGO == 1" { // the block in the switch, not the one around the TriceCheck helpers
+			for k, r := range result {
+				if r.line > i {
+					result = result[:k]
+					break
+				}
+			}
+			break
+		}
+	}
+	if testLines >= 0 && testLines < len(result) {
+		result = result[:testLines]
+	}
+	return result
+}
+
+// TestSHM writes each triceCheck trice over triceShm.c into the shared memory ring and reads it back with the SHM port receiver.
+// The received bytes are decoded separately, so each trice is compared with its expected result.
+func TestSHM(t *testing.T) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	name := shmName(t)
+	assert.Equal(t, 0, triceShmOpen(name))
+	defer triceShmClose()
+	rwc, err := receiver.NewReadWriteCloser(io.Discard, osFSys, false, "SHM", name)
+	assert.Nil(t, err)
+	defer rwc.Close()
+
+	b := make([]byte, 32768)
+	for _, r := range checkResults(t, osFSys) {
+		triceCheck(r.line)
+		triceTransfer()
+		var bin []byte
+		for n, _ := rwc.Read(b); n > 0; n, _ = rwc.Read(b) {
+			bin = append(bin, b[:n]...)
+		}
+		buf := fmt.Sprint(bin)
+		var o bytes.Buffer
+		assert.Nil(t, args.Handler(io.Writer(&o), osFSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buf[1 : len(buf)-1], "-hs=off", "-prefix=off", "-li=off", "-color=off"}))
+		assert.Equal(t, r.exps, strings.TrimSuffix(o.String(), "\n"), fmt.Sprint("line ", r.line))
+	}
+	assert.Equal(t, 0, triceShmDropCount())
+}
+
+// syncBuffer is a bytes.Buffer for a concurrent writer.
+type syncBuffer struct {
+	mu sync.Mutex
+	b  bytes.Buffer
+}
+
+func (p *syncBuffer) Write(b []byte) (int, error) {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	return p.b.Write(b)
+}
+
+func (p *syncBuffer) String() string {
+	p.mu.Lock()
+	defer p.mu.Unlock()
+	return p.b.String()
+}
+
+// TestSHMLog decodes the triceCheck trices with "trice log -p SHM" while the target code writes them into the shared memory ring.
+// Trices without newline continue their line with the next trice here, which gets no stamp then.
+// So the output is compared without line ends and stamps.
+// The SHM port waits for data and does not return, so the log stays running until the test binary ends.
+// This test needs to be the last in the package, because the log holds the args and receiver settings.
+func TestSHMLog(t *testing.T) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	name := shmName(t)
+	assert.Equal(t, 0, triceShmOpen(name))
+	defer triceShmClose()
+	var o syncBuffer
+	go func() {
+		_ = args.Handler(&o, osFSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=SHM", "-args", name, "-hs=off", "-prefix=off", "-li=off", "-color=off"})
+	}()
+
+	var exp strings.Builder
+	for _, r := range checkResults(t, osFSys) {
+		triceCheck(r.line)
+		triceTransfer()
+		exp.WriteString(r.exps)
+		for triceShmPending() > 0 { // The ring is smaller than all trices together.
+			time.Sleep(100 * time.Microsecond)
+		}
+	}
+	stamp := regexp.MustCompile(`time: *[0-9,_]*default: |\n`)
+	want := stamp.ReplaceAllString(exp.String(), "")
+	var act string
+	for timeout := time.Now().Add(5 * time.Second); time.Now().Before(timeout); time.Sleep(10 * time.Millisecond) {
+		if act = stamp.ReplaceAllString(o.String(), ""); len(act) >= len(want) {
+			break
+		}
+	}
+	assert.Equal(t, want, act)
+	assert.Equal(t, 0, triceShmDropCount())
+}
@@ -0,0 +1,24 @@
+/*! \file triceConfig.h
+\author Thomas.Hoehenleitner [at] seerose.net
+*******************************************************************************/
+
+#ifndef TRICE_CONFIG_H_
+#define TRICE_CONFIG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRICE_DEFERRED_OUTPUT 1
+#define TRICE_DEFERRED_AUXILIARY8 1
+#define TRICE_SHM 1
+#define TRICE_SHM_SIZE 4096 // small, so the ring wraps often
+
+#define TRICE_CGO 0 // The auxiliary output goes into the shared memory ring and not into the CGO test buffer.
+#define TRICE_CYCLE_COUNTER 0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRICE_CONFIG_H_ */
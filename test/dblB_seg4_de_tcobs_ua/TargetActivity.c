@@ -0,0 +1,11 @@
+#include "trice.h"
+
+// Each segment has 2048/4 - TRICE_DATA_OFFSET = 448 bytes space.
+// A segment is closed, when less than TRICE_SINGLE_MAX_SIZE = 104 bytes are left, so 4 TRice64 with 104 bytes fit into each segment.
+void TargetActivity(void) {
+	TRice(iD(16200), "Hello ");    // 8 bytes
+	TRice(iD(16201), "World!\n");  // 8 bytes
+	for (int i = 0; i < 17; i++) { // 16 fit into the 4 segments, the 17th gets dropped.
+		TRice64(iD(16202), "msg:Twelve 64-bit values: %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", -1, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11, -12);
+	}
+}
@@ -0,0 +1,10 @@
+package cgot
+
+// For some reason inside the trice_test.go an 'import "C"' is not possible.
+
+// void TargetActivity( void );
+import "C"
+
+func targetActivity() {
+	C.TargetActivity()
+}
@@ -0,0 +1,51 @@
+package cgot
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"path"
+	"strings"
+	"testing"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+func TestLogs(t *testing.T) {
+
+	// triceLog is the log function for executing the trice logging on binary log data in buffer as space separated numbers.
+	// It uses the inside fSys specified til.json and returns the log output.
+	triceLog := func(t *testing.T, fSys *afero.Afero, buffer string) string {
+		var o bytes.Buffer
+		assert.Nil(t, args.Handler(io.Writer(&o), fSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buffer, "-hs=off", "-prefix=off", "-li=off", "-color=off"}))
+		return o.String()
+	}
+
+	triceLogTest(t, triceLog, testLines)
+}
+
+// TestBurst checks, that a Trice burst fills all 4 segments and that TriceTransfer transmits them in order.
+func TestBurst(t *testing.T) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+	triceTransfer() // The segment of the last transmission in TestLogs gets free only here.
+
+	targetActivity()
+
+	var bin []byte
+	for i := 0; i < 5; i++ { // one segment per call
+		triceTransfer()
+		bin = append(bin, out[:triceOutDepth()]...)
+		triceClearOutBuffer()
+	}
+
+	buf := fmt.Sprint(bin)
+	var o bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&o), osFSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buf[1 : len(buf)-1], "-hs=off", "-prefix=off", "-li=off", "-color=none"}))
+
+	exp := " 842,150_450 Hello World!" + strings.Repeat("\n 842,150_450 Twelve 64-bit values: -1,-2,-3,-4,-5,-6,-7,-8,-9,-10,-11,-12", 16)
+	assert.Equal(t, exp, strings.TrimSuffix(o.String(), "\n"))
+}
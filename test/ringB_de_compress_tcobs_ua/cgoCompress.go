@@ -0,0 +1,32 @@
+// Copyright 2024 Thomas.Hoehenleitner [at] seerose.net
+// Use of this source code is governed by a license that can be found in the LICENSE file.
+
+package cgot
+
+// #include <stdint.h>
+// #include <stddef.h>
+// void TriceCompressReset( void );
+// size_t TriceCompress( uint8_t* dst, const uint8_t* src, size_t len );
+// static size_t compressAll( uint8_t* dst, const uint8_t* src, const uint16_t* lens, int n ){
+//     size_t sum = 0;
+//     for( int i = 0; i < n; i++ ){
+//         sum += TriceCompress( dst, src, lens[i] );
+//         src += lens[i];
+//     }
+//     return sum;
+// }
+import "C"
+
+import "unsafe"
+
+// triceCompressReset lets the next trice start with a fresh compression state.
+func triceCompressReset() {
+	C.TriceCompressReset()
+}
+
+// triceCompressAll compresses the trices with lengths lens, stored one after another in src, and returns the compressed byte count.
+func triceCompressAll(src []byte, lens []uint16) int {
+	dst := make([]byte, 4096)
+	n := C.compressAll((*C.uint8_t)(unsafe.Pointer(&dst[0])), (*C.uint8_t)(unsafe.Pointer(&src[0])), (*C.uint16_t)(unsafe.Pointer(&lens[0])), C.int(len(lens)))
+	return int(n)
+}
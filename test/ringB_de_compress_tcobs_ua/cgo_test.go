@@ -0,0 +1,91 @@
+package cgot
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"path"
+	"strings"
+	"testing"
+
+	"github.com/rokath/tcobs/v1"
+	"github.com/rokath/trice/internal/args"
+	"github.com/rokath/trice/internal/decoder"
+	"github.com/rokath/trice/internal/trexDecoder"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+func TestLogs(t *testing.T) {
+
+	// triceLog is the log function for executing the trice logging on binary log data in buffer as space separated numbers.
+	// It uses the inside fSys specified til.json and returns the log output.
+	triceLog := func(t *testing.T, fSys *afero.Afero, buffer string) string {
+		var o bytes.Buffer
+		assert.Nil(t, args.Handler(io.Writer(&o), fSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buffer, "-hs=off", "-prefix=off", "-li=off", "-color=off", "-compressed"}))
+		return o.String()
+	}
+
+	compressLogTest(t, triceLog, testLines)
+}
+
+// compressLogTest works like triceLogTest but resets the target compression state for each line,
+// because each triceLog call starts with a fresh trice tool decompression state.
+func compressLogTest(t *testing.T, triceLog logF, limit int) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+	result := getExpectedResults(osFSys, path.Join(triceDir, "./test/testdata/triceCheck.c"))
+	for i, r := range result {
+		if limit >= 0 && i+1 >= limit {
+			return
+		}
+		fmt.Println(i, r)
+		triceCompressReset()
+		triceCheck(r.line)
+		triceTransfer()
+		bin := out[:triceOutDepth()]
+		buf := fmt.Sprint(bin)
+		act := triceLog(t, osFSys, buf[1:len(buf)-1])
+		triceClearOutBuffer()
+		assert.Equal(t, r.exps, strings.TrimSuffix(act, "\n"))
+	}
+}
+
+// BenchmarkCompress runs the triceCheck.c traffic through the target compression.
+// It reports the compressed to original size ratio and the target compression time per trice.
+func BenchmarkCompress(b *testing.B) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+	result := getExpectedResults(osFSys, path.Join(triceDir, "./test/testdata/triceCheck.c"))
+	dc := trexDecoder.NewDecompressor(decoder.LittleEndian)
+	buf := make([]byte, 4096)
+	var original []byte // all original trices
+	var lens []uint16   // original trice lengths
+	var compressed int  // compressed byte count
+	triceCompressReset()
+	for _, r := range result {
+		triceCheck(r.line)
+		triceTransfer()
+		for _, frame := range bytes.Split(out[:triceOutDepth()], []byte{0}) {
+			if len(frame) == 0 {
+				continue
+			}
+			n, err := tcobs.Decode(buf, frame)
+			assert.Nil(b, err)
+			compressed += n
+			before := len(original)
+			original, err = dc.Expand(original, buf[len(buf)-n:])
+			assert.Nil(b, err)
+			lens = append(lens, uint16(len(original)-before))
+		}
+		triceClearOutBuffer()
+	}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		triceCompressAll(original, lens)
+	}
+	b.ReportMetric(float64(b.Elapsed().Nanoseconds())/float64(b.N*len(lens)), "ns/trice")
+	b.ReportMetric(float64(compressed)/float64(len(original)), "ratio")
+}
@@ -0,0 +1,28 @@
+/*! \file triceConfig.h
+\author Thomas.Hoehenleitner [at] seerose.net
+*******************************************************************************/
+
+#ifndef TRICE_CONFIG_H_
+#define TRICE_CONFIG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRICE_BUFFER TRICE_RING_BUFFER
+#define TRICE_DEFERRED_OUTPUT 1
+#define TRICE_DEFERRED_STREAM_ENCRYPT 1
+#define TRICE_STREAM_NONCE 0x12345678
+#define TRICE_DEFERRED_OUT_FRAMING TRICE_FRAMING_COBS
+
+#define TRICE_DEFERRED_UARTA 1
+#define TRICE_UARTA
+
+#define TRICE_CGO 1
+#define TRICE_CYCLE_COUNTER 0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRICE_CONFIG_H_ */
@@ -30,6 +30,8 @@ package cgot
 // #include "../../src/triceRingBuffer.c"
 // #include "../../src/triceStackBuffer.c"
 // #include "../../src/triceStaticBuffer.c"
+// #include "../../src/triceFlash.c"
+// #include "../../src/speck.c"
 // #include "../../src/xtea.c"
 // #include "../../src/cobsDecode.c"
 // #include "../../src/cobsEncode.c"
@@ -0,0 +1,13 @@
+#include "trice.h"
+
+// TRICE_RING_BUFFER_EXACT_SIZE == 324 and each Trice occupies exactly its size.
+char* TargetActivity(void) {                                                                                                                  // 324 bytes space
+	TRice(iD(16204), "Hello ");                                                                                                               // -8 bytes = 316 bytes space
+	TRice(iD(16205), "World!\n");                                                                                                             // -8 bytes = 308 bytes space
+	TRice64(iD(16206), "msg:Twelve 64-bit values: %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", -1, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11, -12); // -104 bytes = 204 bytes space
+	TRice64(iD(16206), "msg:Twelve 64-bit values: %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", -1, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11, -12); // -104 bytes = 100 bytes space
+	trice(iD(16207), "Hello again\n");                                                                                                        // -4 bytes = 96 bytes space
+	TRice64(iD(16206), "msg:Twelve 64-bit values: %d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n", -1, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11, -12); // -104 bytes -> no fit, dropped!
+	trice(iD(16207), "Hello again\n");                                                                                                        // -4 bytes = 92 bytes space
+	return " 842,150_450 Hello World!\n 842,150_450 Twelve 64-bit values: -1,-2,-3,-4,-5,-6,-7,-8,-9,-10,-11,-12\n 842,150_450 Twelve 64-bit values: -1,-2,-3,-4,-5,-6,-7,-8,-9,-10,-11,-12\n             Hello again\n             Hello again";
+}
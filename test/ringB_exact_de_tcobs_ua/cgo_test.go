@@ -0,0 +1,49 @@
+package cgot
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"path"
+	"strings"
+	"testing"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+// triceLog is the log function for executing the trice logging on binary log data in buffer as space separated numbers.
+// It uses the inside fSys specified til.json and returns the log output.
+func triceLog(t *testing.T, fSys *afero.Afero, buffer string) string {
+	var o bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&o), fSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buffer, "-hs=off", "-prefix=off", "-li=off", "-color=off"}))
+	return o.String()
+}
+
+func TestLogs(t *testing.T) {
+	triceLogTest(t, triceLog, testLines)
+}
+
+// TestBurst checks, that a Trice burst uses the whole ring buffer and that Trices are split at the buffer end.
+// The previous test leaves the ring buffer write position somewhere, so the burst wraps.
+func TestBurst(t *testing.T) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+
+	exp := targetActivity()
+
+	// For the ring buffer, we need to call triceTransfer() at least for each Trice statement in targetActivity()
+	for i := 0; i < 10; i++ {
+		triceTransfer()
+	}
+
+	buf := fmt.Sprint(out[:triceOutDepth()])
+	var o bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&o), osFSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buf[1 : len(buf)-1], "-hs=off", "-prefix=off", "-li=off", "-color=none"}))
+	act := o.String()
+	triceClearOutBuffer()
+
+	assert.Equal(t, exp, strings.TrimSuffix(act, "\n"))
+}
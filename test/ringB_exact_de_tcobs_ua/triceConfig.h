@@ -0,0 +1,30 @@
+/*! \file triceConfig.h
+\author Thomas.Hoehenleitner [at] seerose.net
+*******************************************************************************/
+
+#ifndef TRICE_CONFIG_H_
+#define TRICE_CONFIG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRICE_BUFFER TRICE_RING_BUFFER
+#define TRICE_RING_BUFFER_EXACT 1
+
+#define TRICE_PROTECT 1
+
+#define TRICE_DEFERRED_BUFFER_SIZE 604 // TRICE_RING_BUFFER_EXACT_SIZE is 604 + 64 - 2 * 172 = 324
+
+#define TRICE_DEFERRED_OUTPUT 1
+#define TRICE_DEFERRED_UARTA 1
+#define TRICE_UARTA
+
+#define TRICE_CGO 1
+#define TRICE_CYCLE_COUNTER 0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRICE_CONFIG_H_ */
@@ -0,0 +1,16 @@
+package cgot
+
+// For some reason inside the trice_test.go an 'import "C"' is not possible.
+
+// void TargetActivity( int n );
+// void TriceInit( void );
+import "C"
+
+func targetActivity(n int) {
+	C.TargetActivity(C.int(n))
+}
+
+// triceReset is like a target reset. The ring buffer values are kept like in retained RAM.
+func triceReset() {
+	C.TriceInit()
+}
@@ -0,0 +1,86 @@
+package cgot
+
+import (
+	"bytes"
+	"fmt"
+	"io"
+	"path"
+	"strings"
+	"testing"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+// triceLog is the log function for executing the trice logging on binary log data in buffer as space separated numbers.
+// It uses the inside fSys specified til.json and returns the log output.
+func triceLog(t *testing.T, fSys *afero.Afero, buffer string) string {
+	var o bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&o), fSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buffer, "-hs=off", "-prefix=off", "-li=off", "-color=off"}))
+	return o.String()
+}
+
+func TestLogs(t *testing.T) {
+	triceLogTest(t, triceLog, testLines)
+}
+
+// transferAll calls TriceTransfer until nothing is left and returns the log of the transmitted data.
+func transferAll(t *testing.T) string {
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+	var b []byte
+	for i := 0; i < 100; i++ {
+		triceTransfer()
+		b = append(b, out[:triceOutDepth()]...)
+		triceClearOutBuffer()
+	}
+	s := fmt.Sprint(b)
+	var o bytes.Buffer
+	assert.Nil(t, args.Handler(io.Writer(&o), &afero.Afero{Fs: afero.NewOsFs()}, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", s[1 : len(s)-1], "-hs=off", "-prefix=off", "-li=off", "-color=none"}))
+	return strings.TrimSuffix(o.String(), "\n")
+}
+
+// expLog returns the expected log lines for the target activity values.
+func expLog(values ...int) (lines []string) {
+	for _, n := range values {
+		lines = append(lines, fmt.Sprintf(" 842,150_450 Twelve 64-bit values: %d,-2,-3,-4,-5,-6,-7,-8,-9,-10,-11,-12", n))
+	}
+	return
+}
+
+// TestPostMortem checks, that not transmitted trices are transmitted after a reset as previous boot block ahead of the new trices.
+func TestPostMortem(t *testing.T) {
+	transferAll(t)
+	targetActivity(1)
+	targetActivity(2)
+	targetActivity(3)
+	triceReset()
+	targetActivity(4)
+	exp := append([]string{"             previous boot begin (3 trices)"}, expLog(1, 2, 3)...)
+	exp = append(append(exp, "             previous boot end"), expLog(4)...)
+	assert.Equal(t, strings.Join(exp, "\n"), transferAll(t))
+}
+
+// TestPostMortemPartlyTransmitted checks, that after a reset only the not transmitted trices are transmitted again.
+func TestPostMortemPartlyTransmitted(t *testing.T) {
+	transferAll(t)
+	targetActivity(1)
+	targetActivity(2)
+	targetActivity(3)
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+	triceTransfer() // trice 1
+	triceReset()
+	exp := append([]string{"             previous boot begin (2 trices)"}, expLog(2, 3)...)
+	exp = append(exp, "             previous boot end")
+	assert.Equal(t, strings.Join(exp, "\n"), transferAll(t))
+}
+
+// TestPostMortemEmpty checks, that a reset without not transmitted trices gives no markers.
+func TestPostMortemEmpty(t *testing.T) {
+	transferAll(t)
+	triceReset()
+	targetActivity(5)
+	assert.Equal(t, strings.Join(expLog(5), "\n"), transferAll(t))
+}
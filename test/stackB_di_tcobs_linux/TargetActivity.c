@@ -0,0 +1,42 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "trice.h"
+
+//! triceLinuxTestCount is the trice count of each thread.
+static int triceLinuxTestCount;
+
+static void* triceLinuxTestThread(void* arg) {
+	int n = (int)(intptr_t)arg;
+	for (int i = 0; i < triceLinuxTestCount; i++) {
+		trice(iD(16208), "msg:thread %d trice %d\n", n, i);
+	}
+	return NULL;
+}
+
+// TargetActivity lets threads write count trices each over the Linux backend into the file fn.
+// It returns 0 on success, otherwise -1 or the pthread error.
+int TargetActivity(const char* fn, int threads, int count) {
+	pthread_t t[64];
+	if (threads > 64) {
+		return -1;
+	}
+	int fd = open(fn, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		return -1;
+	}
+	int err = TriceLinuxStart(fd);
+	if (err == 0) {
+		triceLinuxTestCount = count;
+		int started = 0;
+		while (started < threads && (err = pthread_create(&t[started], NULL, triceLinuxTestThread, (void*)(intptr_t)started)) == 0) {
+			started++;
+		}
+		for (int i = 0; i < started; i++) {
+			pthread_join(t[i], NULL);
+		}
+		TriceLinuxStop();
+	}
+	close(fd);
+	return err;
+}
@@ -0,0 +1,23 @@
+package cgot
+
+// For some reason inside the trice_test.go an 'import "C"' is not possible.
+
+// #cgo LDFLAGS: -pthread
+// #include <stdlib.h>
+// #include "../../src/triceLinux.c"
+// int TargetActivity( const char* fn, int threads, int count );
+import "C"
+
+import "unsafe"
+
+// targetActivity lets threads C threads write count trices each into the file fn.
+func targetActivity(fn string, threads, count int) int {
+	s := C.CString(fn)
+	defer C.free(unsafe.Pointer(s))
+	return int(C.TargetActivity(s, C.int(threads), C.int(count)))
+}
+
+// triceLinuxDropCount returns the count of trices not fitting into the ring of their thread.
+func triceLinuxDropCount() int {
+	return int(C.TriceLinuxDropCount)
+}
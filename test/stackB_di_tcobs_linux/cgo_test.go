@@ -0,0 +1,57 @@
+package cgot
+
+import (
+	"bytes"
+	"io"
+	"path"
+	"regexp"
+	"strconv"
+	"strings"
+	"testing"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+// TestThreads decodes the trices of several threads written over the Linux backend into a file.
+// The trices of each thread need to arrive in order. A trice not fitting into the ring of its thread is dropped and counted.
+func TestThreads(t *testing.T) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	fn := path.Join(t.TempDir(), "trices.bin")
+	line := regexp.MustCompile(`^\s*thread (\d+) trice (\d+)$`)
+
+	for _, x := range []struct {
+		threads, count int
+		lossless       bool // lossless is true, when the trices of one thread fit into its ring.
+	}{
+		{8, 2000, true},
+		{8, 20000, false},
+	} {
+		drops := triceLinuxDropCount()
+		assert.Equal(t, 0, targetActivity(fn, x.threads, x.count))
+		drops = triceLinuxDropCount() - drops
+
+		var o bytes.Buffer
+		assert.Nil(t, args.Handler(io.Writer(&o), osFSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=FILEBUFFER", "-args", fn, "-hs=off", "-prefix=off", "-li=off", "-color=none", "-pf=TCOBS", "-d16"}))
+
+		next := make([]int, x.threads)
+		received := 0
+		for _, s := range strings.Split(strings.TrimSuffix(o.String(), "\n"), "\n") {
+			m := line.FindStringSubmatch(s)
+			if !assert.NotNil(t, m, s) {
+				return
+			}
+			n, _ := strconv.Atoi(m[1])
+			i, _ := strconv.Atoi(m[2])
+			assert.True(t, i >= next[n], "thread %d trice %d after %d", n, i, next[n]-1)
+			next[n] = i + 1
+			received++
+		}
+		assert.Equal(t, x.threads*x.count, received+drops)
+		if x.lossless {
+			assert.Equal(t, 0, drops)
+		}
+		t.Logf("%d threads with %d trices each: %d received, %d dropped", x.threads, x.count, received, drops)
+	}
+}
@@ -0,0 +1,25 @@
+/*! \file triceConfig.h
+\author Thomas.Hoehenleitner [at] seerose.net
+*******************************************************************************/
+
+#ifndef TRICE_CONFIG_H_
+#define TRICE_CONFIG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRICE_LINUX 1
+#define TRICE_BUFFER TRICE_STACK_BUFFER
+#define TRICE_DIRECT_OUTPUT 1
+#define TRICE_DIRECT_OUT_FRAMING TRICE_FRAMING_TCOBS
+#define TRICE_DIRECT_AUXILIARY8 1
+
+#define TRICE_CGO 0 // The auxiliary output goes to the Linux backend and not into the CGO test buffer.
+#define TRICE_CYCLE_COUNTER 0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRICE_CONFIG_H_ */
@@ -0,0 +1,11 @@
+package cgot
+
+// For some reason inside the trice_test.go an 'import "C"' is not possible.
+
+// extern unsigned cgoTriceChannel;
+import "C"
+
+// triceChannel returns the SEGGER RTT up-channel of the last trice output.
+func triceChannel() int {
+	return int(C.cgoTriceChannel)
+}
@@ -0,0 +1,69 @@
+package cgot
+
+import (
+	"bytes"
+	"encoding/json"
+	"fmt"
+	"io"
+	"path"
+	"strconv"
+	"testing"
+
+	"github.com/rokath/trice/internal/args"
+	"github.com/spf13/afero"
+	"github.com/tj/assert"
+)
+
+func TestLogs(t *testing.T) {
+
+	// triceLog is the log function for executing the trice logging on binary log data in buffer as space separated numbers.
+	// It uses the inside fSys specified til.json and returns the log output.
+	triceLog := func(t *testing.T, fSys *afero.Afero, buffer string) string {
+		var o bytes.Buffer
+		assert.Nil(t, args.Handler(io.Writer(&o), fSys, []string{"trice", "log", "-i", path.Join(triceDir, "/test/testdata/til.json"), "-p=BUFFER", "-args", buffer, "-hs=off", "-prefix=off", "-li=off", "-color=off", "-pf=TCOBS", "-d16"}))
+		return o.String()
+	}
+
+	triceLogTest(t, triceLog, testLines)
+}
+
+// TestRouting checks, that the trices with IDs inside TRICE_SEGGER_RTT_ROUTED_CHANNEL_MIN_ID ... TRICE_SEGGER_RTT_ROUTED_CHANNEL_MAX_ID
+// go to the SEGGER RTT up-channel 1 and all others to up-channel 0. The trice IDs are taken from li.json.
+func TestRouting(t *testing.T) {
+	osFSys := &afero.Afero{Fs: afero.NewOsFs()}
+	b, err := osFSys.ReadFile(path.Join(triceDir, "/test/testdata/li.json"))
+	assert.Nil(t, err)
+	var li map[string]struct {
+		File string
+		Line int
+	}
+	assert.Nil(t, json.Unmarshal(b, &li))
+	idAt := make(map[int]int) // idAt maps the triceCheck.c lines to their trice IDs.
+	for k, v := range li {
+		if v.File == "triceCheck.c" {
+			id, err := strconv.Atoi(k)
+			assert.Nil(t, err)
+			idAt[v.Line] = id
+		}
+	}
+
+	out := make([]byte, 32768)
+	setTriceBuffer(out)
+	var count [2]int
+	for _, r := range getExpectedResults(osFSys, path.Join(triceDir, "./test/testdata/triceCheck.c")) {
+		id, ok := idAt[r.line]
+		if !ok {
+			continue
+		}
+		triceCheck(r.line)
+		assert.True(t, triceOutDepth() > 0, fmt.Sprint("line ", r.line))
+		triceClearOutBuffer()
+		exp := 0
+		if 16000 <= id && id <= 16365 {
+			exp = 1
+		}
+		assert.Equal(t, exp, triceChannel(), fmt.Sprint("line ", r.line, ", ID ", id))
+		count[exp]++
+	}
+	assert.True(t, count[0] > 0 && count[1] > 0, fmt.Sprint(count))
+}
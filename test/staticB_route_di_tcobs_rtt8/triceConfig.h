@@ -0,0 +1,27 @@
+/*! \file triceConfig.h
+\author Thomas.Hoehenleitner [at] seerose.net
+*******************************************************************************/
+
+#ifndef TRICE_CONFIG_H_
+#define TRICE_CONFIG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRICE_BUFFER TRICE_STATIC_BUFFER
+#define TRICE_DIRECT_OUTPUT 1
+#define TRICE_DIRECT_OUT_FRAMING TRICE_FRAMING_TCOBS
+#define TRICE_DIRECT_SEGGER_RTT_8BIT_WRITE 1
+#define TRICE_SEGGER_RTT_ROUTED_CHANNEL 1
+#define TRICE_SEGGER_RTT_ROUTED_CHANNEL_MIN_ID 16000
+#define TRICE_SEGGER_RTT_ROUTED_CHANNEL_MAX_ID 16365 // below the reserved IDs starting with TRICE_IDENTITY_ID
+
+#define TRICE_CGO 1
+#define TRICE_CYCLE_COUNTER 0 // The routed channels share one cycle counter, but the unstamped trices are not merged in their order.
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRICE_CONFIG_H_ */
@@ -0,0 +1,24 @@
+/*! \file triceConfig.h
+\author Thomas.Hoehenleitner [at] seerose.net
+*******************************************************************************/
+
+#ifndef TRICE_CONFIG_H_
+#define TRICE_CONFIG_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRICE_BUFFER TRICE_STATIC_BUFFER
+#define TRICE_DIRECT_OUTPUT 1
+#define TRICE_DIRECT_SEGGER_RTT_32BIT_WRITE 1
+#define TRICE_DIRECT_SEGGER_RTT_32BIT_ZERO_COPY 1
+
+#define TRICE_CGO 1
+#define TRICE_CYCLE_COUNTER 0
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRICE_CONFIG_H_ */
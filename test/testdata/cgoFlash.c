@@ -0,0 +1,83 @@
+/*! \file cgoFlash.c
+\brief file backed flash emulator for testing the trice flash log (TRICE_DEFERRED_FLASH == 1) on a PC
+\author thomas.hoehenleitner [at] seerose.net
+*******************************************************************************/
+#include "trice.h"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+//! cgoFlashFile is the file descriptor of the flash image.
+static int cgoFlashFile = -1;
+
+//! cgoFlashPowerFail is the count of still successful programming operations. After that programming has no effect. -1 is for no power fail.
+static int cgoFlashPowerFail = -1;
+
+//! CgoCriticalSection is incremented by TRICE_ENTER_CRITICAL_SECTION, when the test configuration does so.
+int CgoCriticalSection = 0;
+
+//! CgoFlashInCriticalSection counts the erase and program operations inside a critical section.
+int CgoFlashInCriticalSection = 0;
+
+// cgoFlashRead reads len bytes from address.
+static void cgoFlashRead(uint32_t address, void* buf, size_t len) {
+	if (pread(cgoFlashFile, buf, len, address - TRICE_FLASH_BASE_ADDRESS) != (ssize_t)len) {
+		memset(buf, 0xFF, len);
+	}
+}
+
+// cgoFlashProgram programs len bytes at address like NOR flash: Bits can only change from 1 to 0.
+static int cgoFlashProgram(uint32_t address, const void* buf, size_t len) {
+	uint8_t b[TRICE_FLASH_PAGE_SIZE];
+	if ((address % TRICE_FLASH_PROGRAM_SIZE) || (len % TRICE_FLASH_PROGRAM_SIZE) || len > sizeof(b)) {
+		return -1;
+	}
+	if (CgoCriticalSection) {
+		CgoFlashInCriticalSection++;
+	}
+	if (cgoFlashPowerFail == 0) {
+		return 0;
+	}
+	if (cgoFlashPowerFail > 0) {
+		cgoFlashPowerFail--;
+	}
+	cgoFlashRead(address, b, len);
+	for (size_t i = 0; i < len; i++) {
+		b[i] &= ((const uint8_t*)buf)[i];
+	}
+	return pwrite(cgoFlashFile, b, len, address - TRICE_FLASH_BASE_ADDRESS) == (ssize_t)len ? 0 : -1;
+}
+
+// cgoFlashErase sets the page at address to 0xFF.
+static int cgoFlashErase(uint32_t address) {
+	uint8_t b[TRICE_FLASH_PAGE_SIZE];
+	if ((address - TRICE_FLASH_BASE_ADDRESS) % TRICE_FLASH_PAGE_SIZE) {
+		return -1;
+	}
+	if (CgoCriticalSection) {
+		CgoFlashInCriticalSection++;
+	}
+	memset(b, 0xFF, sizeof(b));
+	return pwrite(cgoFlashFile, b, sizeof(b), address - TRICE_FLASH_BASE_ADDRESS) == (ssize_t)sizeof(b) ? 0 : -1;
+}
+
+// CgoFlashOpen creates the erased flash image file filename and installs the emulator functions.
+// This function is called from Go before TriceInit.
+int CgoFlashOpen(const char* filename) {
+	cgoFlashFile = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (cgoFlashFile < 0) {
+		return -1;
+	}
+	for (unsigned page = 0; page < TRICE_FLASH_PAGE_COUNT; page++) {
+		cgoFlashErase(TRICE_FLASH_BASE_ADDRESS + page * TRICE_FLASH_PAGE_SIZE);
+	}
+	UserTriceFlashReadFn = cgoFlashRead;
+	UserTriceFlashProgramFn = cgoFlashProgram;
+	UserTriceFlashEraseFn = cgoFlashErase;
+	return 0;
+}
+
+// CgoFlashPowerFail lets programming stop working after count operations. count -1 ends the power fail.
+void CgoFlashPowerFail(int count) {
+	cgoFlashPowerFail = count;
+}
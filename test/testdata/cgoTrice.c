@@ -34,3 +34,13 @@ void TriceWriteDeviceCgo(const void* buf, unsigned len) {
 	memcpy(cgoTriceBuffer + cgoTriceBufferDepth, buf, len);
 	cgoTriceBufferDepth += len;
 }
+
+// cgoTriceChannel holds the SEGGER RTT up-channel of the last TriceWriteDeviceCgoRtt call.
+unsigned cgoTriceChannel = 0;
+
+//! TriceWriteDeviceCgoRtt records upChannel and copies buf with len into triceBuffer.
+//! This function is called from the trice runtime instead of a SEGGER RTT write.
+void TriceWriteDeviceCgoRtt(unsigned upChannel, const void* buf, unsigned len) {
+	cgoTriceChannel = upChannel;
+	TriceWriteDeviceCgo(buf, len);
+}
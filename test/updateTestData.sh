@@ -21,15 +21,20 @@ CGOTESTDIRS="
     _ERROR_ringB_di_xtea_cobs_rtt32__de_cobs_ua/
     _ERROR_ringB_di_xtea_cobs_rtt32__de_tcobs_ua/
     dblB_de_cobs_ua/
+    dblB_de_flash_tcobs_ua/
     dblB_de_multi_cobs_ua/
+    dblB_de_multi_compress_tcobs_ua/
     dblB_de_multi_nopf_ua/
     dblB_de_multi_tcobs_ua/
     dblB_de_multi_xtea_cobs_ua/
     dblB_de_multi_xtea_tcobs_ua/
     dblB_de_nopf_ua/
+    dblB_de_speck_tcobs_ua/
+    dblB_de_tcobs_shm/
     dblB_de_tcobs_ua/
     dblB_de_xtea_cobs_ua/
     dblB_de_xtea_tcobs_ua/
+    dblB_seg4_de_tcobs_ua/
     dblB_di_nopf_rtt32__de_cobs_ua/
     dblB_di_nopf_rtt32__de_multi_cobs_ua/
     dblB_di_nopf_rtt32__de_multi_tcobs_ua/
@@ -40,8 +45,12 @@ CGOTESTDIRS="
     dblB_di_nopf_rtt8__de_multi_tcobs_ua/
     dblB_di_nopf_rtt8__de_tcobs_ua/
     ringB_de_cobs_ua/
+    ringB_de_compress_tcobs_ua/
     ringB_de_nopf_ua/
+    ringB_de_speck_cobs_ua/
     ringB_de_tcobs_ua/
+    ringB_exact_de_tcobs_ua/
+    ringB_postmortem_de_tcobs_ua/
     ringB_de_xtea_cobs_ua/
     ringB_de_xtea_tcobs_ua/
     ringB_di_cobs_rtt32__de_tcobs_ua/
@@ -55,6 +64,7 @@ CGOTESTDIRS="
     stackB_di_nopf_aux8/
     stackB_di_nopf_rtt32/
     stackB_di_nopf_rtt8/
+    stackB_di_tcobs_linux/
     stackB_di_xtea_cobs_rtt8/
     staticB_di_nopf_aux32/
     staticB_di_nopf_aux8/
@@ -63,6 +73,8 @@ CGOTESTDIRS="
     staticB_di_tcobs_rtt32/
     staticB_di_tcobs_rtt8/
     staticB_di_xtea_cobs_rtt32/
+    staticB_route_di_tcobs_rtt8/
+    staticB_zero_di_nopf_rtt32/
 "
 
 for d in $CGOTESTDIRS